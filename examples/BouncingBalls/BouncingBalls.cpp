@@ -37,22 +37,18 @@ struct segment
     this->dir = dir;
   }
 
-  void draw(Graphics &g, double a, double b)
+  void draw(Graphics &g, const Transform &t)
   {
     // segment
     g.drawLine(Pen(Color::White, 3),
-	       static_cast<int>(pos.x*a),
-	       static_cast<int>(pos.y*b),
-	       static_cast<int>((pos.x+dir.x)*a),
-	       static_cast<int>((pos.y+dir.y)*b));
+	       t.apply(PointF(pos.x, pos.y)),
+	       t.apply(PointF(pos.x+dir.x, pos.y+dir.y)));
 
     // normal
     vector2d normal = 8*dir.get_normal().normalize();
     g.drawLine(Pen(Color::White, 1),
-	       static_cast<int>((pos.x+dir.x/2)*a),
-	       static_cast<int>((pos.y+dir.y/2)*b),
-	       static_cast<int>((pos.x+dir.x/2+normal.x)*a),
-	       static_cast<int>((pos.y+dir.y/2+normal.y)*b));
+	       t.apply(PointF(pos.x+dir.x/2, pos.y+dir.y/2)),
+	       t.apply(PointF(pos.x+dir.x/2+normal.x, pos.y+dir.y/2+normal.y)));
   }
 
   // TODO this is wrong
@@ -216,7 +212,7 @@ void move_balls()
 
 }
 
-void draw_balls(Graphics &g, double a, double b)
+void draw_balls(Graphics &g, const Transform &t)
 {
   for (std::vector<ball*>::iterator
 	 it = balls.begin(); it != balls.end(); ++it) {
@@ -224,18 +220,18 @@ void draw_balls(Graphics &g, double a, double b)
     Brush brush(bal->color);
 
     g.fillEllipse(brush,
-		  static_cast<int>((bal->pos.x-bal->radius)*a),
-		  static_cast<int>((bal->pos.y-bal->radius)*b),
-		  static_cast<int>((bal->radius*2+1)*a),
-		  static_cast<int>((bal->radius*2+1)*b));
+		  t.apply(RectF(bal->pos.x-bal->radius,
+				bal->pos.y-bal->radius,
+				bal->radius*2+1,
+				bal->radius*2+1)));
   }
 }
 
-void draw_segments(Graphics &g, double a, double b)
+void draw_segments(Graphics &g, const Transform &t)
 {
   for (std::vector<segment>::iterator
 	 it = segments.begin(); it != segments.end(); ++it) {
-    it->draw(g, a, b);
+    it->draw(g, t);
   }
 }
 
@@ -380,8 +376,11 @@ protected:
 
     g.drawString(L"Press 'A' key to add balls", getFgColor(), 0, 0);
 
-    simulation_model::draw_balls   (g, a, b);
-    simulation_model::draw_segments(g, a, b);
+    Transform t;
+    t.scale(a, b);
+
+    simulation_model::draw_balls   (g, t);
+    simulation_model::draw_segments(g, t);
   }
 
   void onKeyDown(KeyEvent &ev)
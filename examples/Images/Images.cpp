@@ -5,6 +5,7 @@
 // please read LICENSE.txt for more information.
 
 #include <time.h>
+#include <vector>
 
 #include <vaca/vaca.h>
 #include "resource.h"
@@ -147,6 +148,132 @@ protected:
 
 //////////////////////////////////////////////////////////////////////
 
+// A big image (8192x8192) to be shown with an ImagePyramid
+static ImagePixels make_big_image()
+{
+  ImagePixels pixels(8192, 8192);
+  for (int y=0; y<pixels.getHeight(); ++y)
+    for (int x=0; x<pixels.getWidth(); ++x) {
+      int grid = ((x % 256) < 2 || (y % 256) < 2) ? 255: 0;
+      pixels.setPixel(x, y, ImagePixels::makePixel(max_value(grid, (x/32) & 255),
+						   max_value(grid, (y/32) & 255),
+						   max_value(grid, (x ^ y) & 255), 255));
+    }
+  return pixels;
+}
+
+// Paints the area of the tile using its pixels directly (they are
+// not copied to an Image)
+static void draw_tile(Graphics& g, const PyramidTile& tile)
+{
+  const ImagePixels& pixels = *tile.pixels;
+  const Rect& src = tile.srcBounds;
+  const Rect& dst = tile.dstBounds;
+
+  BITMAPINFO info;
+  ZeroMemory(&info, sizeof(info));
+  info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+  info.bmiHeader.biWidth = pixels.getScanlineSize();
+  info.bmiHeader.biHeight = -pixels.getHeight(); // top-down
+  info.bmiHeader.biPlanes = 1;
+  info.bmiHeader.biBitCount = 32;
+  info.bmiHeader.biCompression = BI_RGB;
+
+  HDC hdc = g.getHandle();
+  SetStretchBltMode(hdc, HALFTONE);
+  SetBrushOrgEx(hdc, 0, 0, NULL);
+  StretchDIBits(hdc, dst.x, dst.y, dst.w, dst.h,
+		src.x, src.y, src.w, src.h,
+		&pixels[0], &info, DIB_RGB_COLORS, SRCCOPY);
+}
+
+// Shows a big image that can be zoomed with the mouse wheel and
+// scrolled dragging it. Only the visible tiles are painted.
+class ZoomFrame : public Frame
+{
+  ImagePyramid m_pyramid;
+  std::vector<PyramidTile> m_tiles;
+  double m_zoom;
+  Point m_scroll;		// origin of the viewport in the zoomed image
+  Point m_dragPoint;
+
+public:
+
+  ZoomFrame()
+    : Frame(L"Images - Zoom (use the wheel and drag the image)")
+    , m_pyramid(make_big_image())
+    , m_zoom(1.0 / 16)
+  {
+    setDoubleBuffered(true);
+    setBgColor(Color::Gray);
+    setSize(getNonClientSize() + Size(640, 480));
+
+    // a tile is ready (this is called from a background thread, but
+    // invalidating a window is safe from any thread)
+    m_pyramid.TileReady.connect([this](int, int, int) { invalidate(false); });
+  }
+
+protected:
+
+  virtual void onMouseDown(MouseEvent& ev)
+  {
+    m_dragPoint = ev.getPoint();
+    captureMouse();
+    Frame::onMouseDown(ev);
+  }
+
+  virtual void onMouseMove(MouseEvent& ev)
+  {
+    if (hasCapture()) {
+      m_scroll -= ev.getPoint() - m_dragPoint;
+      m_dragPoint = ev.getPoint();
+      invalidate(false);
+    }
+    Frame::onMouseMove(ev);
+  }
+
+  virtual void onMouseUp(MouseEvent& ev)
+  {
+    if (hasCapture())
+      releaseMouse();
+    Frame::onMouseUp(ev);
+  }
+
+  virtual void onMouseWheel(MouseEvent& ev)
+  {
+    double zoom = m_zoom * (ev.getDelta() > 0 ? 1.25: 0.8);
+    zoom = clamp_value(zoom, 1.0 / 64, 8.0);
+
+    // keep the same point of the image under the mouse
+    Point pt = ev.getPoint();
+    m_scroll = Point(static_cast<int>((m_scroll.x + pt.x) * zoom / m_zoom) - pt.x,
+		     static_cast<int>((m_scroll.y + pt.y) * zoom / m_zoom) - pt.y);
+    m_zoom = zoom;
+
+    invalidate(false);
+    Frame::onMouseWheel(ev);
+  }
+
+  virtual void onPaint(PaintEvent& ev)
+  {
+    Graphics& g = ev.getGraphics();
+    Rect viewport(m_scroll, getClientBounds().getSize());
+
+    m_pyramid.getVisibleTiles(m_zoom, viewport, m_tiles);
+    for (auto& tile : m_tiles)
+      draw_tile(g, tile);
+  }
+
+  virtual void onResize(ResizeEvent& ev)
+  {
+    invalidate(false);
+    Frame::onResize(ev);
+  }
+
+};
+
+//////////////////////////////////////////////////////////////////////
+
 int VACA_MAIN()
 {
   srand(static_cast<unsigned int>(time(NULL)));
@@ -155,6 +282,11 @@ int VACA_MAIN()
   MainFrame frm;
   frm.setIcon(ResourceId(IDI_VACA));
   frm.setVisible(true);
+
+  ZoomFrame zoomFrm;
+  zoomFrm.setIcon(ResourceId(IDI_VACA));
+  zoomFrm.setVisible(true);
+
   app.run();
   return 0;
 }
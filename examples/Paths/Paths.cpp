@@ -446,7 +446,7 @@ private:
     Figs::iterator selFig = NULLFIGURE;
 
     for (Figs::iterator it=m_figs.begin(); it!=m_figs.end(); ++it) {
-      if (it->path.toRegion().contains(hotSpot)) {
+      if (it->path.contains(hotSpot)) {
 	selFig = it;
 	break;
       }
@@ -570,7 +570,7 @@ private:
 	case ID_COPY: {
 	  m_clipboard = *m_selFigure;
 
-	  Rect bounds = m_clipboard.path.toRegion().getBounds();
+	  Rect bounds = m_clipboard.path.getBounds();
 	  m_clipboard.path.offset(-bounds.getOrigin() - Point(bounds.getSize()/2));
 
 	  if (id == ID_CUT) {
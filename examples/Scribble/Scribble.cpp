@@ -11,7 +11,10 @@ using namespace vaca;
 
 class Scribble : public Widget
 {
-  Image m_image;
+  // The drawing is kept in a surface made of tiles, so it can be
+  // bigger than the widget, and resizing the widget doesn't need to
+  // copy it
+  TiledSurface m_surface;
   Point m_point[3];
   bool m_erasing;
 
@@ -19,47 +22,19 @@ public:
 
   Scribble(Widget* parent)
     : Widget(parent)
+    , m_surface(Color::White)
   {
     setBgColor(Color::White);
   }
 
 protected:
 
-  virtual void onResize(ResizeEvent& ev)
-  {
-    Size imageSize = getClientBounds().getSize();
-    if (imageSize.w > 0 && imageSize.h > 0) {
-      Image newImage(imageSize);
-
-      Graphics& g = newImage.getGraphics();
-
-      // clear the new image with a white background
-      Brush whiteBrush(Color::White);
-      g.fillRect(whiteBrush, 0, 0, imageSize.w, imageSize.h);
-
-      // draw the old image in the center of the new image
-      if (m_image.isValid())
-	g.drawImage(m_image, Point(imageSize/2 - m_image.getSize()/2));
-
-      // Assign the new image to the member variable m_image. Remember
-      // that Image class is a shared-pointer, so here the old image
-      // referenced by m_image is automatically deleted.  This is the
-      // magic of SharedPtrs!
-      m_image = newImage;
-
-      // redraw all the image
-      invalidate(false);
-    }
-    Widget::onResize(ev);
-  }
-
   virtual void onPaint(PaintEvent& ev)
   {
     Graphics& g = ev.getGraphics();
 
-    // draw only the clip area
-    Rect rc = g.getClipBounds();
-    g.drawImage(m_image, rc.getOrigin(), rc);
+    // draw only the clip area (only the tiles inside it are copied)
+    m_surface.paint(g, g.getClipBounds());
   }
 
   virtual void onMouseDown(MouseEvent& ev)
@@ -78,9 +53,6 @@ protected:
   virtual void onMouseMove(MouseEvent& ev)
   {
     if (hasCapture()) {
-      // get the graphics from the to draw into the image
-      Graphics& g = m_image.getGraphics();
-
       // rotate points
       m_point[0] = m_point[1];
       m_point[1] = m_point[2];
@@ -90,22 +62,7 @@ protected:
       Color color(m_erasing ? Color::White: Color::Black);
       Pen pen(color, m_erasing ? 64: 1);
 
-      // draw (or erase)
-      g.drawLine(pen, m_point[1], m_point[2]);
-
-      // we are drawing?
-      if (!m_erasing) {
-	// this adds an extra style to the trace (more realistic)
-	GraphicsPath path;
-	path.moveTo(m_point[0]);
-	path.lineTo(m_point[1]);
-	path.lineTo(m_point[2]);
-
-	Brush brush(color);
-	g.fillPath(path, brush, Point(0, 0));
-      }
-
-      // invalidate the drawn area
+      // the area to be modified
       Point minPoint = m_point[0];
       Point maxPoint = m_point[0];
       for (int c = 1; c < 3; ++c) {
@@ -114,8 +71,32 @@ protected:
 	if (maxPoint.x < m_point[c].x) maxPoint.x = m_point[c].x;
 	if (maxPoint.y < m_point[c].y) maxPoint.y = m_point[c].y;
       }
-      invalidate(Rect(minPoint-pen.getWidth(),
-		      maxPoint+pen.getWidth()), false);
+      Rect bounds(minPoint-pen.getWidth(),
+		  maxPoint+pen.getWidth());
+
+      // draw (or erase) in the tiles touched by the bounds
+      m_surface.draw(bounds, [&](Graphics& g) {
+	  g.drawLine(pen, m_point[1], m_point[2]);
+
+	  // we are drawing?
+	  if (!m_erasing) {
+	    // this adds an extra style to the trace (more realistic)
+	    GraphicsPath path;
+	    path.moveTo(m_point[0]);
+	    path.lineTo(m_point[1]);
+	    path.lineTo(m_point[2]);
+
+	    Brush brush(color);
+	    g.fillPath(path, brush, Point(0, 0));
+	  }
+	});
+
+      // invalidate only the modified parts of each tile
+      std::vector<Rect> dirty;
+      m_surface.getDirtyRects(dirty);
+      for (size_t i=0; i<dirty.size(); ++i)
+	invalidate(dirty[i], false);
+      m_surface.clearDirty();
     }
   }
 
@@ -6,14 +6,18 @@
 
 #include <vaca/vaca.h>
 #include <vfw.h>
+#include <cstdlib>
+#include <vector>
 #include "../resource.h"
 
 #ifndef WM_CAP_DRIVER_CONNECT
 
+#define WM_CAP_SET_CALLBACK_FRAME	(WM_USER+5)
 #define WM_CAP_DRIVER_CONNECT		(WM_USER+10)
 #define WM_CAP_DRIVER_DISCONNECT	(WM_USER+11)
 #define WM_CAP_DRIVER_GET_CAPS		(WM_USER+14)
 #define WM_CAP_EDIT_COPY		(WM_USER+30)
+#define WM_CAP_GET_VIDEOFORMAT		(WM_USER+44)
 #define WM_CAP_SET_PREVIEW		(WM_USER+50)
 #define WM_CAP_SET_PREVIEWRATE		(WM_USER+52)
 #define WM_CAP_SET_SCALE		(WM_USER+53)
@@ -77,13 +81,21 @@ public:
 class WebCam : public Widget
 {
   int m_driverIndex;
+  DWORD m_format;
+  FramePipeline* m_pipeline;
 
 public:
+  // Generated each time a frame is captured (it can be read with
+  // getPipeline()->acquire)
+  Signal<void()> FrameReady;
+
   WebCam(Widget* parent)
     // Create the Widget without a Win32 class (this means that the
     // HWND will be created later). See TN002 for more information.
     : Widget(WidgetClassName::None, parent, Widget::Styles::None)
     , m_driverIndex(-1)
+    , m_format(0)
+    , m_pipeline(NULL)
   {
     // now we can create the widget because in this point is when our
     // version of createHandle (see below) will be called
@@ -102,9 +114,14 @@ public:
   {
     if (m_driverIndex != driverIndex) {
       // disconnect from the old driver
-      if (m_driverIndex >= 0)
+      if (m_driverIndex >= 0) {
+	sendMessage(WM_CAP_SET_CALLBACK_FRAME, 0, 0L);
 	sendMessage(WM_CAP_DRIVER_DISCONNECT, 0, 0L);
 
+	delete m_pipeline;
+	m_pipeline = NULL;
+      }
+
       // connect to the new driver
       m_driverIndex = driverIndex;
       if (m_driverIndex >= 0) {
@@ -114,6 +131,7 @@ public:
 	    setPreferredSize(Size(cs.uiImageWidth, cs.uiImageHeight));
 	    getParent()->setSize(getParent()->getPreferredSize());
 	  }
+	  createPipeline();
 	}
       }
     }
@@ -149,7 +167,54 @@ public:
       sendMessage(WM_CAP_EDIT_COPY, 0, 0L);
   }
 
+  FramePipeline* getPipeline()
+  {
+    return m_pipeline;
+  }
+
 private:
+  // Creates the frames to receive the captured images (only for
+  // YUV formats, other formats are only previewed)
+  void createPipeline()
+  {
+    std::vector<BYTE> buf(sendMessage(WM_CAP_GET_VIDEOFORMAT, 0, 0L));
+    if (buf.size() < sizeof(BITMAPINFOHEADER) ||
+	!sendMessage(WM_CAP_GET_VIDEOFORMAT, buf.size(), reinterpret_cast<LPARAM>(&buf[0])))
+      return;
+
+    const BITMAPINFOHEADER* bih = reinterpret_cast<const BITMAPINFOHEADER*>(&buf[0]);
+    m_format = bih->biCompression;
+    if (m_format == MAKEFOURCC('Y','U','Y','2') ||
+	m_format == MAKEFOURCC('N','V','1','2')) {
+      m_pipeline = new FramePipeline(Size(bih->biWidth, std::abs(bih->biHeight)));
+      sendMessage(WM_CAP_SET_CALLBACK_FRAME, 0, reinterpret_cast<LPARAM>(&WebCam::frameCallback));
+    }
+  }
+
+  // Called by VFW with each captured frame
+  static LRESULT CALLBACK frameCallback(HWND hwnd, LPVIDEOHDR hdr)
+  {
+    WebCam* webcam = dynamic_cast<WebCam*>(Widget::fromHandle(hwnd));
+    if (webcam && webcam->m_pipeline)
+      webcam->onFrame(hdr->lpData);
+    return TRUE;
+  }
+
+  void onFrame(const unsigned char* data)
+  {
+    ImagePixels& frame = m_pipeline->beginWrite();
+    int w = frame.getWidth();
+    int h = frame.getHeight();
+
+    if (m_format == MAKEFOURCC('Y','U','Y','2'))
+      VideoFormats::yuy2ToPixels(data, w*2, frame);
+    else
+      VideoFormats::nv12ToPixels(data, w, data + w*h, w, frame);
+
+    m_pipeline->endWrite();
+    FrameReady();
+  }
+
   // This is a tricky situation, we have to override this method to
   // obtain a custom HWND that isn't created with Win32's CreateWindowEx
   virtual HWND createHandle(LPCTSTR className, Widget* parent, Style style)
@@ -165,11 +230,59 @@ private:
 
 //////////////////////////////////////////////////////////////////////
 
+// Paints the last frame captured by the WebCam, with the statistics
+// of its FramePipeline
+class FrameView : public Widget
+{
+  WebCam& m_webcam;
+  Image m_image;
+
+public:
+  FrameView(WebCam& webcam, Widget* parent)
+    : Widget(parent)
+    , m_webcam(webcam)
+  {
+    setPreferredSize(Size(160, 120));
+    setDoubleBuffered(true);
+
+    m_webcam.FrameReady.connect([this]{ invalidate(false); });
+  }
+
+protected:
+  virtual void onPaint(PaintEvent& ev)
+  {
+    Graphics& g = ev.getGraphics();
+    FramePipeline* pipeline = m_webcam.getPipeline();
+
+    // the newest frame (older frames were dropped by the pipeline)
+    if (pipeline && pipeline->acquire()) {
+      const ImagePixels& frame = pipeline->getFrame();
+      if (!m_image.isValid() || m_image.getSize() != frame.getSize())
+	m_image = Image(frame.getSize(), 32);
+      m_image.setPixels(frame);
+    }
+
+    g.fillRect(Brush(Color::Black), getClientBounds());
+    if (m_image.isValid())
+      g.drawImage(m_image, Point(0, 0));
+
+    if (pipeline)
+      g.drawString(format_string(L"%d frames, %d dropped, %.1f ms",
+				 pipeline->getProducedFrames(),
+				 pipeline->getDroppedFrames(),
+				 pipeline->getAverageLatency() * 1000.0),
+		   Color::White, 4, 4);
+  }
+};
+
+//////////////////////////////////////////////////////////////////////
+
 class MainFrame : public Frame
 {
   Label m_driverLabel;
   DriversComboBox m_driver;
   WebCam m_webcam;
+  FrameView m_frameView;
   ToggleButton m_start;
   Button m_capture;
   Button m_copy;
@@ -183,6 +296,7 @@ public:
     , m_driverLabel(L"Driver:", this)
     , m_driver(this)
     , m_webcam(this)
+    , m_frameView(m_webcam, this)
     , m_start(L"Start", this)
     , m_capture(L"Capture", this)
     , m_copy(L"Copy", this)
@@ -191,9 +305,9 @@ public:
     , m_rateEdit(L"", this, TextEdit::Styles::Default +
 			    TextEdit::Styles::ReadOnly)
   {
-    setLayout(Bix::parse(L"Y[X[%,f%],X[fX[],%,fX[]],X[fX[],%,%,%,fX[]],%,X[f%,%]]",
+    setLayout(Bix::parse(L"Y[X[%,f%],X[fX[],%,%,fX[]],X[fX[],%,%,%,fX[]],%,X[f%,%]]",
 			 &m_driverLabel, &m_driver,
-			 &m_webcam,
+			 &m_webcam, &m_frameView,
 			 &m_start, &m_capture, &m_copy,
 			 &m_rateLabel,
 			 &m_rate, &m_rateEdit));
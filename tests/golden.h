@@ -0,0 +1,298 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+// Golden-image tests: a test case renders something into ImagePixels
+// and the result is compared with a stored image (the golden image)
+// in tests/golden/<name>.pam. The comparison is perceptual: two
+// pixels are equal if their distance in the CIE L*a*b* color space
+// is below a threshold, so small rounding differences between
+// implementations (e.g. SSE2 and scalar code) don't break the tests.
+//
+// When a case fails, <name>.actual.pam and <name>.diff.pam (modified
+// pixels in red) are written in the current directory. Images are
+// saved in the PAM format (netpbm) so they can be opened with most
+// image viewers without extra libraries.
+//
+// Environment variables:
+//   VACA_GOLDEN_UPDATE=1        Rewrites the golden images with the
+//                               current results.
+//   VACA_GOLDEN_TIMES=file      Appends the render time of each case
+//                               to this file ("name seconds").
+//   VACA_GOLDEN_BASELINE=file   Fails the cases that are slower than
+//                               the times in this file (written with
+//                               VACA_GOLDEN_TIMES in a previous run)
+//                               multiplied by VACA_GOLDEN_SLOWDOWN
+//                               (1.5 by default).
+
+#ifndef VACA_TESTS_GOLDEN_H
+#define VACA_TESTS_GOLDEN_H
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "vaca/ColorSpaces.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/TimePoint.h"
+
+#ifndef VACA_GOLDEN_DIR
+  #define VACA_GOLDEN_DIR "golden"
+#endif
+
+namespace golden {
+
+using vaca::ImagePixels;
+
+/**
+   Maximum differences accepted between the rendered image and the
+   golden one.
+*/
+struct Tolerance
+{
+  // Maximum distance (CIE76 delta E) between two colors that are
+  // considered equal (2.3 is the "just noticeable difference")
+  double deltaE;
+
+  // Maximum difference in the alpha channel
+  int alpha;
+
+  // Fraction of pixels (from 0 to 1) that can be different
+  double differentPixels;
+
+  Tolerance(double deltaE = 2.3, int alpha = 2, double differentPixels = 0.0)
+    : deltaE(deltaE), alpha(alpha), differentPixels(differentPixels) { }
+};
+
+/**
+   Result of comparing two images.
+*/
+struct Comparison
+{
+  int differentPixels;
+  double maxDeltaE;
+  ImagePixels diff;
+};
+
+inline const char* get_env(const char* name)
+{
+  const char* value = std::getenv(name);
+  return value && *value ? value: NULL;
+}
+
+inline std::string golden_path(const std::string& name)
+{
+  return std::string(VACA_GOLDEN_DIR) + "/" + name + ".pam";
+}
+
+// Writes the pixels in a PAM file (RGB_ALPHA, 8 bits per channel)
+inline bool write_pam(const std::string& fileName, const ImagePixels& pixels)
+{
+  FILE* f = std::fopen(fileName.c_str(), "wb");
+  if (!f)
+    return false;
+
+  std::fprintf(f, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n",
+	       pixels.getWidth(), pixels.getHeight());
+
+  std::vector<unsigned char> row(pixels.getWidth()*4);
+  for (int y=0; y<pixels.getHeight(); ++y) {
+    for (int x=0; x<pixels.getWidth(); ++x) {
+      ImagePixels::pixel_type c = pixels.getPixel(x, y);
+      row[x*4  ] = ImagePixels::getR(c);
+      row[x*4+1] = ImagePixels::getG(c);
+      row[x*4+2] = ImagePixels::getB(c);
+      row[x*4+3] = ImagePixels::getA(c);
+    }
+    if (!row.empty())
+      std::fwrite(&row[0], 1, row.size(), f);
+  }
+
+  return std::fclose(f) == 0;
+}
+
+// Reads a PAM file written by write_pam
+inline bool read_pam(const std::string& fileName, ImagePixels& pixels)
+{
+  FILE* f = std::fopen(fileName.c_str(), "rb");
+  if (!f)
+    return false;
+
+  int w = -1, h = -1, depth = 0, maxval = 0;
+  char line[256];
+  bool ok = (std::fgets(line, sizeof(line), f) && std::strncmp(line, "P7", 2) == 0);
+
+  while (ok && std::fgets(line, sizeof(line), f)) {
+    if (std::strncmp(line, "ENDHDR", 6) == 0)
+      break;
+    std::sscanf(line, "WIDTH %d", &w);
+    std::sscanf(line, "HEIGHT %d", &h);
+    std::sscanf(line, "DEPTH %d", &depth);
+    std::sscanf(line, "MAXVAL %d", &maxval);
+  }
+
+  ok = ok && (w >= 0 && h >= 0 && depth == 4 && maxval == 255);
+  if (ok) {
+    pixels = ImagePixels(w, h);
+    std::vector<unsigned char> row(w*4);
+    for (int y=0; ok && y<h; ++y) {
+      if (w > 0 && std::fread(&row[0], 1, row.size(), f) != row.size())
+	ok = false;
+      for (int x=0; ok && x<w; ++x)
+	pixels.setPixel(x, y, ImagePixels::makePixel(row[x*4], row[x*4+1],
+						     row[x*4+2], row[x*4+3]));
+    }
+  }
+
+  std::fclose(f);
+  return ok;
+}
+
+// Compares two images of the same size. The diff image shows the
+// expected image in gray, and the different pixels in red.
+inline Comparison compare(const ImagePixels& expected, const ImagePixels& actual,
+			  const Tolerance& tolerance)
+{
+  assert(expected.getSize() == actual.getSize());
+
+  Comparison result;
+  result.differentPixels = 0;
+  result.maxDeltaE = 0.0;
+  result.diff = ImagePixels(expected.getSize());
+
+  std::vector<vaca::LabColor> labExpected, labActual;
+  vaca::ColorSpaces::rgbToLab(expected, labExpected);
+  vaca::ColorSpaces::rgbToLab(actual, labActual);
+
+  int i = 0;
+  for (int y=0; y<expected.getHeight(); ++y)
+    for (int x=0; x<expected.getWidth(); ++x, ++i) {
+      ImagePixels::pixel_type e = expected.getPixel(x, y);
+      ImagePixels::pixel_type a = actual.getPixel(x, y);
+      const vaca::LabColor& le = labExpected[i];
+      const vaca::LabColor& la = labActual[i];
+      double deltaE = std::sqrt((le.l-la.l)*(le.l-la.l) +
+				(le.a-la.a)*(le.a-la.a) +
+				(le.b-la.b)*(le.b-la.b));
+
+      if (deltaE > result.maxDeltaE)
+	result.maxDeltaE = deltaE;
+
+      if (deltaE > tolerance.deltaE ||
+	  std::abs(ImagePixels::getA(e) - ImagePixels::getA(a)) > tolerance.alpha) {
+	++result.differentPixels;
+	result.diff.setPixel(x, y, ImagePixels::makePixel(255, 0, 0, 255));
+      }
+      else {
+	int gray = 128 + static_cast<int>(le.l * 1.27) / 2;
+	result.diff.setPixel(x, y, ImagePixels::makePixel(gray, gray, gray, 255));
+      }
+    }
+
+  return result;
+}
+
+// Returns the time of the case in the VACA_GOLDEN_BASELINE file, or
+// a negative number if there is no baseline
+inline double baseline_time(const std::string& name)
+{
+  const char* fileName = get_env("VACA_GOLDEN_BASELINE");
+  FILE* f = fileName ? std::fopen(fileName, "r"): NULL;
+  if (!f)
+    return -1.0;
+
+  double result = -1.0;
+  char caseName[256];
+  double seconds;
+  while (std::fscanf(f, "%255s %lf", caseName, &seconds) == 2)
+    if (name == caseName)
+      result = seconds;	// the last time of the case
+
+  std::fclose(f);
+  return result;
+}
+
+// Renders the case (several times, to measure the best time),
+// compares the result with the golden image, and checks the time
+// against the baseline.
+inline ::testing::AssertionResult check(const std::string& name,
+					const std::function<ImagePixels()>& render,
+					const Tolerance& tolerance = Tolerance(),
+					int repetitions = 5)
+{
+  ImagePixels actual;
+  double bestTime = 0.0;
+
+  for (int i=0; i<repetitions; ++i) {
+    vaca::TimePoint t;
+    actual = render();
+    double seconds = t.elapsed();
+    if (i == 0 || seconds < bestTime)
+      bestTime = seconds;
+  }
+
+  std::printf("golden %s = %.4g s\n", name.c_str(), bestTime);
+
+  if (const char* timesFile = get_env("VACA_GOLDEN_TIMES")) {
+    if (FILE* f = std::fopen(timesFile, "a")) {
+      std::fprintf(f, "%s %.6g\n", name.c_str(), bestTime);
+      std::fclose(f);
+    }
+  }
+
+  if (get_env("VACA_GOLDEN_UPDATE")) {
+    if (!write_pam(golden_path(name), actual))
+      return ::testing::AssertionFailure() << "can't write " << golden_path(name);
+    return ::testing::AssertionSuccess();
+  }
+
+  ImagePixels expected;
+  if (!read_pam(golden_path(name), expected)) {
+    write_pam(name + ".actual.pam", actual);
+    return ::testing::AssertionFailure()
+      << "golden image " << golden_path(name) << " not found ("
+      << name << ".actual.pam written, run with VACA_GOLDEN_UPDATE=1 to create it)";
+  }
+
+  if (expected.getSize() != actual.getSize()) {
+    write_pam(name + ".actual.pam", actual);
+    return ::testing::AssertionFailure()
+      << name << ": size " << actual.getWidth() << "x" << actual.getHeight()
+      << ", expected " << expected.getWidth() << "x" << expected.getHeight();
+  }
+
+  Comparison result = compare(expected, actual, tolerance);
+  int totalPixels = expected.getWidth() * expected.getHeight();
+  if (result.differentPixels > tolerance.differentPixels * totalPixels) {
+    write_pam(name + ".actual.pam", actual);
+    write_pam(name + ".diff.pam", result.diff);
+    return ::testing::AssertionFailure()
+      << name << ": " << result.differentPixels << " of " << totalPixels
+      << " pixels are different (max delta E " << result.maxDeltaE
+      << "), see " << name << ".diff.pam";
+  }
+
+  double baseline = baseline_time(name);
+  if (baseline > 0.0) {
+    const char* slowdownVar = get_env("VACA_GOLDEN_SLOWDOWN");
+    double slowdown = slowdownVar ? std::atof(slowdownVar): 1.5;
+
+    // 1 ms of margin for very fast cases
+    if (bestTime > baseline*slowdown + 0.001)
+      return ::testing::AssertionFailure()
+	<< name << ": " << bestTime << " s, the baseline is " << baseline << " s";
+  }
+
+  return ::testing::AssertionSuccess();
+}
+
+} // namespace golden
+
+#endif // VACA_TESTS_GOLDEN_H
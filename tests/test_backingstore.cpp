@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include "vaca/BackingStore.h"
+#include "vaca/Graphics.h"
+#include "vaca/Thread.h"
+#include "vaca/win32.h"
+
+using namespace vaca;
+
+TEST(BackingStore, ReuseImage)
+{
+  Image screen(32, 32);
+  Graphics& g = screen.getGraphics();
+  BackingStore store;
+
+  Image a = store.acquire(Size(100, 50), g);
+  store.release(a);
+  EXPECT_EQ(0, store.getHits());
+  EXPECT_EQ(1, store.getMisses());
+  EXPECT_EQ(Size(100, 50), store.getCapacity());
+
+  // smaller sizes reuse the same image
+  for (int i=0; i<10; ++i) {
+    Image b = store.acquire(Size(100-i, 10+i), g);
+    EXPECT_TRUE(a == b);
+    store.release(b);
+  }
+  EXPECT_EQ(10, store.getHits());
+  EXPECT_EQ(1, store.getMisses());
+
+  // the image grows to the biggest size
+  Image c = store.acquire(Size(20, 80), g);
+  store.release(c);
+  EXPECT_TRUE(a != c);
+  EXPECT_EQ(Size(100, 80), store.getCapacity());
+  EXPECT_EQ(2, store.getMisses());
+
+  store.resetCounters();
+  EXPECT_EQ(0, store.getHits());
+  EXPECT_EQ(0, store.getMisses());
+}
+
+TEST(BackingStore, NestedAcquire)
+{
+  Image screen(32, 32);
+  Graphics& g = screen.getGraphics();
+  BackingStore store;
+
+  Image a = store.acquire(Size(10, 10), g);
+  Image b = store.acquire(Size(10, 10), g);
+  EXPECT_TRUE(a != b);
+  EXPECT_EQ(Size(10, 10), b.getSize());
+  store.release(b);
+  store.release(a);
+  EXPECT_EQ(2, store.getMisses());
+
+  Image c = store.acquire(Size(5, 5), g);
+  EXPECT_TRUE(a == c);
+  store.release(c);
+  EXPECT_EQ(1, store.getHits());
+}
+
+TEST(BackingStore, Shrink)
+{
+  Image screen(32, 32);
+  Graphics& g = screen.getGraphics();
+  BackingStore store;
+
+  store.release(store.acquire(Size(400, 400), g));
+  for (int i=0; i<BackingStore::ShrinkPeriod*2; ++i)
+    store.release(store.acquire(Size(10, 10), g));
+
+  EXPECT_EQ(Size(10, 10), store.getCapacity());
+  EXPECT_EQ(2, store.getMisses());
+}
+
+TEST(BackingStore, ImageOutlivesGraphics)
+{
+  BackingStore store;
+  {
+    // the device context of "screen" is deleted with it
+    Image screen(32, 32);
+    store.release(store.acquire(Size(100, 50), screen.getGraphics()));
+  }
+
+  Image screen(32, 32);
+  Image a = store.acquire(Size(10, 10), screen.getGraphics());
+  EXPECT_EQ(1, store.getHits());
+  EXPECT_EQ(Size(100, 50), a.getSize());
+  EXPECT_TRUE(a.getGraphics().getHandle() != NULL);
+  store.release(a);
+}
+
+TEST(BackingStore, ReleaseOnException)
+{
+  Image screen(32, 32);
+  Graphics& g = screen.getGraphics();
+  BackingStore store;
+  Image a;
+
+  try {
+    BackingStoreImage backing(store, Size(10, 10), g);
+    a = backing.getImage();
+    throw 1;
+  }
+  catch (int) {
+  }
+
+  // the store isn't locked, so the same image is reused
+  BackingStoreImage backing(store, Size(10, 10), g);
+  EXPECT_TRUE(a == backing.getImage());
+  EXPECT_EQ(1, store.getHits());
+}
+
+TEST(BackingStore, Brush)
+{
+  BackingStore store;
+  Brush a = store.getBrush(Color(10, 20, 30));
+  Brush b = store.getBrush(Color(10, 20, 30));
+  EXPECT_TRUE(a.getColor() == Color(10, 20, 30));
+  EXPECT_TRUE(convert_to<HBRUSH>(a) == convert_to<HBRUSH>(b));
+}
+
+TEST(BackingStore, CurrentThread)
+{
+  BackingStore& a = CurrentThread::getBackingStore();
+  BackingStore& b = CurrentThread::getBackingStore();
+  EXPECT_EQ(&a, &b);
+}
@@ -0,0 +1,430 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "vaca/BandedRegion.h"
+#include "vaca/Point.h"
+#include "vaca/Rect.h"
+#include "vaca/Size.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+inline std::ostream& operator<<(std::ostream& os, const Rect& rc)
+{
+  return os << "Rect("
+	    << rc.x << ", "
+	    << rc.y << ", "
+	    << rc.w << ", "
+	    << rc.h << ")\n";
+}
+
+// Checks the invariants of the bands: sorted rectangles that don't
+// touch, and adjacent bands with different spans
+static ::testing::AssertionResult is_canonical(const BandedRegion& rgn)
+{
+  const std::vector<Rect>& rects = rgn.getRects();
+  size_t prevBegin = 0, prevEnd = 0;
+
+  for (size_t i=0; i<rects.size(); ) {
+    size_t j = i+1;
+    for (; j<rects.size() && rects[j].y == rects[i].y; ++j) {
+      if (rects[j].h != rects[i].h)
+	return ::testing::AssertionFailure() << "different heights in band " << i;
+      if (rects[j].x <= rects[j-1].x + rects[j-1].w)
+	return ::testing::AssertionFailure() << "touching rectangles in band " << i;
+    }
+    if (rects[i].isEmpty())
+      return ::testing::AssertionFailure() << "empty rectangle " << i;
+
+    if (prevEnd > 0) {
+      const Rect& prev = rects[prevBegin];
+      if (prev.y + prev.h > rects[i].y)
+	return ::testing::AssertionFailure() << "overlapped bands " << i;
+
+      if (prev.y + prev.h == rects[i].y && prevEnd - prevBegin == j - i) {
+	bool equal = true;
+	for (size_t k=0; k<j-i; ++k)
+	  equal = equal && (rects[prevBegin+k].x == rects[i+k].x &&
+			    rects[prevBegin+k].w == rects[i+k].w);
+	if (equal)
+	  return ::testing::AssertionFailure() << "bands not joined " << i;
+      }
+    }
+
+    prevBegin = i;
+    prevEnd = j;
+    i = j;
+  }
+  return ::testing::AssertionSuccess();
+}
+
+// A region as a bitmap to check the operators
+class Bitmap
+{
+  std::vector<bool> m_bits;
+public:
+  enum { Size = 64 };
+
+  Bitmap() : m_bits(Size*Size, false) { }
+
+  Bitmap(const BandedRegion& rgn) : m_bits(Size*Size, false) {
+    for (auto& rc : rgn.getRects())
+      for (int y=rc.y; y<rc.y+rc.h; ++y)
+	for (int x=rc.x; x<rc.x+rc.w; ++x)
+	  m_bits[y*Size + x] = true;
+  }
+
+  bool get(int x, int y) const { return m_bits[y*Size + x]; }
+  void set(int x, int y, bool value) { m_bits[y*Size + x] = value; }
+  bool operator==(const Bitmap& other) const { return m_bits == other.m_bits; }
+};
+
+static Rect random_rect()
+{
+  int x = std::rand() % 56, y = std::rand() % 56;
+  return Rect(x, y, 1 + std::rand() % (Bitmap::Size - x), 1 + std::rand() % (Bitmap::Size - y));
+}
+
+// Creates a region joining random rectangles (they are painted in
+// the bitmap too)
+static BandedRegion random_region(Bitmap& bits)
+{
+  std::vector<Rect> rects(1 + std::rand() % 6);
+  for (auto& rc : rects) {
+    rc = random_rect();
+    for (int y=rc.y; y<rc.y+rc.h; ++y)
+      for (int x=rc.x; x<rc.x+rc.w; ++x)
+	bits.set(x, y, true);
+  }
+  return BandedRegion::fromRects(rects);
+}
+
+TEST(BandedRegion, Simple)
+{
+  BandedRegion rgn;
+  EXPECT_TRUE(rgn.isEmpty());
+
+  rgn |= BandedRegion::fromRect(Rect(5, 5, 25, 25));
+  EXPECT_TRUE(rgn.isSimple());
+  EXPECT_EQ(Rect(5, 5, 25, 25), rgn.getBounds());
+
+  EXPECT_TRUE(BandedRegion(Rect(5, 5, 0, 10)).isEmpty());
+}
+
+TEST(BandedRegion, Complex)
+{
+  BandedRegion r1;
+  r1 |= BandedRegion::fromRect(Rect(5, 5, 25, 25));
+  r1 |= BandedRegion::fromRect(Rect(20, 20, 20, 20));
+  EXPECT_TRUE(r1.isComplex());
+  EXPECT_EQ(Rect(5, 5, 35, 35), r1.getBounds());
+  EXPECT_EQ(3, r1.getBandCount());
+  EXPECT_EQ(3, r1.getRectCount());
+  EXPECT_TRUE(is_canonical(r1));
+}
+
+TEST(BandedRegion, GeometricOperations)
+{
+  BandedRegion r1 = BandedRegion::fromRect(Rect(5, 5, 25, 25));
+  BandedRegion r2 = BandedRegion::fromRect(Rect(20, 20, 20, 20));
+
+  EXPECT_EQ(Rect(5, 5, 35, 35), (r1 | r2).getBounds());
+  EXPECT_EQ(Rect(5, 5, 35, 35), (r1 + r2).getBounds());
+  EXPECT_EQ(Rect(5, 5, 25, 25), (r1 - r2).getBounds());
+  EXPECT_EQ(Rect(20, 20, 10, 10), (r1 & r2).getBounds());
+  EXPECT_EQ(Rect(5, 5, 35, 35), (r1 ^ r2).getBounds());
+
+  EXPECT_TRUE((r1 | r2) == (r2 | r1));
+  EXPECT_TRUE((r1 | r2) == (r1 + r2));
+  EXPECT_TRUE((r1 & r2) == (r2 & r1));
+  EXPECT_TRUE((r1 ^ r2) == (r2 ^ r1));
+  EXPECT_TRUE((r1 - r2) != (r2 - r1));
+  EXPECT_TRUE((r1 - r2) == (BandedRegion::fromRect(Rect(5, 5, 25, 15)) |
+			    BandedRegion::fromRect(Rect(5, 5, 15, 25))));
+  EXPECT_TRUE((r1 - r2) == (BandedRegion::fromRect(Rect(5, 5, 15, 25)) |
+			    BandedRegion::fromRect(Rect(5, 5, 25, 15))));
+
+  EXPECT_TRUE((r1 | r2) == ((r1 ^ r2) | (r1 | r2)));
+  EXPECT_TRUE((r1 & r2).isSimple());
+  EXPECT_TRUE((r1 - r1).isEmpty());
+  EXPECT_TRUE((r1 & (r2 - r1)).isEmpty());
+
+  // adjacent rectangles are joined
+  EXPECT_TRUE((BandedRegion(Rect(0, 0, 10, 10)) |
+	       BandedRegion(Rect(10, 0, 10, 10)) |
+	       BandedRegion(Rect(0, 10, 20, 5))).isSimple());
+}
+
+TEST(BandedRegion, Contains)
+{
+  BandedRegion rgn =
+    BandedRegion(Rect(0, 0, 10, 10)) |
+    BandedRegion(Rect(20, 0, 10, 10)) |
+    BandedRegion(Rect(5, 20, 10, 5));
+
+  EXPECT_TRUE(rgn.contains(Point(0, 0)));
+  EXPECT_TRUE(rgn.contains(Point(9, 9)));
+  EXPECT_FALSE(rgn.contains(Point(10, 5)));
+  EXPECT_TRUE(rgn.contains(Point(25, 5)));
+  EXPECT_FALSE(rgn.contains(Point(30, 5)));
+  EXPECT_FALSE(rgn.contains(Point(5, 15)));
+  EXPECT_TRUE(rgn.contains(Point(14, 24)));
+  EXPECT_FALSE(rgn.contains(Point(14, 25)));
+  EXPECT_FALSE(rgn.contains(Point(-1, 0)));
+
+  // some part of the rectangle is inside
+  EXPECT_TRUE(rgn.contains(Rect(9, 9, 5, 5)));
+  EXPECT_FALSE(rgn.contains(Rect(10, 0, 10, 20)));
+  EXPECT_TRUE(rgn.contains(Rect(10, 0, 11, 20)));
+  EXPECT_FALSE(rgn.contains(Rect(0, 10, 30, 10)));
+  EXPECT_FALSE(rgn.contains(Rect(0, 0, 0, 0)));
+}
+
+TEST(BandedRegion, Offset)
+{
+  BandedRegion rgn = BandedRegion(Rect(0, 0, 10, 10)) | BandedRegion(Rect(20, 5, 10, 10));
+  BandedRegion moved = rgn;
+  moved.offset(Point(3, -4));
+
+  EXPECT_EQ(Rect(3, -4, 30, 15), moved.getBounds());
+  EXPECT_TRUE(moved == (BandedRegion(Rect(3, -4, 10, 10)) | BandedRegion(Rect(23, 1, 10, 10))));
+  EXPECT_TRUE(moved.offset(-3, 4) == rgn);
+}
+
+TEST(BandedRegion, Shapes)
+{
+  BandedRegion ellipse = BandedRegion::fromEllipse(Rect(0, 0, 40, 20));
+  EXPECT_TRUE(is_canonical(ellipse));
+  EXPECT_EQ(Rect(0, 0, 40, 20), ellipse.getBounds());
+  EXPECT_TRUE(ellipse.contains(Point(20, 10)));
+  EXPECT_FALSE(ellipse.contains(Point(0, 0)));
+  EXPECT_FALSE(ellipse.contains(Point(39, 19)));
+
+  BandedRegion round = BandedRegion::fromRoundRect(Rect(0, 0, 40, 20), Size(8, 8));
+  EXPECT_TRUE(is_canonical(round));
+  EXPECT_EQ(Rect(0, 0, 40, 20), round.getBounds());
+  EXPECT_TRUE(round.contains(Point(4, 0)));
+  EXPECT_FALSE(round.contains(Point(0, 0)));
+  EXPECT_TRUE(round.contains(Point(0, 10)));
+  EXPECT_FALSE(round.contains(Point(39, 19)));
+  // the middle rows are just one band
+  EXPECT_LT(round.getBandCount(), 10);
+}
+
+TEST(BandedRegion, RandomOperations)
+{
+  std::srand(1234);
+
+  for (int c=0; c<500; ++c) {
+    Bitmap bitsA, bitsB;
+    BandedRegion a = random_region(bitsA);
+    BandedRegion b = random_region(bitsB);
+    Bitmap bitsOr, bitsAnd, bitsSub, bitsXor;
+
+    for (int y=0; y<Bitmap::Size; ++y)
+      for (int x=0; x<Bitmap::Size; ++x) {
+	bool ina = bitsA.get(x, y), inb = bitsB.get(x, y);
+	bitsOr.set(x, y, ina || inb);
+	bitsAnd.set(x, y, ina && inb);
+	bitsSub.set(x, y, ina && !inb);
+	bitsXor.set(x, y, ina != inb);
+
+	ASSERT_EQ(ina, a.contains(Point(x, y)));
+	ASSERT_EQ(ina, a.contains(Rect(x, y, 1, 1)));
+      }
+
+    BandedRegion results[] = { a | b, a & b, a - b, a ^ b };
+    for (auto& rgn : results)
+      ASSERT_TRUE(is_canonical(rgn));
+
+    ASSERT_TRUE(bitsOr == Bitmap(results[0]));
+    ASSERT_TRUE(bitsAnd == Bitmap(results[1]));
+    ASSERT_TRUE(bitsSub == Bitmap(results[2]));
+    ASSERT_TRUE(bitsXor == Bitmap(results[3]));
+
+    // the same pixels have the same rectangles
+    ASSERT_TRUE((a ^ b) == ((a - b) | (b - a)));
+    ASSERT_TRUE((a | b) == ((a ^ b) | (a & b)));
+  }
+}
+
+TEST(BandedRegion, FromBandedRects)
+{
+  std::srand(5678);
+
+  for (int c=0; c<200; ++c) {
+    Bitmap bits;
+    BandedRegion rgn = random_region(bits);
+    ASSERT_TRUE(rgn == BandedRegion::fromBandedRects(rgn.getRects()));
+
+    // bands of one row and spans split in two touching rectangles
+    // (valid bands, but not the canonical ones)
+    std::vector<Rect> rows;
+    for (int y=rgn.getBounds().y; y<rgn.getBounds().y+rgn.getBounds().h; ++y)
+      for (auto& rc : rgn.getRects())
+	if (rc.y <= y && y < rc.y+rc.h) {
+	  rows.push_back(Rect(rc.x, y, rc.w/2, 1));
+	  rows.push_back(Rect(rc.x+rc.w/2, y, rc.w-rc.w/2, 1));
+	}
+
+    BandedRegion copy = BandedRegion::fromBandedRects(rows);
+    ASSERT_TRUE(is_canonical(copy));
+    ASSERT_TRUE(rgn == copy);
+  }
+
+  EXPECT_TRUE(BandedRegion::fromBandedRects(std::vector<Rect>()).isEmpty());
+}
+
+TEST(BandedRegion, Time)
+{
+  double seconds_accum = 0.0;
+
+  for (int c=0; c<1000; ++c) {
+    TimePoint pt;
+    {
+      BandedRegion r1;
+      r1 |= BandedRegion::fromRect(Rect(5, 5, 25, 25));
+      r1 |= BandedRegion::fromRect(Rect(20, 20, 20, 20));
+      r1 += BandedRegion::fromRect(Rect(20, 20, 25, 25));
+      r1 -= BandedRegion::fromRect(Rect(20, 20, 20, 20));
+      r1 ^= BandedRegion::fromEllipse(Rect(0, 0, 100, 100));
+      r1 &= BandedRegion::fromRoundRect(Rect(0, 0, 100, 100), Size(16, 16));
+    }
+    seconds_accum += pt.elapsed();
+  }
+
+  std::printf("seconds_accum = %.16g\n", seconds_accum / 1000.0);
+}
+
+TEST(BandedRegion, ComplexAlgebraTime)
+{
+  // a grid of 32x32 ellipses minus a checkerboard, intersected with
+  // a big ellipse
+  std::vector<Rect> cells;
+  for (int y=0; y<32; ++y)
+    for (int x=0; x<32; ++x)
+      if ((x + y) & 1)
+	cells.push_back(Rect(x*30, y*30, 30, 30));
+
+  TimePoint pt;
+  BandedRegion ellipses;
+  for (int y=0; y<32; ++y) {
+    BandedRegion row;
+    for (int x=0; x<32; ++x)
+      row |= BandedRegion::fromEllipse(Rect(x*30, y*30, 34, 34));
+    ellipses |= row;
+  }
+  double tEllipses = pt.elapsed();
+
+  pt.reset();
+  BandedRegion checker = BandedRegion::fromRects(cells);
+  double tChecker = pt.elapsed();
+
+  pt.reset();
+  BandedRegion result = (ellipses - checker) ^ BandedRegion::fromEllipse(Rect(0, 0, 960, 960));
+  result &= BandedRegion::fromRoundRect(Rect(100, 100, 760, 760), Size(200, 200));
+  double tOps = pt.elapsed();
+
+  pt.reset();
+  int inside = 0;
+  for (int y=0; y<960; ++y)
+    for (int x=0; x<960; ++x)
+      if (result.contains(Point(x, y)))
+	++inside;
+  double tContains = pt.elapsed();
+
+  EXPECT_TRUE(is_canonical(result));
+  std::printf("1024 ellipses = %.4g s (%d rects)\n", tEllipses, ellipses.getRectCount());
+  std::printf("512 rects = %.4g s (%d rects)\n", tChecker, checker.getRectCount());
+  std::printf("operations = %.4g s (%d rects, %d bands)\n", tOps,
+	      result.getRectCount(), result.getBandCount());
+  std::printf("921600 contains = %.4g s (%d inside)\n", tContains, inside);
+}
+
+// A region with a lot of rectangles in each band
+static BandedRegion make_comb(int teeth)
+{
+  std::vector<Rect> rects;
+  for (int i=0; i<teeth; ++i)
+    rects.push_back(Rect(i*8, (i%3)*4, 5, 40 + (i%5)*8));
+  return BandedRegion::fromRects(rects);
+}
+
+TEST(BandedRegion, BatchContains)
+{
+  std::srand(4321);
+
+  // bands with few rectangles (linear search) and a lot of them
+  // (binary search)
+  BandedRegion regions[] = { make_comb(3), make_comb(7), make_comb(100),
+			     BandedRegion::fromEllipse(Rect(10, 10, 200, 60)),
+			     BandedRegion() };
+
+  std::vector<Point> points;
+  std::vector<Rect> rects;
+  for (int i=0; i<1000; ++i) {
+    points.push_back(Point(std::rand() % 840 - 20, std::rand() % 100 - 20));
+    rects.push_back(Rect(std::rand() % 840 - 20, std::rand() % 100 - 20,
+			 std::rand() % 12, std::rand() % 12));
+  }
+
+  for (auto& rgn : regions) {
+    std::vector<unsigned int> pointsMask, rectsMask;
+    rgn.contains(points, pointsMask);
+    rgn.contains(rects, rectsMask);
+    ASSERT_EQ(32u, pointsMask.size());
+    ASSERT_EQ(32u, rectsMask.size());
+
+    for (size_t i=0; i<points.size(); ++i) {
+      bool inside = rgn.contains(points[i]);
+      ASSERT_EQ(inside, ((pointsMask[i/32] >> (i%32)) & 1) != 0) << "point " << i;
+
+      // the scalar definition of contains(Rect)
+      bool overlap = false;
+      for (auto& rc : rgn.getRects())
+	overlap = overlap || !rc.createIntersect(rects[i]).isEmpty();
+      ASSERT_EQ(overlap, rgn.contains(rects[i])) << "rect " << i;
+      ASSERT_EQ(overlap, ((rectsMask[i/32] >> (i%32)) & 1) != 0) << "rect " << i;
+    }
+  }
+
+  std::vector<unsigned int> mask(5, 0xffffffff);
+  make_comb(3).contains(std::vector<Point>(), mask);
+  EXPECT_TRUE(mask.empty());
+}
+
+TEST(BandedRegion, BatchContainsTime)
+{
+  BandedRegion rgn;
+  for (int i=0; i<1000; ++i)
+    rgn |= BandedRegion::fromEllipse(Rect((i*37) % 1900, (i*53) % 1060, 20 + i%40, 20 + i%30));
+
+  std::vector<Point> points;
+  for (int y=0; y<1080; y+=2)
+    for (int x=0; x<1920; x+=2)
+      points.push_back(Point(x, y));
+
+  std::vector<unsigned int> mask;
+  TimePoint pt;
+  rgn.contains(points, mask);
+  double tBatch = pt.elapsed();
+
+  int inside = 0;
+  pt.reset();
+  for (auto& point : points)
+    if (rgn.contains(point))
+      ++inside;
+  double tSingle = pt.elapsed();
+
+  int batchInside = 0;
+  for (unsigned int bits : mask)
+    for (; bits; bits &= bits-1)
+      ++batchInside;
+
+  EXPECT_EQ(inside, batchInside);
+  std::printf("%d points (%d rects, %d bands): batch = %.4g s, one by one = %.4g s\n",
+	      static_cast<int>(points.size()), rgn.getRectCount(), rgn.getBandCount(),
+	      tBatch, tSingle);
+}
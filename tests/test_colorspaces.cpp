@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#include "vaca/ColorSpaces.h"
+#include "vaca/ColorQuantizer.h"
+#include "vaca/ImageFilters.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static ImagePixels make_gradient(int w, int h)
+{
+  ImagePixels pixels(w, h);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(x & 255, y & 255, (x^y) & 255, 255));
+  return pixels;
+}
+
+static bool in_palette(ImagePixels::pixel_type p, const std::vector<Color>& palette)
+{
+  Color color(ImagePixels::getR(p), ImagePixels::getG(p), ImagePixels::getB(p));
+  for (size_t i=0; i<palette.size(); ++i)
+    if (palette[i] == color)
+      return true;
+  return false;
+}
+
+TEST(ColorSpaces, Grayscale)
+{
+  ImagePixels pixels = make_gradient(37, 5);
+  ImagePixels copy = pixels.clone();
+  ImageFilters::grayscale(pixels);
+
+  for (int y=0; y<pixels.getHeight(); ++y)
+    for (int x=0; x<pixels.getWidth(); ++x) {
+      ImagePixels::pixel_type a = copy.getPixel(x, y);
+      ImagePixels::pixel_type b = pixels.getPixel(x, y);
+      int gray = (ImagePixels::getR(a)*77 +
+		  ImagePixels::getG(a)*151 +
+		  ImagePixels::getB(a)*28 + 128) >> 8;
+      EXPECT_EQ(ImagePixels::makePixel(gray, gray, gray, 255), b);
+    }
+}
+
+TEST(ColorSpaces, Invert)
+{
+  ImagePixels pixels(3, 1);
+  pixels.setPixel(0, 0, ImagePixels::makePixel(0, 0, 0, 255));
+  pixels.setPixel(1, 0, ImagePixels::makePixel(255, 128, 1, 10));
+  pixels.setPixel(2, 0, ImagePixels::makePixel(20, 30, 40, 0));
+  ImageFilters::invert(pixels);
+
+  EXPECT_EQ(ImagePixels::makePixel(255, 255, 255, 255), pixels.getPixel(0, 0));
+  EXPECT_EQ(ImagePixels::makePixel(0, 127, 254, 10), pixels.getPixel(1, 0));
+  EXPECT_EQ(ImagePixels::makePixel(235, 225, 215, 0), pixels.getPixel(2, 0));
+}
+
+TEST(ColorSpaces, Hsv)
+{
+  HsvColor hsv = ColorSpaces::rgbToHsv(Color(255, 0, 0));
+  EXPECT_FLOAT_EQ(0.0f, hsv.h);
+  EXPECT_FLOAT_EQ(1.0f, hsv.s);
+  EXPECT_FLOAT_EQ(1.0f, hsv.v);
+
+  hsv = ColorSpaces::rgbToHsv(Color(0, 0, 255));
+  EXPECT_FLOAT_EQ(240.0f, hsv.h);
+
+  hsv = ColorSpaces::rgbToHsv(Color(128, 128, 128));
+  EXPECT_FLOAT_EQ(0.0f, hsv.s);
+
+  // round trip of all the pixels
+  ImagePixels pixels = make_gradient(256, 256);
+  ImagePixels copy = pixels.clone();
+  std::vector<HsvColor> colors;
+  ColorSpaces::rgbToHsv(pixels, colors);
+  ASSERT_EQ(256u*256u, colors.size());
+  ColorSpaces::hsvToRgb(colors, pixels);
+
+  for (int y=0; y<256; ++y)
+    for (int x=0; x<256; ++x)
+      EXPECT_EQ(copy.getPixel(x, y), pixels.getPixel(x, y));
+}
+
+TEST(ColorSpaces, Lab)
+{
+  LabColor lab = ColorSpaces::rgbToLab(Color(255, 255, 255));
+  EXPECT_NEAR(100.0f, lab.l, 0.01f);
+  EXPECT_NEAR(0.0f, lab.a, 0.01f);
+  EXPECT_NEAR(0.0f, lab.b, 0.01f);
+
+  lab = ColorSpaces::rgbToLab(Color(255, 0, 0));
+  EXPECT_NEAR(53.24f, lab.l, 0.01f);
+  EXPECT_NEAR(80.09f, lab.a, 0.01f);
+  EXPECT_NEAR(67.20f, lab.b, 0.01f);
+
+  EXPECT_EQ(Color(12, 200, 99), ColorSpaces::labToRgb(ColorSpaces::rgbToLab(Color(12, 200, 99))));
+
+  // round trip of all the pixels
+  ImagePixels pixels = make_gradient(256, 256);
+  ImagePixels copy = pixels.clone();
+  std::vector<LabColor> colors;
+  ColorSpaces::rgbToLab(pixels, colors);
+  ColorSpaces::labToRgb(colors, pixels);
+
+  int maxError = 0;
+  for (int y=0; y<256; ++y)
+    for (int x=0; x<256; ++x) {
+      ImagePixels::pixel_type a = copy.getPixel(x, y);
+      ImagePixels::pixel_type b = pixels.getPixel(x, y);
+      maxError = std::max(maxError, std::abs(ImagePixels::getR(a) - ImagePixels::getR(b)));
+      maxError = std::max(maxError, std::abs(ImagePixels::getG(a) - ImagePixels::getG(b)));
+      maxError = std::max(maxError, std::abs(ImagePixels::getB(a) - ImagePixels::getB(b)));
+      EXPECT_EQ(ImagePixels::getA(a), ImagePixels::getA(b));
+    }
+  EXPECT_LE(maxError, 1);
+}
+
+TEST(ColorQuantizer, FewColors)
+{
+  ImagePixels pixels(10, 10);
+  for (int y=0; y<10; ++y)
+    for (int x=0; x<10; ++x)
+      pixels.setPixel(x, y, (x < 5) ? ImagePixels::makePixel(255, 0, 0, 255):
+				      ImagePixels::makePixel(0, 0, 255, 128));
+
+  ColorQuantizer quantizer(16);
+  std::vector<Color> palette = quantizer.createPalette(pixels);
+  ASSERT_EQ(2u, palette.size());
+  EXPECT_TRUE(in_palette(ImagePixels::makePixel(255, 0, 0, 255), palette));
+  EXPECT_TRUE(in_palette(ImagePixels::makePixel(0, 0, 255, 255), palette));
+
+  // the image must not change
+  ImagePixels copy = pixels.clone();
+  quantizer.setDithering(true);
+  quantizer.remap(pixels, palette);
+  for (int y=0; y<10; ++y)
+    for (int x=0; x<10; ++x)
+      EXPECT_EQ(copy.getPixel(x, y), pixels.getPixel(x, y));
+}
+
+TEST(ColorQuantizer, Quantize)
+{
+  EXPECT_EQ(2, ColorQuantizer::getMaxColorsForDepth(1));
+  EXPECT_EQ(16, ColorQuantizer::getMaxColorsForDepth(4));
+  EXPECT_EQ(256, ColorQuantizer::getMaxColorsForDepth(8));
+  EXPECT_EQ(256, ColorQuantizer::getMaxColorsForDepth(24));
+
+  for (int dithering=0; dithering<2; ++dithering) {
+    ImagePixels pixels = make_gradient(300, 200);
+    ImagePixels copy = pixels.clone();
+
+    ColorQuantizer quantizer(64);
+    quantizer.setDithering(dithering != 0);
+    std::vector<Color> palette = quantizer.quantize(pixels);
+    EXPECT_EQ(64u, palette.size());
+
+    // all pixels are in the palette and the average color is kept
+    double sum[2] = { 0.0, 0.0 };
+    for (int y=0; y<pixels.getHeight(); ++y)
+      for (int x=0; x<pixels.getWidth(); ++x) {
+	ImagePixels::pixel_type p = pixels.getPixel(x, y);
+	EXPECT_TRUE(in_palette(p, palette));
+	sum[0] += ImagePixels::getG(copy.getPixel(x, y));
+	sum[1] += ImagePixels::getG(p);
+      }
+    EXPECT_NEAR(sum[0], sum[1], sum[0] * 0.02);
+  }
+}
+
+TEST(ColorSpaces, Time)
+{
+  ImagePixels pixels = make_gradient(1920, 1080);
+  std::vector<HsvColor> hsv;
+  std::vector<LabColor> lab;
+  TimePoint t;
+
+  ImageFilters::grayscale(pixels);
+  std::printf("grayscale = %.4g s\n", t.elapsed());
+
+  t.reset();
+  ImageFilters::invert(pixels);
+  std::printf("invert = %.4g s\n", t.elapsed());
+
+  pixels = make_gradient(1920, 1080);
+  t.reset();
+  ColorSpaces::rgbToHsv(pixels, hsv);
+  ColorSpaces::hsvToRgb(hsv, pixels);
+  std::printf("rgbToHsv + hsvToRgb = %.4g s\n", t.elapsed());
+
+  t.reset();
+  ColorSpaces::rgbToLab(pixels, lab);
+  ColorSpaces::labToRgb(lab, pixels);
+  std::printf("rgbToLab + labToRgb = %.4g s\n", t.elapsed());
+
+  for (int dithering=0; dithering<2; ++dithering) {
+    ImagePixels copy = pixels.clone();
+    ColorQuantizer quantizer(256);
+    quantizer.setDithering(dithering != 0);
+    t.reset();
+    quantizer.quantize(copy);
+    std::printf("quantize(256%s) = %.4g s\n",
+		dithering ? ", dithering": "", t.elapsed());
+  }
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+
+#include "vaca/Compositor.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+static ImagePixels make_flat(int w, int h, pixel_type color)
+{
+  ImagePixels pixels(w, h);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      pixels.setPixel(x, y, color);
+  return pixels;
+}
+
+static bool near_pixel(pixel_type a, pixel_type b)
+{
+  return (std::abs(ImagePixels::getR(a) - ImagePixels::getR(b)) <= 1 &&
+	  std::abs(ImagePixels::getG(a) - ImagePixels::getG(b)) <= 1 &&
+	  std::abs(ImagePixels::getB(a) - ImagePixels::getB(b)) <= 1 &&
+	  std::abs(ImagePixels::getA(a) - ImagePixels::getA(b)) <= 1);
+}
+
+TEST(Compositor, Background)
+{
+  Compositor compositor(Size(10, 10), Color(1, 2, 3));
+  EXPECT_TRUE(compositor.isDamaged());
+
+  ImagePixels pixels = compositor.getPixels();
+  EXPECT_FALSE(compositor.isDamaged());
+  EXPECT_EQ(ImagePixels::makePixel(1, 2, 3, 255), pixels.getPixel(0, 0));
+  EXPECT_EQ(ImagePixels::makePixel(1, 2, 3, 255), pixels.getPixel(9, 9));
+}
+
+TEST(Compositor, Opacity)
+{
+  Compositor compositor(Size(20, 10), Color(0, 0, 0));
+  int layer = compositor.addLayer(Rect(5, 0, 10, 10));
+  compositor.setLayerPixels(layer, make_flat(10, 10, ImagePixels::makePixel(255, 100, 0, 255)));
+
+  ImagePixels pixels = compositor.getPixels();
+  EXPECT_EQ(ImagePixels::makePixel(0, 0, 0, 255), pixels.getPixel(4, 5));
+  EXPECT_EQ(ImagePixels::makePixel(255, 100, 0, 255), pixels.getPixel(5, 5));
+  EXPECT_EQ(ImagePixels::makePixel(255, 100, 0, 255), pixels.getPixel(14, 5));
+  EXPECT_EQ(ImagePixels::makePixel(0, 0, 0, 255), pixels.getPixel(15, 5));
+
+  compositor.setLayerOpacity(layer, 128);
+  pixels = compositor.getPixels();
+  EXPECT_TRUE(near_pixel(ImagePixels::makePixel(128, 50, 0, 255), pixels.getPixel(5, 5)));
+
+  // a translucent layer with straight alpha
+  compositor.setLayerOpacity(layer, 255);
+  compositor.setLayerPixels(layer, make_flat(10, 10, ImagePixels::makePixel(200, 0, 100, 64)));
+  pixels = compositor.getPixels();
+  EXPECT_TRUE(near_pixel(ImagePixels::makePixel(50, 0, 25, 255), pixels.getPixel(9, 9)));
+
+  compositor.setLayerVisible(layer, false);
+  pixels = compositor.getPixels();
+  EXPECT_EQ(ImagePixels::makePixel(0, 0, 0, 255), pixels.getPixel(9, 9));
+}
+
+TEST(Compositor, ClipAndOrder)
+{
+  Compositor compositor(Size(10, 10), Color(0, 0, 0));
+  int a = compositor.addLayer(Rect(0, 0, 10, 10));
+  int b = compositor.addLayer(Rect(0, 0, 10, 10));
+  compositor.setLayerPixels(a, make_flat(10, 10, ImagePixels::makePixel(255, 0, 0, 255)));
+  compositor.setLayerPixels(b, make_flat(10, 10, ImagePixels::makePixel(0, 255, 0, 255)));
+  compositor.setLayerClip(b, Rect(0, 0, 5, 10));
+
+  ImagePixels pixels = compositor.getPixels();
+  EXPECT_EQ(ImagePixels::makePixel(0, 255, 0, 255), pixels.getPixel(4, 0));
+  EXPECT_EQ(ImagePixels::makePixel(255, 0, 0, 255), pixels.getPixel(5, 0));
+
+  compositor.bringLayerToFront(a);
+  pixels = compositor.getPixels();
+  EXPECT_EQ(ImagePixels::makePixel(255, 0, 0, 255), pixels.getPixel(4, 0));
+
+  compositor.removeLayer(a);
+  EXPECT_EQ(1, compositor.getLayerCount());
+  pixels = compositor.getPixels();
+  EXPECT_EQ(ImagePixels::makePixel(0, 255, 0, 255), pixels.getPixel(4, 0));
+  EXPECT_EQ(ImagePixels::makePixel(0, 0, 0, 255), pixels.getPixel(5, 0));
+}
+
+TEST(Compositor, OnlyDamagedAreas)
+{
+  Compositor compositor(Size(100, 100), Color(0, 0, 0));
+  int layer = compositor.addLayer(Rect(0, 0, 100, 100));
+  compositor.getPixels();
+
+  // modified pixels are not composited until they are invalidated
+  ImagePixels layerPixels = compositor.getLayerPixels(layer);
+  layerPixels.setPixel(10, 10, ImagePixels::makePixel(255, 255, 255, 255));
+  layerPixels.setPixel(90, 90, ImagePixels::makePixel(255, 255, 255, 255));
+  EXPECT_FALSE(compositor.isDamaged());
+
+  compositor.invalidateLayer(layer, Rect(10, 10, 1, 1));
+  std::vector<Rect> damaged;
+  compositor.getDamagedRects(damaged);
+  ASSERT_EQ(1u, damaged.size());
+  EXPECT_EQ(Rect(10, 10, 1, 1), damaged[0]);
+
+  ImagePixels pixels = compositor.getPixels();
+  EXPECT_EQ(ImagePixels::makePixel(255, 255, 255, 255), pixels.getPixel(10, 10));
+  EXPECT_EQ(ImagePixels::makePixel(0, 0, 0, 255), pixels.getPixel(90, 90));
+
+  // moving a layer damages the old and the new position
+  int small = compositor.addLayer(Rect(0, 0, 10, 10));
+  compositor.getPixels();
+  compositor.setLayerBounds(small, Rect(50, 50, 10, 10));
+  compositor.getDamagedRects(damaged);
+  EXPECT_EQ(2u, damaged.size());
+
+  // overlapping rectangles are merged
+  compositor.invalidate(Rect(5, 5, 50, 50));
+  compositor.getDamagedRects(damaged);
+  EXPECT_EQ(1u, damaged.size());
+}
+
+TEST(Compositor, Time)
+{
+  Compositor compositor(Size(1920, 1080));
+  for (int i=0; i<4; ++i) {
+    int layer = compositor.addLayer(Rect(i*100, i*100, 1200, 700));
+    compositor.setLayerPixels(layer, make_flat(1200, 700, ImagePixels::makePixel(i*60, 100, 200, 200)));
+    compositor.setLayerOpacity(layer, 192);
+  }
+
+  TimePoint t;
+  compositor.compose();
+  std::printf("compose 4 layers (full) = %.4g s\n", t.elapsed());
+
+  t.reset();
+  for (int i=0; i<100; ++i)
+    compositor.invalidate(Rect(300 + i, 300, 64, 64));
+  compositor.compose();
+  std::printf("compose 4 layers (100 small moves) = %.4g s\n", t.elapsed());
+}
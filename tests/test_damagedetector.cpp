@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "vaca/DamageDetector.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static ImagePixels make_frame(int w, int h)
+{
+  ImagePixels pixels(w, h);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(x, y, x^y, 255));
+  return pixels;
+}
+
+TEST(DamageDetector, EqualFrames)
+{
+  ImagePixels a = make_frame(100, 50);
+  std::vector<Rect> damaged;
+
+  DamageDetector::compare(a, a.clone(), damaged);
+  EXPECT_TRUE(damaged.empty());
+}
+
+TEST(DamageDetector, Cells)
+{
+  ImagePixels a = make_frame(100, 50);
+  ImagePixels b = a.clone();
+  std::vector<Rect> damaged;
+
+  // one pixel in the last (incomplete) cell
+  b.setPixel(99, 7, 0);
+  DamageDetector::compare(a, b, damaged, 16);
+  ASSERT_EQ(1u, damaged.size());
+  EXPECT_EQ(Rect(96, 7, 4, 1), damaged[0]);
+
+  // a vertical line in the same cell is one rectangle
+  b = a.clone();
+  for (int y=10; y<20; ++y)
+    b.setPixel(20, y, 0);
+  DamageDetector::compare(a, b, damaged, 16);
+  ASSERT_EQ(1u, damaged.size());
+  EXPECT_EQ(Rect(16, 10, 16, 10), damaged[0]);
+
+  // two separated areas
+  b.setPixel(70, 15, 0);
+  b.setPixel(1, 40, 0);
+  DamageDetector::compare(a, b, damaged, 16);
+  ASSERT_EQ(3u, damaged.size());
+  EXPECT_EQ(Rect(16, 10, 16, 10), damaged[0]);
+  EXPECT_EQ(Rect(64, 15, 16, 1), damaged[1]);
+  EXPECT_EQ(Rect(0, 40, 16, 1), damaged[2]);
+
+  // contiguous modified cells are joined
+  b = a.clone();
+  for (int x=10; x<50; ++x)
+    b.setPixel(x, 0, 0);
+  DamageDetector::compare(a, b, damaged, 16);
+  ASSERT_EQ(1u, damaged.size());
+  EXPECT_EQ(Rect(0, 0, 64, 1), damaged[0]);
+}
+
+TEST(DamageDetector, Update)
+{
+  DamageDetector detector(8);
+  std::vector<Rect> damaged;
+  ImagePixels frame = make_frame(64, 64);
+
+  detector.update(frame, damaged);
+  ASSERT_EQ(1u, damaged.size());
+  EXPECT_EQ(Rect(0, 0, 64, 64), damaged[0]);
+
+  frame.setPixel(10, 10, 0);
+  detector.update(frame, damaged);
+  ASSERT_EQ(1u, damaged.size());
+  EXPECT_EQ(Rect(8, 10, 8, 1), damaged[0]);
+
+  // the previous frame is updated (the detector has its own copy)
+  detector.update(frame, damaged);
+  EXPECT_TRUE(damaged.empty());
+  frame.setPixel(10, 10, 1);
+  detector.update(frame, damaged);
+  EXPECT_EQ(1u, damaged.size());
+
+  detector.reset();
+  detector.update(frame, damaged);
+  ASSERT_EQ(1u, damaged.size());
+  EXPECT_EQ(Rect(0, 0, 64, 64), damaged[0]);
+
+  detector.update(make_frame(32, 32), damaged);
+  ASSERT_EQ(1u, damaged.size());
+  EXPECT_EQ(Rect(0, 0, 32, 32), damaged[0]);
+}
+
+TEST(DamageDetector, Time)
+{
+  ImagePixels a = make_frame(1920, 1080);
+  ImagePixels b = a.clone();
+  std::vector<Rect> damaged;
+
+  TimePoint t;
+  DamageDetector::compare(a, b, damaged);
+  std::printf("compare equal 1920x1080 = %.4g s\n", t.elapsed());
+
+  // a blinking caret and a progress bar
+  for (int y=500; y<520; ++y)
+    b.setPixel(300, y, 0);
+  for (int y=1000; y<1020; ++y)
+    for (int x=100; x<900; ++x)
+      b.setPixel(x, y, 0);
+
+  t.reset();
+  DamageDetector::compare(a, b, damaged);
+  std::printf("compare 1920x1080 = %.4g s (%d rects)\n", t.elapsed(),
+	      static_cast<int>(damaged.size()));
+}
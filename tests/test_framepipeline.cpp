@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "vaca/FramePipeline.h"
+#include "vaca/VideoFormats.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+// Synthetic capture device: YUY2 frames where the Y of each pixel
+// depends on its position and the frame number (the frame number is
+// also stored in the first pixel)
+class SyntheticSource
+{
+  int m_width, m_height;
+  std::vector<unsigned char> m_data;
+
+public:
+  SyntheticSource(int width, int height)
+    : m_width(width), m_height(height), m_data(width*height*2) { }
+
+  int getStride() const { return m_width*2; }
+
+  const unsigned char* capture(int frameNumber)
+  {
+    for (int y=0; y<m_height; ++y) {
+      unsigned char* p = &m_data[y*getStride()];
+      for (int x=0; x<m_width; x+=2, p+=4) {
+	p[0] = 16 + (x + y + frameNumber) % 220;
+	p[1] = 128;
+	p[2] = 16 + (x + 1 + y + frameNumber) % 220;
+	p[3] = 128;
+      }
+    }
+    m_data[0] = 16 + frameNumber % 220;
+    return &m_data[0];
+  }
+};
+
+static ImagePixels::pixel_type reference_pixel(int y, int u, int v)
+{
+  // floating-point BT.601 (video range)
+  double c = 1.164 * (y - 16);
+  double d = u - 128;
+  double e = v - 128;
+  double r = c + 1.596*e;
+  double g = c - 0.391*d - 0.813*e;
+  double b = c + 2.018*d;
+  return ImagePixels::makePixel(r < 0 ? 0: r > 255 ? 255: static_cast<int>(r + 0.5),
+				g < 0 ? 0: g > 255 ? 255: static_cast<int>(g + 0.5),
+				b < 0 ? 0: b > 255 ? 255: static_cast<int>(b + 0.5), 255);
+}
+
+static bool near_pixel(ImagePixels::pixel_type a, ImagePixels::pixel_type b, int tolerance)
+{
+  return (std::abs(ImagePixels::getR(a) - ImagePixels::getR(b)) <= tolerance &&
+	  std::abs(ImagePixels::getG(a) - ImagePixels::getG(b)) <= tolerance &&
+	  std::abs(ImagePixels::getB(a) - ImagePixels::getB(b)) <= tolerance &&
+	  ImagePixels::getA(a) == ImagePixels::getA(b));
+}
+
+TEST(VideoFormats, Yuy2)
+{
+  // all the combinations of some Y, U and V values (width 18 to test
+  // the SSE2 loop and the rest of pixels)
+  const int w = 18, h = 64;
+  std::vector<unsigned char> yuy2(w*h*2);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; x+=2) {
+      unsigned char* p = &yuy2[(y*w + x)*2];
+      p[0] = x*14;
+      p[1] = y*4;
+      p[2] = 255 - x*14;
+      p[3] = 255 - y*4;
+    }
+
+  ImagePixels pixels(w, h);
+  VideoFormats::yuy2ToPixels(&yuy2[0], w*2, pixels);
+
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x) {
+      const unsigned char* p = &yuy2[(y*w + (x & ~1))*2];
+      EXPECT_TRUE(near_pixel(reference_pixel(p[(x & 1)*2], p[1], p[3]),
+			     pixels.getPixel(x, y), 3)) << x << "," << y;
+    }
+
+  // white and black
+  unsigned char white[] = { 235, 128, 235, 128 };
+  unsigned char black[] = { 16, 128, 16, 128 };
+  ImagePixels two(2, 1);
+  VideoFormats::yuy2ToPixels(white, 4, two);
+  EXPECT_TRUE(near_pixel(ImagePixels::makePixel(255, 255, 255, 255), two.getPixel(1, 0), 1));
+  VideoFormats::yuy2ToPixels(black, 4, two);
+  EXPECT_EQ(ImagePixels::makePixel(0, 0, 0, 255), two.getPixel(0, 0));
+}
+
+TEST(VideoFormats, Nv12)
+{
+  const int w = 21, h = 6;
+  const int strideUV = w+1;
+  std::vector<unsigned char> planeY(w*h), planeUV(strideUV*h/2);
+  for (size_t i=0; i<planeY.size(); ++i)
+    planeY[i] = (i*37) & 255;
+  for (size_t i=0; i<planeUV.size(); ++i)
+    planeUV[i] = (i*59) & 255;
+
+  ImagePixels pixels(w, h);
+  VideoFormats::nv12ToPixels(&planeY[0], w, &planeUV[0], strideUV, pixels);
+
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x) {
+      const unsigned char* uv = &planeUV[(y/2)*strideUV + (x & ~1)];
+      EXPECT_TRUE(near_pixel(reference_pixel(planeY[y*w + x], uv[0], uv[1]),
+			     pixels.getPixel(x, y), 3)) << x << "," << y;
+    }
+}
+
+TEST(FramePipeline, DropStaleFrames)
+{
+  FramePipeline pipeline(Size(4, 4));
+  EXPECT_FALSE(pipeline.acquire());
+
+  for (int i=1; i<=3; ++i) {
+    pipeline.beginWrite().setPixel(0, 0, i);
+    pipeline.endWrite();
+  }
+
+  // only the last frame is acquired
+  ASSERT_TRUE(pipeline.acquire());
+  EXPECT_EQ(3u, pipeline.getFrame().getPixel(0, 0));
+  EXPECT_FALSE(pipeline.acquire());
+  EXPECT_EQ(3u, pipeline.getFrame().getPixel(0, 0));
+
+  EXPECT_EQ(3, pipeline.getProducedFrames());
+  EXPECT_EQ(1, pipeline.getConsumedFrames());
+  EXPECT_EQ(2, pipeline.getDroppedFrames());
+  EXPECT_GE(pipeline.getLastLatency(), 0.0);
+
+  // the acquired frame is not overwritten by the producer
+  for (int i=4; i<=10; ++i) {
+    pipeline.beginWrite().setPixel(0, 0, i);
+    pipeline.endWrite();
+    EXPECT_EQ(3u, pipeline.getFrame().getPixel(0, 0));
+  }
+  ASSERT_TRUE(pipeline.acquire());
+  EXPECT_EQ(10u, pipeline.getFrame().getPixel(0, 0));
+
+  pipeline.resetCounters();
+  EXPECT_EQ(0, pipeline.getProducedFrames());
+  EXPECT_EQ(0, pipeline.getDroppedFrames());
+}
+
+TEST(FramePipeline, Threads)
+{
+  const int w = 320, h = 240, frames = 500;
+  FramePipeline pipeline(Size(w, h));
+
+  // gray levels of each Y value (to know the frame number of each
+  // converted pixel)
+  std::vector<int> frameOfGray(256, -1);
+  for (int i=0; i<220; ++i) {
+    unsigned char yuy2[] = { static_cast<unsigned char>(16 + i), 128,
+			     static_cast<unsigned char>(16 + i), 128 };
+    ImagePixels two(2, 1);
+    VideoFormats::yuy2ToPixels(yuy2, 4, two);
+    frameOfGray[ImagePixels::getG(two.getPixel(0, 0))] = i;
+  }
+
+  std::thread producer([&]() {
+      SyntheticSource source(w, h);
+      for (int i=0; i<frames; ++i) {
+	const unsigned char* data = source.capture(i);
+	VideoFormats::yuy2ToPixels(data, source.getStride(), pipeline.beginWrite());
+	pipeline.endWrite();
+      }
+    });
+
+  // the consumer must see complete frames (the first and the last
+  // pixel from the same frame)
+  while (pipeline.getProducedFrames() < frames) {
+    if (!pipeline.acquire())
+      continue;
+
+    const ImagePixels& frame = pipeline.getFrame();
+    int first = frameOfGray[ImagePixels::getG(frame.getPixel(0, 0))];
+    int last = frameOfGray[ImagePixels::getG(frame.getPixel(w-1, h-1))];
+    ASSERT_GE(first, 0);
+    EXPECT_EQ((w-1 + h-1 + first) % 220, last);
+  }
+  producer.join();
+  pipeline.acquire();
+
+  EXPECT_EQ(frames, pipeline.getProducedFrames());
+  EXPECT_EQ(frames, pipeline.getConsumedFrames() + pipeline.getDroppedFrames());
+  std::printf("%d frames: %d consumed, %d dropped, %.3g ms of average latency\n",
+	      frames, pipeline.getConsumedFrames(), pipeline.getDroppedFrames(),
+	      pipeline.getAverageLatency() * 1000.0);
+}
+
+TEST(VideoFormats, Time)
+{
+  const int w = 1920, h = 1080;
+  SyntheticSource source(w, h);
+  const unsigned char* data = source.capture(0);
+  ImagePixels pixels(w, h);
+
+  TimePoint t;
+  for (int i=0; i<10; ++i)
+    VideoFormats::yuy2ToPixels(data, source.getStride(), pixels);
+  std::printf("yuy2ToPixels 1920x1080 = %.4g s\n", t.elapsed() / 10);
+
+  std::vector<unsigned char> nv12(w*h*3/2, 128);
+  t.reset();
+  for (int i=0; i<10; ++i)
+    VideoFormats::nv12ToPixels(&nv12[0], w, &nv12[w*h], w, pixels);
+  std::printf("nv12ToPixels 1920x1080 = %.4g s\n", t.elapsed() / 10);
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include "golden.h"
+#include "vaca/ColorQuantizer.h"
+#include "vaca/Compositor.h"
+#include "vaca/ImageFilters.h"
+#include "vaca/ImageResampler.h"
+
+using namespace vaca;
+
+static ImagePixels make_test_card(int w, int h)
+{
+  ImagePixels pixels(w, h);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x) {
+      int checker = ((x/8 + y/8) & 1) ? 255: 0;
+      pixels.setPixel(x, y, ImagePixels::makePixel(x*255/w, y*255/h, checker, 255));
+    }
+  return pixels;
+}
+
+static ImagePixels make_flat(int w, int h, ImagePixels::pixel_type color)
+{
+  ImagePixels pixels(w, h);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      pixels.setPixel(x, y, color);
+  return pixels;
+}
+
+//////////////////////////////////////////////////////////////////////
+// The harness
+
+TEST(Golden, PamFile)
+{
+  ImagePixels a = make_test_card(13, 7);
+  a.setPixel(3, 3, ImagePixels::makePixel(1, 2, 3, 4));
+  ASSERT_TRUE(golden::write_pam("golden_pamfile.pam", a));
+
+  ImagePixels b;
+  ASSERT_TRUE(golden::read_pam("golden_pamfile.pam", b));
+  ASSERT_EQ(a.getSize(), b.getSize());
+  for (int y=0; y<a.getHeight(); ++y)
+    for (int x=0; x<a.getWidth(); ++x)
+      EXPECT_EQ(a.getPixel(x, y), b.getPixel(x, y));
+
+  std::remove("golden_pamfile.pam");
+  EXPECT_FALSE(golden::read_pam("golden_pamfile.pam", b));
+}
+
+TEST(Golden, PerceptualTolerance)
+{
+  ImagePixels a = make_test_card(32, 32);
+  ImagePixels b = a.clone();
+
+  // an off-by-one in a channel is not visible
+  b.setPixel(0, 0, a.getPixel(0, 0) + 1);
+  golden::Comparison result = golden::compare(a, b, golden::Tolerance());
+  EXPECT_EQ(0, result.differentPixels);
+  EXPECT_GT(result.maxDeltaE, 0.0);
+
+  // a different color is
+  b.setPixel(5, 5, ImagePixels::makePixel(255, 255, 255, 255) ^ a.getPixel(5, 5));
+  result = golden::compare(a, b, golden::Tolerance());
+  EXPECT_EQ(1, result.differentPixels);
+  EXPECT_EQ(ImagePixels::makePixel(255, 0, 0, 255), result.diff.getPixel(5, 5));
+  EXPECT_NE(ImagePixels::makePixel(255, 0, 0, 255), result.diff.getPixel(0, 0));
+
+  // and a different alpha
+  b = a.clone();
+  b.setPixel(7, 7, a.getPixel(7, 7) & 0x00ffffff);
+  EXPECT_EQ(1, golden::compare(a, b, golden::Tolerance()).differentPixels);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Cases
+
+TEST(Golden, GaussianBlur)
+{
+  EXPECT_TRUE(golden::check("gaussian_blur", []() {
+	ImagePixels pixels = make_test_card(128, 96);
+	ImageFilters::gaussianBlur(pixels, 3.0);
+	return pixels;
+      }));
+}
+
+TEST(Golden, Resample)
+{
+  ImagePixels card = make_test_card(256, 192);
+
+  EXPECT_TRUE(golden::check("resample_bilinear", [&]() {
+	return ImageResampler(ResampleFilter::Bilinear).resample(card, Size(100, 75));
+      }));
+
+  EXPECT_TRUE(golden::check("resample_lanczos", [&]() {
+	return ImageResampler(ResampleFilter::Lanczos).resample(card, Size(100, 75));
+      }));
+}
+
+TEST(Golden, Quantize)
+{
+  // dithering patterns can change a lot with small changes, so a
+  // few different pixels are accepted
+  EXPECT_TRUE(golden::check("quantize_dither", []() {
+	ImagePixels pixels = make_test_card(128, 96);
+	ColorQuantizer quantizer(16);
+	quantizer.setDithering(true);
+	quantizer.quantize(pixels);
+	return pixels;
+      }, golden::Tolerance(2.3, 2, 0.01)));
+}
+
+TEST(Golden, Compositor)
+{
+  EXPECT_TRUE(golden::check("compositor_layers", []() {
+	Compositor compositor(Size(120, 90), Color(255, 255, 255));
+
+	int card = compositor.addLayer(Rect(0, 0, 120, 90));
+	compositor.setLayerPixels(card, make_test_card(120, 90));
+
+	int overlay = compositor.addLayer(Rect(20, 15, 80, 60));
+	compositor.setLayerPixels(overlay, make_flat(80, 60, ImagePixels::makePixel(0, 0, 128, 160)));
+	compositor.setLayerOpacity(overlay, 200);
+
+	int clipped = compositor.addLayer(Rect(50, 0, 60, 90));
+	compositor.setLayerPixels(clipped, make_flat(60, 90, ImagePixels::makePixel(255, 200, 0, 255)));
+	compositor.setLayerOpacity(clipped, 96);
+	compositor.setLayerClip(clipped, Rect(0, 30, 120, 30));
+
+	return compositor.getPixels();
+      }));
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "vaca/GraphicsPath.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+// Distance from a point to the segment a-b
+static double segment_distance(double x, double y, const Point& a, const Point& b)
+{
+  double dx = b.x - a.x, dy = b.y - a.y;
+  double len2 = dx*dx + dy*dy;
+  double t = (len2 > 0.0 ? ((x - a.x)*dx + (y - a.y)*dy) / len2: 0.0);
+  t = std::max(0.0, std::min(1.0, t));
+  double ex = a.x + t*dx - x, ey = a.y + t*dy - y;
+  return std::sqrt(ex*ex + ey*ey);
+}
+
+// Maximum distance from the curve to the polyline
+static double max_distance(const Point& p0, const Point& p1,
+			   const Point& p2, const Point& p3,
+			   const std::vector<Point>& polyline)
+{
+  double result = 0.0;
+  for (int i=0; i<=1000; ++i) {
+    double t = i / 1000.0, u = 1.0 - t;
+    double x = u*u*u*p0.x + 3*u*u*t*p1.x + 3*u*t*t*p2.x + t*t*t*p3.x;
+    double y = u*u*u*p0.y + 3*u*u*t*p1.y + 3*u*t*t*p2.y + t*t*t*p3.y;
+
+    double best = 1e9;
+    for (size_t j=1; j<polyline.size(); ++j)
+      best = std::min(best, segment_distance(x, y, polyline[j-1], polyline[j]));
+    result = std::max(result, best);
+  }
+  return result;
+}
+
+TEST(GraphicsPath, FlattenLines)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).lineTo(10, 0).lineTo(10, 10).closeFigure();
+  path.flatten();
+
+  ASSERT_EQ(3u, path.size());
+  EXPECT_TRUE(path.begin()[2].isCloseFigure());
+}
+
+TEST(GraphicsPath, FlattenCurve)
+{
+  Point p0(0, 0), p1(50, 200), p2(250, -100), p3(300, 100);
+
+  for (double tolerance : { 2.0, 0.5, 0.25, 0.1 }) {
+    GraphicsPath path;
+    path.moveTo(p0).curveTo(p1, p2, p3).closeFigure();
+    path.moveTo(400, 0).lineTo(500, 0);
+    path.flatten(tolerance);
+
+    std::vector<Point> polyline;
+    GraphicsPath::const_iterator it = path.begin();
+    ASSERT_EQ(GraphicsPath::MoveTo, it->getType());
+    polyline.push_back(it->getPoint());
+
+    for (++it; it->getType() == GraphicsPath::LineTo && !it[-1].isCloseFigure(); ++it)
+      polyline.push_back(it->getPoint());
+
+    // the curve finishes in p3 with the CloseFigure flag
+    EXPECT_EQ(p3, polyline.back());
+    EXPECT_TRUE(it[-1].isCloseFigure());
+
+    // the other figure wasn't modified
+    ASSERT_EQ(2, path.end() - it);
+    EXPECT_EQ(Point(400, 0), it[0].getPoint());
+    EXPECT_EQ(Point(500, 0), it[1].getPoint());
+
+    // rounding to integers can add half a pixel (sqrt(2)/2)
+    EXPECT_LE(max_distance(p0, p1, p2, p3, polyline), tolerance + 0.71)
+      << "tolerance " << tolerance;
+
+    // no more than the needed segments
+    if (tolerance >= 0.5) {
+      EXPECT_LT(polyline.size(), 40u);
+    }
+  }
+}
+
+TEST(GraphicsPath, FlattenTime)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0);
+  for (int i=0; i<10000; ++i)
+    path.curveTo(i*10+3, 100, i*10+6, -100, i*10+10, 0);
+
+  TimePoint t;
+  GraphicsPath flat = path;
+  flat.flatten();
+  std::printf("flatten 10000 curves = %.4g s (%u nodes)\n", t.elapsed(), flat.size());
+}
+
+TEST(GraphicsPath, Contains)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).lineTo(100, 0).lineTo(100, 100).lineTo(0, 100).closeFigure();
+
+  EXPECT_TRUE(path.contains(Point(0, 0)));
+  EXPECT_TRUE(path.contains(Point(50, 50)));
+  EXPECT_TRUE(path.contains(Point(99, 99)));
+  EXPECT_FALSE(path.contains(Point(100, 50)));
+  EXPECT_FALSE(path.contains(Point(50, 100)));
+  EXPECT_FALSE(path.contains(Point(-1, 50)));
+
+  // a nested figure with the same direction: a hole only with the even-odd rule
+  path.moveTo(25, 25).lineTo(75, 25).lineTo(75, 75).lineTo(25, 75).closeFigure();
+  EXPECT_FALSE(path.contains(Point(50, 50), FillRule::EvenOdd));
+  EXPECT_TRUE(path.contains(Point(50, 50), FillRule::Winding));
+  EXPECT_TRUE(path.contains(Point(10, 50), FillRule::EvenOdd));
+
+  // open figures are closed (a triangle)
+  GraphicsPath open;
+  open.moveTo(0, 0).lineTo(100, 0).lineTo(0, 100);
+  EXPECT_TRUE(open.contains(Point(10, 10)));
+  EXPECT_FALSE(open.contains(Point(60, 60)));
+
+  // a line after closeFigure() starts in the first point of the
+  // closed figure
+  GraphicsPath closed;
+  closed.moveTo(0, 0).lineTo(100, 0).lineTo(100, 10).closeFigure();
+  closed.lineTo(-100, 100).lineTo(-100, 0);
+  EXPECT_TRUE(closed.contains(Point(-50, 20)));
+  EXPECT_TRUE(closed.contains(Point(90, 5)));
+  EXPECT_FALSE(closed.contains(Point(50, 20)));
+
+  // curves are flattened
+  GraphicsPath curve;
+  curve.moveTo(0, 0).curveTo(0, -100, 100, -100, 100, 0).closeFigure();
+  EXPECT_TRUE(curve.contains(Point(50, -50)));
+  EXPECT_FALSE(curve.contains(Point(50, -80)));
+  EXPECT_FALSE(curve.contains(Point(50, 10)));
+}
+
+TEST(GraphicsPath, Bounds)
+{
+  GraphicsPath path;
+  EXPECT_EQ(Rect(), path.getBounds());
+
+  path.moveTo(10, 20).lineTo(50, 20).curveTo(90, 20, 90, 60, 50, 60);
+  Rect bounds = path.getBounds();
+  EXPECT_EQ(10, bounds.x);
+  EXPECT_EQ(20, bounds.y);
+  EXPECT_EQ(40, bounds.h);
+  EXPECT_GT(bounds.x+bounds.w, 75);	// the curve, not the control points
+  EXPECT_LT(bounds.x+bounds.w, 90);
+}
+
+TEST(GraphicsPath, ContainsAfterEdit)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).lineTo(10, 0).lineTo(10, 10).lineTo(0, 10).closeFigure();
+  EXPECT_FALSE(path.contains(Point(15, 5)));
+
+  path.offset(10, 0);
+  EXPECT_TRUE(path.contains(Point(15, 5)));
+  EXPECT_EQ(Rect(10, 0, 10, 10), path.getBounds());
+
+  GraphicsPath::iterator it = path.begin() + 1;
+  it->getPoint().x = 30;
+  EXPECT_TRUE(path.contains(Point(25, 2)));
+  EXPECT_EQ(Rect(10, 0, 20, 10), path.getBounds());
+
+  path.moveTo(100, 100).lineTo(110, 100).lineTo(110, 110);
+  EXPECT_TRUE(path.contains(Point(109, 105)));
+
+  path.clear();
+  EXPECT_FALSE(path.contains(Point(15, 5)));
+}
+
+TEST(GraphicsPath, ContainsTime)
+{
+  // 100 figures like the ones of examples/Paths
+  std::vector<GraphicsPath> figures(100);
+  for (int i=0; i<100; ++i)
+    figures[i]
+      .moveTo(-64, -64).lineTo(64, -64)
+      .curveTo(128, -32, 128, 32, 64, 64)
+      .lineTo(-64, 64).closeFigure()
+      .offset((i % 10) * 100, (i / 10) * 100);
+
+  TimePoint t;
+  int hits = 0;
+  for (int y=0; y<1000; y+=4)
+    for (int x=0; x<1000; x+=4)
+      for (size_t i=0; i<figures.size(); ++i)
+	if (figures[i].contains(Point(x, y)))
+	  ++hits;
+
+  std::printf("contains %d points x 100 figures = %.4g s (%d hits)\n",
+	      250*250, t.elapsed(), hits);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+
+#include "vaca/ImageAtlas.h"
+#include "vaca/SkylinePacker.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static ImagePixels make_icon(int w, int h, int id)
+{
+  ImagePixels pixels(w, h);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(id & 255, x, y, 255));
+  return pixels;
+}
+
+static bool overlap(const Rect& a, const Rect& b)
+{
+  return (a.x < b.x+b.w && b.x < a.x+a.w &&
+	  a.y < b.y+b.h && b.y < a.y+a.h);
+}
+
+TEST(SkylinePacker, NoOverlaps)
+{
+  SkylinePacker packer(Size(256, 256));
+  std::vector<Rect> rects;
+  Point pos;
+
+  std::srand(1);
+  for (int i=0; i<500; ++i) {
+    Size size(1 + std::rand() % 40, 1 + std::rand() % 40);
+    if (packer.insert(size, pos))
+      rects.push_back(Rect(pos, size));
+  }
+
+  ASSERT_FALSE(rects.empty());
+  Rect sheet(0, 0, 256, 256);
+  long area = 0;
+  for (size_t i=0; i<rects.size(); ++i) {
+    EXPECT_TRUE(sheet.contains(rects[i]));
+    area += rects[i].w * rects[i].h;
+    for (size_t j=i+1; j<rects.size(); ++j)
+      EXPECT_FALSE(overlap(rects[i], rects[j]));
+  }
+  EXPECT_DOUBLE_EQ(area / (256.0*256.0), packer.getOccupancy());
+  EXPECT_GT(packer.getOccupancy(), 0.7);
+}
+
+TEST(SkylinePacker, Full)
+{
+  SkylinePacker packer(Size(32, 32));
+  Point pos;
+
+  for (int i=0; i<16; ++i) {
+    EXPECT_TRUE(packer.insert(Size(8, 8), pos));
+    EXPECT_EQ(0, pos.x % 8);
+    EXPECT_EQ(0, pos.y % 8);
+  }
+  EXPECT_FALSE(packer.insert(Size(1, 1), pos));
+  EXPECT_DOUBLE_EQ(1.0, packer.getOccupancy());
+  EXPECT_FALSE(packer.insert(Size(33, 1), pos));
+
+  packer.clear();
+  EXPECT_TRUE(packer.insert(Size(32, 32), pos));
+}
+
+TEST(ImageAtlas, Lookup)
+{
+  ImageAtlas atlas(Size(64, 64), 1);
+  std::vector<int> indexes;
+
+  for (int i=0; i<40; ++i)
+    indexes.push_back(atlas.addImage(make_icon(4 + i % 13, 4 + i % 7, i)));
+
+  // bigger than a sheet
+  int big = atlas.addImage(make_icon(100, 80, 99));
+
+  EXPECT_EQ(-1, atlas.getSheet(big));
+  atlas.pack();
+  EXPECT_EQ(41, atlas.getImageCount());
+  EXPECT_LE(atlas.getSheetCount(), 4);
+
+  for (int i=0; i<40; ++i) {
+    int sheet = atlas.getSheet(indexes[i]);
+    Rect bounds = atlas.getBounds(indexes[i]);
+    ASSERT_GE(sheet, 0);
+    EXPECT_EQ(Size(4 + i % 13, 4 + i % 7), bounds.getSize());
+
+    ImagePixels pixels = atlas.getSheetPixels(sheet);
+    for (int y=0; y<bounds.h; ++y)
+      for (int x=0; x<bounds.w; ++x)
+	EXPECT_EQ(ImagePixels::makePixel(i, x, y, 255),
+		  pixels.getPixel(bounds.x+x, bounds.y+y));
+  }
+
+  int sheet = atlas.getSheet(big);
+  EXPECT_EQ(Rect(0, 0, 100, 80), atlas.getBounds(big));
+  EXPECT_EQ(Size(101, 81), atlas.getSheetPixels(sheet).getSize());
+
+  // more images are packed in the existing sheets
+  int sheets = atlas.getSheetCount();
+  int small = atlas.addImage(make_icon(2, 2, 7));
+  atlas.pack();
+  EXPECT_EQ(sheets, atlas.getSheetCount());
+  EXPECT_GE(atlas.getSheet(small), 0);
+
+  atlas.clear();
+  EXPECT_EQ(0, atlas.getImageCount());
+  EXPECT_EQ(0, atlas.getSheetCount());
+}
+
+TEST(ImageAtlas, Time)
+{
+  ImageAtlas atlas;
+  TimePoint t;
+
+  static const int sizes[] = { 16, 24, 32, 48 };
+  for (int i=0; i<1000; ++i)
+    atlas.addImage(make_icon(sizes[i % 4], sizes[(i/4) % 4], i));
+  std::printf("add 1000 icons = %.4g s\n", t.elapsed());
+
+  t.reset();
+  atlas.pack();
+  std::printf("pack 1000 icons = %.4g s (%d sheets, %.0f%% used in the first one)\n",
+	      t.elapsed(), atlas.getSheetCount(), atlas.getOccupancy(0) * 100.0);
+}
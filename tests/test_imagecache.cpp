@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "vaca/ImageCache.h"
+#include "vaca/Thread.h"
+#include "vaca/TimePoint.h"
+
+#include <memory>
+#include <vector>
+
+using namespace vaca;
+
+static ImagePixels make_pixels(int w, int h, ImagePixels::pixel_type color)
+{
+  ImagePixels pixels(w, h);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      pixels.setPixel(x, y, color);
+  return pixels;
+}
+
+TEST(ImageCache, Keys)
+{
+  ImageCacheKey a(ResourceId(10));
+  ImageCacheKey b(ResourceId(10), Size(16, 16));
+  ImageCacheKey c(L"image.bmp");
+  ImageCacheKey d(L"image.bmp", Size(16, 16));
+
+  EXPECT_TRUE(a.isResource());
+  EXPECT_FALSE(c.isResource());
+  EXPECT_TRUE(a == ImageCacheKey(ResourceId(10)));
+  EXPECT_TRUE(a != b);
+  EXPECT_TRUE(c != d);
+  EXPECT_TRUE(a != c);
+  EXPECT_TRUE((a < b) != (b < a));
+  EXPECT_TRUE((c < d) != (d < c));
+}
+
+TEST(ImageCache, GetAndPut)
+{
+  ImageCache cache;
+  ImageCacheKey key(L"a.bmp");
+  ImagePixels pixels;
+
+  EXPECT_FALSE(cache.get(key, pixels));
+  EXPECT_EQ(1, cache.getMisses());
+
+  ImagePixels original = make_pixels(8, 4, 0xff102030);
+  cache.put(key, original);
+  EXPECT_EQ(1, cache.getCount());
+  EXPECT_EQ(8u*4u*4u, cache.getBytes());
+
+  // the cache keeps a copy of the pixels
+  original.setPixel(0, 0, 0);
+
+  ASSERT_TRUE(cache.get(key, pixels));
+  EXPECT_EQ(1, cache.getHits());
+  EXPECT_EQ(Size(8, 4), pixels.getSize());
+  EXPECT_EQ(0xff102030, pixels.getPixel(0, 0));
+
+  // replace the image
+  cache.put(key, make_pixels(2, 2, 0));
+  EXPECT_EQ(1, cache.getCount());
+  EXPECT_EQ(2u*2u*4u, cache.getBytes());
+
+  cache.remove(key);
+  EXPECT_EQ(0, cache.getCount());
+  EXPECT_EQ(0u, cache.getBytes());
+  EXPECT_FALSE(cache.contains(key));
+}
+
+TEST(ImageCache, LeastRecentlyUsed)
+{
+  // space for three images of 16x16
+  ImageCache cache(3*16*16*4);
+  ImagePixels pixels;
+
+  for (int i=0; i<3; ++i)
+    cache.put(ImageCacheKey(ResourceId(i)), make_pixels(16, 16, i));
+
+  // use the first one, so the second one is the least recently used
+  EXPECT_TRUE(cache.get(ImageCacheKey(ResourceId(0)), pixels));
+
+  cache.put(ImageCacheKey(ResourceId(3)), make_pixels(16, 16, 3));
+  EXPECT_EQ(3, cache.getCount());
+  EXPECT_EQ(1, cache.getEvictions());
+  EXPECT_TRUE(cache.contains(ImageCacheKey(ResourceId(0))));
+  EXPECT_FALSE(cache.contains(ImageCacheKey(ResourceId(1))));
+  EXPECT_TRUE(cache.contains(ImageCacheKey(ResourceId(2))));
+  EXPECT_TRUE(cache.contains(ImageCacheKey(ResourceId(3))));
+
+  // a bigger image removes two images
+  cache.put(ImageCacheKey(ResourceId(4)), make_pixels(32, 16, 4));
+  EXPECT_EQ(2, cache.getCount());
+  EXPECT_EQ(3, cache.getEvictions());
+  EXPECT_TRUE(cache.contains(ImageCacheKey(ResourceId(3))));
+
+  // images bigger than the budget are not stored
+  cache.put(ImageCacheKey(ResourceId(5)), make_pixels(64, 64, 5));
+  EXPECT_FALSE(cache.contains(ImageCacheKey(ResourceId(5))));
+
+  cache.setBudget(16*16*4);
+  EXPECT_EQ(0, cache.getCount());
+  EXPECT_EQ(5, cache.getEvictions());
+
+  cache.resetCounters();
+  EXPECT_EQ(0, cache.getHits());
+  EXPECT_EQ(0, cache.getMisses());
+  EXPECT_EQ(0, cache.getEvictions());
+}
+
+TEST(ImageCache, Threads)
+{
+  ImageCache cache(64*32*32*4);
+  std::vector<std::unique_ptr<Thread> > threads;
+
+  // background "decoders" and readers of the same keys
+  for (int t=0; t<4; ++t)
+    threads.push_back(std::unique_ptr<Thread>(new Thread([&cache, t] {
+	    ImagePixels pixels;
+	    for (int i=0; i<2000; ++i) {
+	      ImageCacheKey key(ResourceId(i % 100));
+	      if (!cache.get(key, pixels))
+		cache.put(key, make_pixels(32, 32, i % 100));
+	      else
+		EXPECT_EQ(static_cast<ImagePixels::pixel_type>(i % 100), pixels.getPixel(31, 31));
+	    }
+	  })));
+
+  for (size_t t=0; t<threads.size(); ++t)
+    threads[t]->join();
+
+  EXPECT_LE(cache.getBytes(), cache.getBudget());
+  EXPECT_EQ(4*2000, cache.getHits() + cache.getMisses());
+}
+
+TEST(ImageCache, Time)
+{
+  ImageCache cache(256*128*128*4);
+  ImagePixels pixels = make_pixels(128, 128, 0);
+  TimePoint t;
+
+  for (int i=0; i<1024; ++i)
+    cache.put(ImageCacheKey(ResourceId(i)), pixels);
+  std::printf("put 1024 images (128x128, %d evictions) = %.4g s\n",
+	      cache.getEvictions(), t.elapsed());
+
+  // the last 256 images are in the cache
+  t.reset();
+  for (int i=0; i<100000; ++i)
+    cache.get(ImageCacheKey(ResourceId(768 + i % 256)), pixels);
+  std::printf("get 100000 images (%d hits) = %.4g s\n", cache.getHits(), t.elapsed());
+}
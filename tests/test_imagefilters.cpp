@@ -0,0 +1,226 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "vaca/ImageFilters.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static ImagePixels make_flat(int w, int h, ImagePixels::pixel_type color)
+{
+  ImagePixels pixels(w, h);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      pixels.setPixel(x, y, color);
+  return pixels;
+}
+
+static int sum_of_red(const ImagePixels& pixels)
+{
+  int sum = 0;
+  for (int y=0; y<pixels.getHeight(); ++y)
+    for (int x=0; x<pixels.getWidth(); ++x)
+      sum += ImagePixels::getR(pixels.getPixel(x, y));
+  return sum;
+}
+
+TEST(ImageFilters, Clone)
+{
+  ImagePixels a = make_flat(4, 4, ImagePixels::makePixel(1, 2, 3, 4));
+  ImagePixels b = a.clone();
+  a.setPixel(0, 0, 0);
+  EXPECT_EQ(ImagePixels::makePixel(1, 2, 3, 4), b.getPixel(0, 0));
+}
+
+TEST(ImageFilters, FlatColor)
+{
+  ImagePixels::pixel_type color = ImagePixels::makePixel(10, 200, 77, 255);
+  ImagePixels pixels = make_flat(50, 40, color);
+
+  ImageFilters::boxBlur(pixels, 5);
+  ImageFilters::gaussianBlur(pixels, 2.0);
+  ImageFilters::gaussianBlur(pixels, 30.0);
+  ImageFilters::sharpen(pixels, 1.5);
+
+  for (int y=0; y<pixels.getHeight(); ++y)
+    for (int x=0; x<pixels.getWidth(); ++x)
+      EXPECT_EQ(color, pixels.getPixel(x, y));
+}
+
+TEST(ImageFilters, BoxBlur)
+{
+  // one white pixel in the middle of a black image
+  ImagePixels pixels = make_flat(9, 9, ImagePixels::makePixel(0, 0, 0, 255));
+  pixels.setPixel(4, 4, ImagePixels::makePixel(225, 225, 225, 255));
+
+  ImageFilters::boxBlur(pixels, 1);
+
+  for (int y=0; y<9; ++y)
+    for (int x=0; x<9; ++x) {
+      bool inside = (x >= 3 && x <= 5 && y >= 3 && y <= 5);
+      EXPECT_EQ(inside ? 25: 0, ImagePixels::getR(pixels.getPixel(x, y)));
+    }
+}
+
+TEST(ImageFilters, GaussianBlurKeepsEnergy)
+{
+  ImagePixels pixels = make_flat(64, 64, ImagePixels::makePixel(0, 0, 0, 255));
+  for (int y=24; y<40; ++y)
+    for (int x=24; x<40; ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(200, 200, 200, 255));
+
+  int before = sum_of_red(pixels);
+
+  ImagePixels small = pixels.clone();
+  ImageFilters::gaussianBlur(small, 1.5);
+  EXPECT_NEAR(before, sum_of_red(small), before / 100);
+  EXPECT_LT(ImagePixels::getR(small.getPixel(24, 32)), 200);
+  EXPECT_GT(ImagePixels::getR(small.getPixel(23, 32)), 0);
+
+  ImagePixels big = pixels.clone();
+  ImageFilters::gaussianBlur(big, 6.0);
+  EXPECT_NEAR(before, sum_of_red(big), before / 100);
+  EXPECT_LT(ImagePixels::getR(big.getPixel(32, 32)), 200);
+}
+
+TEST(ImageFilters, Convolve)
+{
+  // [-1 1 0] finds horizontal edges
+  ImagePixels pixels = make_flat(8, 2, ImagePixels::makePixel(0, 0, 0, 255));
+  for (int x=4; x<8; ++x) {
+    pixels.setPixel(x, 0, ImagePixels::makePixel(100, 100, 100, 255));
+    pixels.setPixel(x, 1, ImagePixels::makePixel(100, 100, 100, 255));
+  }
+
+  std::vector<double> horz = { -1.0, 1.0, 0.0 };
+  std::vector<double> vert = { 0.0, 1.0, 0.0 };
+  ImageFilters::convolve(pixels, horz, vert);
+
+  for (int x=0; x<8; ++x)
+    EXPECT_EQ(x == 4 ? 100: 0, ImagePixels::getR(pixels.getPixel(x, 0)));
+}
+
+TEST(ImageFilters, ConvolveTinyImage)
+{
+  // a kernel wider than the image: the weights of the pixels outside
+  // the image are added to the border pixels
+  ImagePixels pixels = make_flat(2, 2, ImagePixels::makePixel(60, 60, 60, 255));
+  std::vector<double> blur(31, 1.0/31);
+  std::vector<double> one = { 1.0 };
+  ImageFilters::convolve(pixels, blur, blur);
+  for (int y=0; y<2; ++y)
+    for (int x=0; x<2; ++x)
+      EXPECT_EQ(60, ImagePixels::getR(pixels.getPixel(x, y)));
+
+  // the sum of the weights (2.25) doesn't fit in the fixed-point
+  // weights, so the gain is reduced (and the result is not wrapped)
+  pixels = make_flat(1, 1, ImagePixels::makePixel(50, 50, 50, 255));
+  ImageFilters::convolve(pixels, std::vector<double>(9, 0.25), one);
+  EXPECT_EQ(100, ImagePixels::getR(pixels.getPixel(0, 0)));
+
+  // the weights of the pixels of a row keep their proportions
+  pixels = make_flat(2, 1, ImagePixels::makePixel(0, 0, 0, 255));
+  pixels.setPixel(1, 0, ImagePixels::makePixel(20, 20, 20, 255));
+  ImageFilters::convolve(pixels, std::vector<double>(31, 0.2), one);
+  EXPECT_NEAR(20*3.0 / 3.2 * 2, ImagePixels::getR(pixels.getPixel(0, 0)), 1);
+  EXPECT_NEAR(20*2.0, ImagePixels::getR(pixels.getPixel(1, 0)), 1);
+}
+
+TEST(ImageFilters, Sharpen)
+{
+  ImagePixels pixels = make_flat(16, 16, ImagePixels::makePixel(100, 100, 100, 255));
+  for (int y=0; y<16; ++y)
+    for (int x=8; x<16; ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(150, 150, 150, 255));
+
+  ImageFilters::sharpen(pixels, 1.0);
+
+  EXPECT_LT(ImagePixels::getR(pixels.getPixel(7, 8)), 100);
+  EXPECT_GT(ImagePixels::getR(pixels.getPixel(8, 8)), 150);
+  EXPECT_EQ(100, ImagePixels::getR(pixels.getPixel(0, 8)));
+  EXPECT_EQ(150, ImagePixels::getR(pixels.getPixel(15, 8)));
+}
+
+TEST(ImageFilters, MaskColorToAlpha)
+{
+  ImagePixels pixels(7, 3);
+  for (int y=0; y<3; ++y)
+    for (int x=0; x<7; ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(255, 0, 255, 0));
+
+  pixels.setPixel(0, 0, ImagePixels::makePixel(10, 20, 30, 0));
+  pixels.setPixel(1, 0, ImagePixels::makePixel(250, 4, 251, 0));
+  pixels.setPixel(5, 1, ImagePixels::makePixel(240, 0, 255, 128));
+  pixels.setPixel(6, 2, ImagePixels::makePixel(255, 0, 249, 0));
+
+  ImagePixels exact = pixels.clone();
+  ImageFilters::maskColorToAlpha(exact, Color(255, 0, 255));
+  EXPECT_EQ(ImagePixels::makePixel(10, 20, 30, 255), exact.getPixel(0, 0));
+  EXPECT_EQ(ImagePixels::makePixel(250, 4, 251, 255), exact.getPixel(1, 0));
+  EXPECT_EQ(ImagePixels::makePixel(240, 0, 255, 255), exact.getPixel(5, 1));
+  EXPECT_EQ(ImagePixels::makePixel(255, 0, 249, 255), exact.getPixel(6, 2));
+  EXPECT_EQ(0u, exact.getPixel(2, 0));
+  EXPECT_EQ(0u, exact.getPixel(4, 2));
+
+  ImagePixels tolerant = pixels.clone();
+  ImageFilters::maskColorToAlpha(tolerant, Color(255, 0, 255), 6);
+  EXPECT_EQ(ImagePixels::makePixel(10, 20, 30, 255), tolerant.getPixel(0, 0));
+  EXPECT_EQ(0u, tolerant.getPixel(1, 0));
+  EXPECT_EQ(ImagePixels::makePixel(240, 0, 255, 255), tolerant.getPixel(5, 1));
+  EXPECT_EQ(0u, tolerant.getPixel(6, 2));
+}
+
+TEST(ImageFilters, SplitStrip)
+{
+  ImagePixels strip(50, 8);
+  for (int y=0; y<8; ++y)
+    for (int x=0; x<50; ++x)
+      strip.setPixel(x, y, ImagePixels::makePixel(x / 16, x % 16, y, 255));
+
+  std::vector<ImagePixels> frames = ImageFilters::splitStrip(strip, 16);
+  ASSERT_EQ(3u, frames.size());
+  for (int i=0; i<3; ++i) {
+    EXPECT_EQ(Size(16, 8), frames[i].getSize());
+    for (int y=0; y<8; ++y)
+      for (int x=0; x<16; ++x)
+	EXPECT_EQ(ImagePixels::makePixel(i, x, y, 255), frames[i].getPixel(x, y));
+  }
+
+  EXPECT_TRUE(ImageFilters::splitStrip(strip, 51).empty());
+}
+
+TEST(ImageFilters, Time)
+{
+  ImagePixels pixels(1920, 1080);
+  for (int y=0; y<pixels.getHeight(); ++y)
+    for (int x=0; x<pixels.getWidth(); ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(x, y, x^y, 255));
+
+  int radius[] = { 1, 8, 64 };
+  for (int i=0; i<3; ++i) {
+    TimePoint t;
+    ImageFilters::boxBlur(pixels, radius[i]);
+    std::printf("boxBlur(%d) = %.4g s\n", radius[i], t.elapsed());
+  }
+
+  double sigma[] = { 1.0, 4.0, 32.0 };
+  for (int i=0; i<3; ++i) {
+    TimePoint t;
+    ImageFilters::gaussianBlur(pixels, sigma[i]);
+    std::printf("gaussianBlur(%g) = %.4g s\n", sigma[i], t.elapsed());
+  }
+
+  // a strip of 256 icons of 32x32
+  ImagePixels strip(256*32, 32);
+  for (int y=0; y<strip.getHeight(); ++y)
+    for (int x=0; x<strip.getWidth(); ++x)
+      strip.setPixel(x, y, (x+y) % 5 == 0 ? ImagePixels::makePixel(255, 0, 255, 0):
+					    ImagePixels::makePixel(x, y, 0, 0));
+  TimePoint t;
+  ImageFilters::maskColorToAlpha(strip, Color(255, 0, 255), 2);
+  std::printf("maskColorToAlpha(256 icons) = %.4g s\n", t.elapsed());
+
+  t.reset();
+  std::vector<ImagePixels> frames = ImageFilters::splitStrip(strip, 32);
+  std::printf("splitStrip(256 icons) = %.4g s\n", t.elapsed());
+}
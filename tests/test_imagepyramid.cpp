@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+
+#include "vaca/ImagePyramid.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+static ImagePixels make_image(int w, int h)
+{
+  ImagePixels pixels(w, h);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(x*7, y*3, x^y, 255 - (x+y)%64));
+  return pixels;
+}
+
+// Reference 2x2 box filter (rounding as the pyramid does)
+static ImagePixels half_size(const ImagePixels& src)
+{
+  int w = src.getWidth(), h = src.getHeight();
+  ImagePixels dst((w+1)/2, (h+1)/2);
+
+  for (int y=0; y<dst.getHeight(); ++y)
+    for (int x=0; x<dst.getWidth(); ++x) {
+      int sx[2] = { 2*x, std::min(2*x+1, w-1) };
+      int sy[2] = { 2*y, std::min(2*y+1, h-1) };
+      pixel_type result = 0;
+
+      for (int shift=0; shift<32; shift+=8) {
+	int c[2];
+	for (int i=0; i<2; ++i)
+	  c[i] = (((src.getPixel(sx[i], sy[0]) >> shift) & 255) +
+		  ((src.getPixel(sx[i], sy[1]) >> shift) & 255) + 1) / 2;
+	result |= static_cast<pixel_type>((c[0] + c[1] + 1) / 2) << shift;
+      }
+      dst.setPixel(x, y, result);
+    }
+  return dst;
+}
+
+// Checks that the tiles cover the whole viewport without overlapping
+static void expect_covered(const std::vector<PyramidTile>& tiles, const Rect& viewport)
+{
+  Rect visible(viewport.getSize());
+  int area = 0;
+  for (auto& tile : tiles) {
+    Rect rc = tile.dstBounds.createIntersect(visible);
+    area += rc.w * rc.h;
+  }
+  EXPECT_EQ(visible.w * visible.h, area);
+}
+
+TEST(ImagePyramid, Levels)
+{
+  ImagePyramid pyramid(make_image(1000, 600), 256, 1);
+
+  ASSERT_EQ(3, pyramid.getLevelCount());
+  EXPECT_EQ(Size(1000, 600), pyramid.getLevelSize(0));
+  EXPECT_EQ(Size(500, 300), pyramid.getLevelSize(1));
+  EXPECT_EQ(Size(250, 150), pyramid.getLevelSize(2));
+
+  EXPECT_EQ(0, pyramid.getLevelForZoom(4.0));
+  EXPECT_EQ(0, pyramid.getLevelForZoom(1.0));
+  EXPECT_EQ(0, pyramid.getLevelForZoom(0.6));
+  EXPECT_EQ(1, pyramid.getLevelForZoom(0.5));
+  EXPECT_EQ(1, pyramid.getLevelForZoom(0.3));
+  EXPECT_EQ(2, pyramid.getLevelForZoom(0.25));
+  EXPECT_EQ(2, pyramid.getLevelForZoom(0.01));
+
+  // nothing is created until it is visible
+  pyramid.waitIdle();
+  EXPECT_EQ(0, pyramid.getBuiltTileCount());
+}
+
+TEST(ImagePyramid, Downsample)
+{
+  // odd sizes in all levels
+  ImagePixels source = make_image(1001, 603);
+  ImagePyramid pyramid(source, 64);
+  ASSERT_EQ(5, pyramid.getLevelCount());
+
+  std::vector<PyramidTile> tiles;
+  ImagePixels expected = source;
+
+  for (int level=1; level<pyramid.getLevelCount(); ++level) {
+    expected = half_size(expected);
+
+    double zoom = 1.0 / (1 << level);
+    Size size = pyramid.getLevelSize(level);
+    Rect viewport(0, 0, size.w, size.h);
+
+    pyramid.getVisibleTiles(zoom, viewport, tiles);
+    pyramid.waitIdle();
+    pyramid.getVisibleTiles(zoom, viewport, tiles);
+
+    ASSERT_EQ(((size.w+63)/64) * ((size.h+63)/64), static_cast<int>(tiles.size()));
+    expect_covered(tiles, viewport);
+
+    // each tile has its own pixels (the level is not allocated)
+    for (auto& tile : tiles) {
+      ASSERT_TRUE(tile.exact);
+      ASSERT_EQ(level, tile.level);
+      EXPECT_EQ(Rect(tile.dstBounds.getSize()), tile.srcBounds);
+      EXPECT_EQ(tile.dstBounds.getSize(), tile.pixels->getSize());
+
+      const Rect& dst = tile.dstBounds;
+      for (int y=0; y<dst.h; ++y)
+	for (int x=0; x<dst.w; ++x)
+	  ASSERT_EQ(expected.getPixel(dst.x+x, dst.y+y), tile.pixels->getPixel(x, y))
+	    << "level " << level << " pixel " << dst.x+x << "," << dst.y+y;
+    }
+  }
+}
+
+TEST(ImagePyramid, OddTileSize)
+{
+  // the tile size is rounded up to an even number
+  ImagePixels source = make_image(301, 157);
+  ImagePyramid pyramid(source, 37);
+  EXPECT_EQ(38, pyramid.getTileSize());
+
+  std::vector<PyramidTile> tiles;
+  ImagePixels expected = half_size(half_size(source));
+  Size size = pyramid.getLevelSize(2);
+  Rect viewport(0, 0, size.w, size.h);
+
+  pyramid.getVisibleTiles(0.25, viewport, tiles);
+  pyramid.waitIdle();
+  pyramid.getVisibleTiles(0.25, viewport, tiles);
+
+  for (auto& tile : tiles) {
+    ASSERT_TRUE(tile.exact);
+    const Rect& dst = tile.dstBounds;
+    for (int y=0; y<dst.h; ++y)
+      for (int x=0; x<dst.w; ++x)
+	ASSERT_EQ(expected.getPixel(dst.x+x, dst.y+y),
+		  tile.pixels->getPixel(tile.srcBounds.x+x, tile.srcBounds.y+y));
+  }
+}
+
+TEST(ImagePyramid, VisibleTiles)
+{
+  ImagePyramid pyramid(make_image(4000, 3000), 128);
+  std::vector<PyramidTile> tiles;
+
+  // original size, the level 0 is always ready
+  pyramid.getVisibleTiles(1.0, Rect(1000, 1000, 300, 200), tiles);
+  ASSERT_EQ(4*3, static_cast<int>(tiles.size()));
+  expect_covered(tiles, Rect(1000, 1000, 300, 200));
+  for (auto& tile : tiles) {
+    EXPECT_TRUE(tile.exact);
+    EXPECT_EQ(0, tile.level);
+  }
+
+  pyramid.waitIdle();
+  EXPECT_EQ(0, pyramid.getBuiltTileCount());
+
+  // the tiles of a new zoom are taken from other levels until they
+  // are ready, but the whole viewport is painted
+  Rect viewport(700, 300, 640, 480);
+  pyramid.getVisibleTiles(0.4, viewport, tiles);
+  expect_covered(tiles, viewport);
+  for (auto& tile : tiles) {
+    EXPECT_TRUE(tile.exact ? tile.level == 1: tile.level != 1);
+    EXPECT_TRUE(Rect(tile.pixels->getSize()).contains(tile.srcBounds));
+  }
+
+  pyramid.waitIdle();
+  pyramid.getVisibleTiles(0.4, viewport, tiles);
+  expect_covered(tiles, viewport);
+  for (auto& tile : tiles)
+    EXPECT_TRUE(tile.exact);
+
+  // only the visible tiles (and their dependencies) were created
+  int built = pyramid.getBuiltTileCount();
+  Size size1 = pyramid.getLevelSize(1);
+  EXPECT_LT(built, ((size1.w+127)/128) * ((size1.h+127)/128));
+
+  // a viewport outside the image
+  pyramid.getVisibleTiles(0.4, Rect(5000, 0, 100, 100), tiles);
+  EXPECT_TRUE(tiles.empty());
+}
+
+TEST(ImagePyramid, Time)
+{
+  ImagePixels source(8192, 8192);
+  for (int y=0; y<source.getHeight(); ++y)
+    for (int x=0; x<source.getWidth(); ++x)
+      source.setPixel(x, y, ImagePixels::makePixel(x, y, x^y, 255));
+
+  ImagePyramid pyramid(source);
+  std::vector<PyramidTile> tiles;
+  Rect viewport(0, 0, 1280, 1024);
+
+  // only the visible tiles of a zoomed viewport
+  TimePoint t;
+  pyramid.getVisibleTiles(0.5, Rect(1024, 1024, 1280, 1024), tiles);
+  pyramid.waitIdle();
+  std::printf("1280x1024 viewport at 1/2 = %.4g s (%d tiles)\n", t.elapsed(),
+	      pyramid.getBuiltTileCount());
+
+  // all the levels
+  t.reset();
+  pyramid.getVisibleTiles(0.125, viewport, tiles);
+  pyramid.waitIdle();
+  std::printf("whole 8192x8192 at 1/8 = %.4g s (%d tiles)\n", t.elapsed(),
+	      pyramid.getBuiltTileCount());
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "vaca/ImageResampler.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static ImagePixels make_checkerboard(int w, int h, int cell)
+{
+  ImagePixels pixels(w, h);
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      pixels.setPixel(x, y, ((x/cell + y/cell) & 1) ?
+		      ImagePixels::makePixel(255, 255, 255, 255):
+		      ImagePixels::makePixel(0, 0, 0, 255));
+  return pixels;
+}
+
+TEST(ImageResampler, Size)
+{
+  ImagePixels src(40, 30);
+  ImageResampler resampler;
+
+  ImagePixels dst = resampler.resample(src, Size(10, 90));
+  EXPECT_EQ(10, dst.getWidth());
+  EXPECT_EQ(90, dst.getHeight());
+
+  dst = resampler.resample(src, 0, 0);
+  EXPECT_EQ(0, dst.getWidth());
+  EXPECT_EQ(0, dst.getHeight());
+}
+
+TEST(ImageResampler, FlatColor)
+{
+  ImagePixels::pixel_type color = ImagePixels::makePixel(64, 128, 255, 255);
+  ImagePixels src(33, 17);
+  for (int y=0; y<src.getHeight(); ++y)
+    for (int x=0; x<src.getWidth(); ++x)
+      src.setPixel(x, y, color);
+
+  ResampleFilter filters[] = { ResampleFilter::Box,
+			       ResampleFilter::Bilinear,
+			       ResampleFilter::Bicubic,
+			       ResampleFilter::Lanczos };
+
+  for (int i=0; i<4; ++i) {
+    ImageResampler resampler(filters[i]);
+    ImagePixels big = resampler.resample(src, 100, 70);
+    ImagePixels small = resampler.resample(src, 5, 3);
+
+    for (int y=0; y<big.getHeight(); ++y)
+      for (int x=0; x<big.getWidth(); ++x)
+	EXPECT_EQ(color, big.getPixel(x, y));
+
+    for (int y=0; y<small.getHeight(); ++y)
+      for (int x=0; x<small.getWidth(); ++x)
+	EXPECT_EQ(color, small.getPixel(x, y));
+  }
+}
+
+TEST(ImageResampler, Identity)
+{
+  ImagePixels src = make_checkerboard(16, 16, 1);
+  ImageResampler resampler(ResampleFilter::Lanczos);
+  ImagePixels dst = resampler.resample(src, src.getSize());
+
+  for (int y=0; y<src.getHeight(); ++y)
+    for (int x=0; x<src.getWidth(); ++x)
+      EXPECT_EQ(src.getPixel(x, y), dst.getPixel(x, y));
+}
+
+TEST(ImageResampler, BoxAverage)
+{
+  // 2x2 cells of black and white pixels averaged to 1x1 pixels
+  ImagePixels src = make_checkerboard(8, 8, 1);
+  ImageResampler resampler(ResampleFilter::Box);
+  ImagePixels dst = resampler.resample(src, 4, 4);
+
+  for (int y=0; y<dst.getHeight(); ++y)
+    for (int x=0; x<dst.getWidth(); ++x) {
+      ImagePixels::pixel_type color = dst.getPixel(x, y);
+      EXPECT_NEAR(128, ImagePixels::getR(color), 1);
+      EXPECT_NEAR(128, ImagePixels::getG(color), 1);
+      EXPECT_NEAR(128, ImagePixels::getB(color), 1);
+      EXPECT_EQ(255, ImagePixels::getA(color));
+    }
+}
+
+TEST(ImageResampler, LanczosSmallImages)
+{
+  // small images reduced by big factors (the filter is wider than
+  // the image)
+  ImageResampler resampler(ResampleFilter::Lanczos);
+  ImagePixels::pixel_type color = ImagePixels::makePixel(200, 30, 255, 255);
+
+  for (int h=1; h<=7; ++h)
+    for (int w=1; w<=12; ++w) {
+      ImagePixels flat(w, h);
+      for (int y=0; y<h; ++y)
+	for (int x=0; x<w; ++x)
+	  flat.setPixel(x, y, color);
+
+      ImagePixels dst = resampler.resample(flat, 1, 1);
+      ASSERT_EQ(color, dst.getPixel(0, 0)) << w << "x" << h;
+    }
+
+  Size sizes[] = { Size(1, 1), Size(2, 1), Size(3, 2) };
+  for (auto& size : sizes) {
+    ImagePixels dst = resampler.resample(make_checkerboard(96, 64, 1), size);
+    for (int y=0; y<dst.getHeight(); ++y)
+      for (int x=0; x<dst.getWidth(); ++x)
+	EXPECT_NEAR(128, ImagePixels::getR(dst.getPixel(x, y)), 8);
+  }
+}
+
+TEST(ImageResampler, Time)
+{
+  // 8K image
+  ImagePixels src = make_checkerboard(7680, 4320, 7);
+
+  ResampleFilter filters[] = { ResampleFilter::Box,
+			       ResampleFilter::Bilinear,
+			       ResampleFilter::Bicubic,
+			       ResampleFilter::Lanczos };
+  const char* names[] = { "Box", "Bilinear", "Bicubic", "Lanczos" };
+
+  for (int i=0; i<4; ++i) {
+    ImageResampler resampler(filters[i]);
+
+    TimePoint t;
+    ImagePixels thumbnail = resampler.resample(src, 256, 144);
+    double thumbnailSeconds = t.elapsed();
+
+    t.reset();
+    ImagePixels half = resampler.resample(src, 3840, 2160);
+    double halfSeconds = t.elapsed();
+
+    std::printf("%-8s 8K->256x144 = %.4g s, 8K->4K = %.4g s\n",
+		names[i], thumbnailSeconds, halfSeconds);
+  }
+}
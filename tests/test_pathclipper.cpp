@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "vaca/PathClipper.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static GraphicsPath rect_path(int x, int y, int w, int h)
+{
+  GraphicsPath path;
+  path.moveTo(x, y).lineTo(x+w, y).lineTo(x+w, y+h).lineTo(x, y+h).closeFigure();
+  return path;
+}
+
+static GraphicsPath polygon_path(int cx, int cy, int r, int sides, double angle = 0.0)
+{
+  GraphicsPath path;
+  for (int i=0; i<sides; ++i) {
+    double a = angle + 2*3.14159265358979 * i / sides;
+    Point pt(cx + (int)std::floor(r*std::cos(a) + 0.5),
+	     cy + (int)std::floor(r*std::sin(a) + 0.5));
+    if (i == 0)
+      path.moveTo(pt);
+    else
+      path.lineTo(pt);
+  }
+  path.closeFigure();
+  return path;
+}
+
+static GraphicsPath random_polygon()
+{
+  int cx = 100 + std::rand()%50;
+  int cy = 100 + std::rand()%50;
+  int r = 40 + std::rand()%60;
+  int sides = 3 + std::rand()%20;
+  double angle = std::rand()*0.001;
+  return polygon_path(cx, cy, r, sides, angle);
+}
+
+static int figure_count(const GraphicsPath& path)
+{
+  int count = 0;
+  for (GraphicsPath::const_iterator it=path.begin(); it!=path.end(); ++it)
+    if (it->getType() == GraphicsPath::MoveTo)
+      ++count;
+  return count;
+}
+
+static bool apply(PathOperation op, bool a, bool b)
+{
+  switch (op) {
+    case PathOperation::Union:        return a || b;
+    case PathOperation::Intersection: return a && b;
+    case PathOperation::Difference:   return a && !b;
+    case PathOperation::Xor:          return a != b;
+  }
+  return false;
+}
+
+// Compares the pixels of the result with the pixels of both paths.
+// Returns the number of different pixels that are not near the edges
+// of the paths (rounded intersections can move the edges up to
+// sqrt(2)/2 pixels, so pixels in sharp corners can change).
+static int compare_pixels(const GraphicsPath& a, const GraphicsPath& b,
+			  const GraphicsPath& result, PathOperation op,
+			  FillRule rule, bool exact)
+{
+  Rect bounds = a.getBounds().createUnion(b.getBounds()).enlarge(2);
+  int errors = 0;
+
+  for (int y=bounds.y; y<bounds.y+bounds.h; ++y)
+    for (int x=bounds.x; x<bounds.x+bounds.w; ++x) {
+      bool expected = apply(op, a.contains(Point(x, y), rule), b.contains(Point(x, y), rule));
+      bool actual = result.contains(Point(x, y), FillRule::EvenOdd);
+      if (expected == actual)
+	continue;
+
+      // the result doesn't have crossed figures (the same with both rules)
+      if (actual != result.contains(Point(x, y), FillRule::Winding)) {
+	++errors;
+	continue;
+      }
+
+      bool border = false;
+      for (int v=-2; v<=2 && !exact; ++v)
+	for (int u=-2; u<=2; ++u)
+	  if (apply(op, a.contains(Point(x+u, y+v), rule),
+		    b.contains(Point(x+u, y+v), rule)) != expected)
+	    border = true;
+      if (!border)
+	++errors;
+    }
+
+  return errors;
+}
+
+TEST(PathClipper, Rectangles)
+{
+  GraphicsPath a = rect_path(0, 0, 100, 100);
+  GraphicsPath b = rect_path(50, 50, 100, 100);
+  PathClipper clipper;
+
+  PathOperation ops[] = { PathOperation::Union, PathOperation::Intersection,
+			  PathOperation::Difference, PathOperation::Xor };
+  for (int i=0; i<4; ++i) {
+    GraphicsPath result = clipper.combine(a, b, ops[i]);
+    EXPECT_EQ(0, compare_pixels(a, b, result, ops[i], FillRule::EvenOdd, true)) << "operation " << i;
+  }
+
+  // the contours don't have redundant vertices
+  GraphicsPath result = clipper.combine(a, b, PathOperation::Union);
+  EXPECT_EQ(1, figure_count(result));
+  EXPECT_EQ(8u, result.size());
+
+  result = clipper.combine(a, b, PathOperation::Intersection);
+  EXPECT_EQ(1, figure_count(result));
+  EXPECT_EQ(4u, result.size());
+  EXPECT_EQ(Rect(50, 50, 50, 50), result.getBounds());
+
+  result = clipper.combine(a, b, PathOperation::Xor);
+  EXPECT_EQ(2, figure_count(result));
+}
+
+TEST(PathClipper, Holes)
+{
+  GraphicsPath a = rect_path(0, 0, 100, 100);
+  GraphicsPath b = rect_path(25, 25, 50, 50);
+  PathClipper clipper;
+
+  GraphicsPath result = clipper.combine(a, b, PathOperation::Difference);
+  EXPECT_EQ(2, figure_count(result));
+  EXPECT_FALSE(result.contains(Point(50, 50), FillRule::Winding));
+  EXPECT_FALSE(result.contains(Point(50, 50), FillRule::EvenOdd));
+  EXPECT_TRUE(result.contains(Point(10, 50), FillRule::Winding));
+
+  // union with the shape and its hole (they share edges)
+  GraphicsPath both = clipper.combine(result, b, PathOperation::Union);
+  EXPECT_EQ(1, figure_count(both));
+  EXPECT_EQ(4u, both.size());
+
+  // disjoint shapes
+  result = clipper.combine(rect_path(0, 0, 10, 10), rect_path(20, 0, 10, 10), PathOperation::Intersection);
+  EXPECT_TRUE(result.empty());
+  result = clipper.combine(rect_path(0, 0, 10, 10), rect_path(20, 0, 10, 10), PathOperation::Union);
+  EXPECT_EQ(2, figure_count(result));
+}
+
+TEST(PathClipper, FillRules)
+{
+  // a star crosses itself: the center is inside only with the winding rule
+  GraphicsPath star;
+  star.moveTo(100, 0).lineTo(160, 190).lineTo(0, 70).lineTo(200, 70).lineTo(40, 190).closeFigure();
+  GraphicsPath empty;
+  PathClipper clipper;
+
+  GraphicsPath evenOdd = clipper.combine(star, empty, PathOperation::Union, FillRule::EvenOdd);
+  GraphicsPath winding = clipper.combine(star, empty, PathOperation::Union, FillRule::Winding);
+  EXPECT_FALSE(evenOdd.contains(Point(100, 100)));
+  EXPECT_TRUE(winding.contains(Point(100, 100)));
+
+  EXPECT_EQ(0, compare_pixels(star, empty, evenOdd, PathOperation::Union, FillRule::EvenOdd, false));
+  EXPECT_EQ(0, compare_pixels(star, empty, winding, PathOperation::Union, FillRule::Winding, false));
+}
+
+TEST(PathClipper, Polygons)
+{
+  PathClipper clipper;
+  PathOperation ops[] = { PathOperation::Union, PathOperation::Intersection,
+			  PathOperation::Difference, PathOperation::Xor };
+
+  std::srand(45);
+  for (int n=0; n<20; ++n) {
+    GraphicsPath a = random_polygon();
+    GraphicsPath b = random_polygon();
+
+    for (int i=0; i<4; ++i) {
+      GraphicsPath result = clipper.combine(a, b, ops[i]);
+      ASSERT_EQ(0, compare_pixels(a, b, result, ops[i], FillRule::EvenOdd, false))
+	<< "polygons " << n << ", operation " << i;
+    }
+  }
+}
+
+TEST(PathClipper, Curves)
+{
+  GraphicsPath circle;
+  circle.moveTo(0, -100)
+    .curveTo(55, -100, 100, -55, 100, 0)
+    .curveTo(100, 55, 55, 100, 0, 100)
+    .curveTo(-55, 100, -100, 55, -100, 0)
+    .curveTo(-100, -55, -55, -100, 0, -100)
+    .closeFigure();
+  GraphicsPath other = circle;
+  other.offset(70, 30);
+
+  PathClipper clipper;
+  GraphicsPath result = clipper.combine(circle, other, PathOperation::Union);
+  EXPECT_EQ(1, figure_count(result));
+  EXPECT_EQ(0, compare_pixels(circle, other, result, PathOperation::Union, FillRule::EvenOdd, false));
+}
+
+TEST(PathClipper, LineAfterCloseFigure)
+{
+  // the second figure starts in the first point of the closed one
+  GraphicsPath path;
+  path.moveTo(0, 0).lineTo(100, 0).lineTo(100, 10).closeFigure();
+  path.lineTo(-100, 100).lineTo(-100, 0);
+
+  PathClipper clipper;
+  GraphicsPath result = clipper.combine(path, GraphicsPath(), PathOperation::Union);
+  EXPECT_EQ(2, figure_count(result));
+  EXPECT_TRUE(result.contains(Point(-50, 20)));
+  EXPECT_TRUE(result.contains(Point(90, 5)));
+  EXPECT_FALSE(result.contains(Point(50, 20)));
+  EXPECT_EQ(0, compare_pixels(path, GraphicsPath(), result, PathOperation::Union, FillRule::EvenOdd, false));
+}
+
+TEST(PathClipper, Time)
+{
+  GraphicsPath a = polygon_path(0, 0, 1000, 5000);
+  GraphicsPath b = polygon_path(300, 100, 1000, 5000, 0.01);
+  PathClipper clipper;
+
+  TimePoint t;
+  GraphicsPath result = clipper.combine(a, b, PathOperation::Union);
+  std::printf("union of two 5000 vertices polygons = %.4g s (%u nodes)\n", t.elapsed(), result.size());
+
+  // many crossed edges
+  GraphicsPath zigzag1, zigzag2;
+  zigzag1.moveTo(0, 0);
+  zigzag2.moveTo(0, 5);
+  for (int i=0; i<1000; ++i) {
+    zigzag1.lineTo(i*10+5, 100).lineTo(i*10+10, 0);
+    zigzag2.lineTo(i*10+5, -95).lineTo(i*10+10, 5);
+  }
+  t.reset();
+  result = clipper.combine(zigzag1, zigzag2, PathOperation::Xor);
+  std::printf("xor of two zigzags = %.4g s (%u nodes)\n", t.elapsed(), result.size());
+}
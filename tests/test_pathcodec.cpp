@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "vaca/PathCodec.h"
+#include "vaca/ParseException.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static bool equal_paths(const GraphicsPath& a, const GraphicsPath& b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  GraphicsPath::const_iterator it, it2;
+  for (it=a.begin(), it2=b.begin(); it!=a.end(); ++it, ++it2)
+    if (it->getType() != it2->getType() ||
+	it->isCloseFigure() != it2->isCloseFigure() ||
+	it->getPoint() != it2->getPoint())
+      return false;
+  return true;
+}
+
+// A path with many figures of lines and curves
+static GraphicsPath random_path(int figures)
+{
+  GraphicsPath path;
+  for (int f=0; f<figures; ++f) {
+    Point pt(std::rand() % 10000, std::rand() % 10000);
+    path.moveTo(pt);
+
+    int nodes = 1 + std::rand() % 20;
+    for (int i=0; i<nodes; ++i) {
+      pt += Point(std::rand() % 41 - 20, std::rand() % 41 - 20);
+      if (std::rand() % 3 == 0) {
+	path.curveTo(pt + Point(5, 0), pt + Point(5, 5), pt + Point(0, 5));
+	pt += Point(0, 5);
+      }
+      else
+	path.lineTo(pt);
+    }
+    if (std::rand() % 2)
+      path.closeFigure();
+  }
+  return path;
+}
+
+TEST(PathCodec, RoundTrip)
+{
+  GraphicsPath path;
+  path.moveTo(10, 20).lineTo(30, 20).curveTo(40, 20, 50, 30, 50, 40).closeFigure();
+  path.moveTo(-100, -200).lineTo(1000000000, -1000000000).lineTo(-1000000000, 1000000000);
+
+  std::vector<unsigned char> data;
+  PathCodec::encode(path, data);
+  EXPECT_LE(data.size(), PathCodec::getMaxEncodedSize(path));
+
+  GraphicsPath copy;
+  PathCodec::decode(&data[0], data.size(), copy);
+  EXPECT_TRUE(equal_paths(path, copy));
+  EXPECT_EQ(path.getBounds(), copy.getBounds());
+
+  // the bounds include the control points of the curve
+  GraphicsPath curve;
+  curve.moveTo(0, 0).curveTo(1000, 0, 1000, 1000, 0, 1000);
+  data.clear();
+  PathCodec::encode(curve, data);
+  PathView view(&data[0], data.size());
+  EXPECT_EQ(Rect(0, 0, 1000, 1000), view.getBounds());
+  EXPECT_LT(curve.getBounds().w, 1000);
+
+  // empty path
+  GraphicsPath empty;
+  data.clear();
+  PathCodec::encode(empty, data);
+  view = PathView(&data[0], data.size());
+  EXPECT_TRUE(view.empty());
+  EXPECT_EQ(Rect(), view.getBounds());
+  EXPECT_TRUE(view.begin() == view.end());
+  PathCodec::decode(&data[0], data.size(), copy);
+  EXPECT_TRUE(copy.empty());
+}
+
+TEST(PathCodec, View)
+{
+  std::srand(48);
+  GraphicsPath path1 = random_path(100);
+  GraphicsPath path2 = random_path(50);
+
+  // two paths in the same buffer
+  std::vector<unsigned char> data;
+  PathCodec::encode(path1, data);
+  size_t size1 = data.size();
+  PathCodec::encode(path2, data);
+
+  PathView view1(&data[0], data.size());
+  EXPECT_EQ(size1, view1.getDataSize());
+  EXPECT_EQ(path1.size(), view1.size());
+
+  // the bounds include the control points of the curves
+  Point p1 = path1.begin()->getPoint(), p2 = p1;
+  for (GraphicsPath::const_iterator it=path1.begin(); it!=path1.end(); ++it) {
+    p1.x = std::min(p1.x, it->getPoint().x);
+    p1.y = std::min(p1.y, it->getPoint().y);
+    p2.x = std::max(p2.x, it->getPoint().x);
+    p2.y = std::max(p2.y, it->getPoint().y);
+  }
+  EXPECT_EQ(Rect(p1, p2), view1.getBounds());
+  EXPECT_EQ(view1.getBounds(), view1.getBounds().createUnion(path1.getBounds()));
+
+  GraphicsPath::const_iterator it = path1.begin();
+  for (PathView::const_iterator it2=view1.begin(); it2!=view1.end(); ++it2, ++it) {
+    ASSERT_EQ(it->getType(), it2->getType());
+    ASSERT_EQ(it->isCloseFigure(), it2->isCloseFigure());
+    ASSERT_EQ(it->getPoint(), it2->getPoint());
+  }
+
+  PathView view2(&data[size1], data.size() - size1);
+  EXPECT_EQ(data.size() - size1, view2.getDataSize());
+
+  GraphicsPath copy;
+  view2.toPath(copy);
+  EXPECT_TRUE(equal_paths(path2, copy));
+  EXPECT_EQ(path2.getBounds(), copy.getBounds());
+
+  // the nodes of a figure use a few bytes
+  EXPECT_LT(data.size(), (path1.size() + path2.size()) * 3);
+}
+
+TEST(PathCodec, InvalidData)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).curveTo(1000, 0, 1000, 1000, 0, 1000).closeFigure();
+
+  std::vector<unsigned char> data;
+  PathCodec::encode(path, data);
+
+  // truncated data
+  for (size_t size=0; size<data.size(); ++size)
+    EXPECT_THROW(PathView(&data[0], size), ParseException) << "size " << size;
+  EXPECT_NO_THROW(PathView(&data[0], data.size()));
+
+  // invalid signature and version
+  std::vector<unsigned char> bad = data;
+  bad[0] = 'X';
+  EXPECT_THROW(PathView(&bad[0], bad.size()), ParseException);
+  bad = data;
+  bad[4] = 2;
+  EXPECT_THROW(PathView(&bad[0], bad.size()), ParseException);
+
+  // the types of the nodes are after the bounds (four varints of 1 or
+  // 2 bytes), find them changing bytes until a type is invalid
+  int invalid = 0;
+  for (size_t i=13; i<data.size(); ++i) {
+    for (int value=0; value<256; ++value) {
+      bad = data;
+      bad[i] = value;
+      try {
+	GraphicsPath copy;
+	PathCodec::decode(&bad[0], bad.size(), copy);
+	EXPECT_EQ(path.size(), copy.size());
+      }
+      catch (ParseException&) {
+	++invalid;
+      }
+    }
+  }
+  EXPECT_GT(invalid, 0);
+
+  // a curve without its first control point (the points use 8 bytes,
+  // and the types are the two bytes before them)
+  GraphicsPath curve;
+  curve.moveTo(0, 0).curveTo(1, 1, 2, 2, 3, 3);
+  data.clear();
+  PathCodec::encode(curve, data);
+  EXPECT_EQ(0x31, data[data.size()-10]);
+  data[data.size()-10] = 0x41;	// MoveTo + BezierControl2
+  EXPECT_THROW(PathView(&data[0], data.size()), ParseException);
+}
+
+TEST(PathCodec, Time)
+{
+  std::srand(49);
+  GraphicsPath path = random_path(100000);
+  std::vector<unsigned char> data;
+
+  TimePoint t;
+  PathCodec::encode(path, data);
+  double elapsed = t.elapsed();
+  std::printf("encode %u nodes = %.4g s (%u bytes, %.3g bytes per node)\n",
+	      path.size(), elapsed, (unsigned)data.size(), (double)data.size() / path.size());
+
+  t.reset();
+  PathView view(&data[0], data.size());
+  std::printf("check %u nodes = %.4g s\n", view.size(), t.elapsed());
+
+  t.reset();
+  long long sum = 0;
+  for (PathView::const_iterator it=view.begin(); it!=view.end(); ++it)
+    sum += it->getPoint().x;
+  elapsed = t.elapsed();
+  std::printf("iterate %u nodes = %.4g s (%.4g MB/s)\n",
+	      view.size(), elapsed, data.size() / elapsed / 1e6);
+
+  GraphicsPath copy;
+  t.reset();
+  PathCodec::decode(&data[0], data.size(), copy);
+  elapsed = t.elapsed();
+  std::printf("decode %u nodes = %.4g s (%.4g MB/s)\n",
+	      copy.size(), elapsed, data.size() / elapsed / 1e6);
+
+  t.reset();
+  GraphicsPath byValue = path;
+  std::printf("copy %u nodes by value = %.4g s\n", byValue.size(), t.elapsed());
+
+  EXPECT_TRUE(equal_paths(path, copy));
+  EXPECT_NE(0, sum);
+}
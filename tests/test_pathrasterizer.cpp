@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "vaca/PathRasterizer.h"
+#include "vaca/BandedRegion.h"
+#include "vaca/Color.h"
+#include "vaca/GraphicsPath.h"
+#include "vaca/RectF.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static double total_area(const std::vector<unsigned char>& coverage)
+{
+  double area = 0.0;
+  for (size_t i=0; i<coverage.size(); ++i)
+    area += coverage[i] / 255.0;
+  return area;
+}
+
+TEST(PathRasterizer, Rectangle)
+{
+  PathRasterizer rasterizer(Size(40, 40));
+  std::vector<PointF> points;
+  points.push_back(PointF(10.25f, 10.5f));
+  points.push_back(PointF(20.75f, 10.5f));
+  points.push_back(PointF(20.75f, 30.5f));
+  points.push_back(PointF(10.25f, 30.5f));
+  rasterizer.addPolygon(points);
+  EXPECT_EQ(Rect(10, 10, 11, 21), rasterizer.getBounds());
+
+  std::vector<unsigned char> coverage;
+  rasterizer.getCoverage(coverage);
+  EXPECT_TRUE(rasterizer.empty());
+
+  // the covered area of each pixel
+  EXPECT_EQ(0, coverage[5*40 + 15]);
+  EXPECT_EQ(255, coverage[20*40 + 15]);
+  EXPECT_EQ(191, coverage[20*40 + 10]);	// 3/4 of the pixel
+  EXPECT_EQ(191, coverage[20*40 + 20]);
+  EXPECT_EQ(128, coverage[10*40 + 15]);	// 1/2
+  EXPECT_EQ(96, coverage[10*40 + 10]);	// 3/8
+  EXPECT_EQ(0, coverage[20*40 + 21]);
+  EXPECT_NEAR(10.5*20, total_area(coverage), 0.5);
+
+  // the direction of the figure doesn't matter
+  std::vector<PointF> reversed(points.rbegin(), points.rend());
+  std::vector<unsigned char> coverage2;
+  rasterizer.addPolygon(reversed);
+  rasterizer.getCoverage(coverage2);
+  EXPECT_EQ(coverage, coverage2);
+}
+
+TEST(PathRasterizer, Ellipses)
+{
+  PathRasterizer rasterizer(Size(200, 200));
+  std::vector<unsigned char> coverage;
+
+  rasterizer.addEllipse(RectF(20.5f, 30.25f, 150, 100));
+  rasterizer.getCoverage(coverage);
+  EXPECT_NEAR(3.14159265*75*50, total_area(coverage), 2.0);
+
+  // anti-aliased edges: some pixels are partially covered
+  int partial = 0;
+  for (size_t i=0; i<coverage.size(); ++i)
+    if (coverage[i] > 0 && coverage[i] < 255)
+      ++partial;
+  EXPECT_GT(partial, 400);
+
+  // a quarter of a circle, and the rest of the circle
+  rasterizer.addPie(RectF(0, 0, 200, 200), 0, 90);
+  rasterizer.getCoverage(coverage);
+  EXPECT_NEAR(3.14159265*100*100/4, total_area(coverage), 2.0);
+  EXPECT_EQ(255, coverage[50*200 + 150]);	// top right quarter
+  EXPECT_EQ(0, coverage[150*200 + 150]);
+
+  rasterizer.addChord(RectF(0, 0, 200, 200), 90, 270);
+  rasterizer.getCoverage(coverage);
+  double segment = 3.14159265*100*100*3/4 + 100*100/2;
+  EXPECT_NEAR(segment, total_area(coverage), 2.0);
+}
+
+TEST(PathRasterizer, FillRules)
+{
+  // two squares in the same direction
+  GraphicsPath path;
+  path.moveTo(10, 10).lineTo(50, 10).lineTo(50, 50).lineTo(10, 50).closeFigure();
+  path.moveTo(30, 30).lineTo(70, 30).lineTo(70, 70).lineTo(30, 70).closeFigure();
+
+  PathRasterizer rasterizer(Size(80, 80));
+  std::vector<unsigned char> winding, evenOdd;
+  rasterizer.addPath(path);
+  rasterizer.getCoverage(winding, FillRule::Winding);
+  rasterizer.addPath(path);
+  rasterizer.getCoverage(evenOdd, FillRule::EvenOdd);
+
+  EXPECT_EQ(255, winding[40*80 + 40]);
+  EXPECT_EQ(0, evenOdd[40*80 + 40]);
+  EXPECT_EQ(255, evenOdd[20*80 + 20]);
+  EXPECT_NEAR(40*40*2 - 20*20, total_area(winding), 0.5);
+  EXPECT_NEAR(40*40*2 - 20*20*2, total_area(evenOdd), 0.5);
+
+  // the same pixels as the aliased hit-test in the centers of pixels
+  // that are completely inside or outside
+  GraphicsPath star;
+  star.moveTo(40, 0).lineTo(64, 76).lineTo(0, 28).lineTo(80, 28).lineTo(16, 76).closeFigure();
+  for (int rule=0; rule<2; ++rule) {
+    FillRule fillRule = (rule == 0 ? FillRule::Winding: FillRule::EvenOdd);
+    std::vector<unsigned char> coverage;
+    rasterizer.addPath(star);
+    rasterizer.getCoverage(coverage, fillRule);
+
+    for (int y=0; y<80; ++y)
+      for (int x=0; x<80; ++x) {
+	unsigned char c = coverage[y*80 + x];
+	if (c == 255)
+	  ASSERT_TRUE(star.contains(Point(x, y), fillRule)) << x << "," << y;
+	else if (c == 0 && star.contains(Point(x, y), fillRule)) {
+	  // only pixels in the edges (contains() includes them)
+	  bool edge = false;
+	  for (int v=-1; v<=1; ++v)
+	    for (int u=-1; u<=1; ++u)
+	      if (x+u >= 0 && y+v >= 0 && x+u < 80 && y+v < 80 && coverage[(y+v)*80 + x+u] > 0)
+		edge = true;
+	  ASSERT_TRUE(edge) << x << "," << y;
+	}
+      }
+  }
+}
+
+TEST(PathRasterizer, Clipping)
+{
+  // a circle partially outside the image is the same as a part of the
+  // circle in a bigger image
+  PathRasterizer small(Size(60, 50));
+  PathRasterizer big(Size(200, 200));
+  std::vector<unsigned char> a, b;
+
+  small.addEllipse(RectF(-30.3f, -20.6f, 120.4f, 100.7f));
+  small.getCoverage(a);
+  big.addEllipse(RectF(-30.3f + 70, -20.6f + 80, 120.4f, 100.7f));
+  big.getCoverage(b);
+
+  for (int y=0; y<50; ++y)
+    for (int x=0; x<60; ++x)
+      ASSERT_NEAR(b[(y+80)*200 + x+70], a[y*60 + x], 1) << x << "," << y;
+
+  // completely outside
+  small.addEllipse(RectF(-100, -100, 50, 50));
+  small.addEllipse(RectF(1000, 10, 50, 50));
+  small.getCoverage(a);
+  EXPECT_EQ(0, total_area(a));
+
+  // invalid coordinates are ignored
+  small.moveTo(PointF(10, 10));
+  small.lineTo(PointF(std::sqrt(-1.0f), 20));
+  small.lineTo(PointF(1e30f, 1e30f));
+  small.getCoverage(a);
+  EXPECT_EQ(0, total_area(a));
+}
+
+TEST(PathRasterizer, Fill)
+{
+  ImagePixels pixels(Size(20, 20));
+  for (int y=0; y<20; ++y)
+    for (int x=0; x<20; ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(255, 255, 255, 255));
+
+  PathRasterizer rasterizer(pixels.getSize());
+  std::vector<PointF> points;
+  points.push_back(PointF(0, 0));
+  points.push_back(PointF(10.5f, 0));
+  points.push_back(PointF(10.5f, 20));
+  points.push_back(PointF(0, 20));
+  rasterizer.addPolygon(points);
+  rasterizer.fill(pixels, Color(255, 0, 0));
+
+  EXPECT_EQ(ImagePixels::makePixel(255, 0, 0, 255), pixels.getPixel(5, 5));
+  EXPECT_EQ(ImagePixels::makePixel(255, 127, 127, 255), pixels.getPixel(10, 5));
+  EXPECT_EQ(ImagePixels::makePixel(255, 255, 255, 255), pixels.getPixel(11, 5));
+
+  // with opacity
+  rasterizer.addPolygon(points);
+  rasterizer.fill(pixels, Color(0, 0, 255), FillRule::EvenOdd, 128);
+  EXPECT_EQ(ImagePixels::makePixel(127, 0, 128, 255), pixels.getPixel(5, 5));
+}
+
+TEST(PathRasterizer, Time)
+{
+  ImagePixels pixels(Size(1000, 1000));
+  PathRasterizer rasterizer(pixels.getSize());
+
+  TimePoint t;
+  for (int i=0; i<100; ++i) {
+    rasterizer.addEllipse(RectF(i*0.1f, 0, 900.5f, 800.5f));
+    rasterizer.fill(pixels, Color(i, 0, 0));
+  }
+  std::printf("100 anti-aliased ellipses = %.4g s\n", t.elapsed());
+
+  // aliased ellipses (with the same region that GDI uses)
+  t.reset();
+  for (int i=0; i<100; ++i) {
+    BandedRegion rgn = BandedRegion::fromEllipse(Rect(i/10, 0, 900, 800));
+    const std::vector<Rect>& rects = rgn.getRects();
+    ImagePixels::pixel_type color = ImagePixels::makePixel(i, 0, 0, 255);
+    for (size_t j=0; j<rects.size(); ++j)
+      for (int y=rects[j].y; y<rects[j].y+rects[j].h; ++y)
+	std::fill(&pixels[y*1000 + rects[j].x], &pixels[y*1000 + rects[j].x] + rects[j].w, color);
+  }
+  std::printf("100 aliased ellipses = %.4g s\n", t.elapsed());
+
+  // a star with many crossed lines
+  std::vector<PointF> star;
+  for (int i=0; i<1001; ++i) {
+    double a = 2*3.14159265 * i * 500 / 1001;
+    star.push_back(PointF(static_cast<float>(500 + 490*std::cos(a)),
+			  static_cast<float>(500 + 490*std::sin(a))));
+  }
+  t.reset();
+  for (int i=0; i<10; ++i) {
+    rasterizer.addPolygon(star);
+    rasterizer.fill(pixels, Color(0, i, 0), FillRule::Winding);
+  }
+  std::printf("10 anti-aliased stars of 1001 vertices = %.4g s\n", t.elapsed());
+}
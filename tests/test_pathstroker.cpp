@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+
+#include "vaca/PathStroker.h"
+#include "vaca/Color.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+// Winding number of the polygons of the stroke in the center of the
+// pixel (x, y)
+static int winding(const GraphicsPath& path, int x, int y)
+{
+  double px = x + 0.5, py = y + 0.5;
+  int result = 0;
+  GraphicsPath::const_iterator it = path.begin(), start = path.begin();
+
+  for (; it != path.end(); ++it) {
+    if (it->getType() == GraphicsPath::MoveTo)
+      start = it;
+
+    const Point& a = it->getPoint();
+    const Point& b = (it->isCloseFigure() ? start->getPoint(): it[1].getPoint());
+
+    if ((a.y <= py) != (b.y <= py)) {
+      double cx = a.x + (py - a.y) * (b.x - a.x) / (b.y - a.y);
+      if (cx > px)
+	result += (b.y > a.y ? 1: -1);
+    }
+  }
+  return result;
+}
+
+static bool inside(const GraphicsPath& path, int x, int y)
+{
+  bool result = path.contains(Point(x, y), FillRule::Winding);
+  EXPECT_EQ(winding(path, x, y) != 0, result);
+  return result;
+}
+
+static GraphicsPath corner()
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).lineTo(100, 0).lineTo(100, 100);
+  return path;
+}
+
+TEST(PathStroker, Caps)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).lineTo(100, 0);
+
+  GraphicsPath flat = PathStroker::createStroke(path, StrokeStyle(10, PenJoin::Round, PenEndCap::Flat));
+  EXPECT_TRUE(inside(flat, 50, 3));
+  EXPECT_TRUE(inside(flat, 50, -4));
+  EXPECT_FALSE(inside(flat, 50, 6));
+  EXPECT_FALSE(inside(flat, -2, 0));
+  EXPECT_FALSE(inside(flat, 101, 0));
+
+  GraphicsPath square = PathStroker::createStroke(path, StrokeStyle(10, PenJoin::Round, PenEndCap::Square));
+  EXPECT_TRUE(inside(square, -4, 3));
+  EXPECT_TRUE(inside(square, 103, -4));
+  EXPECT_FALSE(inside(square, -6, 0));
+
+  GraphicsPath round = PathStroker::createStroke(path, StrokeStyle(10, PenJoin::Round, PenEndCap::Round));
+  EXPECT_TRUE(inside(round, -4, 0));
+  EXPECT_TRUE(inside(round, 103, 0));
+  EXPECT_FALSE(inside(round, -5, -4));
+  EXPECT_FALSE(inside(round, 103, -4));
+}
+
+TEST(PathStroker, Joins)
+{
+  GraphicsPath miter = PathStroker::createStroke(corner(), StrokeStyle(20, PenJoin::Miter, PenEndCap::Flat));
+  EXPECT_TRUE(inside(miter, 108, -9));
+  EXPECT_TRUE(inside(miter, 95, 50));
+  EXPECT_FALSE(inside(miter, 50, 50));
+
+  GraphicsPath bevel = PathStroker::createStroke(corner(), StrokeStyle(20, PenJoin::Bevel, PenEndCap::Flat));
+  EXPECT_TRUE(inside(bevel, 103, -4));
+  EXPECT_FALSE(inside(bevel, 108, -9));
+
+  GraphicsPath round = PathStroker::createStroke(corner(), StrokeStyle(20, PenJoin::Round, PenEndCap::Flat));
+  EXPECT_TRUE(inside(round, 105, -7));
+  EXPECT_FALSE(inside(round, 108, -9));
+
+  // the overlapped parts are filled with the winding rule
+  EXPECT_EQ(1, std::abs(winding(miter, 95, 50)));
+  EXPECT_NE(0, winding(round, 100, 0));
+}
+
+TEST(PathStroker, MiterLimit)
+{
+  // a sharp corner: the miter is 20 times the width
+  GraphicsPath path;
+  path.moveTo(0, 0).lineTo(100, 0).lineTo(0, 10);
+
+  GraphicsPath miter = PathStroker::createStroke(path, StrokeStyle(10, PenJoin::Miter, PenEndCap::Flat, 30.0));
+  GraphicsPath limited = PathStroker::createStroke(path, StrokeStyle(10, PenJoin::Miter, PenEndCap::Flat, 4.0));
+
+  EXPECT_TRUE(inside(miter, 140, -3));
+  EXPECT_TRUE(inside(miter, 190, -5));
+  EXPECT_FALSE(inside(limited, 140, -3));
+  EXPECT_FALSE(inside(limited, 102, -3));
+}
+
+TEST(PathStroker, ClosedFigure)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).lineTo(100, 0).lineTo(100, 100).lineTo(0, 100).closeFigure();
+
+  GraphicsPath stroke = PathStroker::createStroke(path, StrokeStyle(10, PenJoin::Miter, PenEndCap::Round));
+  EXPECT_TRUE(inside(stroke, -4, -4));	// miter join (no caps)
+  EXPECT_TRUE(inside(stroke, 0, 50));
+  EXPECT_TRUE(inside(stroke, 103, 50));
+  EXPECT_FALSE(inside(stroke, 50, 50));
+  EXPECT_FALSE(inside(stroke, -7, 50));
+
+  // all polygons have the same orientation
+  int sign = 0;
+  GraphicsPath::const_iterator start = stroke.begin();
+  long long area = 0;
+  for (GraphicsPath::const_iterator it = stroke.begin(); it != stroke.end(); ++it) {
+    if (it->getType() == GraphicsPath::MoveTo) {
+      start = it;
+      area = 0;
+    }
+    const Point& a = it->getPoint();
+    const Point& b = (it->isCloseFigure() ? start->getPoint(): it[1].getPoint());
+    area += (long long)a.x * b.y - (long long)b.x * a.y;
+
+    if (it->isCloseFigure()) {
+      ASSERT_NE(0, area);
+      if (sign == 0)
+	sign = (area > 0 ? 1: -1);
+      EXPECT_EQ(sign, area > 0 ? 1: -1);
+    }
+  }
+}
+
+TEST(PathStroker, Dashes)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0).lineTo(100, 0);
+
+  StrokeStyle style(4, PenJoin::Round, PenEndCap::Flat);
+  style.dashes.push_back(10);
+  style.dashes.push_back(10);
+
+  GraphicsPath dashed = PathStroker::createStroke(path, style);
+  EXPECT_TRUE(inside(dashed, 5, 0));
+  EXPECT_FALSE(inside(dashed, 15, 0));
+  EXPECT_TRUE(inside(dashed, 25, 0));
+  EXPECT_FALSE(inside(dashed, 95, 0));
+
+  style.dashOffset = 10;
+  dashed = PathStroker::createStroke(path, style);
+  EXPECT_FALSE(inside(dashed, 5, 0));
+  EXPECT_TRUE(inside(dashed, 15, 0));
+
+  // an odd number of lengths is repeated: 10 on, 5 off, 10 on, 10 off, 5 on
+  style.dashes.back() = 5;
+  style.dashes.push_back(10);
+  style.dashOffset = 0;
+  dashed = PathStroker::createStroke(path, style);
+  EXPECT_FALSE(inside(dashed, 12, 0));
+  EXPECT_TRUE(inside(dashed, 20, 0));
+  EXPECT_FALSE(inside(dashed, 30, 0));
+  EXPECT_TRUE(inside(dashed, 37, 0));
+  EXPECT_FALSE(inside(dashed, 45, 0));
+
+  // a closed figure that starts and ends with a dash has a join in the first vertex
+  GraphicsPath square;
+  square.moveTo(0, 0).lineTo(100, 0).lineTo(100, 100).lineTo(0, 100).closeFigure();
+  style = StrokeStyle(10, PenJoin::Miter, PenEndCap::Flat);
+  style.dashes.push_back(20);
+  style.dashes.push_back(10);
+  dashed = PathStroker::createStroke(square, style);
+  EXPECT_TRUE(inside(dashed, -4, -4));
+}
+
+TEST(PathStroker, FromPen)
+{
+  StrokeStyle solid(Pen(Color::Black, 4, PenStyle::Solid, PenEndCap::Square, PenJoin::Bevel));
+  EXPECT_EQ(4.0, solid.width);
+  EXPECT_EQ(PenEndCap::Square, solid.endCap);
+  EXPECT_EQ(PenJoin::Bevel, solid.join);
+  EXPECT_TRUE(solid.dashes.empty());
+
+  StrokeStyle dash(Pen(Color::Black, 4, PenStyle::Dash));
+  ASSERT_EQ(2u, dash.dashes.size());
+  EXPECT_EQ(12.0, dash.dashes[0]);
+  EXPECT_EQ(4.0, dash.dashes[1]);
+
+  StrokeStyle null(Pen(Color::Black, 4, PenStyle::Null));
+  EXPECT_TRUE(null.isNull());
+  EXPECT_TRUE(PathStroker::createStroke(corner(), null).empty());
+}
+
+TEST(PathStroker, Cache)
+{
+  PathStroker stroker(2);
+  StrokeStyle thin(2), thick(10);
+
+  GraphicsPath a = stroker.stroke(corner(), thick);
+  GraphicsPath b = stroker.stroke(corner(), thick);
+  EXPECT_EQ(1, stroker.getMisses());
+  EXPECT_EQ(1, stroker.getHits());
+  EXPECT_EQ(a.size(), b.size());
+
+  stroker.stroke(corner(), thin);
+  EXPECT_EQ(2, stroker.getMisses());
+  EXPECT_EQ(2, stroker.getCount());
+
+  // the path is part of the key
+  GraphicsPath other = corner();
+  other.lineTo(0, 100);
+  stroker.stroke(other, thin);
+  EXPECT_EQ(3, stroker.getMisses());
+  EXPECT_EQ(1, stroker.getEvictions());
+
+  // "thick" was removed from the cache
+  stroker.stroke(corner(), thin);
+  stroker.stroke(corner(), thick);
+  EXPECT_EQ(2, stroker.getHits());
+  EXPECT_EQ(4, stroker.getMisses());
+
+  stroker.setCapacity(0);
+  EXPECT_EQ(0, stroker.getCount());
+  stroker.stroke(corner(), thick);
+  EXPECT_EQ(0, stroker.getCount());
+}
+
+TEST(PathStroker, Time)
+{
+  GraphicsPath path;
+  path.moveTo(0, 0);
+  for (int i=0; i<5000; ++i)
+    path.curveTo(i*20+5, 100, i*20+15, -100, i*20+20, 0);
+
+  StrokeStyle style(8, PenJoin::Round, PenEndCap::Round);
+  PathStroker stroker;
+
+  TimePoint t;
+  GraphicsPath stroke = stroker.stroke(path, style);
+  double first = t.elapsed();
+
+  t.reset();
+  stroker.stroke(path, style);
+  double cached = t.elapsed();
+
+  std::printf("stroke 5000 curves = %.4g s (%u nodes), cached = %.4g s\n",
+	      first, stroke.size(), cached);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include "vaca/PointF.h"
+#include "vaca/SizeF.h"
+#include "vaca/Point.h"
+#include "vaca/Size.h"
+
+using namespace vaca;
+
+inline std::ostream& operator<<(std::ostream& os, const Point& pt)
+{
+  return os << "Point(" << pt.x << ", " << pt.y << ")\n";
+}
+
+TEST(PointF, Basics)
+{
+  PointF p1;
+  EXPECT_EQ(0.0f, p1.x);
+  EXPECT_EQ(0.0f, p1.y);
+
+  PointF p2(1.5f, -2.25f);
+  EXPECT_TRUE(p1 != p2);
+
+  p1 = p2;
+  EXPECT_TRUE(p1 == p2);
+
+  p1 += p2;
+  EXPECT_EQ(3.0f, p1.x);
+  EXPECT_EQ(-4.5f, p1.y);
+
+  p1 /= 2.0f;
+  EXPECT_TRUE(p1 == p2);
+
+  EXPECT_TRUE(p2*2.0f - p2 == p2);
+  EXPECT_TRUE(-p2 == PointF(-1.5f, 2.25f));
+
+  // conversion from integers
+  PointF p3 = Point(3, -4);
+  EXPECT_EQ(3.0f, p3.x);
+  EXPECT_EQ(-4.0f, p3.y);
+}
+
+TEST(PointF, Round)
+{
+  EXPECT_EQ(Point(2, -2), PointF(1.5f, -2.25f).round());
+  EXPECT_EQ(Point(-1, -2), PointF(-0.6f, -2.5f).round());
+  EXPECT_EQ(Point(1, -3), PointF(1.5f, -2.25f).floor());
+
+  // static_cast<int> would give Point(0, 0)
+  EXPECT_EQ(Point(-1, 1), PointF(-0.9f, 0.9f).round());
+}
+
+TEST(SizeF, Basics)
+{
+  SizeF s1(2.5f, 4.0f);
+  SizeF s2 = Size(1, 2);
+
+  EXPECT_TRUE(s1 + s2 == SizeF(3.5f, 6.0f));
+  EXPECT_TRUE(s1 * 2.0f == SizeF(5.0f, 8.0f));
+  EXPECT_TRUE(s1.createUnion(s2) == SizeF(2.5f, 4.0f));
+  EXPECT_TRUE(s1.createIntersect(s2) == SizeF(1.0f, 2.0f));
+  EXPECT_TRUE(Size(3, 4) == s1.round());
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "vaca/RectArray.h"
+#include "vaca/BandedRegion.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static std::vector<Rect> random_rects(int count, int size, int maxSide)
+{
+  std::vector<Rect> rects;
+  for (int i=0; i<count; ++i)
+    rects.push_back(Rect(std::rand() % size - size/4,
+			 std::rand() % size - size/4,
+			 std::rand() % maxSide,	// some rectangles are empty
+			 std::rand() % maxSide));
+  return rects;
+}
+
+static bool overlap(const Rect& a, const Rect& b)
+{
+  return !a.isEmpty() && !b.isEmpty() && !a.createIntersect(b).isEmpty();
+}
+
+TEST(RectArray, Basic)
+{
+  RectArray rects;
+  EXPECT_TRUE(rects.empty());
+  EXPECT_EQ(Rect(), rects.getBounds());
+
+  rects.add(Rect(10, 20, 30, 40));
+  rects.add(Rect(5, 5, 0, 10));		// empty
+  rects.add(Rect(-10, 50, 5, 5));
+  EXPECT_EQ(3, rects.size());
+  EXPECT_EQ(Rect(10, 20, 30, 40), rects.getRect(0));
+  EXPECT_EQ(Rect(), rects.getRect(1));
+  EXPECT_EQ(Rect(-10, 20, 50, 40), rects.getBounds());
+
+  rects.offset(10, -20);
+  EXPECT_EQ(Rect(20, 0, 30, 40), rects.getRect(0));
+  EXPECT_EQ(Rect(0, 30, 5, 5), rects.getRect(2));
+
+  rects.setRect(1, Rect(0, 0, 4, 4));
+  rects.intersect(Rect(2, 2, 30, 30));
+  EXPECT_EQ(Rect(20, 2, 12, 30), rects.getRect(0));
+  EXPECT_EQ(Rect(2, 2, 2, 2), rects.getRect(1));
+  EXPECT_EQ(Rect(2, 30, 3, 2), rects.getRect(2));
+
+  // touching rectangles don't overlap
+  std::vector<int> indices;
+  rects.findOverlapping(Rect(4, 2, 16, 50), indices);
+  EXPECT_EQ(1, indices.size());
+  EXPECT_EQ(2, indices[0]);
+}
+
+TEST(RectArray, BoundsAndIntersect)
+{
+  std::srand(1);
+  for (int n=0; n<40; ++n) {
+    std::vector<Rect> input = random_rects(n, 200, 60);
+    RectArray rects(input);
+
+    Rect bounds;
+    for (size_t i=0; i<input.size(); ++i)
+      bounds = bounds.createUnion(input[i]);
+    EXPECT_EQ(bounds, rects.getBounds());
+
+    Rect clip(std::rand() % 100, std::rand() % 100, 80, 60);
+    std::vector<Rect> output;
+    rects.intersect(clip);
+    rects.getRects(output);
+    for (size_t i=0; i<input.size(); ++i) {
+      Rect expected = input[i].isEmpty() ? Rect(): input[i].createIntersect(clip);
+      if (expected.isEmpty())
+	expected = Rect();
+      ASSERT_EQ(expected, output[i]);
+    }
+  }
+}
+
+TEST(RectArray, FindOverlapping)
+{
+  std::srand(2);
+  std::vector<Rect> input = random_rects(500, 1000, 80);
+  RectArray rects(input);
+
+  std::vector<int> indices;
+  for (int k=0; k<50; ++k) {
+    Rect rc = random_rects(1, 1000, 200)[0];
+    std::vector<int> expected;
+    for (size_t i=0; i<input.size(); ++i)
+      if (overlap(input[i], rc))
+	expected.push_back(i);
+
+    rects.findOverlapping(rc, indices);
+    ASSERT_EQ(expected, indices);
+  }
+
+  std::vector<std::pair<int, int> > pairs, expected;
+  for (size_t i=0; i<input.size(); ++i)
+    for (size_t j=i+1; j<input.size(); ++j)
+      if (overlap(input[i], input[j]))
+	expected.push_back(std::make_pair(i, j));
+
+  rects.findOverlappingPairs(pairs);
+  std::sort(pairs.begin(), pairs.end());
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(expected, pairs);
+}
+
+TEST(RectArray, Merge)
+{
+  std::srand(3);
+  for (int k=0; k<20; ++k) {
+    std::vector<Rect> input = random_rects(k*10, 500, 50);
+    RectArray rects(input);
+    rects.merge();
+
+    // no overlapping rectangles
+    std::vector<std::pair<int, int> > pairs;
+    rects.findOverlappingPairs(pairs);
+    EXPECT_TRUE(pairs.empty());
+
+    // exactly the same pixels, without empty rectangles, and not more
+    // rectangles than the region
+    std::vector<Rect> output;
+    rects.getRects(output);
+    for (size_t i=0; i<output.size(); ++i)
+      ASSERT_FALSE(output[i].isEmpty());
+
+    BandedRegion before = BandedRegion::fromRects(input);
+    BandedRegion after = BandedRegion::fromRects(output);
+    EXPECT_EQ(before, after);
+    EXPECT_LE(output.size(), before.getRects().size());
+  }
+
+  // a grid of adjacent rectangles is one rectangle
+  RectArray grid;
+  for (int y=0; y<10; ++y)
+    for (int x=0; x<10; ++x)
+      grid.add(Rect(x*16, y*16, 16, 16));
+  grid.merge();
+  EXPECT_EQ(1, grid.size());
+  EXPECT_EQ(Rect(0, 0, 160, 160), grid.getRect(0));
+
+  // two separated rectangles are kept
+  RectArray two;
+  two.add(Rect(0, 0, 10, 10));
+  two.add(Rect(11, 0, 10, 10));
+  two.add(Rect(2, 2, 4, 4));
+  two.merge();
+  EXPECT_EQ(2, two.size());
+
+  // separated groups of overlapping rectangles
+  RectArray groups;
+  groups.add(Rect(0, 0, 10, 10));
+  groups.add(Rect(100, 100, 10, 10));
+  groups.add(Rect(5, 5, 10, 10));
+  groups.add(Rect(200, 0, 10, 10));
+  groups.add(Rect(105, 105, 10, 10));
+  groups.add(Rect(205, 5, 10, 10));
+  groups.merge();
+
+  std::vector<Rect> output;
+  groups.getRects(output);
+  ASSERT_EQ(9, output.size());
+
+  int area = 0;
+  for (size_t i=0; i<output.size(); ++i)
+    area += output[i].w * output[i].h;
+  EXPECT_EQ(3 * (100+100-25), area);
+
+  RectArray first;
+  for (size_t i=0; i<output.size(); ++i)
+    if (output[i].x < 100)
+      first.add(output[i]);
+  first.getRects(output);
+  ASSERT_EQ(3, output.size());
+  EXPECT_EQ(Rect(0, 0, 10, 5), output[0]);
+  EXPECT_EQ(Rect(0, 5, 15, 5), output[1]);
+  EXPECT_EQ(Rect(5, 10, 10, 5), output[2]);
+
+  // the pixels of an L are not filled to its bounds
+  RectArray shape;
+  shape.add(Rect(0, 0, 10, 40));
+  shape.add(Rect(0, 30, 40, 10));
+  shape.merge();
+  shape.getRects(output);
+  ASSERT_EQ(2, output.size());
+  EXPECT_EQ(Rect(0, 0, 10, 30), output[0]);
+  EXPECT_EQ(Rect(0, 30, 40, 10), output[1]);
+}
+
+TEST(RectArray, Time)
+{
+  std::srand(4);
+  std::vector<Rect> input = random_rects(1000000, 10000, 100);
+  RectArray rects(input);
+  Rect clip(1000, 1000, 5000, 5000);
+
+  TimePoint t;
+  Rect bounds;
+  for (size_t i=0; i<input.size(); ++i)
+    bounds = bounds.createUnion(input[i]);
+  for (size_t i=0; i<input.size(); ++i)
+    input[i] = input[i].createIntersect(clip);
+  std::printf("Rect::createUnion + createIntersect (1000000 rects) = %.4g s\n", t.elapsed());
+
+  t.reset();
+  EXPECT_EQ(bounds, rects.getBounds());
+  rects.intersect(clip);
+  std::printf("RectArray::getBounds + intersect (1000000 rects) = %.4g s\n", t.elapsed());
+
+  std::vector<Rect> small = random_rects(10000, 10000, 100);
+  int count = 0;
+  t.reset();
+  for (size_t i=0; i<small.size(); ++i)
+    for (size_t j=i+1; j<small.size(); ++j)
+      if (overlap(small[i], small[j]))
+	++count;
+  std::printf("Overlapping pairs one by one (10000 rects) = %.4g s\n", t.elapsed());
+
+  std::vector<std::pair<int, int> > pairs;
+  RectArray smallRects(small);
+  t.reset();
+  smallRects.findOverlappingPairs(pairs);
+  std::printf("RectArray::findOverlappingPairs (10000 rects) = %.4g s\n", t.elapsed());
+  EXPECT_EQ(count, pairs.size());
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include "vaca/RectF.h"
+#include "vaca/PointF.h"
+#include "vaca/SizeF.h"
+#include "vaca/Rect.h"
+#include "vaca/Point.h"
+
+using namespace vaca;
+
+inline std::ostream& operator<<(std::ostream& os, const Rect& rc)
+{
+  return os << "Rect("
+	    << rc.x << ", "
+	    << rc.y << ", "
+	    << rc.w << ", "
+	    << rc.h << ")\n";
+}
+
+inline std::ostream& operator<<(std::ostream& os, const RectF& rc)
+{
+  return os << "RectF("
+	    << rc.x << ", "
+	    << rc.y << ", "
+	    << rc.w << ", "
+	    << rc.h << ")\n";
+}
+
+TEST(RectF, Constructors)
+{
+  EXPECT_EQ(RectF(0, 0, 0, 0), RectF());
+  EXPECT_EQ(RectF(0, 0, 3.5f, 2), RectF(3.5f, 2));
+  EXPECT_EQ(RectF(0, 0, 3.5f, 2), RectF(SizeF(3.5f, 2)));
+  EXPECT_EQ(RectF(1, 2, 3, 4), RectF(Rect(1, 2, 3, 4)));
+  EXPECT_EQ(RectF(1.5f, 2, 3, 4), RectF(PointF(1.5f, 2), SizeF(3, 4)));
+  EXPECT_EQ(RectF(1.5f, 2, 3, 4), RectF(PointF(4.5f, 2), PointF(1.5f, 6)));
+}
+
+TEST(RectF, Geometry)
+{
+  RectF rc(1, 1, 3, 2);
+
+  EXPECT_TRUE(rc.getCenter() == PointF(2.5f, 2));
+  EXPECT_TRUE(rc.getPoint2() == PointF(4, 3));
+  EXPECT_TRUE(rc.contains(PointF(1, 1)));
+  EXPECT_TRUE(rc.contains(PointF(3.99f, 2.99f)));
+  EXPECT_FALSE(rc.contains(PointF(4, 2)));
+  EXPECT_TRUE(rc.contains(RectF(1.5f, 1.5f, 1, 1)));
+
+  // rectangles that only touch don't intersect
+  EXPECT_FALSE(rc.intersects(RectF(4, 1, 1, 1)));
+  EXPECT_TRUE(rc.intersects(RectF(3.9f, 1, 1, 1)));
+
+  EXPECT_EQ(RectF(1, 1, 4, 3), rc.createUnion(RectF(2, 2, 3, 2)));
+  EXPECT_EQ(RectF(2, 2, 2, 1), rc.createIntersect(RectF(2, 2, 3, 2)));
+  EXPECT_EQ(RectF(), rc.createIntersect(RectF(10, 10, 1, 1)));
+  EXPECT_EQ(rc, RectF().createUnion(rc));
+}
+
+TEST(RectF, Round)
+{
+  EXPECT_EQ(Rect(1, 2, 3, 2), RectF(0.6f, 1.6f, 3.0f, 2.0f).round());
+  EXPECT_EQ(Rect(0, 1, 4, 3), RectF(0.6f, 1.6f, 3.0f, 2.0f).getEnclosingRect());
+
+  // adjacent rectangles are adjacent after rounding
+  RectF a(0.3f, 0, 1.4f, 1);
+  RectF b(1.7f, 0, 1.4f, 1);
+  EXPECT_EQ(a.round().x + a.round().w, b.round().x);
+}
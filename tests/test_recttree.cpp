@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "vaca/RectTree.h"
+#include "vaca/Point.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static Rect random_rect(int size, int maxSize)
+{
+  return Rect(std::rand() % size, std::rand() % size,
+	      1 + std::rand() % maxSize, 1 + std::rand() % maxSize);
+}
+
+static bool overlap(const Rect& a, const Rect& b)
+{
+  return
+    a.w > 0 && a.h > 0 && b.w > 0 && b.h > 0 &&
+    a.x < b.x+b.w && b.x < a.x+a.w &&
+    a.y < b.y+b.h && b.y < a.y+a.h;
+}
+
+static long long distance2(const Point& pt, const Rect& rc)
+{
+  long long dx = (pt.x < rc.x ? rc.x - pt.x: pt.x >= rc.x+rc.w ? pt.x - (rc.x+rc.w-1): 0);
+  long long dy = (pt.y < rc.y ? rc.y - pt.y: pt.y >= rc.y+rc.h ? pt.y - (rc.y+rc.h-1): 0);
+  return dx*dx + dy*dy;
+}
+
+// Compares the results of the tree with a linear scan of "rects"
+// (rects[handle] is the rectangle of each handle, or an empty rect)
+static void check_queries(const RectTree& tree, const std::vector<Rect>& rects)
+{
+  std::vector<int> found, expected;
+
+  for (int i=0; i<100; ++i) {
+    Point pt(std::rand() % 1100 - 50, std::rand() % 1100 - 50);
+
+    tree.query(pt, found);
+    expected.clear();
+    for (size_t j=0; j<rects.size(); ++j)
+      if (rects[j].contains(pt))
+	expected.push_back(j);
+    std::sort(found.begin(), found.end());
+    ASSERT_EQ(expected, found);
+
+    Rect rc = random_rect(1000, 200);
+    tree.query(rc, found);
+    expected.clear();
+    for (size_t j=0; j<rects.size(); ++j)
+      if (overlap(rects[j], rc))
+	expected.push_back(j);
+    std::sort(found.begin(), found.end());
+    ASSERT_EQ(expected, found);
+
+    int nearest = tree.nearest(pt);
+    long long best = -1;
+    for (size_t j=0; j<rects.size(); ++j)
+      if (!rects[j].isEmpty() && (best < 0 || distance2(pt, rects[j]) < best))
+	best = distance2(pt, rects[j]);
+    if (best < 0) {
+      EXPECT_EQ(-1, nearest);
+    }
+    else {
+      ASSERT_GE(nearest, 0);
+      EXPECT_EQ(best, distance2(pt, rects[nearest]));
+    }
+  }
+}
+
+TEST(RectTree, Empty)
+{
+  RectTree tree;
+  std::vector<int> found;
+
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(0, tree.getHeight());
+  tree.query(Point(0, 0), found);
+  EXPECT_TRUE(found.empty());
+  EXPECT_EQ(-1, tree.nearest(Point(0, 0)));
+}
+
+TEST(RectTree, InsertRemove)
+{
+  RectTree tree;
+  int a = tree.insert(Rect(0, 0, 10, 10), 100);
+  int b = tree.insert(Rect(5, 5, 10, 10), 200);
+  EXPECT_EQ(2, tree.size());
+  EXPECT_EQ(100, tree.getValue(a));
+  EXPECT_EQ(Rect(5, 5, 10, 10), tree.getBounds(b));
+
+  std::vector<int> found;
+  tree.query(Point(7, 7), found);
+  EXPECT_EQ(2u, found.size());
+  tree.query(Point(12, 12), found);
+  ASSERT_EQ(1u, found.size());
+  EXPECT_EQ(b, found[0]);
+
+  tree.remove(b);
+  tree.query(Point(7, 7), found);
+  ASSERT_EQ(1u, found.size());
+  EXPECT_EQ(a, found[0]);
+
+  // the handle is reused
+  EXPECT_EQ(b, tree.insert(Rect(20, 20, 5, 5)));
+
+  tree.move(a, Rect(30, 30, 10, 10));
+  tree.query(Point(7, 7), found);
+  EXPECT_TRUE(found.empty());
+  EXPECT_EQ(a, tree.nearest(Point(45, 45)));
+}
+
+TEST(RectTree, RandomOperations)
+{
+  std::srand(44);
+
+  RectTree tree;
+  std::vector<Rect> rects;	// rectangle of each handle
+
+  for (int step=0; step<20; ++step) {
+    for (int i=0; i<100; ++i) {
+      int op = std::rand() % 4;
+      std::vector<int> alive;
+      for (size_t j=0; j<rects.size(); ++j)
+	if (!rects[j].isEmpty())
+	  alive.push_back(j);
+
+      if (op <= 1 || alive.empty()) {
+	Rect rc = random_rect(1000, 100);
+	int handle = tree.insert(rc);
+	if (handle >= (int)rects.size())
+	  rects.resize(handle+1);
+	rects[handle] = rc;
+      }
+      else if (op == 2) {
+	int handle = alive[std::rand() % alive.size()];
+	tree.remove(handle);
+	rects[handle] = Rect();
+      }
+      else {
+	int handle = alive[std::rand() % alive.size()];
+	rects[handle] = random_rect(1000, 100);
+	tree.move(handle, rects[handle]);
+      }
+    }
+
+    check_queries(tree, rects);
+  }
+
+  // the tree is balanced
+  EXPECT_LE(tree.getHeight(), 20);
+}
+
+TEST(RectTree, Build)
+{
+  std::srand(45);
+
+  std::vector<Rect> rects;
+  for (int i=0; i<5000; ++i)
+    rects.push_back(random_rect(1000, 50));
+
+  RectTree tree;
+  tree.build(rects);
+  EXPECT_EQ(5000, tree.size());
+  EXPECT_EQ(123, tree.getValue(123));
+  EXPECT_LE(tree.getHeight(), 14);
+  check_queries(tree, rects);
+
+  // a built tree can be modified
+  tree.remove(10);
+  rects[10] = Rect();
+  tree.move(20, Rect(0, 0, 5, 5));
+  rects[20] = Rect(0, 0, 5, 5);
+  check_queries(tree, rects);
+}
+
+TEST(RectTree, Time)
+{
+  std::srand(46);
+
+  const int n = 1000000;
+  std::vector<Rect> rects(n);
+  for (int i=0; i<n; ++i)
+    rects[i] = random_rect(100000, 100);
+
+  RectTree tree;
+  TimePoint t;
+  tree.build(rects);
+  std::printf("build %d rects = %.4g s (height %d)\n", n, t.elapsed(), tree.getHeight());
+
+  RectTree dynamic;
+  t.reset();
+  for (int i=0; i<n; ++i)
+    dynamic.insert(rects[i]);
+  std::printf("insert %d rects = %.4g s (height %d)\n", n, t.elapsed(), dynamic.getHeight());
+
+  std::vector<int> found;
+  size_t total = 0;
+  t.reset();
+  for (int i=0; i<100000; ++i) {
+    tree.query(Point(std::rand() % 100000, std::rand() % 100000), found);
+    total += found.size();
+  }
+  std::printf("100000 point queries = %.4g s (%u found)\n", t.elapsed(), (unsigned)total);
+
+  total = 0;
+  t.reset();
+  for (int i=0; i<100000; ++i) {
+    tree.query(random_rect(100000, 500), found);
+    total += found.size();
+  }
+  std::printf("100000 rect queries = %.4g s (%u found)\n", t.elapsed(), (unsigned)total);
+
+  t.reset();
+  for (int i=0; i<100000; ++i)
+    tree.nearest(Point(std::rand() % 100000, std::rand() % 100000));
+  std::printf("100000 nearest queries = %.4g s\n", t.elapsed());
+
+  t.reset();
+  for (int i=0; i<100000; ++i) {
+    int handle = std::rand() % n;
+    Rect rc = rects[handle];
+    rc.offset(std::rand() % 21 - 10, std::rand() % 21 - 10);
+    tree.move(handle, rc);
+  }
+  std::printf("100000 moves = %.4g s\n", t.elapsed());
+
+  // linear scan to compare
+  total = 0;
+  t.reset();
+  for (int i=0; i<100; ++i) {
+    Point pt(std::rand() % 100000, std::rand() % 100000);
+    for (int j=0; j<n; ++j)
+      if (rects[j].contains(pt))
+	++total;
+  }
+  std::printf("100 point queries with a linear scan = %.4g s\n", t.elapsed());
+}
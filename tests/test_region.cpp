@@ -80,6 +80,31 @@ TEST(Region, GeometricOperations)
   EXPECT_TRUE((r1 | r2) == ((r1 ^ r2) | (r1 | r2)));
 }
 
+TEST(Region, BatchContains)
+{
+  Region rgn =
+    Region::fromRect(Rect(0, 0, 10, 10)) |
+    Region::fromRect(Rect(20, 0, 10, 10)) |
+    Region::fromEllipse(Rect(0, 20, 30, 20));
+
+  std::vector<Point> points;
+  std::vector<Rect> rects;
+  for (int y=-2; y<42; y+=3)
+    for (int x=-2; x<32; x+=3) {
+      points.push_back(Point(x, y));
+      rects.push_back(Rect(x, y, 2, 2));
+    }
+
+  std::vector<unsigned int> pointsMask, rectsMask;
+  rgn.contains(points, pointsMask);
+  rgn.contains(rects, rectsMask);
+
+  for (size_t i=0; i<points.size(); ++i) {
+    EXPECT_EQ(rgn.contains(points[i]), ((pointsMask[i/32] >> (i%32)) & 1) != 0);
+    EXPECT_EQ(rgn.contains(rects[i]), ((rectsMask[i/32] >> (i%32)) & 1) != 0);
+  }
+}
+
 TEST(Region, References)
 {
   Region a = Region::fromRect(Rect(5, 5, 25, 25));
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "vaca/StrokeFitter.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+// Positions of the mouse in a freehand stroke: a spiral with loops
+// drawn with variable speed, rounded to pixels
+static std::vector<PointF> mouse_stroke(int count)
+{
+  std::vector<PointF> points;
+  double t = 0.0;
+  for (int i=0; i<count; ++i) {
+    double r = 50 + t*4;
+    double x = 300 + r*std::cos(t) + 30*std::cos(3.1*t);
+    double y = 300 + r*std::sin(t) + 30*std::sin(2.3*t);
+    points.push_back(PointF(std::floor(x + 0.5), std::floor(y + 0.5)));
+    t += 0.01 + 0.01*std::sin(i*0.05);
+  }
+  return points;
+}
+
+static double segment_distance(const PointF& pt, const PointF& a, const PointF& b)
+{
+  double dx = b.x - a.x, dy = b.y - a.y;
+  double len2 = dx*dx + dy*dy;
+  double t = (len2 > 0 ? ((pt.x - a.x)*dx + (pt.y - a.y)*dy) / len2: 0.0);
+  t = (t < 0 ? 0: t > 1 ? 1: t);
+  double ex = a.x + dx*t - pt.x, ey = a.y + dy*t - pt.y;
+  return std::sqrt(ex*ex + ey*ey);
+}
+
+// Maximum distance from the points to the polyline
+static double max_distance(const std::vector<PointF>& points, const std::vector<PointF>& polyline)
+{
+  double maxDist = 0.0;
+  for (size_t i=0; i<points.size(); ++i) {
+    double best = 1e9;
+    for (size_t j=0; j+1<polyline.size(); ++j)
+      best = std::min(best, segment_distance(points[i], polyline[j], polyline[j+1]));
+    if (polyline.size() == 1)
+      best = segment_distance(points[i], polyline[0], polyline[0]);
+    maxDist = std::max(maxDist, best);
+  }
+  return maxDist;
+}
+
+// Maximum distance from the points to the curves of the path
+static double max_distance(const std::vector<PointF>& points, const GraphicsPath& path)
+{
+  GraphicsPath flat = path;
+  flat.flatten(0.05);
+
+  std::vector<PointF> polyline;
+  for (GraphicsPath::const_iterator it=flat.begin(); it!=flat.end(); ++it)
+    polyline.push_back(PointF(it->getPoint()));
+  return max_distance(points, polyline);
+}
+
+TEST(StrokeFitter, Simplify)
+{
+  std::vector<PointF> points, result;
+
+  // collinear points
+  for (int i=0; i<=10; ++i)
+    points.push_back(PointF(i*3.0f, i*2.0f));
+  StrokeFitter::simplify(points, 0.5, result);
+  ASSERT_EQ(2u, result.size());
+  EXPECT_TRUE(result[0] == points[0]);
+  EXPECT_TRUE(result[1] == points[10]);
+
+  // a stroke
+  points = mouse_stroke(2000);
+  StrokeFitter::simplify(points, 1.0, result);
+  EXPECT_LE(max_distance(points, result), 1.0);
+  EXPECT_LT(result.size(), points.size() / 5);
+
+  // a bigger tolerance removes more points
+  std::vector<PointF> result2;
+  StrokeFitter::simplify(points, 4.0, result2);
+  EXPECT_LE(max_distance(points, result2), 4.0);
+  EXPECT_LT(result2.size(), result.size());
+}
+
+TEST(StrokeFitter, FitCurves)
+{
+  std::vector<PointF> points = mouse_stroke(2000);
+  GraphicsPath path = StrokeFitter::fitCurves(points, 1.0);
+
+  // the control points are rounded to pixels
+  EXPECT_LE(max_distance(points, path), 1.0 + 0.75);
+  EXPECT_LE(path.size(), points.size() / 10);
+  EXPECT_EQ(GraphicsPath::MoveTo, path.begin()->getType());
+  EXPECT_TRUE(PointF((path.end()-1)->getPoint()) == points.back());
+}
+
+TEST(StrokeFitter, Streaming)
+{
+  std::vector<PointF> points = mouse_stroke(5000);
+  StrokeFitter fitter(1.0);
+  EXPECT_TRUE(fitter.empty());
+
+  int maxPending = 0;
+  for (size_t i=0; i<points.size(); ++i) {
+    fitter.addPoint(points[i]);
+    maxPending = std::max(maxPending, fitter.getPendingPointCount());
+
+    // the path is complete while the stroke is drawn
+    if (i == 2500) {
+      std::vector<PointF> drawn(points.begin(), points.begin()+i+1);
+      EXPECT_LE(max_distance(drawn, fitter.getPath()), 1.0 + 0.75);
+    }
+  }
+  fitter.finish();
+
+  // only the last points are kept
+  EXPECT_LE(maxPending, 256);
+  EXPECT_EQ(1, fitter.getPendingPointCount());
+
+  GraphicsPath path = fitter.getPath();
+  EXPECT_LE(max_distance(points, path), 1.0 + 0.75);
+  EXPECT_LE(path.size(), points.size() / 10);
+  EXPECT_TRUE(PointF((path.end()-1)->getPoint()) == points.back());
+}
+
+TEST(StrokeFitter, SmallStrokes)
+{
+  StrokeFitter fitter;
+
+  // a click
+  fitter.addPoint(PointF(10, 10));
+  fitter.addPoint(PointF(10, 10));
+  fitter.finish();
+  EXPECT_EQ(1, fitter.getPointCount());
+  GraphicsPath path = fitter.getPath();
+  ASSERT_EQ(1u, path.size());
+  EXPECT_EQ(Point(10, 10), path.begin()->getPoint());
+
+  // a line
+  fitter.clear();
+  fitter.addPoint(PointF(10, 10));
+  fitter.addPoint(PointF(20, 10));
+  path = fitter.getPath();
+  ASSERT_EQ(4u, path.size());
+  EXPECT_EQ(Point(20, 10), (path.begin()+3)->getPoint());
+
+  // a stroke that goes back over itself
+  std::vector<PointF> points;
+  for (int i=0; i<50; ++i)
+    points.push_back(PointF(static_cast<float>(i), 0));
+  for (int i=48; i>=0; --i)
+    points.push_back(PointF(static_cast<float>(i), 0));
+
+  fitter.clear();
+  for (size_t i=0; i<points.size(); ++i)
+    fitter.addPoint(points[i]);
+  fitter.finish();
+  path = fitter.getPath();
+  EXPECT_LE(max_distance(points, path), 1.75);
+  for (GraphicsPath::const_iterator it=path.begin(); it!=path.end(); ++it)
+    EXPECT_TRUE(std::abs(it->getPoint().x) < 100 && std::abs(it->getPoint().y) < 100);
+}
+
+TEST(StrokeFitter, Corner)
+{
+  // a "V": the stroke turns 135 degrees
+  std::vector<PointF> points;
+  for (int i=0; i<50; ++i)
+    points.push_back(PointF(static_cast<float>(i), 0));
+  for (int i=1; i<50; ++i)
+    points.push_back(PointF(static_cast<float>(49-i), static_cast<float>(i)));
+
+  GraphicsPath path = StrokeFitter::fitCurves(points, 1.0);
+  EXPECT_LE(max_distance(points, path), 1.75);
+
+  // the curve after the corner doesn't continue the tangent of the
+  // previous one (its control points would be after the corner)
+  for (GraphicsPath::const_iterator it=path.begin(); it!=path.end(); ++it)
+    EXPECT_LE(it->getPoint().x, 49);
+}
+
+TEST(StrokeFitter, Time)
+{
+  std::vector<PointF> points = mouse_stroke(100000);
+
+  TimePoint t;
+  StrokeFitter fitter(1.0);
+  for (size_t i=0; i<points.size(); ++i)
+    fitter.addPoint(points[i]);
+  fitter.finish();
+  GraphicsPath path = fitter.getPath();
+  std::printf("streaming fit of %u points = %.4g s (%u nodes)\n",
+	      (unsigned)points.size(), t.elapsed(), path.size());
+
+  t.reset();
+  path = StrokeFitter::fitCurves(points, 1.0);
+  std::printf("fit %u points at once = %.4g s (%u nodes)\n",
+	      (unsigned)points.size(), t.elapsed(), path.size());
+
+  std::vector<PointF> result;
+  t.reset();
+  StrokeFitter::simplify(points, 1.0, result);
+  std::printf("simplify %u points = %.4g s (%u points)\n",
+	      (unsigned)points.size(), t.elapsed(), (unsigned)result.size());
+}
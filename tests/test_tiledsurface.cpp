@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "vaca/TiledSurface.h"
+#include "vaca/Graphics.h"
+#include "vaca/Brush.h"
+
+using namespace vaca;
+
+#define EXPECT_PIXEL(pixels, x, y, r, g, b)			\
+  {								\
+    ImagePixels::pixel_type color = pixels.getPixel(x, y);	\
+    EXPECT_EQ(r, ImagePixels::getR(color));			\
+    EXPECT_EQ(g, ImagePixels::getG(color));			\
+    EXPECT_EQ(b, ImagePixels::getB(color));			\
+  }
+
+TEST(TiledSurface, DrawCreatesTiles)
+{
+  TiledSurface surface(Color::White, 64);
+  EXPECT_EQ(0, surface.getTileCount());
+  EXPECT_FALSE(surface.isDirty());
+
+  // this rectangle touches four tiles
+  Rect rc(60, 60, 10, 10);
+  surface.draw(rc, [&](Graphics& g) {
+      g.fillRect(Brush(Color(255, 0, 0)), rc);
+    });
+
+  EXPECT_EQ(4, surface.getTileCount());
+  EXPECT_EQ(Rect(0, 0, 128, 128), surface.getBounds());
+  EXPECT_TRUE(surface.isDirty());
+
+  std::vector<Rect> dirty;
+  surface.getDirtyRects(dirty);
+  ASSERT_EQ(4u, dirty.size());
+  Rect all;
+  for (size_t i=0; i<dirty.size(); ++i) {
+    EXPECT_TRUE(rc.contains(dirty[i]));
+    all = all.createUnion(dirty[i]);
+  }
+  EXPECT_EQ(rc, all);
+
+  surface.clearDirty();
+  EXPECT_FALSE(surface.isDirty());
+}
+
+TEST(TiledSurface, GetPixels)
+{
+  TiledSurface surface(Color(0, 0, 255), 16);
+
+  Rect rc(10, 10, 20, 4);
+  surface.draw(rc, [&](Graphics& g) {
+      // the clipping region avoids to draw outside rc
+      g.fillRect(Brush(Color(255, 0, 0)), Rect(0, 0, 100, 100));
+    });
+
+  // a negative position (outside the created tiles)
+  ImagePixels pixels = surface.getPixels(Rect(-8, 8, 48, 8));
+  EXPECT_PIXEL(pixels, 0, 0, 0, 0, 255);
+  EXPECT_PIXEL(pixels, 17, 1, 0, 0, 255);
+  EXPECT_PIXEL(pixels, 18, 2, 255, 0, 0);
+  EXPECT_PIXEL(pixels, 37, 5, 255, 0, 0);
+  EXPECT_PIXEL(pixels, 38, 5, 0, 0, 255);
+  EXPECT_PIXEL(pixels, 20, 6, 0, 0, 255);
+}
+
+TEST(TiledSurface, SetPixels)
+{
+  TiledSurface surface(Color::White, 8);
+
+  ImagePixels pixels(10, 10);
+  for (int y=0; y<10; ++y)
+    for (int x=0; x<10; ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(x*10, y*10, 0, 0));
+
+  surface.setPixels(Point(-5, 3), pixels);
+  EXPECT_EQ(4, surface.getTileCount());
+
+  ImagePixels copy = surface.getPixels(Rect(-5, 3, 10, 10));
+  for (int y=0; y<10; ++y)
+    for (int x=0; x<10; ++x)
+      EXPECT_PIXEL(copy, x, y, x*10, y*10, 0);
+}
+
+TEST(TiledSurface, Paint)
+{
+  TiledSurface surface(Color::White, 32);
+  surface.draw(Rect(0, 0, 8, 8), [](Graphics& g) {
+      g.fillRect(Brush(Color::Black), Rect(0, 0, 8, 8));
+    });
+
+  Image image(64, 64);
+  Graphics& g = image.getGraphics();
+  surface.paint(g, Rect(0, 0, 64, 64));
+
+  ImagePixels pixels = image.getPixels();
+  EXPECT_PIXEL(pixels, 0, 0, 0, 0, 0);
+  EXPECT_PIXEL(pixels, 7, 7, 0, 0, 0);
+  EXPECT_PIXEL(pixels, 8, 8, 255, 255, 255);
+  EXPECT_PIXEL(pixels, 40, 40, 255, 255, 255);
+}
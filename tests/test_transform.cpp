@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "vaca/Transform.h"
+#include "vaca/PointF.h"
+#include "vaca/RectF.h"
+#include "vaca/GraphicsPath.h"
+#include "vaca/TimePoint.h"
+
+using namespace vaca;
+
+static void expect_near(const PointF& expected, const PointF& actual)
+{
+  EXPECT_NEAR(expected.x, actual.x, 1e-4);
+  EXPECT_NEAR(expected.y, actual.y, 1e-4);
+}
+
+TEST(Transform, Basics)
+{
+  Transform t;
+  EXPECT_TRUE(t.isIdentity());
+  EXPECT_TRUE(t.apply(PointF(3, 4)) == PointF(3, 4));
+
+  t.translate(10, 20);
+  EXPECT_TRUE(t.apply(PointF(3, 4)) == PointF(13, 24));
+
+  t.reset().scale(2, 3);
+  EXPECT_TRUE(t.apply(PointF(3, 4)) == PointF(6, 12));
+  EXPECT_EQ(6.0, t.getDeterminant());
+
+  // 90 degrees clockwise on the screen
+  t.reset().rotate(90);
+  EXPECT_TRUE(t.apply(PointF(1, 0)) == PointF(0, 1));
+  EXPECT_TRUE(t.apply(PointF(0, 1)) == PointF(-1, 0));
+
+  t.reset().shear(0.5, 0);
+  EXPECT_TRUE(t.apply(PointF(0, 2)) == PointF(1, 2));
+}
+
+TEST(Transform, Order)
+{
+  // rotate a point around (100, 100)
+  Transform t;
+  t.translate(100, 100).rotate(90).translate(-100, -100);
+  expect_near(PointF(100, 110), t.apply(PointF(110, 100)));
+
+  // operator* applies the left side first
+  Transform a = Transform().translate(5, 0);
+  Transform b = Transform().scale(2, 2);
+  expect_near(PointF(12, 2), (a*b).apply(PointF(1, 1)));
+  expect_near(PointF(7, 2), (b*a).apply(PointF(1, 1)));
+}
+
+TEST(Transform, Invert)
+{
+  Transform t;
+  t.translate(15, -3).rotate(30).scale(2, 0.5).shear(0.2, 0.1);
+
+  Transform inv = t;
+  ASSERT_TRUE(inv.invert());
+  for (int i=0; i<10; ++i) {
+    PointF pt(i*7.5f - 20, i*i*1.5f);
+    expect_near(pt, inv.apply(t.apply(pt)));
+  }
+
+  Transform singular(1, 2, 2, 4, 0, 0);
+  EXPECT_FALSE(singular.isInvertible());
+  EXPECT_FALSE(singular.invert());
+  EXPECT_TRUE(singular == Transform(1, 2, 2, 4, 0, 0));
+}
+
+TEST(Transform, Rect)
+{
+  Transform t;
+  t.rotate(45);
+  RectF rc = t.apply(RectF(0, 0, 10, 10));
+  EXPECT_NEAR(-7.0711, rc.x, 1e-3);
+  EXPECT_NEAR(0.0, rc.y, 1e-3);
+  EXPECT_NEAR(14.142, rc.w, 1e-3);
+  EXPECT_NEAR(14.142, rc.h, 1e-3);
+}
+
+TEST(Transform, Batch)
+{
+  Transform t;
+  t.translate(3.5, -1).rotate(17).scale(1.5, 0.75);
+
+  std::srand(46);
+  std::vector<PointF> src(1003);
+  for (size_t i=0; i<src.size(); ++i)
+    src[i] = PointF((std::rand() % 20001 - 10000) / 10.0f,
+		    (std::rand() % 20001 - 10000) / 10.0f);
+
+  std::vector<PointF> dst(src.size());
+  t.apply(&src[0], &dst[0], src.size());
+
+  // the batch version gives the same results than one point
+  for (size_t i=0; i<src.size(); ++i)
+    ASSERT_TRUE(t.apply(src[i]) == dst[i]) << i;
+
+  // in-place
+  t.apply(src);
+  EXPECT_TRUE(src == dst);
+}
+
+TEST(Transform, GraphicsPath)
+{
+  GraphicsPath path;
+  path.moveTo(PointF(0.4f, 0.6f)).lineTo(PointF(10.5f, 0)).lineTo(10, 10).closeFigure();
+  EXPECT_TRUE(path.begin()->getPoint() == Point(0, 1));
+  EXPECT_TRUE((path.begin()+1)->getPoint() == Point(11, 0));
+
+  path.transform(Transform().translate(100, 100).scale(2, 2));
+  EXPECT_TRUE(path.begin()->getPoint() == Point(100, 102));
+  EXPECT_TRUE((path.begin()+2)->getPoint() == Point(120, 120));
+  EXPECT_TRUE(path.contains(Point(115, 105)));
+}
+
+TEST(Transform, Time)
+{
+  const int n = 1000000;
+  std::vector<PointF> points(n);
+  for (int i=0; i<n; ++i)
+    points[i] = PointF(static_cast<float>(i % 1000), static_cast<float>(i / 1000));
+
+  Transform t;
+  t.translate(512, 384).rotate(30).scale(1.25, 1.25);
+  std::vector<PointF> dst(n);
+
+  TimePoint tp;
+  for (int i=0; i<n; ++i)
+    dst[i] = t.apply(points[i]);
+  std::printf("transform %d points one by one = %.4g s\n", n, tp.elapsed());
+
+  tp.reset();
+  t.apply(&points[0], &dst[0], n);
+  std::printf("transform %d points in batch = %.4g s\n", n, tp.elapsed());
+}
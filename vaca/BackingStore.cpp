@@ -0,0 +1,154 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/BackingStore.h"
+#include "vaca/Graphics.h"
+
+using namespace vaca;
+
+BackingStore::BackingStore()
+  : m_capacity(0, 0)
+  , m_peak(0, 0)
+  , m_acquisitions(0)
+  , m_locked(false)
+  , m_hits(0)
+  , m_misses(0)
+  , m_brushColor(m_brush.getColor())
+{
+}
+
+BackingStore::~BackingStore()
+{
+}
+
+/**
+   Returns an image of @a size pixels at least, compatible with @a g.
+
+   The returned image must be given back with #release when the
+   painting is finished (see BackingStoreImage). If the backing store
+   is already in use (e.g. a widget is painted inside the @c onPaint
+   of other widget) a temporary image compatible with @a g is
+   returned.
+
+   The reused image is compatible with the screen, not with @a g,
+   because the image lives more than the device context of @a g (the
+   @c HDC of @c BeginPaint is not valid after @c EndPaint).
+
+   The content of the image is undefined, you have to clear it.
+*/
+Image BackingStore::acquire(const Size& size, Graphics& g)
+{
+  assert(size.w > 0 && size.h > 0);
+
+  if (m_locked) {
+    ++m_misses;
+    return Image(size, g);
+  }
+
+  m_peak = Size(max_value(m_peak.w, size.w),
+		max_value(m_peak.h, size.h));
+
+  // the recent sizes were much smaller than the current image?
+  // release it so the new one uses less memory
+  if (++m_acquisitions >= ShrinkPeriod) {
+    if (m_peak.w*m_peak.h*4 < m_capacity.w*m_capacity.h)
+      clear();
+
+    m_acquisitions = 0;
+    m_peak = size;
+  }
+
+  m_locked = true;
+
+  if (size.w <= m_capacity.w && size.h <= m_capacity.h) {
+    ++m_hits;
+  }
+  else {
+    // grow to the biggest size requested recently
+    m_capacity = Size(max_value(m_capacity.w, m_peak.w),
+		      max_value(m_capacity.h, m_peak.h));
+    m_image = Image(m_capacity);
+    ++m_misses;
+  }
+
+  return m_image;
+}
+
+/**
+   Gives back the @a image returned by #acquire.
+*/
+void BackingStore::release(const Image& image)
+{
+  if (image == m_image)
+    m_locked = false;
+}
+
+/**
+   Returns a brush of the specified @a color. The last brush is
+   cached, so widgets with the same background color don't create a
+   new brush in each paint.
+*/
+Brush BackingStore::getBrush(const Color& color)
+{
+  if (m_brushColor != color) {
+    m_brush = Brush(color);
+    m_brushColor = color;
+  }
+
+  return m_brush;
+}
+
+/**
+   Returns a region that can be reused to get the clipping region of
+   the painted widget.
+*/
+Region& BackingStore::getRegion()
+{
+  return m_region;
+}
+
+/**
+   Returns the size of the current image (zero if there is no image).
+*/
+Size BackingStore::getCapacity() const
+{
+  return m_capacity;
+}
+
+/**
+   Returns the number of times that #acquire reused the image.
+*/
+int BackingStore::getHits() const
+{
+  return m_hits;
+}
+
+/**
+   Returns the number of times that #acquire had to create a new
+   image.
+*/
+int BackingStore::getMisses() const
+{
+  return m_misses;
+}
+
+void BackingStore::resetCounters()
+{
+  m_hits = 0;
+  m_misses = 0;
+}
+
+/**
+   Releases the image (the next #acquire will create a new one). It
+   does nothing if the image is being used.
+*/
+void BackingStore::clear()
+{
+  if (!m_locked) {
+    m_image = Image();
+    m_capacity = Size(0, 0);
+  }
+}
@@ -0,0 +1,125 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_BACKINGSTORE_H
+#define VACA_BACKINGSTORE_H
+
+#include "vaca/base.h"
+#include "vaca/NonCopyable.h"
+#include "vaca/Image.h"
+#include "vaca/Brush.h"
+#include "vaca/Color.h"
+#include "vaca/Region.h"
+#include "vaca/Size.h"
+
+namespace vaca {
+
+/**
+   Off-screen image reused by double-buffered widgets.
+
+   Each thread has one backing store (see CurrentThread#getBackingStore)
+   that is used by Widget#doPaint to paint widgets with
+   Widget#setDoubleBuffered. Instead of creating a new bitmap for each
+   @c WM_PAINT, the same image is reused while it is big enough for the
+   clipping bounds. The image grows to the biggest size requested, and
+   it is released when the requested sizes have been much smaller
+   during a while.
+
+   The number of acquired images that were reused (hits) or that
+   needed a new bitmap (misses) can be used to check that animated
+   widgets don't allocate bitmaps in each frame.
+
+   @see Widget#doPaint, Widget#setDoubleBuffered
+*/
+class VACA_DLL BackingStore : private NonCopyable
+{
+  Image m_image;
+  Size m_capacity;
+  Size m_peak;
+  int m_acquisitions;
+  bool m_locked;
+  int m_hits;
+  int m_misses;
+  Brush m_brush;
+  Color m_brushColor;
+  Region m_region;
+
+public:
+  /**
+     Number of acquisitions after which the image can be shrunk.
+  */
+  enum { ShrinkPeriod = 120 };
+
+  BackingStore();
+  virtual ~BackingStore();
+
+  Image acquire(const Size& size, Graphics& g);
+  void release(const Image& image);
+
+  Brush getBrush(const Color& color);
+  Region& getRegion();
+
+  Size getCapacity() const;
+  int getHits() const;
+  int getMisses() const;
+  void resetCounters();
+
+  void clear();
+};
+
+/**
+   Acquires an image of a BackingStore and releases it when it is
+   destroyed, so the backing store is not left locked if an exception
+   is thrown while the image is used (e.g. from Widget#onPaint).
+
+   @code
+   BackingStoreImage backing(store, size, g);
+   Graphics& imageG = backing.getImage().getGraphics();
+   ...
+   @endcode
+
+   @see BackingStore#acquire, BackingStore#release
+*/
+class BackingStoreImage : private NonCopyable
+{
+  BackingStore& m_store;
+  Image m_image;
+
+  // not defined
+  BackingStoreImage();
+
+public:
+
+  /**
+     Acquires an image of @a size pixels from @a store.
+  */
+  BackingStoreImage(BackingStore& store, const Size& size, Graphics& g)
+    : m_store(store)
+    , m_image(store.acquire(size, g))
+  {
+  }
+
+  /**
+     Gives back the image to the store.
+  */
+  ~BackingStoreImage()
+  {
+    m_store.release(m_image);
+  }
+
+  /**
+     Returns the acquired image.
+  */
+  Image& getImage()
+  {
+    return m_image;
+  }
+
+};
+
+} // namespace vaca
+
+#endif // VACA_BACKINGSTORE_H
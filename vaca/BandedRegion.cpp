@@ -0,0 +1,724 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/BandedRegion.h"
+#include "vaca/Point.h"
+#include "vaca/Size.h"
+#include "vaca/Simd.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+using namespace vaca;
+
+namespace {
+
+  struct Span
+  {
+    int x1, x2;
+  };
+
+  struct UnionOp     { bool operator()(bool a, bool b) const { return a || b; } };
+  struct IntersectOp { bool operator()(bool a, bool b) const { return a && b; } };
+  struct SubtractOp  { bool operator()(bool a, bool b) const { return a && !b; } };
+  struct XorOp       { bool operator()(bool a, bool b) const { return a != b; } };
+
+  // Merges the spans of two bands (sorted rectangles that don't touch
+  // each other) keeping the parts where op(insideA, insideB) is true
+  template<typename Op>
+  void merge_spans(const Rect* a, const Rect* aEnd,
+		   const Rect* b, const Rect* bEnd,
+		   std::vector<Span>& spans)
+  {
+    Op op;
+    bool inA = false, inB = false, inside = false;
+    int start = 0;
+
+    spans.clear();
+    for (;;) {
+      int xa = (a != aEnd ? (inA ? a->x + a->w: a->x): INT_MAX);
+      int xb = (b != bEnd ? (inB ? b->x + b->w: b->x): INT_MAX);
+      int x = min_value(xa, xb);
+      if (x == INT_MAX)
+	break;
+
+      if (xa == x) {
+	if (inA) ++a;
+	inA = !inA;
+      }
+      if (xb == x) {
+	if (inB) ++b;
+	inB = !inB;
+      }
+
+      bool now = op(inA, inB);
+      if (now != inside) {
+	if (now)
+	  start = x;
+	else {
+	  Span span = { start, x };
+	  spans.push_back(span);
+	}
+	inside = now;
+      }
+    }
+  }
+
+  // Adds the band [y1, y2) with the given spans at the end of
+  // "rects". If the previous band ends in y1 and has the same spans,
+  // it is enlarged instead. "prevBand" is the index of the last band.
+  void append_band(std::vector<Rect>& rects, size_t& prevBand,
+		   int y1, int y2, const std::vector<Span>& spans)
+  {
+    if (spans.empty() || y1 >= y2)
+      return;
+
+    const size_t n = rects.size();
+    if (prevBand < n &&
+	rects[prevBand].y + rects[prevBand].h == y1 &&
+	n - prevBand == spans.size()) {
+      bool equal = true;
+      for (size_t i=0; i<spans.size() && equal; ++i) {
+	const Rect& rc = rects[prevBand+i];
+	equal = (rc.x == spans[i].x1 && rc.x + rc.w == spans[i].x2);
+      }
+      if (equal) {
+	for (size_t i=prevBand; i<n; ++i)
+	  rects[i].h = y2 - rects[i].y;
+	return;
+      }
+    }
+
+    prevBand = n;
+    for (size_t i=0; i<spans.size(); ++i)
+      rects.push_back(Rect(spans[i].x1, y1, spans[i].x2 - spans[i].x1, y2 - y1));
+  }
+
+  // Bands with more rectangles than this are searched with a binary
+  // search instead of comparing all of them
+  const int linear_search_limit = 16;
+
+#ifdef VACA_SSE2
+
+  static_assert(sizeof(Rect) == 4*sizeof(int), "Rect must be x, y, w, h");
+
+  // Loads the left (x) and right (x+w) sides of four rectangles
+  inline void load_spans(const Rect* rects, __m128i& x1, __m128i& x2)
+  {
+    __m128 r0 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rects)));
+    __m128 r1 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rects+1)));
+    __m128 r2 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rects+2)));
+    __m128 r3 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rects+3)));
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3); // now r0 has the four x, and r2 the four w
+
+    x1 = _mm_castps_si128(r0);
+    x2 = _mm_add_epi32(x1, _mm_castps_si128(r2));
+  }
+
+#endif
+
+  inline void set_bit(std::vector<unsigned int>& mask, size_t i)
+  {
+    mask[i / 32] |= 1u << (i % 32);
+  }
+
+  inline int round_to_int(double x)
+  {
+    return static_cast<int>(std::floor(x + 0.5));
+  }
+
+}
+
+/**
+   Creates an empty region.
+*/
+BandedRegion::BandedRegion()
+{
+}
+
+/**
+   Creates a region with the rectangle @a rc.
+*/
+BandedRegion::BandedRegion(const Rect& rc)
+{
+  if (!rc.isEmpty()) {
+    m_rects.push_back(rc);
+    m_bands.push_back(0);
+    m_bands.push_back(1);
+    m_bounds = rc;
+  }
+}
+
+bool BandedRegion::isEmpty() const
+{
+  return m_rects.empty();
+}
+
+/**
+   Returns true if the region is just a rectangle.
+*/
+bool BandedRegion::isSimple() const
+{
+  return m_rects.size() == 1;
+}
+
+/**
+   Returns true if the region has more than one rectangle.
+*/
+bool BandedRegion::isComplex() const
+{
+  return m_rects.size() > 1;
+}
+
+/**
+   Returns the bounds of the region (an empty rectangle if the region
+   is empty).
+*/
+Rect BandedRegion::getBounds() const
+{
+  return m_bounds;
+}
+
+/**
+   Returns the rectangles of the region, sorted by bands (from top to
+   bottom) and by @c x inside each band. They don't overlap.
+*/
+const std::vector<Rect>& BandedRegion::getRects() const
+{
+  return m_rects;
+}
+
+int BandedRegion::getRectCount() const
+{
+  return static_cast<int>(m_rects.size());
+}
+
+int BandedRegion::getBandCount() const
+{
+  return max_value(static_cast<int>(m_bands.size()) - 1, 0);
+}
+
+BandedRegion& BandedRegion::offset(int dx, int dy)
+{
+  for (auto& rc : m_rects)
+    rc.offset(dx, dy);
+
+  if (!m_rects.empty())
+    m_bounds.offset(dx, dy);
+
+  return *this;
+}
+
+BandedRegion& BandedRegion::offset(const Point& point)
+{
+  return offset(point.x, point.y);
+}
+
+/**
+   Returns true if the point is inside the region. It makes a binary
+   search of the band and of the rectangle inside the band.
+*/
+bool BandedRegion::contains(const Point& pt) const
+{
+  if (!m_bounds.contains(pt))
+    return false;
+
+  int band = findBand(pt.y);
+  return band >= 0 && bandContains(band, pt.x);
+}
+
+/**
+   Returns true if some part of the rectangle @a rc is inside the
+   region (like Region#contains).
+*/
+bool BandedRegion::contains(const Rect& rc) const
+{
+  if (rc.isEmpty() || !m_bounds.intersects(rc))
+    return false;
+
+  const int bands = getBandCount();
+  for (int band=findFirstBandBelow(rc.y);
+       band < bands && m_rects[m_bands[band]].y < rc.y + rc.h; ++band) {
+    if (bandIntersects(band, rc.x, rc.x + rc.w))
+      return true;
+  }
+  return false;
+}
+
+/**
+   Tests a lot of points at the same time.
+
+   @param mask
+     The result: the bit @c i%32 of @c mask[i/32] is 1 if
+     @c points[i] is inside the region.
+*/
+void BandedRegion::contains(const std::vector<Point>& points, std::vector<unsigned int>& mask) const
+{
+  mask.assign((points.size() + 31) / 32, 0);
+
+  // the band of the previous point is checked before searching it
+  // (e.g. the points of a stroke are usually in the same band)
+  int band = -1;
+
+  for (size_t i=0; i<points.size(); ++i) {
+    const Point& pt = points[i];
+    if (!m_bounds.contains(pt))
+      continue;
+
+    if (band < 0 ||
+	pt.y < m_rects[m_bands[band]].y ||
+	pt.y >= m_rects[m_bands[band]].y + m_rects[m_bands[band]].h) {
+      band = findBand(pt.y);
+      if (band < 0)
+	continue;
+    }
+
+    if (bandContains(band, pt.x))
+      set_bit(mask, i);
+  }
+}
+
+/**
+   Tests a lot of rectangles at the same time (see
+   #contains(const Rect&) const).
+
+   @param mask
+     The result: the bit @c i%32 of @c mask[i/32] is 1 if some part
+     of @c rects[i] is inside the region.
+*/
+void BandedRegion::contains(const std::vector<Rect>& rects, std::vector<unsigned int>& mask) const
+{
+  mask.assign((rects.size() + 31) / 32, 0);
+
+  for (size_t i=0; i<rects.size(); ++i)
+    if (contains(rects[i]))
+      set_bit(mask, i);
+}
+
+bool BandedRegion::operator==(const BandedRegion& rgn) const
+{
+  return m_rects == rgn.m_rects;
+}
+
+bool BandedRegion::operator!=(const BandedRegion& rgn) const
+{
+  return !operator==(rgn);
+}
+
+BandedRegion BandedRegion::operator|(const BandedRegion& rgn) const
+{
+  return combine<UnionOp>(*this, rgn);
+}
+
+BandedRegion BandedRegion::operator+(const BandedRegion& rgn) const
+{
+  return operator|(rgn);
+}
+
+BandedRegion BandedRegion::operator&(const BandedRegion& rgn) const
+{
+  return combine<IntersectOp>(*this, rgn);
+}
+
+BandedRegion BandedRegion::operator-(const BandedRegion& rgn) const
+{
+  return combine<SubtractOp>(*this, rgn);
+}
+
+BandedRegion BandedRegion::operator^(const BandedRegion& rgn) const
+{
+  return combine<XorOp>(*this, rgn);
+}
+
+/**
+   Makes an union between both regions and leaves the result in
+   @b this region.
+*/
+BandedRegion& BandedRegion::operator|=(const BandedRegion& rgn)
+{
+  return *this = combine<UnionOp>(*this, rgn);
+}
+
+/**
+   Makes an union between both regions and leaves the result in
+   @b this region.
+*/
+BandedRegion& BandedRegion::operator+=(const BandedRegion& rgn)
+{
+  return operator|=(rgn);
+}
+
+/**
+   Makes the intersection between both regions and leaves
+   the result in @b this region.
+*/
+BandedRegion& BandedRegion::operator&=(const BandedRegion& rgn)
+{
+  return *this = combine<IntersectOp>(*this, rgn);
+}
+
+/**
+   Substracts the speficied region @a rgn from @b this region.
+*/
+BandedRegion& BandedRegion::operator-=(const BandedRegion& rgn)
+{
+  return *this = combine<SubtractOp>(*this, rgn);
+}
+
+/**
+   Makes a XOR operation between both regions and leaves the result in
+   @b this region.
+*/
+BandedRegion& BandedRegion::operator^=(const BandedRegion& rgn)
+{
+  return *this = combine<XorOp>(*this, rgn);
+}
+
+/**
+   Creates a region from a rectangle.
+*/
+BandedRegion BandedRegion::fromRect(const Rect& rc)
+{
+  return BandedRegion(rc);
+}
+
+/**
+   Creates a region from a list of rectangles (they can overlap). The
+   rectangles are joined in pairs, so it is faster than joining them
+   one by one.
+*/
+BandedRegion BandedRegion::fromRects(const std::vector<Rect>& rects)
+{
+  if (rects.empty())
+    return BandedRegion();
+
+  return fromRects(&rects[0], &rects[0] + rects.size());
+}
+
+/**
+   Creates a region from rectangles that are already divided in bands
+   (like the rectangles of Region#getRects): the rectangles of each
+   band have the same @c y and height and are sorted by @c x, and the
+   bands are sorted by @c y and don't overlap.
+
+   The rectangles are copied in only one pass (touching rectangles and
+   equal adjacent bands are joined), so it is faster than #fromRects.
+*/
+BandedRegion BandedRegion::fromBandedRects(const std::vector<Rect>& rects)
+{
+  BandedRegion rgn;
+  rgn.m_rects.reserve(rects.size());
+
+  std::vector<Span> spans;
+  size_t prevBand = 0;
+  size_t i = 0;
+
+  while (i < rects.size()) {
+    const int y1 = rects[i].y;
+    const int y2 = rects[i].y + rects[i].h;
+    assert(rgn.m_rects.empty() || rgn.m_rects.back().y + rgn.m_rects.back().h <= y1);
+
+    spans.clear();
+    for (; i < rects.size() && rects[i].y == y1 && rects[i].h == y2 - y1; ++i) {
+      const Rect& rc = rects[i];
+      if (rc.w <= 0)
+	continue;
+
+      assert(spans.empty() || spans.back().x2 <= rc.x);
+      if (!spans.empty() && spans.back().x2 == rc.x)
+	spans.back().x2 = rc.x + rc.w;
+      else {
+	Span span = { rc.x, rc.x + rc.w };
+	spans.push_back(span);
+      }
+    }
+
+    append_band(rgn.m_rects, prevBand, y1, y2, spans);
+  }
+
+  rgn.updateBands();
+  return rgn;
+}
+
+BandedRegion BandedRegion::fromRects(const Rect* begin, const Rect* end)
+{
+  if (end - begin == 1)
+    return BandedRegion(*begin);
+
+  const Rect* middle = begin + (end - begin)/2;
+  return combine<UnionOp>(fromRects(begin, middle),
+			  fromRects(middle, end));
+}
+
+/**
+   Creates a region from an ellipse (one span for each row of pixels).
+*/
+BandedRegion BandedRegion::fromEllipse(const Rect& rc)
+{
+  BandedRegion rgn;
+  if (rc.isEmpty())
+    return rgn;
+
+  const double a = rc.w / 2.0;
+  const double b = rc.h / 2.0;
+  const double cx = rc.x + a;
+  const double cy = rc.y + b;
+  std::vector<Span> spans(1);
+  size_t prevBand = 0;
+
+  for (int y=rc.y; y<rc.y+rc.h; ++y) {
+    double dy = (y + 0.5 - cy) / b;
+    double half = a * std::sqrt(max_value(0.0, 1.0 - dy*dy));
+
+    spans[0].x1 = round_to_int(cx - half);
+    spans[0].x2 = round_to_int(cx + half);
+    if (spans[0].x1 < spans[0].x2)
+      append_band(rgn.m_rects, prevBand, y, y+1, spans);
+  }
+
+  rgn.updateBands();
+  return rgn;
+}
+
+/**
+   Creates a region from a rectangle with rounded corners, each corner
+   is a quarter of an ellipse of @a ellipseSize.
+*/
+BandedRegion BandedRegion::fromRoundRect(const Rect& rc, const Size& ellipseSize)
+{
+  BandedRegion rgn;
+  if (rc.isEmpty())
+    return rgn;
+
+  const int ew = clamp_value(ellipseSize.w, 0, rc.w);
+  const int eh = clamp_value(ellipseSize.h, 0, rc.h);
+  if (ew < 2 || eh < 2)
+    return BandedRegion(rc);
+
+  const double a = ew / 2.0;
+  const double b = eh / 2.0;
+  std::vector<Span> spans(1);
+  size_t prevBand = 0;
+
+  for (int y=rc.y; y<rc.y+rc.h; ++y) {
+    // row inside the ellipse of the corners
+    double dy;
+    if (y < rc.y + eh/2)
+      dy = (y - rc.y + 0.5 - b) / b;
+    else if (y >= rc.y + rc.h - eh/2)
+      dy = (y - (rc.y + rc.h - eh) + 0.5 - b) / b;
+    else
+      dy = 0.0;
+
+    int inset = round_to_int(a - a * std::sqrt(max_value(0.0, 1.0 - dy*dy)));
+    spans[0].x1 = rc.x + inset;
+    spans[0].x2 = rc.x + rc.w - inset;
+    if (spans[0].x1 < spans[0].x2)
+      append_band(rgn.m_rects, prevBand, y, y+1, spans);
+  }
+
+  rgn.updateBands();
+  return rgn;
+}
+
+/**
+   Sweeps the bands of both regions from top to bottom. Each part of
+   a band where the regions don't change vertically is merged
+   horizontally with Op, so the result has the bands already split
+   and joined.
+*/
+template<typename Op>
+BandedRegion BandedRegion::combine(const BandedRegion& a, const BandedRegion& b)
+{
+  Op op;
+  const int na = a.getBandCount();
+  const int nb = b.getBandCount();
+
+  BandedRegion rgn;
+  rgn.m_rects.reserve(a.m_rects.size() + b.m_rects.size());
+
+  std::vector<Span> spans;
+  size_t prevBand = 0;
+  int ka = 0, kb = 0;		// current band of each region
+  int y = INT_MIN;
+
+  for (;;) {
+    // skip the bands that are above y
+    while (ka < na && a.m_rects[a.m_bands[ka]].y + a.m_rects[a.m_bands[ka]].h <= y)
+      ++ka;
+    while (kb < nb && b.m_rects[b.m_bands[kb]].y + b.m_rects[b.m_bands[kb]].h <= y)
+      ++kb;
+
+    const bool moreA = (ka < na);
+    const bool moreB = (kb < nb);
+    if ((!moreA || !op(true, false)) &&
+	(!moreB || !op(false, true)) &&
+	(!moreA || !moreB || !op(true, true)))
+      break;
+
+    const Rect* bandA = (moreA ? &a.m_rects[a.m_bands[ka]]: NULL);
+    const Rect* bandB = (moreB ? &b.m_rects[b.m_bands[kb]]: NULL);
+    const int topA = (moreA ? max_value(bandA->y, y): INT_MAX);
+    const int topB = (moreB ? max_value(bandB->y, y): INT_MAX);
+    const int top = min_value(topA, topB);
+    const bool inA = (topA == top);
+    const bool inB = (topB == top);
+
+    int bottom = INT_MAX;
+    bottom = min_value(bottom, inA ? bandA->y + bandA->h: topA);
+    bottom = min_value(bottom, inB ? bandB->y + bandB->h: topB);
+
+    if (inA && inB)
+      merge_spans<Op>(bandA, &a.m_rects[0] + a.m_bands[ka+1],
+		      bandB, &b.m_rects[0] + b.m_bands[kb+1], spans);
+    else if (inA)
+      merge_spans<Op>(bandA, &a.m_rects[0] + a.m_bands[ka+1], NULL, NULL, spans);
+    else
+      merge_spans<Op>(NULL, NULL, bandB, &b.m_rects[0] + b.m_bands[kb+1], spans);
+
+    append_band(rgn.m_rects, prevBand, top, bottom, spans);
+    y = bottom;
+  }
+
+  rgn.updateBands();
+  return rgn;
+}
+
+// Returns the band that contains the row y, or -1 if the row is
+// outside all the bands
+int BandedRegion::findBand(int y) const
+{
+  // the last band with top <= y
+  int lo = 0, hi = getBandCount();
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (m_rects[m_bands[mid]].y <= y)
+      lo = mid+1;
+    else
+      hi = mid;
+  }
+
+  if (lo == 0)
+    return -1;
+
+  const Rect& rc = m_rects[m_bands[lo-1]];
+  return (y < rc.y + rc.h ? lo-1: -1);
+}
+
+// Returns the first band that ends after the row y
+int BandedRegion::findFirstBandBelow(int y) const
+{
+  int lo = 0, hi = getBandCount();
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    const Rect& rc = m_rects[m_bands[mid]];
+    if (rc.y + rc.h <= y)
+      lo = mid+1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// Returns true if a rectangle of the band has the column x
+bool BandedRegion::bandContains(int band, int x) const
+{
+  const Rect* begin = &m_rects[0] + m_bands[band];
+  const Rect* end = &m_rects[0] + m_bands[band+1];
+
+  if (end - begin > linear_search_limit) {
+    // the last rectangle with left side <= x
+    const Rect* it = std::upper_bound(begin, end, x,
+				      [](int x, const Rect& rc) { return x < rc.x; });
+    return (it != begin && x < (it-1)->x + (it-1)->w);
+  }
+
+  const Rect* it = begin;
+
+#ifdef VACA_SSE2
+  const __m128i vx = _mm_set1_epi32(x);
+  for (; it+4<=end; it+=4) {
+    __m128i x1, x2;
+    load_spans(it, x1, x2);
+
+    // x1 <= x && x < x2
+    __m128i inside = _mm_andnot_si128(_mm_cmpgt_epi32(x1, vx),
+				      _mm_cmpgt_epi32(x2, vx));
+    if (_mm_movemask_epi8(inside))
+      return true;
+  }
+#endif
+
+  for (; it!=end; ++it)
+    if (it->x <= x && x < it->x + it->w)
+      return true;
+
+  return false;
+}
+
+// Returns true if a rectangle of the band overlaps the columns [x1, x2)
+bool BandedRegion::bandIntersects(int band, int x1, int x2) const
+{
+  const Rect* begin = &m_rects[0] + m_bands[band];
+  const Rect* end = &m_rects[0] + m_bands[band+1];
+
+  if (end - begin > linear_search_limit) {
+    // the first rectangle with right side > x1 (the right sides are
+    // sorted too because the rectangles don't overlap)
+    const Rect* it = std::upper_bound(begin, end, x1,
+				      [](int x, const Rect& rc) { return x < rc.x + rc.w; });
+    return (it != end && it->x < x2);
+  }
+
+  const Rect* it = begin;
+
+#ifdef VACA_SSE2
+  const __m128i vx1 = _mm_set1_epi32(x1);
+  const __m128i vx2 = _mm_set1_epi32(x2);
+  for (; it+4<=end; it+=4) {
+    __m128i rx1, rx2;
+    load_spans(it, rx1, rx2);
+
+    // rx1 < x2 && x1 < rx2
+    __m128i overlap = _mm_and_si128(_mm_cmpgt_epi32(vx2, rx1),
+				    _mm_cmpgt_epi32(rx2, vx1));
+    if (_mm_movemask_epi8(overlap))
+      return true;
+  }
+#endif
+
+  for (; it!=end; ++it)
+    if (it->x < x2 && x1 < it->x + it->w)
+      return true;
+
+  return false;
+}
+
+// Calculates the bounds and the index of the bands
+void BandedRegion::updateBands()
+{
+  m_bands.clear();
+  if (m_rects.empty()) {
+    m_bounds = Rect();
+    return;
+  }
+
+  int x1 = INT_MAX, x2 = INT_MIN;
+  for (size_t i=0; i<m_rects.size(); ++i) {
+    const Rect& rc = m_rects[i];
+    if (i == 0 || rc.y != m_rects[i-1].y)
+      m_bands.push_back(static_cast<int>(i));
+
+    x1 = min_value(x1, rc.x);
+    x2 = max_value(x2, rc.x + rc.w);
+  }
+  m_bands.push_back(static_cast<int>(m_rects.size()));
+
+  const int y1 = m_rects.front().y;
+  const int y2 = m_rects.back().y + m_rects.back().h;
+  m_bounds = Rect(x1, y1, x2 - x1, y2 - y1);
+}
@@ -0,0 +1,95 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_BANDEDREGION_H
+#define VACA_BANDEDREGION_H
+
+#include "vaca/base.h"
+#include "vaca/Rect.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   A region implemented as a list of rectangles (it doesn't use GDI).
+
+   The rectangles are divided in horizontal bands: all the rectangles
+   of a band have the same @c y and height, they are sorted by @c x
+   and they don't touch each other. Bands are sorted by @c y, and two
+   adjacent bands never have the same horizontal spans (they are
+   joined in one band). So a set of pixels has only one
+   representation, and the operators are linear merges of the bands
+   of both regions.
+
+   It has the same operations as Region, and it can be converted to a
+   Region with Region::fromRects(rgn.getRects()).
+
+   @see Region
+*/
+class VACA_DLL BandedRegion
+{
+  std::vector<Rect> m_rects;
+  std::vector<int> m_bands;	// index of the first rectangle of each band (and m_rects.size())
+  Rect m_bounds;
+
+public:
+
+  BandedRegion();
+  explicit BandedRegion(const Rect& rc);
+
+  bool isEmpty() const;
+  bool isSimple() const;
+  bool isComplex() const;
+
+  Rect getBounds() const;
+  const std::vector<Rect>& getRects() const;
+  int getRectCount() const;
+  int getBandCount() const;
+
+  BandedRegion& offset(int dx, int dy);
+  BandedRegion& offset(const Point& point);
+
+  bool contains(const Point& pt) const;
+  bool contains(const Rect& rc) const;
+  void contains(const std::vector<Point>& points, std::vector<unsigned int>& mask) const;
+  void contains(const std::vector<Rect>& rects, std::vector<unsigned int>& mask) const;
+
+  bool operator==(const BandedRegion& rgn) const;
+  bool operator!=(const BandedRegion& rgn) const;
+
+  BandedRegion operator|(const BandedRegion& rgn) const;
+  BandedRegion operator+(const BandedRegion& rgn) const;
+  BandedRegion operator&(const BandedRegion& rgn) const;
+  BandedRegion operator-(const BandedRegion& rgn) const;
+  BandedRegion operator^(const BandedRegion& rgn) const;
+
+  BandedRegion& operator|=(const BandedRegion& rgn);
+  BandedRegion& operator+=(const BandedRegion& rgn);
+  BandedRegion& operator&=(const BandedRegion& rgn);
+  BandedRegion& operator-=(const BandedRegion& rgn);
+  BandedRegion& operator^=(const BandedRegion& rgn);
+
+  static BandedRegion fromRect(const Rect& rc);
+  static BandedRegion fromRects(const std::vector<Rect>& rects);
+  static BandedRegion fromBandedRects(const std::vector<Rect>& rects);
+  static BandedRegion fromEllipse(const Rect& rc);
+  static BandedRegion fromRoundRect(const Rect& rc, const Size& ellipseSize);
+
+private:
+  template<typename Op>
+  static BandedRegion combine(const BandedRegion& a, const BandedRegion& b);
+  static BandedRegion fromRects(const Rect* begin, const Rect* end);
+  int findBand(int y) const;
+  int findFirstBandBelow(int y) const;
+  bool bandContains(int band, int x) const;
+  bool bandIntersects(int band, int x1, int x2) const;
+  void updateBands();
+};
+
+} // namespace vaca
+
+#endif // VACA_BANDEDREGION_H
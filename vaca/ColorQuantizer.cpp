@@ -0,0 +1,405 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/ColorQuantizer.h"
+#include "vaca/ParallelFor.h"
+
+#include <algorithm>
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  // Bits per channel used in the histogram and in the table of
+  // nearest colors
+  const int bits = 5;
+  const int levels = 1 << bits;
+  const int shift = 8 - bits;
+  const int table_size = levels * levels * levels;
+
+  // Minimum number of scanlines to be processed by each thread
+  const int scanlines_per_thread = 16;
+
+  inline int bin_index(int r, int g, int b)
+  {
+    return ((r >> shift) << (2*bits)) | ((g >> shift) << bits) | (b >> shift);
+  }
+
+  inline int bin_index(pixel_type p)
+  {
+    return bin_index(ImagePixels::getR(p),
+		     ImagePixels::getG(p),
+		     ImagePixels::getB(p));
+  }
+
+  // Pixels of the image that fall in each bin of the histogram (sums
+  // are used to calculate the average color of the bin)
+  struct Histogram
+  {
+    std::vector<int> count;
+    std::vector<double> sumR, sumG, sumB;
+
+    Histogram()
+      : count(table_size, 0)
+      , sumR(table_size, 0.0)
+      , sumG(table_size, 0.0)
+      , sumB(table_size, 0.0) {
+    }
+  };
+
+  // A box of the RGB cube (bounds in bins, both inclusive)
+  struct Box
+  {
+    int lo[3], hi[3];
+    int count;
+
+    int getAxisLength(int axis) const {
+      return hi[axis] - lo[axis] + 1;
+    }
+
+    bool isSplittable() const {
+      return lo[0] < hi[0] || lo[1] < hi[1] || lo[2] < hi[2];
+    }
+  };
+
+  inline int bin_index(const int c[3])
+  {
+    return (c[0] << (2*bits)) | (c[1] << bits) | c[2];
+  }
+
+  // Shrinks the box to the bounds of the bins that have pixels
+  void shrink_box(const Histogram& hist, Box& box)
+  {
+    int lo[3] = { levels, levels, levels };
+    int hi[3] = { -1, -1, -1 };
+    int c[3];
+
+    box.count = 0;
+    for (c[0]=box.lo[0]; c[0]<=box.hi[0]; ++c[0])
+      for (c[1]=box.lo[1]; c[1]<=box.hi[1]; ++c[1])
+	for (c[2]=box.lo[2]; c[2]<=box.hi[2]; ++c[2]) {
+	  int n = hist.count[bin_index(c)];
+	  if (n > 0) {
+	    box.count += n;
+	    for (int i=0; i<3; ++i) {
+	      lo[i] = min_value(lo[i], c[i]);
+	      hi[i] = max_value(hi[i], c[i]);
+	    }
+	  }
+	}
+
+    if (box.count > 0) {
+      for (int i=0; i<3; ++i) {
+	box.lo[i] = lo[i];
+	box.hi[i] = hi[i];
+      }
+    }
+  }
+
+  // Splits the box in its longest axis, at the median of its pixels
+  void split_box(const Histogram& hist, Box& box, Box& other)
+  {
+    int axis = 0;
+    for (int i=1; i<3; ++i)
+      if (box.getAxisLength(i) > box.getAxisLength(axis))
+	axis = i;
+
+    // pixels in each slice of the box along the axis
+    std::vector<int> slices(box.getAxisLength(axis), 0);
+    int c[3];
+    for (c[0]=box.lo[0]; c[0]<=box.hi[0]; ++c[0])
+      for (c[1]=box.lo[1]; c[1]<=box.hi[1]; ++c[1])
+	for (c[2]=box.lo[2]; c[2]<=box.hi[2]; ++c[2])
+	  slices[c[axis] - box.lo[axis]] += hist.count[bin_index(c)];
+
+    // the last slice of the first half (both halves get one slice
+    // at least)
+    int half = box.count / 2;
+    int accum = 0;
+    int last = 0;
+    for (; last < static_cast<int>(slices.size())-2; ++last) {
+      accum += slices[last];
+      if (accum >= half)
+	break;
+    }
+
+    other = box;
+    box.hi[axis] = box.lo[axis] + last;
+    other.lo[axis] = box.hi[axis] + 1;
+
+    shrink_box(hist, box);
+    shrink_box(hist, other);
+  }
+
+  Color average_color(const Histogram& hist, const Box& box)
+  {
+    double r = 0.0, g = 0.0, b = 0.0;
+    int c[3];
+
+    for (c[0]=box.lo[0]; c[0]<=box.hi[0]; ++c[0])
+      for (c[1]=box.lo[1]; c[1]<=box.hi[1]; ++c[1])
+	for (c[2]=box.lo[2]; c[2]<=box.hi[2]; ++c[2]) {
+	  int i = bin_index(c);
+	  r += hist.sumR[i];
+	  g += hist.sumG[i];
+	  b += hist.sumB[i];
+	}
+
+    return Color(static_cast<int>(r / box.count + 0.5),
+		 static_cast<int>(g / box.count + 0.5),
+		 static_cast<int>(b / box.count + 0.5));
+  }
+
+  // Table with the index of the nearest palette entry for the center
+  // of each bin. The palette is stored as planar arrays so the
+  // distances are calculated with vectorizable loops.
+  class NearestColorTable
+  {
+    std::vector<int> m_r, m_g, m_b;
+    std::vector<unsigned char> m_table;
+
+  public:
+    NearestColorTable(const std::vector<Color>& palette)
+      : m_table(table_size) {
+      assert(!palette.empty() && palette.size() <= 256);
+
+      for (size_t i=0; i<palette.size(); ++i) {
+	m_r.push_back(palette[i].getR());
+	m_g.push_back(palette[i].getG());
+	m_b.push_back(palette[i].getB());
+      }
+
+      parallel_for(0, table_size, 1024, [this](int i0, int i1) {
+	  std::vector<int> dist(m_r.size());
+	  for (int i=i0; i<i1; ++i) {
+	    int r = (((i >> (2*bits)) & (levels-1)) << shift) | (1 << (shift-1));
+	    int g = (((i >> bits) & (levels-1)) << shift) | (1 << (shift-1));
+	    int b = ((i & (levels-1)) << shift) | (1 << (shift-1));
+	    m_table[i] = static_cast<unsigned char>(find(r, g, b, dist));
+	  }
+	});
+    }
+
+    int operator()(int r, int g, int b) const {
+      return m_table[bin_index(r, g, b)];
+    }
+
+  private:
+    int find(int r, int g, int b, std::vector<int>& dist) const {
+      const int n = static_cast<int>(m_r.size());
+      for (int k=0; k<n; ++k) {
+	int dr = m_r[k] - r;
+	int dg = m_g[k] - g;
+	int db = m_b[k] - b;
+	dist[k] = dr*dr + dg*dg + db*db;
+      }
+
+      int best = 0;
+      for (int k=1; k<n; ++k)
+	if (dist[k] < dist[best])
+	  best = k;
+      return best;
+    }
+  };
+
+  inline pixel_type make_pixel(pixel_type alpha, const Color& color)
+  {
+    return (alpha & 0xff000000) |
+      (static_cast<pixel_type>(color.getR()) << 16) |
+      (static_cast<pixel_type>(color.getG()) << 8) |
+      static_cast<pixel_type>(color.getB());
+  }
+
+} // anonymous namespace
+
+/**
+   Creates a quantizer that generates palettes of @a maxColors
+   colors at most (from 1 to 256).
+*/
+ColorQuantizer::ColorQuantizer(int maxColors)
+  : m_maxColors(maxColors)
+  , m_dithering(false)
+{
+  assert(maxColors >= 1 && maxColors <= 256);
+}
+
+int ColorQuantizer::getMaxColors() const
+{
+  return m_maxColors;
+}
+
+void ColorQuantizer::setMaxColors(int maxColors)
+{
+  assert(maxColors >= 1 && maxColors <= 256);
+  m_maxColors = maxColors;
+}
+
+/**
+   Returns true if #remap uses Floyd-Steinberg dithering.
+*/
+bool ColorQuantizer::isDithering() const
+{
+  return m_dithering;
+}
+
+void ColorQuantizer::setDithering(bool state)
+{
+  m_dithering = state;
+}
+
+/**
+   Creates a palette with the most representative colors of the
+   @a pixels (the alpha channel is ignored).
+
+   The palette can have less than #getMaxColors entries if the image
+   has few colors.
+*/
+std::vector<Color> ColorQuantizer::createPalette(const ImagePixels& pixels) const
+{
+  const int width = pixels.getWidth();
+  const int height = pixels.getHeight();
+  const int scanline = pixels.getScanlineSize();
+  std::vector<Color> palette;
+  Histogram hist;
+
+  for (int y=0; y<height; ++y) {
+    const pixel_type* p = &pixels[0] + y*scanline;
+    for (int x=0; x<width; ++x) {
+      int i = bin_index(p[x]);
+      ++hist.count[i];
+      hist.sumR[i] += ImagePixels::getR(p[x]);
+      hist.sumG[i] += ImagePixels::getG(p[x]);
+      hist.sumB[i] += ImagePixels::getB(p[x]);
+    }
+  }
+
+  std::vector<Box> boxes;
+  boxes.reserve(m_maxColors);
+
+  Box box = { { 0, 0, 0 }, { levels-1, levels-1, levels-1 }, 0 };
+  shrink_box(hist, box);
+  if (box.count == 0)
+    return palette;
+  boxes.push_back(box);
+
+  // split the box with more pixels until we have all the colors
+  while (static_cast<int>(boxes.size()) < m_maxColors) {
+    int biggest = -1;
+    for (int i=0; i<static_cast<int>(boxes.size()); ++i)
+      if (boxes[i].isSplittable() &&
+	  (biggest < 0 || boxes[i].count > boxes[biggest].count))
+	biggest = i;
+
+    if (biggest < 0)
+      break;
+
+    Box other;
+    split_box(hist, boxes[biggest], other);
+    boxes.push_back(other);
+  }
+
+  palette.reserve(boxes.size());
+  for (size_t i=0; i<boxes.size(); ++i)
+    palette.push_back(average_color(hist, boxes[i]));
+
+  return palette;
+}
+
+/**
+   Replaces each pixel with the nearest color of the @a palette. The
+   alpha channel of the pixels is not modified.
+
+   Without dithering the image is split between all processors; with
+   dithering the error of each pixel depends on the previous ones, so
+   it is processed in one thread.
+*/
+void ColorQuantizer::remap(ImagePixels& pixels, const std::vector<Color>& palette) const
+{
+  const int width = pixels.getWidth();
+  const int height = pixels.getHeight();
+  const int scanline = pixels.getScanlineSize();
+
+  if (palette.empty() || width == 0 || height == 0)
+    return;
+
+  NearestColorTable nearest(palette);
+
+  if (!m_dithering) {
+    parallel_for(0, height, scanlines_per_thread,
+		 [&](int y0, int y1) {
+		   for (int y=y0; y<y1; ++y) {
+		     pixel_type* p = &pixels[0] + y*scanline;
+		     for (int x=0; x<width; ++x) {
+		       int i = nearest(ImagePixels::getR(p[x]),
+				       ImagePixels::getG(p[x]),
+				       ImagePixels::getB(p[x]));
+		       p[x] = make_pixel(p[x], palette[i]);
+		     }
+		   }
+		 });
+    return;
+  }
+
+  // Floyd-Steinberg: errors (in 1/16 units) for the current and the
+  // next row, with one extra element at each side
+  std::vector<int> current((width+2)*3, 0);
+  std::vector<int> next((width+2)*3, 0);
+
+  for (int y=0; y<height; ++y) {
+    pixel_type* p = &pixels[0] + y*scanline;
+    std::fill(next.begin(), next.end(), 0);
+
+    for (int x=0; x<width; ++x) {
+      int* err = &current[(x+1)*3];
+      int c[3] = {
+	clamp_value(ImagePixels::getR(p[x]) + (err[0] + 8) / 16, 0, 255),
+	clamp_value(ImagePixels::getG(p[x]) + (err[1] + 8) / 16, 0, 255),
+	clamp_value(ImagePixels::getB(p[x]) + (err[2] + 8) / 16, 0, 255)
+      };
+
+      const Color& color = palette[nearest(c[0], c[1], c[2])];
+      int e[3] = { c[0] - color.getR(),
+		   c[1] - color.getG(),
+		   c[2] - color.getB() };
+
+      for (int i=0; i<3; ++i) {
+	err[3+i] += e[i] * 7;
+	next[x*3+i] += e[i] * 3;
+	next[(x+1)*3+i] += e[i] * 5;
+	next[(x+2)*3+i] += e[i];
+      }
+
+      p[x] = make_pixel(p[x], color);
+    }
+
+    current.swap(next);
+  }
+}
+
+/**
+   Creates a palette for the @a pixels and remaps them to it.
+
+   @return The palette used by the new pixels.
+*/
+std::vector<Color> ColorQuantizer::quantize(ImagePixels& pixels) const
+{
+  std::vector<Color> palette = createPalette(pixels);
+  remap(pixels, palette);
+  return palette;
+}
+
+/**
+   Returns the number of colors of the color table of an image with
+   the specified bits per pixel (1, 4 or 8), or 256 for deeper images
+   (so they can be quantized with the biggest palette).
+*/
+int ColorQuantizer::getMaxColorsForDepth(int depth)
+{
+  assert(depth > 0);
+  return depth < 8 ? 1 << depth: 256;
+}
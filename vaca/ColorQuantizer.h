@@ -0,0 +1,64 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_COLORQUANTIZER_H
+#define VACA_COLORQUANTIZER_H
+
+#include "vaca/base.h"
+#include "vaca/Color.h"
+#include "vaca/ImagePixels.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   Reduces the number of colors of an image.
+
+   The palette is created with the median cut algorithm over a
+   histogram of 15 bits per color (5 bits per channel). Then each
+   pixel is replaced with the nearest color of the palette, optionally
+   using Floyd-Steinberg dithering to spread the error to the
+   neighbour pixels.
+
+   The result can be used to fill images with a color table:
+   @code
+   ImagePixels pixels = source.getPixels();
+   ColorQuantizer quantizer(256);
+   quantizer.setDithering(true);
+   std::vector<Color> palette = quantizer.quantize(pixels);
+
+   Image image(pixels.getWidth(), pixels.getHeight(), 8);
+   image.setPalette(palette);
+   image.setPixels(pixels);
+   @endcode
+
+   @see ColorSpaces, Image#setPalette
+*/
+class VACA_DLL ColorQuantizer
+{
+  int m_maxColors;
+  bool m_dithering;
+
+public:
+  explicit ColorQuantizer(int maxColors = 256);
+
+  int getMaxColors() const;
+  void setMaxColors(int maxColors);
+
+  bool isDithering() const;
+  void setDithering(bool state);
+
+  std::vector<Color> createPalette(const ImagePixels& pixels) const;
+  void remap(ImagePixels& pixels, const std::vector<Color>& palette) const;
+  std::vector<Color> quantize(ImagePixels& pixels) const;
+
+  static int getMaxColorsForDepth(int depth);
+};
+
+} // namespace vaca
+
+#endif // VACA_COLORQUANTIZER_H
@@ -0,0 +1,318 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/ColorSpaces.h"
+#include "vaca/ParallelFor.h"
+
+#include <cmath>
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  // Minimum number of scanlines to be processed by each thread
+  const int scanlines_per_thread = 16;
+
+  // D65 reference white
+  const float white_x = 0.95047f;
+  const float white_y = 1.00000f;
+  const float white_z = 1.08883f;
+
+  const float lab_epsilon = 216.0f / 24389.0f;
+  const float lab_kappa = 24389.0f / 27.0f;
+
+  // Tables to convert sRGB components to linear light and back (the
+  // transfer function uses pow(), which is too slow to be called for
+  // each pixel)
+  struct GammaTables
+  {
+    enum { LinearSize = 4096 };
+
+    float toLinear[256];
+    unsigned char fromLinear[LinearSize+1];
+
+    GammaTables() {
+      for (int i=0; i<256; ++i) {
+	double c = i / 255.0;
+	toLinear[i] = static_cast<float>(c <= 0.04045 ? c / 12.92:
+					 std::pow((c + 0.055) / 1.055, 2.4));
+      }
+      for (int i=0; i<=LinearSize; ++i) {
+	double c = static_cast<double>(i) / LinearSize;
+	c = (c <= 0.0031308 ? c * 12.92: 1.055 * std::pow(c, 1.0/2.4) - 0.055);
+	fromLinear[i] = static_cast<unsigned char>(clamp_value(c * 255.0 + 0.5, 0.0, 255.0));
+      }
+    }
+
+    int encode(float linear) const {
+      int i = static_cast<int>(linear * LinearSize + 0.5f);
+      return fromLinear[clamp_value(i, 0, static_cast<int>(LinearSize))];
+    }
+  };
+
+  const GammaTables& gamma_tables()
+  {
+    static GammaTables tables;
+    return tables;
+  }
+
+  inline HsvColor to_hsv(int r, int g, int b)
+  {
+    int max = max_value(r, max_value(g, b));
+    int min = min_value(r, min_value(g, b));
+    int delta = max - min;
+    HsvColor hsv;
+
+    hsv.v = max / 255.0f;
+    hsv.s = (max > 0 ? static_cast<float>(delta) / max: 0.0f);
+
+    if (delta == 0)
+      hsv.h = 0.0f;
+    else {
+      float d = 60.0f / delta;
+      if (max == r)
+	hsv.h = (g - b) * d;
+      else if (max == g)
+	hsv.h = (b - r) * d + 120.0f;
+      else
+	hsv.h = (r - g) * d + 240.0f;
+      if (hsv.h < 0.0f)
+	hsv.h += 360.0f;
+    }
+    return hsv;
+  }
+
+  inline void from_hsv(const HsvColor& hsv, int& r, int& g, int& b)
+  {
+    float v = clamp_value(hsv.v, 0.0f, 1.0f) * 255.0f;
+    float s = clamp_value(hsv.s, 0.0f, 1.0f);
+    float h = std::fmod(hsv.h, 360.0f);
+    if (h < 0.0f)
+      h += 360.0f;
+    h /= 60.0f;
+
+    int sector = min_value(static_cast<int>(h), 5);
+    float f = h - sector;
+    int p = static_cast<int>(v * (1.0f - s) + 0.5f);
+    int q = static_cast<int>(v * (1.0f - s*f) + 0.5f);
+    int t = static_cast<int>(v * (1.0f - s*(1.0f - f)) + 0.5f);
+    int w = static_cast<int>(v + 0.5f);
+
+    switch (sector) {
+      case 0: r = w; g = t; b = p; break;
+      case 1: r = q; g = w; b = p; break;
+      case 2: r = p; g = w; b = t; break;
+      case 3: r = p; g = q; b = w; break;
+      case 4: r = t; g = p; b = w; break;
+      default: r = w; g = p; b = q; break;
+    }
+  }
+
+  inline float lab_f(float t)
+  {
+    return t > lab_epsilon ? std::cbrt(t): (lab_kappa * t + 16.0f) / 116.0f;
+  }
+
+  inline float lab_f_inverse(float t)
+  {
+    float t3 = t*t*t;
+    return t3 > lab_epsilon ? t3: (116.0f * t - 16.0f) / lab_kappa;
+  }
+
+  inline LabColor to_lab(const GammaTables& tables, int r, int g, int b)
+  {
+    float lr = tables.toLinear[r];
+    float lg = tables.toLinear[g];
+    float lb = tables.toLinear[b];
+
+    float fx = lab_f((0.4124564f*lr + 0.3575761f*lg + 0.1804375f*lb) / white_x);
+    float fy = lab_f((0.2126729f*lr + 0.7151522f*lg + 0.0721750f*lb) / white_y);
+    float fz = lab_f((0.0193339f*lr + 0.1191920f*lg + 0.9503041f*lb) / white_z);
+
+    LabColor lab;
+    lab.l = 116.0f * fy - 16.0f;
+    lab.a = 500.0f * (fx - fy);
+    lab.b = 200.0f * (fy - fz);
+    return lab;
+  }
+
+  inline void from_lab(const GammaTables& tables, const LabColor& lab, int& r, int& g, int& b)
+  {
+    float fy = (lab.l + 16.0f) / 116.0f;
+    float fx = fy + lab.a / 500.0f;
+    float fz = fy - lab.b / 200.0f;
+
+    float x = lab_f_inverse(fx) * white_x;
+    float y = lab_f_inverse(fy) * white_y;
+    float z = lab_f_inverse(fz) * white_z;
+
+    r = tables.encode( 3.2404542f*x - 1.5371385f*y - 0.4985314f*z);
+    g = tables.encode(-0.9692660f*x + 1.8760108f*y + 0.0415560f*z);
+    b = tables.encode( 0.0556434f*x - 0.2040259f*y + 1.0572252f*z);
+  }
+
+  inline pixel_type make_pixel(pixel_type alpha, int r, int g, int b)
+  {
+    return (alpha & 0xff000000) |
+      (static_cast<pixel_type>(r) << 16) |
+      (static_cast<pixel_type>(g) << 8) |
+      static_cast<pixel_type>(b);
+  }
+
+} // anonymous namespace
+
+/**
+   Converts a RGB @a color to HSV.
+*/
+HsvColor ColorSpaces::rgbToHsv(const Color& color)
+{
+  return to_hsv(color.getR(), color.getG(), color.getB());
+}
+
+/**
+   Converts a HSV color to RGB.
+*/
+Color ColorSpaces::hsvToRgb(const HsvColor& hsv)
+{
+  int r, g, b;
+  from_hsv(hsv, r, g, b);
+  return Color(r, g, b);
+}
+
+/**
+   Converts a RGB @a color (sRGB) to CIE L*a*b*.
+*/
+LabColor ColorSpaces::rgbToLab(const Color& color)
+{
+  return to_lab(gamma_tables(), color.getR(), color.getG(), color.getB());
+}
+
+/**
+   Converts a CIE L*a*b* color to RGB (sRGB). Colors outside the
+   sRGB gamut are clamped.
+*/
+Color ColorSpaces::labToRgb(const LabColor& lab)
+{
+  int r, g, b;
+  from_lab(gamma_tables(), lab, r, g, b);
+  return Color(r, g, b);
+}
+
+/**
+   Converts all the @a pixels to HSV. The @a hsv vector is resized to
+   the number of pixels.
+*/
+void ColorSpaces::rgbToHsv(const ImagePixels& pixels, std::vector<HsvColor>& hsv)
+{
+  const int width = pixels.getWidth();
+  const int scanline = pixels.getScanlineSize();
+
+  hsv.resize(width * pixels.getHeight());
+  if (hsv.empty())
+    return;
+
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 for (int y=y0; y<y1; ++y) {
+		   const pixel_type* p = &pixels[0] + y*scanline;
+		   HsvColor* dst = &hsv[y*width];
+		   for (int x=0; x<width; ++x)
+		     dst[x] = to_hsv(ImagePixels::getR(p[x]),
+				     ImagePixels::getG(p[x]),
+				     ImagePixels::getB(p[x]));
+		 }
+	       });
+}
+
+/**
+   Converts the @a hsv colors to RGB and puts them in @a pixels.
+
+   @a pixels must have one pixel for each element of @a hsv, and
+   their alpha channel is not modified.
+*/
+void ColorSpaces::hsvToRgb(const std::vector<HsvColor>& hsv, ImagePixels& pixels)
+{
+  const int width = pixels.getWidth();
+  const int scanline = pixels.getScanlineSize();
+
+  assert(hsv.size() == static_cast<size_t>(width * pixels.getHeight()));
+  if (hsv.empty())
+    return;
+
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 int r, g, b;
+		 for (int y=y0; y<y1; ++y) {
+		   pixel_type* p = &pixels[0] + y*scanline;
+		   const HsvColor* src = &hsv[y*width];
+		   for (int x=0; x<width; ++x) {
+		     from_hsv(src[x], r, g, b);
+		     p[x] = make_pixel(p[x], r, g, b);
+		   }
+		 }
+	       });
+}
+
+/**
+   Converts all the @a pixels to CIE L*a*b*. The @a lab vector is
+   resized to the number of pixels.
+*/
+void ColorSpaces::rgbToLab(const ImagePixels& pixels, std::vector<LabColor>& lab)
+{
+  const GammaTables& tables = gamma_tables();
+  const int width = pixels.getWidth();
+  const int scanline = pixels.getScanlineSize();
+
+  lab.resize(width * pixels.getHeight());
+  if (lab.empty())
+    return;
+
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 for (int y=y0; y<y1; ++y) {
+		   const pixel_type* p = &pixels[0] + y*scanline;
+		   LabColor* dst = &lab[y*width];
+		   for (int x=0; x<width; ++x)
+		     dst[x] = to_lab(tables,
+				     ImagePixels::getR(p[x]),
+				     ImagePixels::getG(p[x]),
+				     ImagePixels::getB(p[x]));
+		 }
+	       });
+}
+
+/**
+   Converts the @a lab colors to RGB and puts them in @a pixels.
+   Colors outside the sRGB gamut are clamped.
+
+   @a pixels must have one pixel for each element of @a lab, and
+   their alpha channel is not modified.
+*/
+void ColorSpaces::labToRgb(const std::vector<LabColor>& lab, ImagePixels& pixels)
+{
+  const GammaTables& tables = gamma_tables();
+  const int width = pixels.getWidth();
+  const int scanline = pixels.getScanlineSize();
+
+  assert(lab.size() == static_cast<size_t>(width * pixels.getHeight()));
+  if (lab.empty())
+    return;
+
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 int r, g, b;
+		 for (int y=y0; y<y1; ++y) {
+		   pixel_type* p = &pixels[0] + y*scanline;
+		   const LabColor* src = &lab[y*width];
+		   for (int x=0; x<width; ++x) {
+		     from_lab(tables, src[x], r, g, b);
+		     p[x] = make_pixel(p[x], r, g, b);
+		   }
+		 }
+	       });
+}
@@ -0,0 +1,85 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_COLORSPACES_H
+#define VACA_COLORSPACES_H
+
+#include "vaca/base.h"
+#include "vaca/Color.h"
+#include "vaca/ImagePixels.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   A color in the HSV (hue, saturation, value) color space.
+*/
+struct HsvColor
+{
+  /**
+     Hue in degrees, from 0 to 360 (not included).
+  */
+  float h;
+
+  /**
+     Saturation, from 0 to 1.
+  */
+  float s;
+
+  /**
+     Value (brightness), from 0 to 1.
+  */
+  float v;
+};
+
+/**
+   A color in the CIE L*a*b* color space (D65 white point).
+*/
+struct LabColor
+{
+  /**
+     Lightness, from 0 (black) to 100 (white).
+  */
+  float l;
+
+  /**
+     Green (negative) to red (positive) axis.
+  */
+  float a;
+
+  /**
+     Blue (negative) to yellow (positive) axis.
+  */
+  float b;
+};
+
+/**
+   Conversions between RGB colors and other color spaces.
+
+   The functions that receive ImagePixels convert all the pixels at
+   once (split between all processors). Vectors of HsvColor or
+   LabColor have one element for each pixel in scanline order. The
+   alpha channel of the pixels is not converted.
+
+   @see HsvColor, LabColor, ImageFilters
+*/
+namespace ColorSpaces
+{
+  VACA_DLL HsvColor rgbToHsv(const Color& color);
+  VACA_DLL Color hsvToRgb(const HsvColor& hsv);
+  VACA_DLL LabColor rgbToLab(const Color& color);
+  VACA_DLL Color labToRgb(const LabColor& lab);
+
+  VACA_DLL void rgbToHsv(const ImagePixels& pixels, std::vector<HsvColor>& hsv);
+  VACA_DLL void hsvToRgb(const std::vector<HsvColor>& hsv, ImagePixels& pixels);
+  VACA_DLL void rgbToLab(const ImagePixels& pixels, std::vector<LabColor>& lab);
+  VACA_DLL void labToRgb(const std::vector<LabColor>& lab, ImagePixels& pixels);
+}
+
+} // namespace vaca
+
+#endif // VACA_COLORSPACES_H
@@ -0,0 +1,493 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/Compositor.h"
+#include "vaca/Graphics.h"
+#include "vaca/ParallelFor.h"
+#include "vaca/Simd.h"
+
+#include <algorithm>
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  // Minimum number of scanlines to be composited by each thread
+  const int scanlines_per_thread = 32;
+
+  // Returns a*b/255 rounded to the nearest integer (exact for any
+  // 8-bit a and b)
+  inline int mul_un8(int a, int b)
+  {
+    int t = a*b + 128;
+    return (t + (t >> 8)) >> 8;
+  }
+
+  inline pixel_type premultiply(pixel_type c)
+  {
+    int a = ImagePixels::getA(c);
+    return ImagePixels::makePixel(mul_un8(ImagePixels::getR(c), a),
+				  mul_un8(ImagePixels::getG(c), a),
+				  mul_un8(ImagePixels::getB(c), a), a);
+  }
+
+  // Blends n premultiplied pixels from src over dst ("source over"
+  // operator), applying the opacity to the source:
+  //   dst = src*opacity + dst*(1 - srcAlpha*opacity)
+  void blend_over(pixel_type* dst, const pixel_type* src, int n, int opacity)
+  {
+    int x = 0;
+
+#ifdef VACA_SSE2
+    // four pixels at a time, two pixels in each 16-bit register
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    const __m128i ff = _mm_set1_epi16(255);
+    const __m128i op = _mm_set1_epi16(opacity);
+
+#define MUL_UN8(a, b, result)						\
+    {									\
+      __m128i t = _mm_add_epi16(_mm_mullo_epi16(a, b), half);		\
+      result = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8); \
+    }
+
+#define BLEND_OVER(s, d, result)					\
+    {									\
+      __m128i s2, d2, alpha;						\
+      MUL_UN8(s, op, s2);						\
+      alpha = _mm_shufflelo_epi16(s2, _MM_SHUFFLE(3, 3, 3, 3));	\
+      alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));	\
+      MUL_UN8(d, _mm_sub_epi16(ff, alpha), d2);				\
+      result = _mm_add_epi16(s2, d2);					\
+    }
+
+    for (; x+4<=n; x+=4) {
+      __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src+x));
+      __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst+x));
+      __m128i lo, hi;
+
+      BLEND_OVER(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), lo);
+      BLEND_OVER(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), hi);
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+x), _mm_packus_epi16(lo, hi));
+    }
+
+#undef BLEND_OVER
+#undef MUL_UN8
+#endif
+
+    for (; x<n; ++x) {
+      pixel_type s = src[x];
+      pixel_type d = dst[x];
+      int sa = mul_un8(ImagePixels::getA(s), opacity);
+      int inv = 255 - sa;
+
+      dst[x] = ImagePixels::makePixel
+	(mul_un8(ImagePixels::getR(s), opacity) + mul_un8(ImagePixels::getR(d), inv),
+	 mul_un8(ImagePixels::getG(s), opacity) + mul_un8(ImagePixels::getG(d), inv),
+	 mul_un8(ImagePixels::getB(s), opacity) + mul_un8(ImagePixels::getB(d), inv),
+	 sa + mul_un8(ImagePixels::getA(d), inv));
+    }
+  }
+
+  // Adds the rc rectangle to the list of damaged rectangles, merging
+  // it with the rectangles that it touches
+  void add_damage(std::vector<Rect>& damaged, Rect rc, int maxRects)
+  {
+    for (size_t i=0; i<damaged.size(); ) {
+      if (damaged[i].intersects(rc)) {
+	rc = rc.createUnion(damaged[i]);
+	damaged.erase(damaged.begin()+i);
+	i = 0;		// the new union can touch previous rectangles
+      }
+      else
+	++i;
+    }
+    damaged.push_back(rc);
+
+    if (static_cast<int>(damaged.size()) > maxRects) {
+      Rect bounds;
+      for (size_t i=0; i<damaged.size(); ++i)
+	bounds = bounds.createUnion(damaged[i]);
+      damaged.clear();
+      damaged.push_back(bounds);
+    }
+  }
+
+} // anonymous namespace
+
+/**
+   Creates a compositor without layers.
+
+   @param size
+     Size of the result of the composition.
+
+   @param bgColor
+     Color of the areas that are not covered by opaque layers.
+*/
+Compositor::Compositor(const Size& size, const Color& bgColor)
+  : m_size(size)
+  , m_bgColor(bgColor)
+  , m_pixels(size)
+  , m_nextId(1)
+{
+  invalidate(Rect(size));
+}
+
+Compositor::~Compositor()
+{
+  for (size_t i=0; i<m_layers.size(); ++i)
+    delete m_layers[i];
+}
+
+Size Compositor::getSize() const
+{
+  return m_size;
+}
+
+/**
+   Changes the size of the result. All the area is damaged.
+*/
+void Compositor::setSize(const Size& size)
+{
+  m_size = size;
+  m_pixels = ImagePixels(size);
+  m_image = Image();
+  m_imageDirty = Rect();
+  m_damaged.clear();
+  invalidate(Rect(size));
+}
+
+Color Compositor::getBgColor() const
+{
+  return m_bgColor;
+}
+
+/**
+   Adds a new transparent layer over all the other ones.
+
+   @param bounds
+     Position and size of the layer in the compositor.
+
+   @return
+     An identifier for the new layer.
+*/
+int Compositor::addLayer(const Rect& bounds)
+{
+  Layer* layer = new Layer;
+  layer->id = m_nextId++;
+  layer->bounds = bounds;
+  layer->opacity = 255;
+  layer->visible = true;
+  layer->pixels = ImagePixels(bounds.getSize());
+
+  m_layers.push_back(layer);
+  return layer->id;
+}
+
+void Compositor::removeLayer(int layer)
+{
+  Layer* l = getLayer(layer);
+  invalidate(getVisibleBounds(l));
+
+  m_layers.erase(std::find(m_layers.begin(), m_layers.end(), l));
+  delete l;
+}
+
+/**
+   Moves the @a layer over all the other layers.
+*/
+void Compositor::bringLayerToFront(int layer)
+{
+  Layer* l = getLayer(layer);
+
+  m_layers.erase(std::find(m_layers.begin(), m_layers.end(), l));
+  m_layers.push_back(l);
+  invalidate(getVisibleBounds(l));
+}
+
+int Compositor::getLayerCount() const
+{
+  return static_cast<int>(m_layers.size());
+}
+
+Rect Compositor::getLayerBounds(int layer) const
+{
+  return getLayer(layer)->bounds;
+}
+
+/**
+   Moves or resizes the @a layer. If the size changes, the pixels of
+   the layer are cleared (the layer is transparent).
+*/
+void Compositor::setLayerBounds(int layer, const Rect& bounds)
+{
+  Layer* l = getLayer(layer);
+  if (l->bounds == bounds)
+    return;
+
+  invalidate(getVisibleBounds(l));
+
+  if (l->bounds.getSize() != bounds.getSize())
+    l->pixels = ImagePixels(bounds.getSize());
+  l->bounds = bounds;
+
+  invalidate(getVisibleBounds(l));
+}
+
+int Compositor::getLayerOpacity(int layer) const
+{
+  return getLayer(layer)->opacity;
+}
+
+/**
+   Changes the opacity of the @a layer, from 0 (invisible) to 255
+   (the layer pixels are composited with their own alpha), like
+   Widget#setOpacity.
+*/
+void Compositor::setLayerOpacity(int layer, int opacity)
+{
+  assert(opacity >= 0 && opacity < 256);
+
+  Layer* l = getLayer(layer);
+  if (l->opacity != opacity) {
+    invalidate(getVisibleBounds(l));
+    l->opacity = opacity;
+    invalidate(getVisibleBounds(l));
+  }
+}
+
+bool Compositor::isLayerVisible(int layer) const
+{
+  return getLayer(layer)->visible;
+}
+
+void Compositor::setLayerVisible(int layer, bool visible)
+{
+  Layer* l = getLayer(layer);
+  if (l->visible != visible) {
+    invalidate(getVisibleBounds(l));
+    l->visible = visible;
+    invalidate(getVisibleBounds(l));
+  }
+}
+
+Rect Compositor::getLayerClip(int layer) const
+{
+  return getLayer(layer)->clip;
+}
+
+/**
+   Limits the area where the @a layer is composited to the @a clip
+   rectangle (in coordinates of the compositor). An empty rectangle
+   removes the clipping.
+*/
+void Compositor::setLayerClip(int layer, const Rect& clip)
+{
+  Layer* l = getLayer(layer);
+  invalidate(getVisibleBounds(l));
+  l->clip = clip;
+  invalidate(getVisibleBounds(l));
+}
+
+/**
+   Returns the pixels of the @a layer, with premultiplied alpha. They
+   are shared with the compositor: if you modify them, call
+   #invalidateLayer.
+*/
+ImagePixels Compositor::getLayerPixels(int layer) const
+{
+  return getLayer(layer)->pixels;
+}
+
+/**
+   Replaces the content of the @a layer with a copy of the @a pixels
+   (with straight alpha, as they are returned by Image#getPixels).
+   The @a pixels must have the same size as the layer.
+*/
+void Compositor::setLayerPixels(int layer, const ImagePixels& pixels)
+{
+  Layer* l = getLayer(layer);
+  assert(pixels.getSize() == l->bounds.getSize());
+
+  ImagePixels& dst = l->pixels;
+  for (int y=0; y<pixels.getHeight(); ++y)
+    for (int x=0; x<pixels.getWidth(); ++x)
+      dst.setPixel(x, y, premultiply(pixels.getPixel(x, y)));
+
+  invalidate(getVisibleBounds(l));
+}
+
+/**
+   Draws the content of the @a layer with GDI. The function @a f
+   receives a Graphics of the size of the layer.
+
+   GDI doesn't write the alpha channel, so the layer is opaque after
+   this (use #setLayerOpacity to make it translucent).
+*/
+void Compositor::drawLayer(int layer, const std::function<void(Graphics&)>& f)
+{
+  Layer* l = getLayer(layer);
+  if (l->bounds.isEmpty())
+    return;
+
+  Image image(l->bounds.getSize(), 32);
+  f(image.getGraphics());
+
+  ImagePixels pixels = image.getPixels();
+  for (int y=0; y<pixels.getHeight(); ++y) {
+    pixel_type* p = &pixels[0] + y*pixels.getScanlineSize();
+    for (int x=0; x<pixels.getWidth(); ++x)
+      p[x] |= 0xff000000;
+  }
+  l->pixels = pixels;
+
+  invalidate(getVisibleBounds(l));
+}
+
+/**
+   Marks the @a rc area of the @a layer (in coordinates of the layer)
+   as modified.
+*/
+void Compositor::invalidateLayer(int layer, const Rect& rc)
+{
+  Layer* l = getLayer(layer);
+  invalidate(getVisibleBounds(l).createIntersect(Rect(rc).offset(l->bounds.getOrigin())));
+}
+
+/**
+   Marks the @a rc area of the compositor as damaged, so it will be
+   recomposited in the next call to #compose.
+*/
+void Compositor::invalidate(const Rect& rc)
+{
+  Rect damaged = rc.createIntersect(Rect(m_size));
+  if (!damaged.isEmpty())
+    add_damage(m_damaged, damaged, MaxDamagedRects);
+}
+
+bool Compositor::isDamaged() const
+{
+  return !m_damaged.empty();
+}
+
+/**
+   Returns the areas that will be recomposited in the next call to
+   #compose.
+*/
+void Compositor::getDamagedRects(std::vector<Rect>& rects) const
+{
+  rects = m_damaged;
+}
+
+/**
+   Recomposites the damaged areas.
+*/
+void Compositor::compose()
+{
+  for (size_t i=0; i<m_damaged.size(); ++i) {
+    composeRect(m_damaged[i]);
+    m_imageDirty = m_imageDirty.createUnion(m_damaged[i]);
+  }
+  m_damaged.clear();
+}
+
+/**
+   Returns the result of the composition (opaque pixels). The damaged
+   areas are recomposited first.
+*/
+ImagePixels Compositor::getPixels()
+{
+  compose();
+  return m_pixels;
+}
+
+/**
+   Paints the @a rc area of the result in @a g (both use the same
+   coordinates). The damaged areas are recomposited first.
+*/
+void Compositor::paint(Graphics& g, const Rect& rc)
+{
+  compose();
+
+  if (!m_imageDirty.isEmpty()) {
+    if (!m_image.isValid())
+      m_image = Image(m_size, 32);
+
+    m_image.setPixels(m_pixels);
+    m_imageDirty = Rect();
+  }
+
+  Rect part = rc.createIntersect(Rect(m_size));
+  if (!part.isEmpty())
+    g.drawImage(m_image, part.getOrigin(), part);
+}
+
+Compositor::Layer* Compositor::getLayer(int layer) const
+{
+  for (size_t i=0; i<m_layers.size(); ++i)
+    if (m_layers[i]->id == layer)
+      return m_layers[i];
+
+  assert(false && "Invalid layer");
+  return NULL;
+}
+
+/**
+   Returns the area of the compositor that is affected by the @a layer
+   (its bounds limited by its clipping rectangle).
+*/
+Rect Compositor::getVisibleBounds(const Layer* layer) const
+{
+  if (!layer->visible || layer->opacity == 0)
+    return Rect();
+  else if (layer->clip.isEmpty())
+    return layer->bounds;
+  else
+    return layer->bounds.createIntersect(layer->clip);
+}
+
+/**
+   Composites all the layers in the @a rc area, from the bottom to the
+   top one. The scanlines are split between all processors.
+*/
+void Compositor::composeRect(const Rect& rc)
+{
+  const pixel_type bg = ImagePixels::makePixel(m_bgColor.getR(),
+					       m_bgColor.getG(),
+					       m_bgColor.getB(), 255);
+
+  // layers that intersect rc, and the part of rc that they cover
+  std::vector<std::pair<const Layer*, Rect> > layers;
+  for (size_t i=0; i<m_layers.size(); ++i) {
+    Rect part = getVisibleBounds(m_layers[i]).createIntersect(rc);
+    if (!part.isEmpty())
+      layers.push_back(std::make_pair(m_layers[i], part));
+  }
+
+  parallel_for(rc.y, rc.y+rc.h, scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 for (int y=y0; y<y1; ++y) {
+		   pixel_type* dst = &m_pixels[0] + y*m_pixels.getScanlineSize();
+		   std::fill(dst+rc.x, dst+rc.x+rc.w, bg);
+
+		   for (size_t i=0; i<layers.size(); ++i) {
+		     const Layer* layer = layers[i].first;
+		     const Rect& part = layers[i].second;
+		     if (y < part.y || y >= part.y+part.h)
+		       continue;
+
+		     const ImagePixels& src = layer->pixels;
+		     blend_over(dst + part.x,
+				&src[0] + ((y - layer->bounds.y)*src.getScanlineSize() +
+					   part.x - layer->bounds.x),
+				part.w, layer->opacity);
+		   }
+		 }
+	       });
+}
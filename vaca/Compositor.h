@@ -0,0 +1,134 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_COMPOSITOR_H
+#define VACA_COMPOSITOR_H
+
+#include "vaca/base.h"
+#include "vaca/NonCopyable.h"
+#include "vaca/Color.h"
+#include "vaca/Image.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/Rect.h"
+
+#include <functional>
+#include <vector>
+
+namespace vaca {
+
+/**
+   Composites a stack of translucent layers in memory.
+
+   Widget#setOpacity only works with top-level windows (it uses
+   layered windows). A Compositor can be used by a widget to paint
+   translucent overlays over its content: each part of the widget
+   (e.g. the background and each overlay) is a layer with its own
+   pixels, bounds, opacity and clipping rectangle, and the widget
+   only has to paint the result.
+
+   Layer pixels are stored with premultiplied alpha. The compositor
+   remembers which areas were modified (damaged) by changes in the
+   layers, and #compose only recomposites those areas.
+
+   Example:
+   @code
+   MyWidget::MyWidget(...)
+     : m_compositor(Size(640, 480))
+   {
+     m_background = m_compositor.addLayer(Rect(0, 0, 640, 480));
+     m_overlay = m_compositor.addLayer(Rect(20, 20, 200, 100));
+     m_compositor.setLayerOpacity(m_overlay, 128);
+     ...
+   }
+
+   void MyWidget::onMouseMove(MouseEvent& ev)
+   {
+     m_compositor.setLayerBounds(m_overlay, Rect(ev.getPoint(), Size(200, 100)));
+
+     std::vector<Rect> damaged;
+     m_compositor.getDamagedRects(damaged);
+     for (size_t i=0; i<damaged.size(); ++i)
+       invalidate(damaged[i], false);
+   }
+
+   void MyWidget::onPaint(PaintEvent& ev)
+   {
+     Graphics& g = ev.getGraphics();
+     m_compositor.paint(g, g.getClipBounds());
+   }
+   @endcode
+*/
+class VACA_DLL Compositor : private NonCopyable
+{
+  struct Layer
+  {
+    int id;
+    Rect bounds;
+    Rect clip;
+    int opacity;
+    bool visible;
+    ImagePixels pixels;		// premultiplied alpha
+  };
+
+  Size m_size;
+  Color m_bgColor;
+  std::vector<Layer*> m_layers;	// from the bottom to the top
+  std::vector<Rect> m_damaged;
+  ImagePixels m_pixels;
+  Image m_image;		// m_pixels uploaded to a bitmap by #paint
+  Rect m_imageDirty;
+  int m_nextId;
+
+public:
+  /**
+     Maximum number of damaged rectangles. When there are more, all
+     of them are merged in one rectangle.
+  */
+  enum { MaxDamagedRects = 32 };
+
+  explicit Compositor(const Size& size, const Color& bgColor = Color::White);
+  virtual ~Compositor();
+
+  Size getSize() const;
+  void setSize(const Size& size);
+  Color getBgColor() const;
+
+  int addLayer(const Rect& bounds);
+  void removeLayer(int layer);
+  void bringLayerToFront(int layer);
+  int getLayerCount() const;
+
+  Rect getLayerBounds(int layer) const;
+  void setLayerBounds(int layer, const Rect& bounds);
+  int getLayerOpacity(int layer) const;
+  void setLayerOpacity(int layer, int opacity);
+  bool isLayerVisible(int layer) const;
+  void setLayerVisible(int layer, bool visible);
+  Rect getLayerClip(int layer) const;
+  void setLayerClip(int layer, const Rect& clip);
+
+  ImagePixels getLayerPixels(int layer) const;
+  void setLayerPixels(int layer, const ImagePixels& pixels);
+  void drawLayer(int layer, const std::function<void(Graphics&)>& f);
+  void invalidateLayer(int layer, const Rect& rc);
+
+  void invalidate(const Rect& rc);
+  bool isDamaged() const;
+  void getDamagedRects(std::vector<Rect>& rects) const;
+
+  void compose();
+  ImagePixels getPixels();
+  void paint(Graphics& g, const Rect& rc);
+
+private:
+  Layer* getLayer(int layer) const;
+  Rect getVisibleBounds(const Layer* layer) const;
+  void composeRect(const Rect& rc);
+};
+
+} // namespace vaca
+
+#endif // VACA_COMPOSITOR_H
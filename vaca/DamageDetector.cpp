@@ -0,0 +1,210 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/DamageDetector.h"
+#include "vaca/ParallelFor.h"
+#include "vaca/Region.h"
+#include "vaca/Simd.h"
+
+#include <cstring>
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  // Minimum number of scanlines to be compared by each thread
+  const int scanlines_per_thread = 64;
+
+  bool equal_pixels(const pixel_type* a, const pixel_type* b, int n)
+  {
+    int x = 0;
+
+#ifdef VACA_SSE2
+    // eight pixels at a time
+    for (; x+8<=n; x+=8) {
+      __m128i eq1 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a+x)),
+				    _mm_loadu_si128(reinterpret_cast<const __m128i*>(b+x)));
+      __m128i eq2 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a+x+4)),
+				    _mm_loadu_si128(reinterpret_cast<const __m128i*>(b+x+4)));
+      if (_mm_movemask_epi8(_mm_and_si128(eq1, eq2)) != 0xffff)
+	return false;
+    }
+#endif
+
+    for (; x<n; ++x)
+      if (a[x] != b[x])
+	return false;
+
+    return true;
+  }
+
+  void copy_rect(const ImagePixels& src, ImagePixels& dst, const Rect& rc)
+  {
+    for (int y=rc.y; y<rc.y+rc.h; ++y) {
+      const pixel_type* s = &src[0] + y*src.getScanlineSize() + rc.x;
+      std::copy(s, s+rc.w, &dst[0] + y*dst.getScanlineSize() + rc.x);
+    }
+  }
+
+} // anonymous namespace
+
+/**
+   Creates a detector without a previous frame.
+
+   @param cellSize
+     Width in pixels of the compared cells. Smaller cells give
+     rectangles that fit better the modified pixels, but more
+     rectangles.
+*/
+DamageDetector::DamageDetector(int cellSize)
+  : m_cellSize(cellSize)
+{
+  assert(cellSize > 0);
+}
+
+DamageDetector::~DamageDetector()
+{
+}
+
+int DamageDetector::getCellSize() const
+{
+  return m_cellSize;
+}
+
+/**
+   Compares the @a frame with the previous one (the @a frame of the
+   last call to #update), and remembers it for the next call.
+
+   If there is no previous frame, or it has a different size, the
+   whole @a frame is damaged.
+*/
+void DamageDetector::update(const ImagePixels& frame, std::vector<Rect>& damaged)
+{
+  if (m_previous.getSize() != frame.getSize()) {
+    damaged.clear();
+    if (frame.getWidth() > 0 && frame.getHeight() > 0)
+      damaged.push_back(Rect(frame.getSize()));
+
+    m_previous = frame.clone();
+    return;
+  }
+
+  compare(m_previous, frame, damaged, m_cellSize);
+
+  // only the damaged areas are different, so they are the only ones
+  // that need to be copied
+  for (size_t i=0; i<damaged.size(); ++i)
+    copy_rect(frame, m_previous, damaged[i]);
+}
+
+/**
+   Like #update, but returns the damaged areas as a region.
+*/
+Region DamageDetector::update(const ImagePixels& frame)
+{
+  std::vector<Rect> damaged;
+  update(frame, damaged);
+  return Region::fromRects(damaged);
+}
+
+/**
+   Forgets the previous frame, so the next call to #update will damage
+   the whole frame.
+*/
+void DamageDetector::reset()
+{
+  m_previous = ImagePixels();
+}
+
+/**
+   Compares two frames of the same size, and returns the areas where
+   they are different.
+
+   Each scanline is compared with @c memcmp first (most scanlines are
+   usually equal), and then cell by cell (with SSE2). The scanlines are
+   split between all processors. Finally, contiguous modified cells
+   of each scanline are joined horizontally, and equal spans of
+   contiguous scanlines are joined vertically.
+
+   @param damaged
+     The resulting rectangles (they don't overlap).
+*/
+void DamageDetector::compare(const ImagePixels& a, const ImagePixels& b,
+			     std::vector<Rect>& damaged, int cellSize)
+{
+  assert(a.getSize() == b.getSize());
+  assert(cellSize > 0);
+
+  const int width = a.getWidth();
+  const int height = a.getHeight();
+  const int cols = (width + cellSize - 1) / cellSize;
+
+  damaged.clear();
+  if (width == 0 || height == 0)
+    return;
+
+  // modified cells of each scanline
+  std::vector<char> cells(cols*height, 0);
+
+  parallel_for(0, height, scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 for (int y=y0; y<y1; ++y) {
+		   const pixel_type* rowA = &a[0] + y*a.getScanlineSize();
+		   const pixel_type* rowB = &b[0] + y*b.getScanlineSize();
+		   if (std::memcmp(rowA, rowB, width*sizeof(pixel_type)) == 0)
+		     continue;
+
+		   for (int c=0; c<cols; ++c) {
+		     int x = c*cellSize;
+		     int n = min_value(cellSize, width - x);
+		     if (!equal_pixels(rowA+x, rowB+x, n))
+		       cells[y*cols + c] = 1;
+		   }
+		 }
+	       });
+
+  // join the cells; "open" are the indexes of the rectangles that
+  // end in the previous scanline
+  std::vector<int> open, stillOpen;
+
+  for (int y=0; y<height; ++y) {
+    const char* row = &cells[y*cols];
+    stillOpen.clear();
+
+    for (int c=0; c<cols; ) {
+      if (!row[c]) {
+	++c;
+	continue;
+      }
+
+      int c0 = c;
+      while (c < cols && row[c])
+	++c;
+
+      Rect span(c0*cellSize, y, min_value(c*cellSize, width) - c0*cellSize, 1);
+      bool joined = false;
+
+      for (size_t i=0; i<open.size(); ++i) {
+	Rect& rc = damaged[open[i]];
+	if (rc.x == span.x && rc.w == span.w) {
+	  ++rc.h;
+	  stillOpen.push_back(open[i]);
+	  joined = true;
+	  break;
+	}
+      }
+
+      if (!joined) {
+	damaged.push_back(span);
+	stillOpen.push_back(static_cast<int>(damaged.size())-1);
+      }
+    }
+
+    open.swap(stillOpen);
+  }
+}
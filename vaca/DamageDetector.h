@@ -0,0 +1,67 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_DAMAGEDETECTOR_H
+#define VACA_DAMAGEDETECTOR_H
+
+#include "vaca/base.h"
+#include "vaca/NonCopyable.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/Rect.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   Finds the areas that changed between two frames (e.g. two
+   consecutive back buffers of a widget).
+
+   The frames are compared in cells of @c cellSize x 1 pixels, and
+   contiguous modified cells are joined in rectangles. The result
+   can be used to blit only what really changed, or in tests to
+   verify that a widget doesn't repaint pixels that didn't change:
+   @code
+   DamageDetector detector;
+   std::vector<Rect> damaged;
+
+   detector.update(widgetPixels(), damaged);  // first frame: all damaged
+   widget.setText(L"Same text");
+   detector.update(widgetPixels(), damaged);
+   assert(damaged.empty());
+   @endcode
+
+   @see Region#fromRects
+*/
+class VACA_DLL DamageDetector : private NonCopyable
+{
+  ImagePixels m_previous;
+  int m_cellSize;
+
+public:
+  /**
+     Default width of each compared cell (16 pixels are 64 bytes, a
+     cache line).
+  */
+  enum { DefaultCellSize = 16 };
+
+  explicit DamageDetector(int cellSize = DefaultCellSize);
+  virtual ~DamageDetector();
+
+  int getCellSize() const;
+
+  void update(const ImagePixels& frame, std::vector<Rect>& damaged);
+  Region update(const ImagePixels& frame);
+  void reset();
+
+  static void compare(const ImagePixels& a, const ImagePixels& b,
+		      std::vector<Rect>& damaged,
+		      int cellSize = DefaultCellSize);
+};
+
+} // namespace vaca
+
+#endif // VACA_DAMAGEDETECTOR_H
@@ -0,0 +1,308 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/FilterWeights.h"
+#include "vaca/Simd.h"
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  const int half_unit = 1 << (FilterWeights::Precision-1);
+
+  inline pixel_type pack_channels(int b, int g, int r, int a)
+  {
+    b = clamp_value(b >> FilterWeights::Precision, 0, 255);
+    g = clamp_value(g >> FilterWeights::Precision, 0, 255);
+    r = clamp_value(r >> FilterWeights::Precision, 0, 255);
+    a = clamp_value(a >> FilterWeights::Precision, 0, 255);
+    return
+      (static_cast<pixel_type>(a) << 24) |
+      (static_cast<pixel_type>(r) << 16) |
+      (static_cast<pixel_type>(g) << 8) |
+      (static_cast<pixel_type>(b));
+  }
+
+#ifdef VACA_SSE2
+
+  // Multiplies the four channels of p0 and p1 by w0 and w1
+  // respectively, and returns the sum of both products in four
+  // 32-bit lanes (b, g, r, a).
+  inline __m128i madd_pixels(pixel_type p0, pixel_type p1, short w0, short w1)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = _mm_unpacklo_epi8(_mm_cvtsi32_si128(p0), zero);
+    __m128i b = _mm_unpacklo_epi8(_mm_cvtsi32_si128(p1), zero);
+    __m128i w = _mm_set1_epi32(static_cast<int>((static_cast<unsigned int>(w1) << 16) |
+						(w0 & 0xffff)));
+    return _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w);
+  }
+
+  inline pixel_type pack_channels(__m128i acc)
+  {
+    acc = _mm_srai_epi32(acc, FilterWeights::Precision);
+    acc = _mm_packs_epi32(acc, acc);
+    acc = _mm_packus_epi16(acc, acc);
+    return static_cast<pixel_type>(_mm_cvtsi128_si32(acc));
+  }
+
+#endif
+
+} // anonymous namespace
+
+FilterWeights::FilterWeights()
+  : m_srcLength(0)
+  , m_taps(0)
+{
+}
+
+/**
+   Calculates the weights to scale a row (or column) of @a srcLength
+   pixels to @a dstLength pixels.
+
+   @param kernel
+     Filter function, it receives the distance (in source pixels)
+     to the center of the destination pixel.
+
+   @param support
+     Radius of the filter (the kernel is zero outside
+     [-support, support]). When the image is reduced, the support is
+     enlarged with the same factor so all source pixels are used.
+*/
+void FilterWeights::initResample(int srcLength, int dstLength,
+				 double (*kernel)(double), double support)
+{
+  assert(srcLength > 0 && dstLength > 0);
+
+  double scale = static_cast<double>(srcLength) / dstLength;
+  double filterScale = max_value(scale, 1.0);
+  double filterSupport = support * filterScale;
+
+  m_srcLength = srcLength;
+  m_taps = static_cast<int>(std::ceil(filterSupport))*2 + 1;
+  m_start.resize(dstLength);
+  m_count.resize(dstLength);
+  m_weights.assign(dstLength*m_taps, 0);
+
+  std::vector<double> weights;
+  weights.reserve(m_taps);
+
+  for (int i=0; i<dstLength; ++i) {
+    double center = (i + 0.5) * scale;
+    int first = max_value(static_cast<int>(center - filterSupport + 0.5), 0);
+    int last = min_value(static_cast<int>(center + filterSupport + 0.5), srcLength);
+
+    weights.clear();
+    for (int x=first; x<last && x-first<m_taps; ++x)
+      weights.push_back(kernel((x - center + 0.5) / filterScale));
+
+    setWeights(i, first, weights, true);
+  }
+}
+
+/**
+   Calculates the weights to convolve a row (or column) of @a length
+   pixels with the specified @a kernel.
+
+   The @a kernel must have an odd number of elements (its center is
+   the element in the middle), and each element must be in the
+   (-2.0, 2.0) range. The kernel is not normalized, so it can be used
+   for filters whose weights do not sum 1.0 (e.g. edge detection).
+   Pixels outside the row are the same as the nearest border pixel,
+   so their weights are added to the border pixels (if a sum is
+   outside the (-2.0, 2.0) range all the weights of that pixel are
+   scaled down, see #setWeights).
+*/
+void FilterWeights::initKernel(int length, const std::vector<double>& kernel)
+{
+  assert(length > 0);
+  assert((kernel.size() & 1) == 1);
+
+  int radius = static_cast<int>(kernel.size()) / 2;
+
+  m_srcLength = length;
+  m_taps = min_value(2*radius + 1, length);
+  m_start.resize(length);
+  m_count.resize(length);
+  m_weights.assign(length*m_taps, 0);
+
+  std::vector<double> weights;
+  weights.reserve(m_taps);
+
+  for (int i=0; i<length; ++i) {
+    int first = max_value(i - radius, 0);
+    int last = min_value(i + radius, length-1);
+
+    // the weights of pixels outside the row are accumulated in the
+    // border pixels
+    weights.assign(last - first + 1, 0.0);
+    for (int k=-radius; k<=radius; ++k)
+      weights[clamp_value(i+k, first, last) - first] += kernel[k+radius];
+
+    setWeights(i, first, weights, false);
+  }
+}
+
+/**
+   Converts to fixed-point the @a weights of the destination pixel
+   @a i. If @a normalize is true the weights are divided by their
+   sum. The rounding error is corrected so the sum of fixed-point
+   weights is exactly the expected one (e.g. flat areas keep their
+   exact color). Weights that don't fit in the fixed-point format
+   are scaled down with all the other weights of the pixel.
+*/
+void FilterWeights::setWeights(int i, int start, const std::vector<double>& weights, bool normalize)
+{
+  int count = static_cast<int>(weights.size());
+  short* dst = &m_weights[i*m_taps];
+  double sum = 0.0;
+
+  for (int k=0; k<count; ++k)
+    sum += weights[k];
+
+  m_start[i] = start;
+  m_count[i] = count;
+
+  if (count == 0 || (normalize && sum == 0.0)) {
+    m_start[i] = clamp_value(start, 0, m_srcLength-1);
+    m_count[i] = 1;
+    dst[0] = 1 << Precision;
+    return;
+  }
+
+  double scale = (normalize ? 1.0 / sum: 1.0) * (1 << Precision);
+  double gain = (normalize ? 1.0: sum) * (1 << Precision);
+
+  // the weights (and the rounding correction) must fit in a short, so
+  // bigger weights (e.g. a wide kernel folded in the border of a tiny
+  // row) are scaled down: the filter keeps its shape with less gain
+  double biggestWeight = 0.0;
+  for (int k=0; k<count; ++k)
+    biggestWeight = max_value(biggestWeight, std::fabs(weights[k] * scale));
+
+  const double limit = max_value(32767.0 - count, 16384.0);
+  if (biggestWeight > limit) {
+    scale *= limit / biggestWeight;
+    gain *= limit / biggestWeight;
+  }
+
+  int expected = static_cast<int>(std::floor(gain + 0.5));
+  int total = 0;
+  int biggest = 0;
+  for (int k=0; k<count; ++k) {
+    double w = weights[k] * scale;
+    dst[k] = static_cast<short>(clamp_value<double>(std::floor(w + 0.5), -32768.0, 32767.0));
+    total += dst[k];
+    if (std::abs(dst[k]) > std::abs(dst[biggest]))
+      biggest = k;
+  }
+
+  // the rounding error goes to the most important weight
+  dst[biggest] = static_cast<short>(dst[biggest] + expected - total);
+}
+
+/**
+   Horizontal pass: filters the rows [@a y0, @a y1) of @a src and
+   puts the result in the same rows of @a dst.
+
+   @a src must be #getSourceLength pixels wide, @a dst must be
+   #getLength pixels wide, and both must have the same height.
+*/
+void FilterWeights::filterRows(const ImagePixels& src, ImagePixels& dst, int y0, int y1) const
+{
+  assert(src.getWidth() == m_srcLength);
+  assert(dst.getWidth() == getLength());
+  assert(src.getHeight() == dst.getHeight());
+
+  const int dstLength = getLength();
+  const int srcScanline = src.getScanlineSize();
+  const int dstScanline = dst.getScanlineSize();
+
+  for (int y=y0; y<y1; ++y) {
+    const pixel_type* srcRow = &src[0] + y*srcScanline;
+    pixel_type* dstRow = &dst[0] + y*dstScanline;
+
+    for (int x=0; x<dstLength; ++x) {
+      const pixel_type* s = srcRow + m_start[x];
+      const short* w = getWeights(x);
+      const int count = m_count[x];
+      int k = 0;
+
+#ifdef VACA_SSE2
+      __m128i acc = _mm_set1_epi32(half_unit);
+      for (; k+1<count; k+=2)
+	acc = _mm_add_epi32(acc, madd_pixels(s[k], s[k+1], w[k], w[k+1]));
+      if (k < count)
+	acc = _mm_add_epi32(acc, madd_pixels(s[k], 0, w[k], 0));
+      dstRow[x] = pack_channels(acc);
+#else
+      int b = half_unit, g = half_unit, r = half_unit, a = half_unit;
+      for (; k<count; ++k) {
+	pixel_type p = s[k];
+	b += static_cast<int>(p & 0xff) * w[k];
+	g += static_cast<int>((p >> 8) & 0xff) * w[k];
+	r += static_cast<int>((p >> 16) & 0xff) * w[k];
+	a += static_cast<int>(p >> 24) * w[k];
+      }
+      dstRow[x] = pack_channels(b, g, r, a);
+#endif
+    }
+  }
+}
+
+/**
+   Vertical pass: calculates the rows [@a y0, @a y1) of @a dst
+   filtering the columns of @a src.
+
+   @a src must be #getSourceLength pixels high, @a dst must be
+   #getLength pixels high, and both must have the same width.
+*/
+void FilterWeights::filterColumns(const ImagePixels& src, ImagePixels& dst, int y0, int y1) const
+{
+  assert(src.getHeight() == m_srcLength);
+  assert(dst.getHeight() == getLength());
+  assert(src.getWidth() == dst.getWidth());
+
+  const int width = dst.getWidth();
+  const int srcScanline = src.getScanlineSize();
+  const int dstScanline = dst.getScanlineSize();
+
+  for (int y=y0; y<y1; ++y) {
+    const pixel_type* srcCol = &src[0] + m_start[y]*srcScanline;
+    pixel_type* dstRow = &dst[0] + y*dstScanline;
+    const short* w = getWeights(y);
+    const int count = m_count[y];
+
+    for (int x=0; x<width; ++x) {
+      const pixel_type* s = srcCol + x;
+      int k = 0;
+
+#ifdef VACA_SSE2
+      __m128i acc = _mm_set1_epi32(half_unit);
+      for (; k+1<count; k+=2, s+=2*srcScanline)
+	acc = _mm_add_epi32(acc, madd_pixels(s[0], s[srcScanline], w[k], w[k+1]));
+      if (k < count)
+	acc = _mm_add_epi32(acc, madd_pixels(s[0], 0, w[k], 0));
+      dstRow[x] = pack_channels(acc);
+#else
+      int b = half_unit, g = half_unit, r = half_unit, a = half_unit;
+      for (; k<count; ++k, s+=srcScanline) {
+	pixel_type p = *s;
+	b += static_cast<int>(p & 0xff) * w[k];
+	g += static_cast<int>((p >> 8) & 0xff) * w[k];
+	r += static_cast<int>((p >> 16) & 0xff) * w[k];
+	a += static_cast<int>(p >> 24) * w[k];
+      }
+      dstRow[x] = pack_channels(b, g, r, a);
+#endif
+    }
+  }
+}
@@ -0,0 +1,68 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_FILTERWEIGHTS_H
+#define VACA_FILTERWEIGHTS_H
+
+#include "vaca/base.h"
+#include "vaca/ImagePixels.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   Table of fixed-point weights to filter the pixels of an image in
+   one axis.
+
+   For each destination pixel (column or row) the table contains the
+   first source pixel that contributes to it, and the weights of each
+   contributing pixel. Two tables (one for each axis) are used to apply
+   a separable filter: #filterRows is the horizontal pass and
+   #filterColumns the vertical one.
+
+   @internal
+*/
+class VACA_DLL FilterWeights
+{
+public:
+  /**
+     Number of bits of the fractional part of each weight.
+  */
+  enum { Precision = 14 };
+
+private:
+  int m_srcLength;
+  int m_taps;
+  std::vector<int> m_start;
+  std::vector<int> m_count;
+  std::vector<short> m_weights;
+
+public:
+  FilterWeights();
+
+  void initResample(int srcLength, int dstLength,
+		    double (*kernel)(double), double support);
+  void initKernel(int length, const std::vector<double>& kernel);
+
+  int getSourceLength() const { return m_srcLength; }
+  int getLength() const { return static_cast<int>(m_start.size()); }
+  int getTaps() const { return m_taps; }
+
+  int getStart(int i) const { return m_start[i]; }
+  int getCount(int i) const { return m_count[i]; }
+  const short* getWeights(int i) const { return &m_weights[i*m_taps]; }
+
+  void filterRows(const ImagePixels& src, ImagePixels& dst, int y0, int y1) const;
+  void filterColumns(const ImagePixels& src, ImagePixels& dst, int y0, int y1) const;
+
+private:
+  void setWeights(int i, int start, const std::vector<double>& weights, bool normalize);
+};
+
+} // namespace vaca
+
+#endif // VACA_FILTERWEIGHTS_H
@@ -0,0 +1,155 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/FramePipeline.h"
+
+using namespace vaca;
+
+/**
+   Creates the pipeline allocating all its frames.
+*/
+FramePipeline::FramePipeline(const Size& frameSize)
+  : m_frameSize(frameSize)
+  , m_back(0)
+  , m_front(1)
+  , m_middle(2)
+  , m_produced(0)
+  , m_consumed(0)
+  , m_dropped(0)
+  , m_lastLatency(0.0)
+  , m_totalLatency(0.0)
+{
+  for (int i=0; i<3; ++i) {
+    m_slots[i].pixels = ImagePixels(frameSize);
+    m_slots[i].timestamp = 0.0;
+  }
+}
+
+FramePipeline::~FramePipeline()
+{
+}
+
+Size FramePipeline::getFrameSize() const
+{
+  return m_frameSize;
+}
+
+/**
+   Returns the frame where the producer must write the next frame.
+   Only the producer thread can call this method.
+
+   @see endWrite
+*/
+ImagePixels& FramePipeline::beginWrite()
+{
+  return m_slots[m_back].pixels;
+}
+
+/**
+   Publishes the frame returned by #beginWrite. If the previous
+   published frame wasn't acquired by the consumer, it is dropped.
+   Only the producer thread can call this method.
+*/
+void FramePipeline::endWrite()
+{
+  m_slots[m_back].timestamp = m_clock.elapsed();
+
+  int old = m_middle.exchange(m_back | FreshFlag, std::memory_order_acq_rel);
+  if (old & FreshFlag)
+    ++m_dropped;
+
+  m_back = old & ~FreshFlag;
+  ++m_produced;
+}
+
+/**
+   Takes the last published frame (see #getFrame). Only the consumer
+   thread can call this method.
+
+   @return
+     False if there isn't a new frame since the last call (the
+     previous frame is still available in #getFrame).
+*/
+bool FramePipeline::acquire()
+{
+  if (!(m_middle.load(std::memory_order_relaxed) & FreshFlag))
+    return false;
+
+  // the producer can only change m_middle to another fresh frame, so
+  // here we always get a fresh one
+  m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & ~FreshFlag;
+
+  double latency = m_clock.elapsed() - m_slots[m_front].timestamp;
+  m_lastLatency = latency;
+  m_totalLatency = m_totalLatency + latency;
+  ++m_consumed;
+  return true;
+}
+
+/**
+   Returns the frame taken by the last call to #acquire. It is valid
+   until the next call to #acquire.
+*/
+const ImagePixels& FramePipeline::getFrame() const
+{
+  return m_slots[m_front].pixels;
+}
+
+/**
+   Returns the number of frames published by the producer.
+*/
+int FramePipeline::getProducedFrames() const
+{
+  return m_produced;
+}
+
+/**
+   Returns the number of frames acquired by the consumer.
+*/
+int FramePipeline::getConsumedFrames() const
+{
+  return m_consumed;
+}
+
+/**
+   Returns the number of frames that were replaced by a newer one
+   before the consumer acquired them.
+*/
+int FramePipeline::getDroppedFrames() const
+{
+  return m_dropped;
+}
+
+/**
+   Returns the seconds between the publication and the acquisition
+   of the last acquired frame.
+*/
+double FramePipeline::getLastLatency() const
+{
+  return m_lastLatency;
+}
+
+/**
+   Returns the average latency (in seconds) of all the acquired
+   frames.
+*/
+double FramePipeline::getAverageLatency() const
+{
+  int consumed = m_consumed;
+  return consumed > 0 ? m_totalLatency / consumed: 0.0;
+}
+
+/**
+   Sets all the counters to zero.
+*/
+void FramePipeline::resetCounters()
+{
+  m_produced = 0;
+  m_consumed = 0;
+  m_dropped = 0;
+  m_lastLatency = 0.0;
+  m_totalLatency = 0.0;
+}
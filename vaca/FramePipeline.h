@@ -0,0 +1,95 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_FRAMEPIPELINE_H
+#define VACA_FRAMEPIPELINE_H
+
+#include "vaca/base.h"
+#include "vaca/NonCopyable.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/TimePoint.h"
+
+#include <atomic>
+
+namespace vaca {
+
+/**
+   Hands frames from a producer thread (e.g. a video capture
+   callback) to a consumer thread (e.g. the GUI thread that paints
+   them) without locks and without allocating memory.
+
+   The pipeline is a ring of three preallocated frames: one that the
+   producer is writing, one that the consumer is reading, and the
+   last published frame. Publishing a frame replaces the previous
+   published one if the consumer didn't take it yet (it is counted as
+   dropped), so the consumer always gets the newest frame and the
+   latency never grows when the consumer is slower than the producer.
+
+   Producer thread:
+   @code
+   ImagePixels& frame = pipeline.beginWrite();
+   VideoFormats::yuy2ToPixels(data, stride, frame);
+   pipeline.endWrite();
+   @endcode
+
+   Consumer thread:
+   @code
+   if (pipeline.acquire()) {
+     image.setPixels(pipeline.getFrame());
+     ...
+   }
+   @endcode
+
+   There must be only one producer thread and one consumer thread.
+
+   @see VideoFormats
+*/
+class VACA_DLL FramePipeline : private NonCopyable
+{
+  struct Slot
+  {
+    ImagePixels pixels;
+    double timestamp;
+  };
+
+  enum { FreshFlag = 4 };	// m_middle has a frame not acquired yet
+
+  Size m_frameSize;
+  Slot m_slots[3];
+  int m_back;			// slot of the producer
+  int m_front;			// slot of the consumer
+  std::atomic<int> m_middle;	// last published slot (| FreshFlag)
+  TimePoint m_clock;
+
+  std::atomic<int> m_produced;
+  std::atomic<int> m_consumed;
+  std::atomic<int> m_dropped;
+  std::atomic<double> m_lastLatency;
+  std::atomic<double> m_totalLatency;
+
+public:
+  explicit FramePipeline(const Size& frameSize);
+  virtual ~FramePipeline();
+
+  Size getFrameSize() const;
+
+  ImagePixels& beginWrite();
+  void endWrite();
+
+  bool acquire();
+  const ImagePixels& getFrame() const;
+
+  int getProducedFrames() const;
+  int getConsumedFrames() const;
+  int getDroppedFrames() const;
+  double getLastLatency() const;
+  double getAverageLatency() const;
+  void resetCounters();
+};
+
+} // namespace vaca
+
+#endif // VACA_FRAMEPIPELINE_H
@@ -11,6 +11,8 @@
 #include "vaca/Font.h"
 #include "vaca/Rect.h"
 #include "vaca/Point.h"
+#include "vaca/PointF.h"
+#include "vaca/RectF.h"
 #include "vaca/Size.h"
 #include "vaca/Widget.h"
 #include "vaca/System.h"
@@ -608,6 +610,15 @@ void Graphics::drawLine(const Pen& pen, int x1, int y1, int x2, int y2)
   SelectObject(m_handle, oldPen);
 }
 
+/**
+   Draws a line between the nearest pixels of @a pt1 and @a pt2 (the
+   coordinates are rounded, not truncated, see PointF#round).
+*/
+void Graphics::drawLine(const Pen& pen, const PointF& pt1, const PointF& pt2)
+{
+  drawLine(pen, pt1.round(), pt2.round());
+}
+
 void Graphics::drawBezier(const Pen& pen, const Point points[4])
 {
   POINT pts[4];
@@ -673,6 +684,15 @@ void Graphics::drawRect(const Pen& pen, int x, int y, int w, int h)
   SelectObject(m_handle, oldBrush);
 }
 
+/**
+   Draws the rectangle with its sides rounded to the nearest pixels
+   (see RectF#round).
+*/
+void Graphics::drawRect(const Pen& pen, const RectF& rc)
+{
+  drawRect(pen, rc.round());
+}
+
 void Graphics::drawRoundRect(const Pen& pen, const Rect& rc, const Size& ellipse)
 {
   drawRoundRect(pen, rc.x, rc.y, rc.w, rc.h, ellipse.w, ellipse.h);
@@ -742,6 +762,15 @@ void Graphics::drawEllipse(const Pen& pen, int x, int y, int w, int h)
   SelectObject(m_handle, oldBrush);
 }
 
+/**
+   Draws the ellipse inside the rectangle rounded to the nearest
+   pixels (see RectF#round).
+*/
+void Graphics::drawEllipse(const Pen& pen, const RectF& rc)
+{
+  drawEllipse(pen, rc.round());
+}
+
 /**
    Draws an arc with rc as a bounding rectangle for the ellipse that
    encloses the arc. The arc start in the startAngle (a value between
@@ -835,6 +864,27 @@ void Graphics::drawPolyline(const Pen& pen, const std::vector<Point>& points)
   delete[] pts;
 }
 
+/**
+   Draws the polyline between the nearest pixels of the @a points
+   (e.g. the result of Transform#apply).
+*/
+void Graphics::drawPolyline(const Pen& pen, const std::vector<PointF>& points)
+{
+  size_t numPoints = points.size();
+
+  assert(numPoints >= 2);
+
+  POINT* pts = new POINT[numPoints];
+  POINT* pt = pts;
+  for (std::vector<PointF>::const_iterator
+	 it = points.begin(),
+	 end = points.end(); it != end; ++it, ++pt) {
+    *pt = convert_to<POINT>(it->round());
+  }
+  drawPolyline(pen, pts, numPoints);
+  delete[] pts;
+}
+
 void Graphics::fillRect(const Brush& brush, const Rect& rc)
 {
   fillRect(brush, rc.x, rc.y, rc.w, rc.h);
@@ -853,6 +903,16 @@ void Graphics::fillRect(const Brush& brush, int x, int y, int w, int h)
   SelectObject(m_handle, oldBrush);
 }
 
+/**
+   Fills the rectangle with its sides rounded to the nearest pixels
+   (see RectF#round), so adjacent subpixel rectangles don't leave gaps
+   or overlap.
+*/
+void Graphics::fillRect(const Brush& brush, const RectF& rc)
+{
+  fillRect(brush, rc.round());
+}
+
 void Graphics::fillRoundRect(const Brush& brush, const Rect& rc, const Size& ellipse)
 {
   fillRoundRect(brush, rc.x, rc.y, rc.w, rc.h, ellipse.w, ellipse.h);
@@ -889,6 +949,15 @@ void Graphics::fillEllipse(const Brush& brush, int x, int y, int w, int h)
   SelectObject(m_handle, oldBrush);
 }
 
+/**
+   Fills the ellipse inside the rectangle rounded to the nearest
+   pixels (see RectF#round).
+*/
+void Graphics::fillEllipse(const Brush& brush, const RectF& rc)
+{
+  fillEllipse(brush, rc.round());
+}
+
 void Graphics::fillPie(const Brush& brush, const Rect& rc, double startAngle, double sweepAngle)
 {
   fillPie(brush, rc.x, rc.y, rc.w, rc.h, startAngle, sweepAngle);
@@ -17,14 +17,6 @@
 
 namespace vaca {
 
-// ======================================================================
-
-enum class FillRule
-{
-  EvenOdd,
-  Winding
-};
-
 /**
    Class to control a graphics context.
 
@@ -128,18 +120,21 @@ public:
 
   void drawLine(const Pen& pen, const Point& pt1, const Point& pt2);
   void drawLine(const Pen& pen, int x1, int y1, int x2, int y2);
+  void drawLine(const Pen& pen, const PointF& pt1, const PointF& pt2);
   void drawBezier(const Pen& pen, const Point points[4]);
   void drawBezier(const Pen& pen, const std::vector<Point>& points);
   void drawBezier(const Pen& pen, const Point& pt1, const Point& pt2, const Point& pt3, const Point& pt4);
   void drawBezier(const Pen& pen, int x1, int y1, int x2, int y2, int x3, int y3, int x4, int y4);
   void drawRect(const Pen& pen, const Rect& rc);
   void drawRect(const Pen& pen, int x, int y, int w, int h);
+  void drawRect(const Pen& pen, const RectF& rc);
   void drawRoundRect(const Pen& pen, const Rect& rc, const Size& ellipse);
   void drawRoundRect(const Pen& pen, int x, int y, int w, int h, int ellipseWidth, int ellipseHeight);
   void draw3dRect(const Rect& rc, const Color& topLeft, const Color& bottomRight);
   void draw3dRect(int x, int y, int w, int h, const Color& topLeft, const Color& bottomRight);
   void drawEllipse(const Pen& pen, const Rect& rc);
   void drawEllipse(const Pen& pen, int x, int y, int w, int h);
+  void drawEllipse(const Pen& pen, const RectF& rc);
   void drawArc(const Pen& pen, const Rect& rc, double startAngle, double sweepAngle);
   void drawArc(const Pen& pen, int x, int y, int w, int h, double startAngle, double sweepAngle);
   void drawPie(const Pen& pen, const Rect& rc, double startAngle, double sweepAngle);
@@ -147,13 +142,16 @@ public:
   void drawChord(const Pen& pen, const Rect& rc, double startAngle, double sweepAngle);
   void drawChord(const Pen& pen, int x, int y, int w, int h, double startAngle, double sweepAngle);
   void drawPolyline(const Pen& pen, const std::vector<Point>& points);
+  void drawPolyline(const Pen& pen, const std::vector<PointF>& points);
 
   void fillRect(const Brush& brush, const Rect& rc);
   void fillRect(const Brush& brush, int x, int y, int w, int h);
+  void fillRect(const Brush& brush, const RectF& rc);
   void fillRoundRect(const Brush& brush, const Rect& rc, const Size& ellipse);
   void fillRoundRect(const Brush& brush, int x, int y, int w, int h, int ellipseWidth, int ellipseHeight);
   void fillEllipse(const Brush& brush, const Rect& rc);
   void fillEllipse(const Brush& brush, int x, int y, int w, int h);
+  void fillEllipse(const Brush& brush, const RectF& rc);
   void fillPie(const Brush& brush, const Rect& rc, double startAngle, double sweepAngle);
   void fillPie(const Brush& brush, int x, int y, int w, int h, double startAngle, double sweepAngle);
   void fillChord(const Brush& brush, const Rect& rc, double startAngle, double sweepAngle);
@@ -6,14 +6,91 @@
 
 #include "vaca/GraphicsPath.h"
 #include "vaca/Point.h"
+#include "vaca/PointF.h"
+#include "vaca/Transform.h"
 #include "vaca/Region.h"
 #include "vaca/Pen.h"
 #include "vaca/Brush.h"
 #include "vaca/Graphics.h"
 #include "vaca/win32.h"
 
+#include <cmath>
+
 using namespace vaca;
 
+namespace {
+
+  // Maximum number of segments of a flattened bezier curve
+  const int max_curve_segments = 1024;
+
+  // Returns the number of segments needed to flatten the bezier curve
+  // with the given tolerance using Wang's formula: the distance of the
+  // curve to the polyline of n uniform segments is at most
+  // (3*2/8) * max(|p0 - 2p1 + p2|, |p1 - 2p2 + p3|) / n^2.
+  int curve_segments(const Point& p0, const Point& p1,
+		     const Point& p2, const Point& p3, double tolerance)
+  {
+    double ax = p0.x - 2.0*p1.x + p2.x, ay = p0.y - 2.0*p1.y + p2.y;
+    double bx = p1.x - 2.0*p2.x + p3.x, by = p1.y - 2.0*p2.y + p3.y;
+    double m = std::sqrt(max_value(ax*ax + ay*ay, bx*bx + by*by));
+
+    double n = std::ceil(std::sqrt(0.75 * m / tolerance));
+    return clamp_value(static_cast<int>(n), 1, max_curve_segments);
+  }
+
+  // Adds the segments of the curve as LineTo nodes (evaluating the
+  // curve with forward differences). The last node is always p3.
+  void flatten_curve(const Point& p0, const Point& p1,
+		     const Point& p2, const Point& p3, int segments,
+		     std::vector<GraphicsPath::Node>& nodes)
+  {
+    // polynomial coefficients, B(t) = a*t^3 + b*t^2 + c*t + p0
+    double ax = -p0.x + 3.0*p1.x - 3.0*p2.x + p3.x;
+    double ay = -p0.y + 3.0*p1.y - 3.0*p2.y + p3.y;
+    double bx = 3.0*p0.x - 6.0*p1.x + 3.0*p2.x;
+    double by = 3.0*p0.y - 6.0*p1.y + 3.0*p2.y;
+    double cx = -3.0*p0.x + 3.0*p1.x;
+    double cy = -3.0*p0.y + 3.0*p1.y;
+
+    double h = 1.0 / segments, h2 = h*h, h3 = h2*h;
+    double x = p0.x, y = p0.y;
+    double dx = ax*h3 + bx*h2 + cx*h, dy = ay*h3 + by*h2 + cy*h;
+    double ddx = 6.0*ax*h3 + 2.0*bx*h2, ddy = 6.0*ay*h3 + 2.0*by*h2;
+    double dddx = 6.0*ax*h3, dddy = 6.0*ay*h3;
+    Point last = p0;
+
+    for (int i=1; i<segments; ++i) {
+      x += dx; dx += ddx; ddx += dddx;
+      y += dy; dy += ddy; ddy += dddy;
+
+      Point pt(static_cast<int>(std::floor(x + 0.5)),
+	       static_cast<int>(std::floor(y + 0.5)));
+      if (pt != last) {
+	nodes.push_back(GraphicsPath::Node(GraphicsPath::LineTo, pt));
+	last = pt;
+      }
+    }
+
+    nodes.push_back(GraphicsPath::Node(GraphicsPath::LineTo, p3));
+  }
+
+  // Counts the edge from a to b if it crosses the horizontal ray that
+  // goes from the center of the pixel pt to the right (without
+  // counting twice the vertices)
+  void count_crossing(const Point& a, const Point& b, const Point& pt,
+		      int& winding, int& crossings)
+  {
+    if ((a.y <= pt.y) != (b.y <= pt.y)) {
+      double x = a.x + (pt.y + 0.5 - a.y) * (b.x - a.x) / (b.y - a.y);
+      if (x > pt.x + 0.5) {
+	winding += (b.y > a.y ? 1: -1);
+	++crossings;
+      }
+    }
+  }
+
+}
+
 // ======================================================================
 //
 
@@ -55,6 +132,7 @@ const Point& GraphicsPath::Node::getPoint() const
 // GraphicsPath
 
 GraphicsPath::GraphicsPath()
+  : m_cacheValid(false)
 {
 }
 
@@ -62,13 +140,25 @@ GraphicsPath::~GraphicsPath()
 {
 }
 
+/**
+   Returns an iterator to modify the nodes.
+
+   The cache used by #contains and #getBounds is discarded, so
+   don't keep the iterator to modify the nodes after calling those
+   member functions.
+*/
 GraphicsPath::iterator GraphicsPath::begin()
 {
+  invalidateCache();
   return m_nodes.begin();
 }
 
+/**
+   @see begin()
+*/
 GraphicsPath::iterator GraphicsPath::end()
 {
+  invalidateCache();
   return m_nodes.end();
 }
 
@@ -85,6 +175,7 @@ GraphicsPath::const_iterator GraphicsPath::end() const
 void GraphicsPath::clear()
 {
   m_nodes.clear();
+  invalidateCache();
 }
 
 bool GraphicsPath::empty() const
@@ -99,9 +190,18 @@ unsigned GraphicsPath::size() const
 
 GraphicsPath& GraphicsPath::offset(int dx, int dy)
 {
-  for (iterator it=begin(); it!=end(); ++it) {
-    it->getPoint().x += dx;
-    it->getPoint().y += dy;
+  for (std::vector<Node>::iterator it=m_nodes.begin(); it!=m_nodes.end(); ++it) {
+    it->m_point.x += dx;
+    it->m_point.y += dy;
+  }
+
+  // the cache is moved instead of computed again
+  if (m_cacheValid) {
+    for (std::vector<Node>::iterator it=m_flattened.begin(); it!=m_flattened.end(); ++it) {
+      it->m_point.x += dx;
+      it->m_point.y += dy;
+    }
+    m_bounds.offset(dx, dy);
   }
   return *this;
 }
@@ -111,10 +211,40 @@ GraphicsPath& GraphicsPath::offset(const Point& point)
   return offset(point.x, point.y);
 }
 
+/**
+   Transforms all the nodes (including the control points of the
+   curves) with the given affine @a transform. The new points are
+   rounded to the nearest pixel.
+
+   @code
+   GraphicsPath star = ...;
+   star.transform(Transform().translate(50, 50).rotate(angle));
+   @endcode
+*/
+GraphicsPath& GraphicsPath::transform(const Transform& transform)
+{
+  if (m_nodes.empty())
+    return *this;
+
+  std::vector<PointF> points(m_nodes.size());
+  for (size_t i=0; i<m_nodes.size(); ++i)
+    points[i] = PointF(m_nodes[i].m_point);
+
+  transform.apply(points);
+
+  for (size_t i=0; i<m_nodes.size(); ++i)
+    m_nodes[i].m_point = points[i].round();
+
+  invalidateCache();
+  return *this;
+}
+
 GraphicsPath& GraphicsPath::moveTo(const Point& pt)
 {
-  if (!m_nodes.empty() && m_nodes.back().getType() == GraphicsPath::MoveTo)
+  if (!m_nodes.empty() && m_nodes.back().getType() == GraphicsPath::MoveTo) {
     m_nodes.back().m_point = pt;
+    invalidateCache();
+  }
   else
     addNode(GraphicsPath::MoveTo, pt);
   return *this;
@@ -126,6 +256,14 @@ GraphicsPath& GraphicsPath::moveTo(int x, int y)
   return *this;
 }
 
+/**
+   Moves to the nearest pixel of @a pt (see PointF#round).
+*/
+GraphicsPath& GraphicsPath::moveTo(const PointF& pt)
+{
+  return moveTo(pt.round());
+}
+
 GraphicsPath& GraphicsPath::lineTo(const Point& pt)
 {
   addNode(GraphicsPath::LineTo, pt);
@@ -138,6 +276,14 @@ GraphicsPath& GraphicsPath::lineTo(int x, int y)
   return *this;
 }
 
+/**
+   Adds a line to the nearest pixel of @a pt (see PointF#round).
+*/
+GraphicsPath& GraphicsPath::lineTo(const PointF& pt)
+{
+  return lineTo(pt.round());
+}
+
 GraphicsPath& GraphicsPath::curveTo(const Point& pt1, const Point& pt2, const Point& pt3)
 {
   addNode(GraphicsPath::BezierControl1, pt1);
@@ -152,22 +298,44 @@ GraphicsPath& GraphicsPath::curveTo(int x1, int y1, int x2, int y2, int x3, int
   return *this;
 }
 
+/**
+   Adds a curve with its points rounded to the nearest pixels (see
+   PointF#round).
+*/
+GraphicsPath& GraphicsPath::curveTo(const PointF& pt1, const PointF& pt2, const PointF& pt3)
+{
+  return curveTo(pt1.round(), pt2.round(), pt3.round());
+}
+
 GraphicsPath& GraphicsPath::closeFigure()
 {
   if (!m_nodes.empty())
     m_nodes.back().m_flags |= GraphicsPath::CloseFigure;
+  invalidateCache();
   return *this;
 }
 
-GraphicsPath& GraphicsPath::flatten()
+/**
+   Converts all the curves to lines.
+
+   Each curve is divided in the number of segments needed so the
+   lines are not farther than @a tolerance pixels from the curve (the
+   points are rounded to integers, so they can be half a pixel
+   farther). It doesn't need a Graphics.
+
+   @param tolerance
+     Maximum distance (in pixels) between the curves and the lines.
+*/
+GraphicsPath& GraphicsPath::flatten(double tolerance)
 {
-  ScreenGraphics g;
-  g.tracePath(*this, Point(0, 0));
-  ::FlattenPath(g.getHandle());
-  g.getPath(*this);
+  std::vector<Node> nodes;
+
+  if (flattenNodes(nodes, tolerance)) {
+    m_nodes.swap(nodes);
+    invalidateCache();
+  }
   return *this;
 }
-
 GraphicsPath& GraphicsPath::widen(const Pen& pen)
 {
   ScreenGraphics g;
@@ -189,7 +357,158 @@ Region GraphicsPath::toRegion() const
   return g.getRegionFromPath();
 }
 
+/**
+   Returns the bounds of the path (the curves are flattened, so the
+   control points are not included).
+
+   The bounds are cached with the flattened path used by #contains.
+*/
+Rect GraphicsPath::getBounds() const
+{
+  updateCache();
+  return m_bounds;
+}
+
+/**
+   Returns true if the pixel @a pt is inside the area that the path
+   fills (the center of the pixel is inside the figures, and the
+   open figures are closed as in Graphics#fillPath).
+
+   The first call flattens the curves, and the result is cached until
+   the path is modified, so hit-testing a path several times (e.g.
+   each time the mouse moves) doesn't allocate memory or use GDI.
+
+   @param fillRule
+     FillRule::EvenOdd is the rule used by #toRegion and Graphics by
+     default, FillRule::Winding is the rule to use with the result of
+     PathStroker.
+*/
+bool GraphicsPath::contains(const Point& pt, FillRule fillRule) const
+{
+  updateCache();
+
+  if (pt.x < m_bounds.x || pt.x >= m_bounds.x+m_bounds.w ||
+      pt.y < m_bounds.y || pt.y >= m_bounds.y+m_bounds.h)
+    return false;
+
+  int winding = 0;
+  int crossings = 0;
+
+  const Node* nodes = &m_flattened[0];
+  int n = static_cast<int>(m_flattened.size());
+  Point start = nodes[0].m_point;	// first point of the current figure
+  Point last = start;			// current point
+
+  for (int i=0; i<n; ++i) {
+    const Point& p = nodes[i].m_point;
+
+    // the last edge of a figure goes to its first point
+    if (nodes[i].getType() == MoveTo) {
+      count_crossing(last, start, pt, winding, crossings);
+      start = p;
+    }
+    else
+      count_crossing(last, p, pt, winding, crossings);
+    last = p;
+
+    // a line after a closed figure starts in the first point of that
+    // figure (like PathStroker does)
+    if (nodes[i].isCloseFigure()) {
+      count_crossing(last, start, pt, winding, crossings);
+      last = start;
+    }
+  }
+  count_crossing(last, start, pt, winding, crossings);
+
+  if (fillRule == FillRule::EvenOdd)
+    return (crossings & 1) != 0;
+  else
+    return winding != 0;
+}
+
 void GraphicsPath::addNode(int type, const Point& pt)
 {
   m_nodes.push_back(Node(type, pt));
+  invalidateCache();
+}
+
+/**
+   Puts in @a nodes the nodes of the path with the curves converted
+   to lines. Returns false (and @a nodes is not modified) if the path
+   doesn't have curves.
+*/
+bool GraphicsPath::flattenNodes(std::vector<Node>& nodes, double tolerance) const
+{
+  tolerance = max_value(tolerance, 0.01);
+
+  // count the nodes to allocate the result just one time
+  size_t count = 0;
+  bool curves = false;
+  for (size_t i=0; i<m_nodes.size(); ++i) {
+    if (m_nodes[i].getType() == BezierControl1 && i > 0 && i+2 < m_nodes.size()) {
+      count += curve_segments(m_nodes[i-1].m_point, m_nodes[i].m_point,
+			      m_nodes[i+1].m_point, m_nodes[i+2].m_point, tolerance);
+      curves = true;
+      i += 2;
+    }
+    else
+      ++count;
+  }
+
+  if (!curves)
+    return false;
+
+  nodes.clear();
+  nodes.reserve(count);
+
+  for (size_t i=0; i<m_nodes.size(); ++i) {
+    const Node& node = m_nodes[i];
+
+    if (node.getType() == BezierControl1 && i > 0 && i+2 < m_nodes.size()) {
+      const Point& p0 = m_nodes[i-1].m_point;
+      const Point& p3 = m_nodes[i+2].m_point;
+      int segments = curve_segments(p0, node.m_point, m_nodes[i+1].m_point, p3, tolerance);
+
+      flatten_curve(p0, node.m_point, m_nodes[i+1].m_point, p3, segments, nodes);
+      nodes.back().setCloseFigure(m_nodes[i+2].isCloseFigure());
+      i += 2;
+    }
+    else
+      nodes.push_back(node);
+  }
+  return true;
+}
+
+/**
+   Flattens the path and calculates its bounds if they were
+   discarded (the memory of the last cache is reused).
+*/
+void GraphicsPath::updateCache() const
+{
+  if (m_cacheValid)
+    return;
+
+  if (!flattenNodes(m_flattened, 0.25))
+    m_flattened = m_nodes;
+
+  if (m_flattened.empty())
+    m_bounds = Rect();
+  else {
+    Point p1 = m_flattened[0].m_point;
+    Point p2 = p1;
+    for (std::vector<Node>::const_iterator it=m_flattened.begin(); it!=m_flattened.end(); ++it) {
+      p1.x = min_value(p1.x, it->m_point.x);
+      p1.y = min_value(p1.y, it->m_point.y);
+      p2.x = max_value(p2.x, it->m_point.x);
+      p2.y = max_value(p2.y, it->m_point.y);
+    }
+    m_bounds = Rect(p1, p2);
+  }
+
+  m_cacheValid = true;
+}
+
+void GraphicsPath::invalidateCache()
+{
+  m_cacheValid = false;
 }
@@ -9,6 +9,7 @@
 
 #include "vaca/base.h"
 #include "vaca/Point.h"
+#include "vaca/Rect.h"
 
 #include <vector>
 
@@ -19,6 +20,8 @@ namespace vaca {
 */
 class VACA_DLL GraphicsPath
 {
+  friend class PathView;
+
 public:
   // values that are acceptable for Node#m_flags
   enum {
@@ -63,6 +66,11 @@ public:
 private:
   std::vector<Node> m_nodes;
 
+  // cache of the flattened nodes to hit-test the path (see #contains)
+  mutable std::vector<Node> m_flattened;
+  mutable Rect m_bounds;
+  mutable bool m_cacheValid;
+
 public:
   typedef std::vector<Node>::iterator iterator;
   typedef std::vector<Node>::const_iterator const_iterator;
@@ -82,25 +90,35 @@ public:
 
   GraphicsPath& offset(int dx, int dy);
   GraphicsPath& offset(const Point& point);
+  GraphicsPath& transform(const Transform& transform);
 
   GraphicsPath& moveTo(const Point& pt);
   GraphicsPath& moveTo(int x, int y);
+  GraphicsPath& moveTo(const PointF& pt);
 
   GraphicsPath& lineTo(const Point& pt);
   GraphicsPath& lineTo(int x, int y);
+  GraphicsPath& lineTo(const PointF& pt);
 
   GraphicsPath& curveTo(const Point& pt1, const Point& pt2, const Point& pt3);
   GraphicsPath& curveTo(int x1, int y1, int x2, int y2, int x3, int y3);
+  GraphicsPath& curveTo(const PointF& pt1, const PointF& pt2, const PointF& pt3);
 
   GraphicsPath& closeFigure();
 
-  GraphicsPath& flatten();
+  GraphicsPath& flatten(double tolerance = 0.25);
   GraphicsPath& widen(const Pen& pen);
 
+  Rect getBounds() const;
+  bool contains(const Point& pt, FillRule fillRule = FillRule::EvenOdd) const;
+
   Region toRegion() const;
 
 private:
   void addNode(int type, const Point& pt);
+  bool flattenNodes(std::vector<Node>& nodes, double tolerance) const;
+  void updateCache() const;
+  void invalidateCache();
 
 };
 
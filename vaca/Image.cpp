@@ -7,6 +7,7 @@
 #include "vaca/Image.h"
 #include "vaca/Debug.h"
 #include "vaca/Graphics.h"
+#include "vaca/Color.h"
 #include "vaca/Application.h"
 #include "vaca/ResourceException.h"
 #include "vaca/String.h"
@@ -213,6 +214,37 @@ void Image::setPixels(ImagePixels imagePixels)
 	    reinterpret_cast<BITMAPINFO*>(&bc), DIB_RGB_COLORS);
 }
 
+/**
+   Sets the color table of an image with 8 or less bits per pixel
+   (e.g. an image created with @c Image(width,height,8)).
+
+   When #setPixels is used with an image that has a color table, each
+   pixel is converted to the nearest color of the table, so you can
+   use ColorQuantizer to choose the best palette (and to dither the
+   pixels) before calling this method.
+
+   @see ColorQuantizer
+*/
+void Image::setPalette(const std::vector<Color>& palette)
+{
+  assert(getDepth() <= 8);
+  assert(palette.size() <= (1u << getDepth()));
+
+  if (palette.empty())
+    return;
+
+  std::vector<RGBQUAD> colors(palette.size());
+  for (size_t i=0; i<palette.size(); ++i) {
+    colors[i].rgbRed = palette[i].getR();
+    colors[i].rgbGreen = palette[i].getG();
+    colors[i].rgbBlue = palette[i].getB();
+    colors[i].rgbReserved = 0;
+  }
+
+  SetDIBColorTable(getGraphics().getHandle(), 0,
+		   static_cast<UINT>(colors.size()), &colors[0]);
+}
+
 HBITMAP Image::getHandle() const
 {
   return get()->getHandle();
@@ -14,6 +14,8 @@
 #include "vaca/SharedPtr.h"
 #include "vaca/ImagePixels.h"
 
+#include <vector>
+
 namespace vaca {
 
 /**
@@ -78,6 +80,8 @@ public:
   ImagePixels getPixels() const;
   void setPixels(ImagePixels imagePixels);
 
+  void setPalette(const std::vector<Color>& palette);
+
   HBITMAP getHandle() const;
 
   Image& operator=(const Image& image);
@@ -0,0 +1,251 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/ImageAtlas.h"
+#include "vaca/Graphics.h"
+
+#include <algorithm>
+
+using namespace vaca;
+
+namespace {
+
+  // Sorts the indexes of the images from the tallest to the shortest
+  // one (and from the widest to the narrowest one)
+  class TallestFirst
+  {
+    const std::vector<Size>& m_sizes;
+  public:
+    TallestFirst(const std::vector<Size>& sizes) : m_sizes(sizes) { }
+    bool operator()(int a, int b) const {
+      if (m_sizes[a].h != m_sizes[b].h)
+	return m_sizes[a].h > m_sizes[b].h;
+      return m_sizes[a].w > m_sizes[b].w;
+    }
+  };
+
+} // anonymous namespace
+
+/**
+   Creates an empty atlas.
+
+   @param sheetSize
+     Size of each sheet. Images bigger than this size get a sheet
+     of their own size.
+
+   @param padding
+     Pixels between images (to avoid mixing the borders of
+     contiguous images when they are scaled).
+*/
+ImageAtlas::ImageAtlas(const Size& sheetSize, int padding)
+  : m_sheetSize(sheetSize)
+  , m_padding(padding)
+{
+  assert(sheetSize.w > 0 && sheetSize.h > 0);
+  assert(padding >= 0);
+}
+
+ImageAtlas::~ImageAtlas()
+{
+  clear();
+}
+
+Size ImageAtlas::getSheetSize() const
+{
+  return m_sheetSize;
+}
+
+int ImageAtlas::getPadding() const
+{
+  return m_padding;
+}
+
+/**
+   Adds a copy of the @a pixels to the atlas. The image will be
+   placed in a sheet in the next call to #pack.
+
+   @return
+     The index of the image in the atlas.
+*/
+int ImageAtlas::addImage(const ImagePixels& pixels)
+{
+  assert(pixels.getWidth() > 0 && pixels.getHeight() > 0);
+
+  Entry entry;
+  entry.sheet = -1;
+  entry.bounds = Rect(pixels.getSize());
+  entry.pixels = pixels.clone();
+
+  m_entries.push_back(entry);
+  m_pending.push_back(static_cast<int>(m_entries.size())-1);
+  return static_cast<int>(m_entries.size())-1;
+}
+
+/**
+   Adds the pixels of the @a image to the atlas.
+
+   @see addImage(const ImagePixels&)
+*/
+int ImageAtlas::addImage(const Image& image)
+{
+  return addImage(image.getPixels());
+}
+
+/**
+   Places all the images added since the last call to #pack in the
+   sheets. The sheets that already have images are filled first, and
+   new sheets are created when there is no space left.
+*/
+void ImageAtlas::pack()
+{
+  std::vector<Size> sizes(m_entries.size());
+  for (size_t i=0; i<m_pending.size(); ++i)
+    sizes[m_pending[i]] = m_entries[m_pending[i]].bounds.getSize();
+
+  std::sort(m_pending.begin(), m_pending.end(), TallestFirst(sizes));
+
+  for (size_t i=0; i<m_pending.size(); ++i) {
+    Entry& entry = m_entries[m_pending[i]];
+    Size size = entry.bounds.getSize() + m_padding;
+    Point pos;
+    int sheet = -1;
+
+    for (int j=0; j<static_cast<int>(m_sheets.size()); ++j)
+      if (m_sheets[j]->packer.insert(size, pos)) {
+	sheet = j;
+	break;
+      }
+
+    // a new sheet (as big as the image if it doesn't fit in a
+    // normal sheet)
+    if (sheet < 0) {
+      m_sheets.push_back(new Sheet(Size(max_value(m_sheetSize.w, size.w),
+					max_value(m_sheetSize.h, size.h))));
+      sheet = static_cast<int>(m_sheets.size())-1;
+
+      bool inserted = m_sheets[sheet]->packer.insert(size, pos);
+      assert(inserted);
+      (void)inserted;
+    }
+
+    // copy the pixels to the sheet
+    Sheet* s = m_sheets[sheet];
+    const ImagePixels& src = entry.pixels;
+    ImagePixels& dst = s->pixels;
+    for (int y=0; y<src.getHeight(); ++y)
+      std::copy(&src[0] + y*src.getScanlineSize(),
+		&src[0] + y*src.getScanlineSize() + src.getWidth(),
+		&dst[0] + (pos.y+y)*dst.getScanlineSize() + pos.x);
+    s->modified = true;
+
+    entry.sheet = sheet;
+    entry.bounds.setOrigin(pos);
+    entry.pixels = ImagePixels();
+  }
+
+  m_pending.clear();
+}
+
+/**
+   Returns the number of images in the atlas.
+*/
+int ImageAtlas::getImageCount() const
+{
+  return static_cast<int>(m_entries.size());
+}
+
+int ImageAtlas::getSheetCount() const
+{
+  return static_cast<int>(m_sheets.size());
+}
+
+/**
+   Returns the sheet where the image with the specified @a index is,
+   or -1 if the image wasn't packed yet.
+*/
+int ImageAtlas::getSheet(int index) const
+{
+  assert(index >= 0 && index < getImageCount());
+  return m_entries[index].sheet;
+}
+
+/**
+   Returns the bounds of the image with the specified @a index inside
+   its sheet.
+*/
+Rect ImageAtlas::getBounds(int index) const
+{
+  assert(index >= 0 && index < getImageCount());
+  return m_entries[index].bounds;
+}
+
+/**
+   Returns the pixels of the specified @a sheet (shared with the atlas,
+   don't modify them).
+*/
+ImagePixels ImageAtlas::getSheetPixels(int sheet) const
+{
+  assert(sheet >= 0 && sheet < getSheetCount());
+  return m_sheets[sheet]->pixels;
+}
+
+/**
+   Returns the @a sheet as an image (one bitmap for all the images of
+   the sheet). The bitmap is updated only if new images were packed
+   in the sheet.
+*/
+Image ImageAtlas::getSheetImage(int sheet)
+{
+  assert(sheet >= 0 && sheet < getSheetCount());
+  Sheet* s = m_sheets[sheet];
+
+  if (s->modified) {
+    if (!s->image.isValid() || s->image.getSize() != s->pixels.getSize())
+      s->image = Image(s->pixels.getSize(), 32);
+
+    s->image.setPixels(s->pixels);
+    s->modified = false;
+  }
+
+  return s->image;
+}
+
+/**
+   Returns the used area of the @a sheet, from 0.0 (empty) to 1.0
+   (full).
+*/
+double ImageAtlas::getOccupancy(int sheet) const
+{
+  assert(sheet >= 0 && sheet < getSheetCount());
+  return m_sheets[sheet]->packer.getOccupancy();
+}
+
+/**
+   Draws the image with the specified @a index in @a g, with its
+   top-left corner in @a pt.
+*/
+void ImageAtlas::drawImage(Graphics& g, int index, const Point& pt)
+{
+  assert(index >= 0 && index < getImageCount());
+  const Entry& entry = m_entries[index];
+  assert(entry.sheet >= 0);
+
+  Image image = getSheetImage(entry.sheet);
+  g.drawImage(image, pt, entry.bounds);
+}
+
+/**
+   Removes all the images and sheets.
+*/
+void ImageAtlas::clear()
+{
+  for (size_t i=0; i<m_sheets.size(); ++i)
+    delete m_sheets[i];
+
+  m_sheets.clear();
+  m_entries.clear();
+  m_pending.clear();
+}
@@ -0,0 +1,102 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_IMAGEATLAS_H
+#define VACA_IMAGEATLAS_H
+
+#include "vaca/base.h"
+#include "vaca/NonCopyable.h"
+#include "vaca/Image.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/Rect.h"
+#include "vaca/SkylinePacker.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   Packs a lot of small images (e.g. icons of different sizes) into a
+   few big images called sheets.
+
+   Images are added with #addImage, which returns an index to
+   identify the image. Then #pack places all the added images in the
+   sheets (with SkylinePacker), so a set of hundreds of icons needs
+   only a few bitmaps. The position of each image is obtained in
+   constant time with #getSheet and #getBounds.
+
+   Example:
+   @code
+   ImageAtlas atlas;
+   int open = atlas.addImage(Image(ResourceId(IDB_OPEN)));
+   int save = atlas.addImage(Image(ResourceId(IDB_SAVE)));
+   atlas.pack();
+   ...
+   atlas.drawImage(g, open, Point(4, 4));
+   @endcode
+
+   @see SkylinePacker, ImageList
+*/
+class VACA_DLL ImageAtlas : private NonCopyable
+{
+  struct Entry
+  {
+    int sheet;
+    Rect bounds;
+    ImagePixels pixels;	// pixels waiting to be packed
+  };
+
+  struct Sheet
+  {
+    SkylinePacker packer;
+    ImagePixels pixels;
+    Image image;	// created when the sheet is drawn
+    bool modified;
+
+    Sheet(const Size& size)
+      : packer(size), pixels(size), modified(true) { }
+  };
+
+  Size m_sheetSize;
+  int m_padding;
+  std::vector<Entry> m_entries;
+  std::vector<Sheet*> m_sheets;
+  std::vector<int> m_pending;
+
+public:
+  /**
+     Default width and height of each sheet.
+  */
+  enum { DefaultSheetSize = 1024 };
+
+  explicit ImageAtlas(const Size& sheetSize = Size(DefaultSheetSize, DefaultSheetSize),
+		      int padding = 1);
+  virtual ~ImageAtlas();
+
+  Size getSheetSize() const;
+  int getPadding() const;
+
+  int addImage(const ImagePixels& pixels);
+  int addImage(const Image& image);
+  void pack();
+
+  int getImageCount() const;
+  int getSheetCount() const;
+
+  int getSheet(int index) const;
+  Rect getBounds(int index) const;
+  ImagePixels getSheetPixels(int sheet) const;
+  Image getSheetImage(int sheet);
+  double getOccupancy(int sheet) const;
+
+  void drawImage(Graphics& g, int index, const Point& pt);
+
+  void clear();
+};
+
+} // namespace vaca
+
+#endif // VACA_IMAGEATLAS_H
@@ -0,0 +1,328 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/ImageCache.h"
+#include "vaca/Image.h"
+#include "vaca/ImageResampler.h"
+#include "vaca/ScopedLock.h"
+
+using namespace vaca;
+
+// ======================================================================
+// ImageCacheKey
+
+/**
+   Creates a key for a bitmap in the resources of the application.
+*/
+ImageCacheKey::ImageCacheKey(ResourceId resourceId, const Size& size)
+  : m_resourceId(resourceId.getId())
+  , m_size(size)
+{
+}
+
+/**
+   Creates a key for a bitmap loaded from a file.
+*/
+ImageCacheKey::ImageCacheKey(const String& fileName, const Size& size)
+  : m_fileName(fileName)
+  , m_resourceId(0)
+  , m_size(size)
+{
+}
+
+bool ImageCacheKey::isResource() const
+{
+  return m_fileName.empty();
+}
+
+int ImageCacheKey::getResourceId() const
+{
+  return m_resourceId;
+}
+
+const String& ImageCacheKey::getFileName() const
+{
+  return m_fileName;
+}
+
+/**
+   Returns the requested size, or a zero size to use the original
+   size of the image.
+*/
+Size ImageCacheKey::getSize() const
+{
+  return m_size;
+}
+
+bool ImageCacheKey::operator<(const ImageCacheKey& other) const
+{
+  if (m_resourceId != other.m_resourceId)
+    return m_resourceId < other.m_resourceId;
+  if (m_size.w != other.m_size.w)
+    return m_size.w < other.m_size.w;
+  if (m_size.h != other.m_size.h)
+    return m_size.h < other.m_size.h;
+  return m_fileName < other.m_fileName;
+}
+
+bool ImageCacheKey::operator==(const ImageCacheKey& other) const
+{
+  return
+    m_resourceId == other.m_resourceId &&
+    m_size == other.m_size &&
+    m_fileName == other.m_fileName;
+}
+
+bool ImageCacheKey::operator!=(const ImageCacheKey& other) const
+{
+  return !operator==(other);
+}
+
+// ======================================================================
+// ImageCache
+
+/**
+   Creates an empty cache that can hold up to @a budget bytes of
+   pixels.
+*/
+ImageCache::ImageCache(size_t budget)
+  : m_budget(budget)
+  , m_bytes(0)
+  , m_hits(0)
+  , m_misses(0)
+  , m_evictions(0)
+{
+}
+
+ImageCache::~ImageCache()
+{
+}
+
+size_t ImageCache::getBudget() const
+{
+  ScopedLock hold(m_mutex);
+  return m_budget;
+}
+
+/**
+   Changes the maximum number of bytes of the cache. If the new
+   budget is smaller than the current size, the least recently used
+   images are removed.
+*/
+void ImageCache::setBudget(size_t budget)
+{
+  ScopedLock hold(m_mutex);
+  m_budget = budget;
+  evict(m_budget);
+}
+
+/**
+   Returns the number of bytes used by the pixels of all the images
+   in the cache.
+*/
+size_t ImageCache::getBytes() const
+{
+  ScopedLock hold(m_mutex);
+  return m_bytes;
+}
+
+/**
+   Returns the number of images in the cache.
+*/
+int ImageCache::getCount() const
+{
+  ScopedLock hold(m_mutex);
+  return static_cast<int>(m_entries.size());
+}
+
+/**
+   Looks for the image with the specified @a key.
+
+   @return
+     True if the image was found (then @a pixels is a copy of
+     the cached pixels), or false if it isn't in the cache.
+*/
+bool ImageCache::get(const ImageCacheKey& key, ImagePixels& pixels)
+{
+  ScopedLock hold(m_mutex);
+  Index::iterator it = m_index.find(key);
+
+  if (it == m_index.end()) {
+    ++m_misses;
+    return false;
+  }
+
+  // move the entry to the front of the list (most recently used)
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+  pixels = it->second->pixels.clone();
+  ++m_hits;
+  return true;
+}
+
+/**
+   Puts a copy of the @a pixels in the cache (replacing the old
+   pixels with the same @a key). Images bigger than the whole budget
+   are not stored.
+*/
+void ImageCache::put(const ImageCacheKey& key, const ImagePixels& pixels)
+{
+  size_t bytes =
+    static_cast<size_t>(pixels.getScanlineSize()) *
+    static_cast<size_t>(pixels.getHeight()) *
+    sizeof(ImagePixels::pixel_type);
+
+  // copy the pixels outside the lock
+  ImagePixels copy = pixels.clone();
+
+  ScopedLock hold(m_mutex);
+  Index::iterator it = m_index.find(key);
+  if (it != m_index.end()) {
+    m_bytes -= it->second->bytes;
+    m_entries.erase(it->second);
+    m_index.erase(it);
+  }
+
+  if (bytes > m_budget)
+    return;		// "copy" is not shared yet
+
+  evict(m_budget - bytes);
+
+  m_entries.push_front(Entry(key, copy, bytes));
+  m_index[key] = m_entries.begin();
+  m_bytes += bytes;
+
+  // release our reference while the mutex is locked
+  copy = ImagePixels();
+}
+
+/**
+   Returns true if the image with the specified @a key is in the
+   cache. It doesn't modify the counters nor the order of use.
+*/
+bool ImageCache::contains(const ImageCacheKey& key) const
+{
+  ScopedLock hold(m_mutex);
+  return m_index.find(key) != m_index.end();
+}
+
+void ImageCache::remove(const ImageCacheKey& key)
+{
+  ScopedLock hold(m_mutex);
+  Index::iterator it = m_index.find(key);
+  if (it != m_index.end()) {
+    m_bytes -= it->second->bytes;
+    m_entries.erase(it->second);
+    m_index.erase(it);
+  }
+}
+
+/**
+   Removes all the images from the cache (the counters are not
+   reset).
+*/
+void ImageCache::clear()
+{
+  ScopedLock hold(m_mutex);
+  m_entries.clear();
+  m_index.clear();
+  m_bytes = 0;
+}
+
+/**
+   Creates an Image using the cached pixels, or loading them from the
+   resource or file specified in the @a key (if the key has a size,
+   the loaded image is resampled to that size).
+
+   The image is decoded outside the lock of the cache, so other
+   threads are not blocked while the image is loaded.
+
+   @throw ResourceException
+     If the image isn't in the cache and it cannot be loaded.
+*/
+Image ImageCache::loadImage(const ImageCacheKey& key)
+{
+  ImagePixels pixels;
+
+  if (!get(key, pixels)) {
+    Image original = (key.isResource() ?
+		      Image(ResourceId(key.getResourceId())):
+		      Image(key.getFileName()));
+    pixels = original.getPixels();
+
+    Size size = key.getSize();
+    if (size.w > 0 && size.h > 0 && size != pixels.getSize())
+      pixels = ImageResampler(ResampleFilter::Bilinear).resample(pixels, size);
+
+    put(key, pixels);
+  }
+
+  Image image(pixels.getSize());
+  image.setPixels(pixels);
+  return image;
+}
+
+/**
+   Returns the number of calls to #get (or #loadImage) that found the
+   image in the cache.
+*/
+int ImageCache::getHits() const
+{
+  ScopedLock hold(m_mutex);
+  return m_hits;
+}
+
+/**
+   Returns the number of calls to #get (or #loadImage) that didn't
+   find the image in the cache.
+*/
+int ImageCache::getMisses() const
+{
+  ScopedLock hold(m_mutex);
+  return m_misses;
+}
+
+/**
+   Returns the number of images removed to keep the cache inside the
+   budget.
+*/
+int ImageCache::getEvictions() const
+{
+  ScopedLock hold(m_mutex);
+  return m_evictions;
+}
+
+void ImageCache::resetCounters()
+{
+  ScopedLock hold(m_mutex);
+  m_hits = 0;
+  m_misses = 0;
+  m_evictions = 0;
+}
+
+/**
+   Returns the cache shared by the whole application.
+*/
+ImageCache& ImageCache::getDefault()
+{
+  static ImageCache cache;
+  return cache;
+}
+
+/**
+   Removes the least recently used images until the cache uses
+   @a budget bytes or less. The mutex must be locked.
+*/
+void ImageCache::evict(size_t budget)
+{
+  while (m_bytes > budget && !m_entries.empty()) {
+    Entry& entry = m_entries.back();
+    m_bytes -= entry.bytes;
+    m_index.erase(entry.key);
+    m_entries.pop_back();
+    ++m_evictions;
+  }
+}
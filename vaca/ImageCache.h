@@ -0,0 +1,131 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_IMAGECACHE_H
+#define VACA_IMAGECACHE_H
+
+#include "vaca/base.h"
+#include "vaca/NonCopyable.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/Mutex.h"
+#include "vaca/ResourceId.h"
+#include "vaca/Size.h"
+
+#include <cstddef>
+#include <list>
+#include <map>
+
+namespace vaca {
+
+/**
+   Identifies an image in the ImageCache: a resource ID or a file
+   name, and the size requested for the image (a zero size means the
+   original size).
+*/
+class VACA_DLL ImageCacheKey
+{
+  String m_fileName;
+  int m_resourceId;
+  Size m_size;
+
+public:
+  ImageCacheKey(ResourceId resourceId, const Size& size = Size(0, 0));
+  ImageCacheKey(const String& fileName, const Size& size = Size(0, 0));
+
+  bool isResource() const;
+  int getResourceId() const;
+  const String& getFileName() const;
+  Size getSize() const;
+
+  bool operator<(const ImageCacheKey& other) const;
+  bool operator==(const ImageCacheKey& other) const;
+  bool operator!=(const ImageCacheKey& other) const;
+};
+
+/**
+   Keeps decoded images in memory so they are not loaded again each
+   time an Image is created from the same resource or file.
+
+   Images are stored as ImagePixels. When the total size of the
+   pixels exceeds the budget (in bytes), the least recently used
+   images are removed from the cache.
+
+   All member functions are thread-safe, so background threads can
+   decode images and put them in the cache while the GUI thread uses
+   it. As the reference counter of ImagePixels is not thread-safe,
+   the cache never shares its pixels: #put stores a copy, and #get
+   returns a copy.
+
+   Example:
+   @code
+   // the same bitmap used by several windows is loaded one time
+   Image image = ImageCache::getDefault().loadImage(ResourceId(IDB_LOGO));
+   @endcode
+
+   @see ImagePixels, Image
+*/
+class VACA_DLL ImageCache : private NonCopyable
+{
+  struct Entry
+  {
+    ImageCacheKey key;
+    ImagePixels pixels;
+    size_t bytes;
+
+    Entry(const ImageCacheKey& key, const ImagePixels& pixels, size_t bytes)
+      : key(key), pixels(pixels), bytes(bytes) { }
+  };
+
+  // Entries sorted from the most to the least recently used one
+  typedef std::list<Entry> Entries;
+  typedef std::map<ImageCacheKey, Entries::iterator> Index;
+
+  mutable Mutex m_mutex;
+  Entries m_entries;
+  Index m_index;
+  size_t m_budget;
+  size_t m_bytes;
+  int m_hits;
+  int m_misses;
+  int m_evictions;
+
+public:
+  /**
+     Default budget (32 MB).
+  */
+  enum { DefaultBudget = 32*1024*1024 };
+
+  explicit ImageCache(size_t budget = DefaultBudget);
+  virtual ~ImageCache();
+
+  size_t getBudget() const;
+  void setBudget(size_t budget);
+
+  size_t getBytes() const;
+  int getCount() const;
+
+  bool get(const ImageCacheKey& key, ImagePixels& pixels);
+  void put(const ImageCacheKey& key, const ImagePixels& pixels);
+  bool contains(const ImageCacheKey& key) const;
+  void remove(const ImageCacheKey& key);
+  void clear();
+
+  Image loadImage(const ImageCacheKey& key);
+
+  int getHits() const;
+  int getMisses() const;
+  int getEvictions() const;
+  void resetCounters();
+
+  static ImageCache& getDefault();
+
+private:
+  void evict(size_t budget);
+};
+
+} // namespace vaca
+
+#endif // VACA_IMAGECACHE_H
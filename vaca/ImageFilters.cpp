@@ -0,0 +1,510 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/ImageFilters.h"
+#include "vaca/FilterWeights.h"
+#include "vaca/ParallelFor.h"
+#include "vaca/Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  // Minimum number of scanlines/columns to be processed by each thread
+  const int scanlines_per_thread = 32;
+  const int columns_per_thread = 64;
+
+  // Gaussian blurs with a bigger sigma are approximated with three
+  // box blurs, which cost the same for any radius
+  const double max_kernel_sigma = 2.0;
+
+#ifdef VACA_SSE2
+
+  inline __m128i unpack_pixel(pixel_type p)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(p), zero), zero);
+  }
+
+  inline pixel_type average_pixel(__m128i sum, __m128 scale)
+  {
+    __m128i v = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale));
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    return static_cast<pixel_type>(_mm_cvtsi128_si32(v));
+  }
+
+#else
+
+  inline void add_pixel(int* sum, pixel_type p)
+  {
+    sum[0] += p & 0xff;
+    sum[1] += (p >> 8) & 0xff;
+    sum[2] += (p >> 16) & 0xff;
+    sum[3] += p >> 24;
+  }
+
+  inline void sub_pixel(int* sum, pixel_type p)
+  {
+    sum[0] -= p & 0xff;
+    sum[1] -= (p >> 8) & 0xff;
+    sum[2] -= (p >> 16) & 0xff;
+    sum[3] -= p >> 24;
+  }
+
+  inline pixel_type average_pixel(const int* sum, float scale)
+  {
+    return
+      (static_cast<pixel_type>(sum[3] * scale + 0.5f) << 24) |
+      (static_cast<pixel_type>(sum[2] * scale + 0.5f) << 16) |
+      (static_cast<pixel_type>(sum[1] * scale + 0.5f) << 8) |
+      (static_cast<pixel_type>(sum[0] * scale + 0.5f));
+  }
+
+#endif
+
+  // Horizontal pass of the box blur: a running sum of 2*radius+1
+  // pixels through each scanline.
+  void box_blur_rows(const ImagePixels& src, ImagePixels& dst, int radius, int y0, int y1)
+  {
+    const int width = src.getWidth();
+    const int last = width-1;
+    const int scanline = src.getScanlineSize();
+    const float scale = 1.0f / (2*radius + 1);
+
+    for (int y=y0; y<y1; ++y) {
+      const pixel_type* s = &src[0] + y*scanline;
+      pixel_type* d = &dst[0] + y*scanline;
+
+#ifdef VACA_SSE2
+      const __m128 vscale = _mm_set1_ps(scale);
+      __m128i sum = _mm_setzero_si128();
+      for (int k=-radius; k<=radius; ++k)
+	sum = _mm_add_epi32(sum, unpack_pixel(s[clamp_value(k, 0, last)]));
+
+      for (int x=0; x<width; ++x) {
+	d[x] = average_pixel(sum, vscale);
+	sum = _mm_add_epi32(sum, unpack_pixel(s[min_value(x+radius+1, last)]));
+	sum = _mm_sub_epi32(sum, unpack_pixel(s[max_value(x-radius, 0)]));
+      }
+#else
+      int sum[4] = { 0, 0, 0, 0 };
+      for (int k=-radius; k<=radius; ++k)
+	add_pixel(sum, s[clamp_value(k, 0, last)]);
+
+      for (int x=0; x<width; ++x) {
+	d[x] = average_pixel(sum, scale);
+	add_pixel(sum, s[min_value(x+radius+1, last)]);
+	sub_pixel(sum, s[max_value(x-radius, 0)]);
+      }
+#endif
+    }
+  }
+
+  // Vertical pass of the box blur: a running sum for each column in
+  // [x0, x1), advancing one scanline at a time so the memory is
+  // accessed sequentially.
+  void box_blur_columns(const ImagePixels& src, ImagePixels& dst, int radius, int x0, int x1)
+  {
+    const int height = src.getHeight();
+    const int last = height-1;
+    const int scanline = src.getScanlineSize();
+    const int columns = x1 - x0;
+    const float scale = 1.0f / (2*radius + 1);
+    const pixel_type* s = &src[0] + x0;
+    pixel_type* d = &dst[0] + x0;
+    std::vector<int> sums(4*columns, 0);
+
+#ifdef VACA_SSE2
+    const __m128 vscale = _mm_set1_ps(scale);
+    __m128i* sum = reinterpret_cast<__m128i*>(&sums[0]);
+
+    for (int k=-radius; k<=radius; ++k) {
+      const pixel_type* row = s + clamp_value(k, 0, last)*scanline;
+      for (int x=0; x<columns; ++x)
+	_mm_storeu_si128(sum+x, _mm_add_epi32(_mm_loadu_si128(sum+x), unpack_pixel(row[x])));
+    }
+
+    for (int y=0; y<height; ++y) {
+      const pixel_type* addRow = s + min_value(y+radius+1, last)*scanline;
+      const pixel_type* subRow = s + max_value(y-radius, 0)*scanline;
+      pixel_type* dstRow = d + y*scanline;
+
+      for (int x=0; x<columns; ++x) {
+	__m128i v = _mm_loadu_si128(sum+x);
+	dstRow[x] = average_pixel(v, vscale);
+	v = _mm_add_epi32(v, unpack_pixel(addRow[x]));
+	v = _mm_sub_epi32(v, unpack_pixel(subRow[x]));
+	_mm_storeu_si128(sum+x, v);
+      }
+    }
+#else
+    int* sum = &sums[0];
+
+    for (int k=-radius; k<=radius; ++k) {
+      const pixel_type* row = s + clamp_value(k, 0, last)*scanline;
+      for (int x=0; x<columns; ++x)
+	add_pixel(sum+4*x, row[x]);
+    }
+
+    for (int y=0; y<height; ++y) {
+      const pixel_type* addRow = s + min_value(y+radius+1, last)*scanline;
+      const pixel_type* subRow = s + max_value(y-radius, 0)*scanline;
+      pixel_type* dstRow = d + y*scanline;
+
+      for (int x=0; x<columns; ++x) {
+	dstRow[x] = average_pixel(sum+4*x, scale);
+	add_pixel(sum+4*x, addRow[x]);
+	sub_pixel(sum+4*x, subRow[x]);
+      }
+    }
+#endif
+  }
+
+  std::vector<double> gaussian_kernel(double sigma)
+  {
+    int radius = static_cast<int>(std::ceil(3.0 * sigma));
+    std::vector<double> kernel(2*radius + 1);
+    double sum = 0.0;
+
+    for (int k=-radius; k<=radius; ++k) {
+      kernel[k+radius] = std::exp(-(k*k) / (2.0 * sigma * sigma));
+      sum += kernel[k+radius];
+    }
+
+    for (size_t k=0; k<kernel.size(); ++k)
+      kernel[k] /= sum;
+
+    return kernel;
+  }
+
+} // anonymous namespace
+
+/**
+   Convolves the @a pixels with a separable kernel: first each
+   scanline is convolved with @a horzKernel, and then each column
+   with @a vertKernel.
+
+   Both kernels must have an odd number of elements (the center of
+   the kernel is the element in the middle), and each element must be
+   in the (-2.0, 2.0) range. The kernels are not normalized.
+*/
+void ImageFilters::convolve(ImagePixels& pixels,
+			    const std::vector<double>& horzKernel,
+			    const std::vector<double>& vertKernel)
+{
+  if (pixels.getWidth() == 0 || pixels.getHeight() == 0)
+    return;
+
+  FilterWeights horz, vert;
+  horz.initKernel(pixels.getWidth(), horzKernel);
+  vert.initKernel(pixels.getHeight(), vertKernel);
+
+  ImagePixels tmp(pixels.getSize());
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 horz.filterRows(pixels, tmp, y0, y1);
+	       });
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 vert.filterColumns(tmp, pixels, y0, y1);
+	       });
+}
+
+/**
+   Replaces each pixel with the average of the square of
+   (2*@a radius+1) x (2*@a radius+1) pixels around it.
+
+   The cost of this filter does not depend on the @a radius: each pass
+   keeps a running sum of the pixels inside the box.
+*/
+void ImageFilters::boxBlur(ImagePixels& pixels, int radius)
+{
+  boxBlur(pixels, radius, radius);
+}
+
+/**
+   Box blur with a different radius for each axis. A zero radius skips
+   the pass of that axis.
+*/
+void ImageFilters::boxBlur(ImagePixels& pixels, int horzRadius, int vertRadius)
+{
+  assert(horzRadius >= 0 && vertRadius >= 0);
+
+  if (pixels.getWidth() == 0 || pixels.getHeight() == 0)
+    return;
+
+  ImagePixels tmp(pixels.getSize());
+
+  if (horzRadius > 0) {
+    parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+		 [&](int y0, int y1) {
+		   box_blur_rows(pixels, tmp, horzRadius, y0, y1);
+		 });
+  }
+  else
+    tmp = pixels.clone();
+
+  if (vertRadius > 0) {
+    parallel_for(0, pixels.getWidth(), columns_per_thread,
+		 [&](int x0, int x1) {
+		   box_blur_columns(tmp, pixels, vertRadius, x0, x1);
+		 });
+  }
+  else if (horzRadius > 0)
+    std::copy(&tmp[0], &tmp[0] + tmp.getScanlineSize()*tmp.getHeight(), &pixels[0]);
+}
+
+/**
+   Blurs the @a pixels with a gaussian function of the specified
+   standard deviation @a sigma (in pixels).
+
+   Small values of @a sigma use an exact gaussian kernel (see
+   #convolve). Bigger values are approximated with three successive
+   box blurs (see #boxBlur), so large radii are as fast as small ones.
+*/
+void ImageFilters::gaussianBlur(ImagePixels& pixels, double sigma)
+{
+  if (sigma <= 0.0)
+    return;
+
+  if (sigma <= max_kernel_sigma) {
+    std::vector<double> kernel = gaussian_kernel(sigma);
+    convolve(pixels, kernel, kernel);
+    return;
+  }
+
+  // Sizes of three boxes to approximate the gaussian (see "Fast
+  // Almost-Gaussian Filtering", Peter Kovesi)
+  const int n = 3;
+  double idealWidth = std::sqrt(12.0*sigma*sigma/n + 1.0);
+  int lowerWidth = static_cast<int>(std::floor(idealWidth));
+  if ((lowerWidth & 1) == 0)
+    --lowerWidth;
+  int upperWidth = lowerWidth + 2;
+  double idealLowerBoxes =
+    (12.0*sigma*sigma - n*lowerWidth*lowerWidth - 4.0*n*lowerWidth - 3.0*n)
+    / (-4.0*lowerWidth - 4.0);
+  int lowerBoxes = static_cast<int>(std::floor(idealLowerBoxes + 0.5));
+
+  for (int i=0; i<n; ++i) {
+    int width = (i < lowerBoxes ? lowerWidth: upperWidth);
+    boxBlur(pixels, (width-1) / 2);
+  }
+}
+
+/**
+   Sharpens the @a pixels using an unsharp mask: the difference between
+   each pixel and a gaussian blurred version of it (with the specified
+   @a sigma) is multiplied by @a amount and added to the pixel.
+
+   The alpha channel is not modified.
+
+   @param amount
+     Strength of the filter, 0.0 does nothing, 1.0 adds the whole
+     difference.
+*/
+void ImageFilters::sharpen(ImagePixels& pixels, double amount, double sigma)
+{
+  if (amount <= 0.0 || pixels.getWidth() == 0 || pixels.getHeight() == 0)
+    return;
+
+  ImagePixels blurred = pixels.clone();
+  gaussianBlur(blurred, sigma);
+
+  // amount in 8.8 fixed-point
+  const int factor = static_cast<int>(amount * 256.0 + 0.5);
+  const int scanline = pixels.getScanlineSize();
+
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 for (int y=y0; y<y1; ++y) {
+		   pixel_type* p = &pixels[0] + y*scanline;
+		   const pixel_type* b = &blurred[0] + y*scanline;
+
+		   for (int x=0; x<pixels.getWidth(); ++x) {
+		     pixel_type result = p[x] & 0xff000000;
+		     for (int shift=0; shift<24; shift+=8) {
+		       int v = (p[x] >> shift) & 0xff;
+		       int diff = v - static_cast<int>((b[x] >> shift) & 0xff);
+		       v += (diff * factor + 128) >> 8;
+		       result |= static_cast<pixel_type>(clamp_value(v, 0, 255)) << shift;
+		     }
+		     p[x] = result;
+		   }
+		 }
+	       });
+}
+
+/**
+   Converts the @a pixels to shades of gray using the same luminance
+   weights as Color#toBlackAndWhite (30% red, 59% green, and 11%
+   blue). The alpha channel is not modified.
+*/
+void ImageFilters::grayscale(ImagePixels& pixels)
+{
+  const int width = pixels.getWidth();
+  const int scanline = pixels.getScanlineSize();
+
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 for (int y=y0; y<y1; ++y) {
+		   pixel_type* p = &pixels[0] + y*scanline;
+		   int x = 0;
+
+#ifdef VACA_SSE2
+		   // four pixels at a time, luminance in 8.8 fixed-point
+		   const __m128i zero = _mm_setzero_si128();
+		   const __m128i weights = _mm_setr_epi16(28, 151, 77, 0, 28, 151, 77, 0);
+		   const __m128i half = _mm_set1_epi32(128);
+		   const __m128i alphaMask = _mm_set1_epi32(0xff000000);
+
+		   for (; x+4<=width; x+=4) {
+		     __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p+x));
+		     __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights);
+		     __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights);
+		     lo = _mm_add_epi32(lo, _mm_srli_epi64(lo, 32));
+		     hi = _mm_add_epi32(hi, _mm_srli_epi64(hi, 32));
+		     __m128i gray = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(lo),
+								    _mm_castsi128_ps(hi),
+								    _MM_SHUFFLE(2, 0, 2, 0)));
+		     gray = _mm_srli_epi32(_mm_add_epi32(gray, half), 8);
+		     gray = _mm_or_si128(gray, _mm_or_si128(_mm_slli_epi32(gray, 8),
+							    _mm_slli_epi32(gray, 16)));
+		     _mm_storeu_si128(reinterpret_cast<__m128i*>(p+x),
+				      _mm_or_si128(gray, _mm_and_si128(v, alphaMask)));
+		   }
+#endif
+
+		   for (; x<width; ++x) {
+		     pixel_type c = p[x];
+		     pixel_type gray = (((c >> 16) & 0xff) * 77 +
+					((c >> 8) & 0xff) * 151 +
+					(c & 0xff) * 28 + 128) >> 8;
+		     p[x] = (c & 0xff000000) | (gray << 16) | (gray << 8) | gray;
+		   }
+		 }
+	       });
+}
+
+/**
+   Inverts the color of each pixel, like Color#negative does. The
+   alpha channel is not modified.
+*/
+void ImageFilters::invert(ImagePixels& pixels)
+{
+  const int width = pixels.getWidth();
+  const int scanline = pixels.getScanlineSize();
+
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 // this loop is vectorized by the compiler
+		 for (int y=y0; y<y1; ++y) {
+		   pixel_type* p = &pixels[0] + y*scanline;
+		   for (int x=0; x<width; ++x)
+		     p[x] ^= 0x00ffffff;
+		 }
+	       });
+}
+
+/**
+   Converts the pixels of the @a maskColor to transparent pixels (all
+   the channels, alpha included, are set to zero), and makes all the
+   other pixels opaque. This is what an image list does with a masked
+   bitmap, but here it is done directly over the pixels, so the result
+   can be stored (e.g. in an ImageCache) and drawn with alpha blending.
+
+   @param tolerance
+     Maximum difference (from 0 to 255) between each RGB component of
+     a pixel and the @a maskColor to consider that pixel as part of the
+     mask. It is useful for images that were compressed with loss.
+*/
+void ImageFilters::maskColorToAlpha(ImagePixels& pixels, const Color& maskColor, int tolerance)
+{
+  assert(tolerance >= 0 && tolerance <= 255);
+
+  const int width = pixels.getWidth();
+  const int scanline = pixels.getScanlineSize();
+  const int maskR = maskColor.getR();
+  const int maskG = maskColor.getG();
+  const int maskB = maskColor.getB();
+  const pixel_type mask = ImagePixels::makePixel(maskR, maskG, maskB, 0);
+
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 for (int y=y0; y<y1; ++y) {
+		   pixel_type* p = &pixels[0] + y*scanline;
+		   int x = 0;
+
+#ifdef VACA_SSE2
+		   // four pixels at a time: the absolute difference of each
+		   // component (saturated), minus the tolerance, must be zero
+		   // in the three RGB components
+		   const __m128i zero = _mm_setzero_si128();
+		   const __m128i maskv = _mm_set1_epi32(mask);
+		   const __m128i tol = _mm_set1_epi32(ImagePixels::makePixel(tolerance, tolerance, tolerance, 0));
+		   const __m128i rgbMask = _mm_set1_epi32(0x00ffffff);
+		   const __m128i alphaMask = _mm_set1_epi32(0xff000000);
+
+		   for (; x+4<=width; x+=4) {
+		     __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p+x));
+		     __m128i diff = _mm_or_si128(_mm_subs_epu8(v, maskv),
+						 _mm_subs_epu8(maskv, v));
+		     diff = _mm_and_si128(_mm_subs_epu8(diff, tol), rgbMask);
+		     __m128i transparent = _mm_cmpeq_epi32(diff, zero);
+		     _mm_storeu_si128(reinterpret_cast<__m128i*>(p+x),
+				      _mm_andnot_si128(transparent, _mm_or_si128(v, alphaMask)));
+		   }
+#endif
+
+		   for (; x<width; ++x) {
+		     pixel_type c = p[x];
+		     if (std::abs(ImagePixels::getR(c) - maskR) <= tolerance &&
+			 std::abs(ImagePixels::getG(c) - maskG) <= tolerance &&
+			 std::abs(ImagePixels::getB(c) - maskB) <= tolerance)
+		       p[x] = 0;
+		     else
+		       p[x] = c | 0xff000000;
+		   }
+		 }
+	       });
+}
+
+/**
+   Cuts a horizontal @a strip of images (like the bitmaps used to
+   create an ImageList) in frames of @a frameWidth pixels. If the
+   width of the strip is not a multiple of @a frameWidth, the pixels
+   at the right side are ignored.
+
+   @return
+     A copy of each frame, from left to right.
+*/
+std::vector<ImagePixels> ImageFilters::splitStrip(const ImagePixels& strip, int frameWidth)
+{
+  assert(frameWidth > 0);
+
+  const int height = strip.getHeight();
+  const int scanline = strip.getScanlineSize();
+  std::vector<ImagePixels> frames(strip.getWidth() / frameWidth);
+
+  for (int i=0; i<static_cast<int>(frames.size()); ++i) {
+    ImagePixels frame(frameWidth, height);
+
+    for (int y=0; y<height; ++y) {
+      const pixel_type* src = &strip[0] + y*scanline + i*frameWidth;
+      std::copy(src, src+frameWidth, &frame[0] + y*frame.getScanlineSize());
+    }
+    frames[i] = frame;
+  }
+
+  return frames;
+}
@@ -0,0 +1,61 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_IMAGEFILTERS_H
+#define VACA_IMAGEFILTERS_H
+
+#include "vaca/base.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/Color.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   Filters that modify ImagePixels in place.
+
+   Blur filters are separable (a horizontal pass followed by a
+   vertical one), and each pass is split between all processors.
+   Pixels outside the image are considered equal to the nearest
+   border pixel.
+
+   There are also routines to prepare sprite sheets or strips of
+   icons without GDI: #maskColorToAlpha replaces a background color
+   with transparent pixels, and #splitStrip cuts a strip in frames.
+
+   Example:
+   @code
+   ImagePixels pixels = image.getPixels();
+   ImageFilters::gaussianBlur(pixels, 4.0);
+   image.setPixels(pixels);
+   @endcode
+
+   @see ImageResampler, ColorSpaces, ColorQuantizer
+*/
+namespace ImageFilters
+{
+  VACA_DLL void convolve(ImagePixels& pixels,
+			 const std::vector<double>& horzKernel,
+			 const std::vector<double>& vertKernel);
+
+  VACA_DLL void boxBlur(ImagePixels& pixels, int radius);
+  VACA_DLL void boxBlur(ImagePixels& pixels, int horzRadius, int vertRadius);
+
+  VACA_DLL void gaussianBlur(ImagePixels& pixels, double sigma);
+
+  VACA_DLL void sharpen(ImagePixels& pixels, double amount, double sigma = 1.0);
+
+  VACA_DLL void grayscale(ImagePixels& pixels);
+  VACA_DLL void invert(ImagePixels& pixels);
+
+  VACA_DLL void maskColorToAlpha(ImagePixels& pixels, const Color& maskColor, int tolerance = 0);
+  VACA_DLL std::vector<ImagePixels> splitStrip(const ImagePixels& strip, int frameWidth);
+}
+
+} // namespace vaca
+
+#endif // VACA_IMAGEFILTERS_H
@@ -74,6 +74,33 @@ ImageList::ImageList(const String& fileName, int widthPerIcon, Color maskColor)
   get()->setHandle(himagelist);
 }
 
+/**
+   Creates a ImageList from a @a strip of pixels with alpha channel
+   (e.g. the result of ImageFilters#maskColorToAlpha), so the mask is
+   not generated by GDI.
+
+   @see ImageFilters#maskColorToAlpha, ImageFilters#splitStrip
+*/
+ImageList::ImageList(const ImagePixels& strip, int widthPerIcon)
+  : SharedPtr<GdiObj>(new GdiObj())
+{
+  assert(widthPerIcon > 0);
+
+  HIMAGELIST himagelist =
+    ImageList_Create(widthPerIcon, strip.getHeight(),
+		     ILC_COLOR32, strip.getWidth() / widthPerIcon, 1);
+  if (himagelist == NULL)
+    throw ResourceException(L"Can't create the image-list");
+
+  get()->setHandle(himagelist);
+
+  Image image(strip.getSize(), 32);
+  image.setPixels(strip);
+
+  // ImageList_Add adds one image for each widthPerIcon pixels
+  ImageList_Add(getHandle(), image.getHandle(), NULL);
+}
+
 ImageList::~ImageList()
 {
 }
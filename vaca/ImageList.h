@@ -9,6 +9,7 @@
 
 #include "vaca/base.h"
 #include "vaca/Image.h"
+#include "vaca/ImagePixels.h"
 #include "vaca/Color.h"
 #include "vaca/ResourceId.h"
 #include "vaca/GdiObject.h"
@@ -56,6 +57,7 @@ public:
   explicit ImageList(HIMAGELIST hImageList);
   ImageList(ResourceId bitmapId, int widthPerIcon, Color maskColor);
   ImageList(const String& fileName, int widthPerIcon, Color maskColor);
+  ImageList(const ImagePixels& strip, int widthPerIcon);
   virtual ~ImageList();
 
   int getImageCount() const;
@@ -81,7 +81,7 @@ public:
 
   void copyTo(ImagePixelsHandle& other) const
   {
-    std::copy(m_buffer.begin(), m_buffer.begin(), other.m_buffer.begin());
+    std::copy(m_buffer.begin(), m_buffer.end(), other.m_buffer.begin());
   }
 
 private:
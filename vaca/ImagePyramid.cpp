@@ -0,0 +1,455 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/ImagePyramid.h"
+#include "vaca/Point.h"
+#include "vaca/Simd.h"
+#include "vaca/System.h"
+#include "vaca/Thread.h"
+
+#include <cmath>
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  // Unlocks the mutex of a ScopedLock during its life-time
+  class ScopedUnlock : private NonCopyable
+  {
+    ScopedLock& m_lock;
+  public:
+    ScopedUnlock(ScopedLock& lock) : m_lock(lock) {
+      m_lock.getMutex().unlock();
+    }
+    ~ScopedUnlock() {
+      m_lock.getMutex().lock();
+    }
+  };
+
+  // Average of each channel rounding up, (a+b+1)/2, which is what
+  // _mm_avg_epu8 does
+  inline pixel_type average(pixel_type a, pixel_type b)
+  {
+    return (a | b) - (((a ^ b) & 0xfefefefe) >> 1);
+  }
+
+  // Fills @a dst from @a pt with the average of each 2x2 block of the
+  // area @a rc of @a src (the last column/row of the area is repeated
+  // if it has an odd size).
+  void downsample(const ImagePixels& src, const Rect& rc,
+		  ImagePixels& dst, const Point& pt)
+  {
+    const int w = (rc.w+1)/2;
+    const int h = (rc.h+1)/2;
+
+    for (int y=0; y<h; ++y) {
+      const pixel_type* row0 = &src[0] + (rc.y + 2*y)*src.getScanlineSize() + rc.x;
+      const pixel_type* row1 = &src[0] + (rc.y + min_value(2*y+1, rc.h-1))*src.getScanlineSize() + rc.x;
+      pixel_type* d = &dst[0] + (pt.y + y)*dst.getScanlineSize() + pt.x;
+      int x = 0;
+
+#ifdef VACA_SSE2
+      // four destination pixels at a time while the 2x2 blocks are
+      // complete (the same averages as the scalar version)
+      for (; x+4<=rc.w/2; x+=4) {
+	__m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2*x));
+	__m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2*x + 4));
+	__m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2*x));
+	__m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2*x + 4));
+	__m128 v0 = _mm_castsi128_ps(_mm_avg_epu8(a0, b0));
+	__m128 v1 = _mm_castsi128_ps(_mm_avg_epu8(a1, b1));
+	__m128i even = _mm_castps_si128(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0)));
+	__m128i odd = _mm_castps_si128(_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1)));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(d + x), _mm_avg_epu8(even, odd));
+      }
+#endif
+
+      for (; x<w; ++x) {
+	int sx0 = 2*x;
+	int sx1 = min_value(2*x+1, rc.w-1);
+	d[x] = average(average(row0[sx0], row1[sx0]),
+		       average(row0[sx1], row1[sx1]));
+      }
+    }
+  }
+
+}
+
+/**
+   Creates the pyramid for the @a source image. The levels are not
+   created until they are needed.
+
+   @param tileSize
+     Width and height of each tile (it is rounded up to an even
+     number, so each tile is made from whole tiles of the level
+     below).
+
+   @param threads
+     Number of background threads that create the tiles (zero means
+     one for each processor).
+*/
+ImagePyramid::ImagePyramid(const ImagePixels& source, int tileSize, int threads)
+  : m_source(source)
+  , m_tileSize((max_value(tileSize, 16) + 1) & ~1)
+  , m_building(0)
+  , m_builtTiles(0)
+  , m_stop(false)
+{
+  Size size = source.getSize();
+  for (;;) {
+    Level level;
+    level.size = size;
+    level.cols = (size.w + m_tileSize - 1) / m_tileSize;
+    level.rows = (size.h + m_tileSize - 1) / m_tileSize;
+    level.states.resize(level.cols * level.rows, m_levels.empty() ? Ready: Missing);
+    if (!m_levels.empty())
+      level.tiles.resize(level.cols * level.rows);
+    m_levels.push_back(level);
+
+    if (size.w <= m_tileSize && size.h <= m_tileSize)
+      break;
+
+    size = Size((size.w+1)/2, (size.h+1)/2);
+  }
+
+  if (threads <= 0)
+    threads = System::getProcessorCount();
+
+  for (int i=0; i<threads; ++i)
+    m_workers.push_back(std::make_unique<Thread>([this] { workerLoop(); }));
+}
+
+/**
+   Stops the background threads (the tiles that are being created
+   are finished).
+*/
+ImagePyramid::~ImagePyramid()
+{
+  {
+    ScopedLock hold(m_mutex);
+    m_stop = true;
+    m_jobs.clear();
+    m_jobsCond.notifyAll();
+  }
+
+  for (auto& worker : m_workers)
+    worker->join();
+}
+
+/**
+   Returns the size of the original image.
+*/
+Size ImagePyramid::getSize() const
+{
+  return m_levels[0].size;
+}
+
+int ImagePyramid::getTileSize() const
+{
+  return m_tileSize;
+}
+
+/**
+   Returns the number of levels, including the original image (the
+   level 0). The last level fits in one tile.
+*/
+int ImagePyramid::getLevelCount() const
+{
+  return static_cast<int>(m_levels.size());
+}
+
+Size ImagePyramid::getLevelSize(int level) const
+{
+  assert(level >= 0 && level < getLevelCount());
+  return m_levels[level].size;
+}
+
+/**
+   Returns the level that should be used to show the image at the
+   specified @a zoom (1.0 is the original size). It is the smallest
+   level that isn't smaller than the zoomed image, so the level is
+   never enlarged more than necessary.
+*/
+int ImagePyramid::getLevelForZoom(double zoom) const
+{
+  if (zoom >= 1.0)
+    return 0;
+  if (zoom <= 0.0)
+    return getLevelCount()-1;
+
+  int level = static_cast<int>(std::floor(std::log(1.0 / zoom) / std::log(2.0) + 1e-9));
+  return min_value(level, getLevelCount()-1);
+}
+
+bool ImagePyramid::isTileReady(int level, int col, int row)
+{
+  ScopedLock hold(m_mutex);
+  return tileState(level, col, row) == Ready;
+}
+
+/**
+   Returns the number of tiles created by the background threads
+   (including the tiles of the lower levels needed to create the
+   visible ones).
+*/
+int ImagePyramid::getBuiltTileCount()
+{
+  ScopedLock hold(m_mutex);
+  return m_builtTiles;
+}
+
+/**
+   Returns the tiles to paint the @a viewport of the image at the
+   specified @a zoom.
+
+   Tiles of the best level for the @a zoom that are not created yet
+   are queued for the background threads (and the tiles queued in
+   previous calls that weren't started are discarded, as they
+   aren't visible anymore). Meanwhile, the area of those tiles is
+   taken from the nearest coarser level that is ready, or from the
+   original image if there isn't one (the tile has @a exact = false), and the TileReady signal is generated when the tile is
+   available.
+
+   @param viewport
+     The visible area of the zoomed image (i.e. the image is
+     @a zoom times its original size, and its top-left corner is at
+     0,0).
+
+   @param tiles
+     The tiles to paint. PyramidTile#dstBounds are relative to the
+     @a viewport origin, and adjacent tiles don't have gaps between
+     them. The pointers are valid while the pyramid exists.
+*/
+void ImagePyramid::getVisibleTiles(double zoom, const Rect& viewport,
+				   std::vector<PyramidTile>& tiles)
+{
+  tiles.clear();
+  if (zoom <= 0.0 || viewport.isEmpty())
+    return;
+
+  const int k = getLevelForZoom(zoom);
+  const int last = getLevelCount()-1;
+  const Level& level = m_levels[k];
+  const double scale = zoom * (1 << k); // viewport pixels per level pixel
+
+  int x0 = max_value(0, static_cast<int>(std::floor(viewport.x / scale)));
+  int y0 = max_value(0, static_cast<int>(std::floor(viewport.y / scale)));
+  int x1 = min_value(level.size.w, static_cast<int>(std::ceil((viewport.x+viewport.w) / scale)));
+  int y1 = min_value(level.size.h, static_cast<int>(std::ceil((viewport.y+viewport.h) / scale)));
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  ScopedLock hold(m_mutex);
+
+  // forget the tiles queued by the previous call
+  for (auto& job : m_jobs) {
+    char& state = tileState(job.level, job.col, job.row);
+    if (state == Queued)
+      state = Missing;
+  }
+  m_jobs.clear();
+
+  for (int row=y0/m_tileSize; row<=(y1-1)/m_tileSize; ++row) {
+    for (int col=x0/m_tileSize; col<=(x1-1)/m_tileSize; ++col) {
+      Rect bounds = getTileBounds(k, col, row);
+      PyramidTile tile;
+
+      // round the edges in the same way for adjacent tiles
+      int dx0 = static_cast<int>(std::floor(bounds.x * scale + 0.5));
+      int dy0 = static_cast<int>(std::floor(bounds.y * scale + 0.5));
+      int dx1 = static_cast<int>(std::floor((bounds.x+bounds.w) * scale + 0.5));
+      int dy1 = static_cast<int>(std::floor((bounds.y+bounds.h) * scale + 0.5));
+      tile.dstBounds = Rect(dx0 - viewport.x, dy0 - viewport.y, dx1 - dx0, dy1 - dy0);
+
+      if (tileState(k, col, row) == Ready) {
+	if (k == 0) {
+	  tile.pixels = &m_source;
+	  tile.srcBounds = bounds;
+	}
+	else {
+	  tile.pixels = &tilePixels(k, col, row);
+	  tile.srcBounds = Rect(bounds.getSize());
+	}
+	tile.level = k;
+	tile.exact = true;
+      }
+      else {
+	queueTile(k, col, row);
+
+	tile.pixels = NULL;
+	tile.exact = false;
+	for (int j=k+1; j<=last; ++j) {
+	  int shift = j - k;
+	  if (tileState(j, col >> shift, row >> shift) == Ready) {
+	    const Level& coarse = m_levels[j];
+	    int sx0 = bounds.x >> shift;
+	    int sy0 = bounds.y >> shift;
+	    int sx1 = min_value(coarse.size.w, (bounds.x + bounds.w + (1 << shift) - 1) >> shift);
+	    int sy1 = min_value(coarse.size.h, (bounds.y + bounds.h + (1 << shift) - 1) >> shift);
+
+	    // the area is inside the coarse tile (relative to its origin)
+	    Rect coarseTile = getTileBounds(j, col >> shift, row >> shift);
+	    tile.pixels = &tilePixels(j, col >> shift, row >> shift);
+	    tile.srcBounds = Rect(sx0 - coarseTile.x, sy0 - coarseTile.y, sx1 - sx0, sy1 - sy0);
+	    tile.level = j;
+	    break;
+	  }
+	}
+	// or the original image
+	if (!tile.pixels) {
+	  int sx0 = bounds.x << k;
+	  int sy0 = bounds.y << k;
+
+	  tile.pixels = &m_source;
+	  tile.srcBounds = Rect(sx0, sy0,
+				min_value(bounds.w << k, m_levels[0].size.w - sx0),
+				min_value(bounds.h << k, m_levels[0].size.h - sy0));
+	  tile.level = 0;
+	}
+      }
+
+      tiles.push_back(tile);
+    }
+  }
+
+  if (!m_jobs.empty())
+    m_jobsCond.notifyAll();
+}
+
+/**
+   Waits until the background threads create all the queued tiles.
+*/
+void ImagePyramid::waitIdle()
+{
+  ScopedLock hold(m_mutex);
+  m_readyCond.wait(hold, [this] { return m_jobs.empty() && m_building == 0; });
+}
+
+void ImagePyramid::workerLoop()
+{
+  ScopedLock hold(m_mutex);
+
+  for (;;) {
+    m_jobsCond.wait(hold, [this] { return m_stop || !m_jobs.empty(); });
+    if (m_stop)
+      break;
+
+    Job job = m_jobs.front();
+    m_jobs.pop_front();
+
+    // the tile could be discarded or created as a dependency of
+    // other tile
+    char& state = tileState(job.level, job.col, job.row);
+    if (state == Queued) {
+      state = Building;
+      ++m_building;
+      buildTile(hold, job.level, job.col, job.row);
+      --m_building;
+
+      ScopedUnlock unlock(hold);
+      TileReady(job.level, job.col, job.row);
+    }
+
+    m_readyCond.notifyAll();
+  }
+}
+
+// Creates the tile (its state must be Building), and the tiles of
+// the lower levels that it needs. The mutex is locked.
+void ImagePyramid::buildTile(ScopedLock& lock, int level, int col, int row)
+{
+  assert(level > 0);
+
+  if (level > 1) {
+    const Level& below = m_levels[level-1];
+
+    for (int r=2*row; r<min_value(2*row+2, below.rows); ++r) {
+      for (int c=2*col; c<min_value(2*col+2, below.cols); ++c) {
+	char& state = tileState(level-1, c, r);
+	if (state == Missing || state == Queued) {
+	  state = Building;
+	  buildTile(lock, level-1, c, r);
+	}
+	else if (state == Building) {
+	  // other thread is creating it
+	  m_readyCond.wait(lock, [&] { return tileState(level-1, c, r) == Ready; });
+	}
+      }
+    }
+  }
+
+  // the pixels are allocated and calculated without the lock (the
+  // tiles of the level below are ready, so they aren't modified)
+  Rect bounds = getTileBounds(level, col, row);
+  ImagePixels pixels;
+  {
+    ScopedUnlock unlock(lock);
+    pixels = ImagePixels(bounds.getSize());
+
+    if (level == 1) {
+      const Size& size = m_levels[0].size;
+      downsample(m_source, Rect(2*bounds.x, 2*bounds.y,
+				min_value(2*bounds.w, size.w - 2*bounds.x),
+				min_value(2*bounds.h, size.h - 2*bounds.y)),
+		 pixels, Point(0, 0));
+    }
+    else {
+      const Level& below = m_levels[level-1];
+      const int half = m_tileSize/2;
+
+      for (int r=2*row; r<min_value(2*row+2, below.rows); ++r)
+	for (int c=2*col; c<min_value(2*col+2, below.cols); ++c) {
+	  const ImagePixels& src = below.tiles[r*below.cols + c];
+	  downsample(src, Rect(src.getSize()),
+		     pixels, Point((c - 2*col)*half, (r - 2*row)*half));
+	}
+    }
+  }
+
+  tilePixels(level, col, row) = pixels;
+  tileState(level, col, row) = Ready;
+  ++m_builtTiles;
+  m_readyCond.notifyAll();
+}
+
+// Queues the tile if it isn't created yet. The mutex is locked.
+void ImagePyramid::queueTile(int level, int col, int row)
+{
+  char& state = tileState(level, col, row);
+  if (state == Missing) {
+    state = Queued;
+
+    Job job = { level, col, row };
+    m_jobs.push_back(job);
+  }
+}
+
+Rect ImagePyramid::getTileBounds(int level, int col, int row) const
+{
+  const Level& l = m_levels[level];
+  int x = col * m_tileSize;
+  int y = row * m_tileSize;
+  return Rect(x, y,
+	      min_value(m_tileSize, l.size.w - x),
+	      min_value(m_tileSize, l.size.h - y));
+}
+
+ImagePixels& ImagePyramid::tilePixels(int level, int col, int row)
+{
+  Level& l = m_levels[level];
+  assert(level > 0);
+  assert(col >= 0 && col < l.cols && row >= 0 && row < l.rows);
+  return l.tiles[row*l.cols + col];
+}
+
+char& ImagePyramid::tileState(int level, int col, int row)
+{
+  Level& l = m_levels[level];
+  assert(col >= 0 && col < l.cols && row >= 0 && row < l.rows);
+  return l.states[row*l.cols + col];
+}
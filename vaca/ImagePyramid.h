@@ -0,0 +1,120 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_IMAGEPYRAMID_H
+#define VACA_IMAGEPYRAMID_H
+
+#include "vaca/base.h"
+#include "vaca/NonCopyable.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/Mutex.h"
+#include "vaca/ScopedLock.h"
+#include "vaca/ConditionVariable.h"
+#include "vaca/Signal.h"
+#include "vaca/Rect.h"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace vaca {
+
+/**
+   A tile of an ImagePyramid that must be painted to show a viewport.
+
+   @see ImagePyramid#getVisibleTiles
+*/
+struct PyramidTile
+{
+  const ImagePixels* pixels;	///< Pixels of the tile of the level (or the original image for the level 0).
+  Rect srcBounds;		///< Area of @a pixels to be painted.
+  Rect dstBounds;		///< Where to paint it (in viewport coordinates).
+  int level;			///< Level of @a pixels.
+  bool exact;			///< False if it is a coarser level (the wanted one isn't ready yet).
+};
+
+/**
+   A mipmapped image to show big images at any zoom level.
+
+   The pyramid has the original image as level 0, and each level is
+   the previous one downsampled at half its size, until the whole
+   image fits in one tile. Levels are divided in tiles of
+   @a tileSize x @a tileSize pixels which are created in background
+   threads only when they are visible (see #getVisibleTiles), so
+   panning and zooming a huge image only touches the tiles on the
+   screen. Each tile has its own pixels, so the memory used by a
+   level grows with the number of created tiles.
+
+   Example:
+   @code
+   std::vector<PyramidTile> tiles;
+   pyramid.getVisibleTiles(zoom, viewport, tiles);
+   for (auto& tile : tiles)
+     ... paint tile.srcBounds of *tile.pixels in tile.dstBounds ...
+   @endcode
+
+   The source image must not be modified while the pyramid exists.
+*/
+class VACA_DLL ImagePyramid : private NonCopyable
+{
+  enum TileState { Missing, Queued, Building, Ready };
+
+  struct Level
+  {
+    Size size;
+    int cols, rows;
+    std::vector<ImagePixels> tiles;
+    std::vector<char> states;
+  };
+
+  struct Job
+  {
+    int level, col, row;
+  };
+
+  ImagePixels m_source;
+  int m_tileSize;
+  std::vector<Level> m_levels;
+  std::deque<Job> m_jobs;
+  int m_building;
+  int m_builtTiles;
+  bool m_stop;
+  Mutex m_mutex;
+  ConditionVariable m_jobsCond;
+  ConditionVariable m_readyCond;
+  std::vector<std::unique_ptr<Thread> > m_workers;
+
+public:
+  ImagePyramid(const ImagePixels& source, int tileSize = 256, int threads = 0);
+  virtual ~ImagePyramid();
+
+  Size getSize() const;
+  int getTileSize() const;
+  int getLevelCount() const;
+  Size getLevelSize(int level) const;
+  int getLevelForZoom(double zoom) const;
+  bool isTileReady(int level, int col, int row);
+  int getBuiltTileCount();
+
+  void getVisibleTiles(double zoom, const Rect& viewport,
+		       std::vector<PyramidTile>& tiles);
+  void waitIdle();
+
+  // Signals
+  Signal<void(int, int, int)> TileReady; ///< Called from a worker thread (level, col, row).
+
+private:
+  void workerLoop();
+  void buildTile(ScopedLock& lock, int level, int col, int row);
+  void queueTile(int level, int col, int row);
+  Rect getTileBounds(int level, int col, int row) const;
+  char& tileState(int level, int col, int row);
+  ImagePixels& tilePixels(int level, int col, int row);
+};
+
+} // namespace vaca
+
+#endif // VACA_IMAGEPYRAMID_H
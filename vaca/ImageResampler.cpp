@@ -0,0 +1,133 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/ImageResampler.h"
+#include "vaca/FilterWeights.h"
+#include "vaca/ParallelFor.h"
+
+#include <cmath>
+
+using namespace vaca;
+
+namespace {
+
+  const double pi = 3.14159265358979323846;
+
+  // Minimum number of scanlines to be processed by each thread
+  const int scanlines_per_thread = 32;
+
+  double box_kernel(double x)
+  {
+    return (x > -0.5 && x <= 0.5) ? 1.0: 0.0;
+  }
+
+  double bilinear_kernel(double x)
+  {
+    x = std::fabs(x);
+    return x < 1.0 ? 1.0 - x: 0.0;
+  }
+
+  // Catmull-Rom spline (a = -0.5)
+  double bicubic_kernel(double x)
+  {
+    const double a = -0.5;
+    x = std::fabs(x);
+    if (x < 1.0)
+      return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+    else if (x < 2.0)
+      return (((x - 5.0) * x + 8.0) * x - 4.0) * a;
+    else
+      return 0.0;
+  }
+
+  double sinc(double x)
+  {
+    if (x == 0.0)
+      return 1.0;
+    x *= pi;
+    return std::sin(x) / x;
+  }
+
+  // Lanczos with three lobes
+  double lanczos_kernel(double x)
+  {
+    return (x > -3.0 && x < 3.0) ? sinc(x) * sinc(x/3.0): 0.0;
+  }
+
+} // anonymous namespace
+
+/**
+   Creates a resampler that uses the specified @a filter.
+*/
+ImageResampler::ImageResampler(ResampleFilter filter)
+  : m_filter(filter)
+{
+}
+
+ImageResampler::~ImageResampler()
+{
+}
+
+ResampleFilter ImageResampler::getFilter() const
+{
+  return m_filter;
+}
+
+void ImageResampler::setFilter(ResampleFilter filter)
+{
+  m_filter = filter;
+}
+
+/**
+   Returns a new ImagePixels of the specified @a size with the
+   content of @a src resized.
+
+   The original @a src is not modified. If @a size is equal to the
+   @a src size, a copy of @a src is returned.
+*/
+ImagePixels ImageResampler::resample(const ImagePixels& src, const Size& size) const
+{
+  return resample(src, size.w, size.h);
+}
+
+ImagePixels ImageResampler::resample(const ImagePixels& src, int width, int height) const
+{
+  assert(width >= 0 && height >= 0);
+
+  ImagePixels dst(width, height);
+  if (width == 0 || height == 0 ||
+      src.getWidth() == 0 || src.getHeight() == 0)
+    return dst;
+
+  double (*kernel)(double) = NULL;
+  double support = 0.0;
+
+  switch (m_filter) {
+    case ResampleFilter::Box:      kernel = box_kernel;      support = 0.5; break;
+    case ResampleFilter::Bilinear: kernel = bilinear_kernel; support = 1.0; break;
+    case ResampleFilter::Bicubic:  kernel = bicubic_kernel;  support = 2.0; break;
+    case ResampleFilter::Lanczos:  kernel = lanczos_kernel;  support = 3.0; break;
+  }
+
+  FilterWeights horz, vert;
+  horz.initResample(src.getWidth(), width, kernel, support);
+  vert.initResample(src.getHeight(), height, kernel, support);
+
+  // horizontal pass: from "src" to "tmp" (width x src.getHeight())
+  ImagePixels tmp(width, src.getHeight());
+  parallel_for(0, tmp.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 horz.filterRows(src, tmp, y0, y1);
+	       });
+
+  // vertical pass: from "tmp" to "dst" (width x height)
+  parallel_for(0, height, scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 vert.filterColumns(tmp, dst, y0, y1);
+	       });
+
+  return dst;
+}
@@ -0,0 +1,68 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_IMAGERESAMPLER_H
+#define VACA_IMAGERESAMPLER_H
+
+#include "vaca/base.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/Size.h"
+
+namespace vaca {
+
+/**
+   Filter used to calculate the pixels of a resized image.
+
+   One of the following values:
+   @li ResampleFilter::Box (nearest pixels average, fastest)
+   @li ResampleFilter::Bilinear (default)
+   @li ResampleFilter::Bicubic
+   @li ResampleFilter::Lanczos (sharpest, slowest)
+*/
+enum class ResampleFilter
+{
+  Box,
+  Bilinear,
+  Bicubic,
+  Lanczos,
+};
+
+/**
+   Resizes ImagePixels using a separable filter.
+
+   The image is resized in two passes (one horizontal, and one
+   vertical), and each pass is split in bands of scanlines that are
+   processed by all the processors of the computer.
+
+   Example:
+   @code
+   ImagePixels pixels = image.getPixels();
+   ImageResampler resampler(ResampleFilter::Lanczos);
+   ImagePixels thumbnail = resampler.resample(pixels, Size(128, 96));
+   @endcode
+
+   @see ResampleFilter
+*/
+class VACA_DLL ImageResampler
+{
+  ResampleFilter m_filter;
+
+public:
+
+  ImageResampler(ResampleFilter filter = ResampleFilter::Bilinear);
+  virtual ~ImageResampler();
+
+  ResampleFilter getFilter() const;
+  void setFilter(ResampleFilter filter);
+
+  ImagePixels resample(const ImagePixels& src, const Size& size) const;
+  ImagePixels resample(const ImagePixels& src, int width, int height) const;
+
+};
+
+} // namespace vaca
+
+#endif // VACA_IMAGERESAMPLER_H
@@ -0,0 +1,73 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/ParallelFor.h"
+#include "vaca/System.h"
+#include "vaca/Thread.h"
+
+#include <memory>
+#include <vector>
+
+using namespace vaca;
+
+/**
+   Splits the range [@a begin, @a end) in contiguous chunks and calls
+   @a f(chunkBegin, chunkEnd) for each one of them in a different
+   thread.
+
+   The current thread processes the last chunk, and the function
+   returns when all chunks were processed. If the range is smaller
+   than two @a grain units (or the computer has just one processor)
+   @a f is called just one time in the current thread.
+
+   Example:
+   @code
+   parallel_for(0, pixels.getHeight(), 64,
+		[&](int y0, int y1) {
+		  for (int y=y0; y<y1; ++y)
+		    process_scanline(pixels, y);
+		});
+   @endcode
+
+   @param grain
+     Minimum number of elements that a thread should process, so
+     small ranges are not split in more threads than necessary.
+
+   @warning @a f must not throw exceptions.
+
+   @see System#getProcessorCount
+*/
+void vaca::parallel_for(int begin, int end, int grain,
+			const std::function<void(int, int)>& f)
+{
+  int count = end - begin;
+  if (count <= 0)
+    return;
+
+  int workers = (count + max_value(grain, 1) - 1) / max_value(grain, 1);
+  workers = min_value(workers, System::getProcessorCount());
+  if (workers <= 1) {
+    f(begin, end);
+    return;
+  }
+
+  std::vector<std::unique_ptr<Thread> > threads;
+  int chunk = count / workers;
+  int extra = count % workers;
+  int from = begin;
+
+  for (int i=0; i<workers-1; ++i) {
+    int to = from + chunk + (i < extra ? 1: 0);
+    threads.push_back(std::make_unique<Thread>([&f, from, to] { f(from, to); }));
+    from = to;
+  }
+
+  // the last chunk is processed by the current thread
+  f(from, end);
+
+  for (auto& thread : threads)
+    thread->join();
+}
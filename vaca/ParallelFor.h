@@ -0,0 +1,21 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_PARALLELFOR_H
+#define VACA_PARALLELFOR_H
+
+#include "vaca/base.h"
+
+#include <functional>
+
+namespace vaca {
+
+VACA_DLL void parallel_for(int begin, int end, int grain,
+			   const std::function<void(int, int)>& f);
+
+} // namespace vaca
+
+#endif // VACA_PARALLELFOR_H
@@ -0,0 +1,598 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/PathClipper.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace vaca;
+
+namespace {
+
+  inline int round_to_int(double x)
+  {
+    return static_cast<int>(std::floor(x + 0.5));
+  }
+
+  inline bool point_less(const Point& a, const Point& b)
+  {
+    return a.y < b.y || (a.y == b.y && a.x < b.x);
+  }
+
+  inline bool is_inside(int winding, FillRule fillRule)
+  {
+    return (fillRule == FillRule::EvenOdd ? (winding & 1) != 0: winding != 0);
+  }
+
+  inline bool apply(PathOperation operation, bool a, bool b)
+  {
+    switch (operation) {
+      case PathOperation::Union:        return a || b;
+      case PathOperation::Intersection: return a && b;
+      case PathOperation::Difference:   return a && !b;
+      case PathOperation::Xor:          return a != b;
+    }
+    return false;
+  }
+
+  // Two x coordinates closer than this are the same point (where two
+  // edges cross)
+  const double same_x = 1e-6;
+
+  // Returns true if the edge "a" goes more to the left than "b"
+  // (dxa/dya < dxb/dyb, dy is positive)
+  template<typename Edge>
+  inline bool is_steeper_left(const Edge& a, const Edge& b)
+  {
+    return
+      static_cast<long long>(a.x2 - a.x1) * (b.y2 - b.y1) <
+      static_cast<long long>(b.x2 - b.x1) * (a.y2 - a.y1);
+  }
+
+  // Compares edges by their temporary "x" and then by their slope
+  template<typename Edge>
+  struct EdgeLess
+  {
+    const std::vector<Edge>& edges;
+
+    EdgeLess(const std::vector<Edge>& edges) : edges(edges) { }
+
+    bool operator()(int i, int j) const
+    {
+      const Edge& a = edges[i];
+      const Edge& b = edges[j];
+      if (a.x != b.x)
+	return a.x < b.x;
+      return is_steeper_left(a, b);
+    }
+  };
+
+  // Sorts the edges from left to right using their temporary "x", and
+  // the edges that are in the same point (where they cross, with
+  // rounding errors) by their slope, so the order is the one just
+  // below the "x" line
+  template<typename Edge>
+  void sort_edges(std::vector<int>& active, const std::vector<Edge>& edges)
+  {
+    std::sort(active.begin(), active.end(), EdgeLess<Edge>(edges));
+
+    for (size_t i=1; i<active.size(); ++i)
+      for (size_t j=i; j>0; --j) {
+	const Edge& a = edges[active[j-1]];
+	const Edge& b = edges[active[j]];
+	if (b.x - a.x >= same_x || !is_steeper_left(b, a))
+	  break;
+	std::swap(active[j-1], active[j]);
+      }
+  }
+
+  // A vertex of a contour and the source edge of the segment that
+  // starts in it
+  struct Vertex
+  {
+    Point pt;
+    int edge;
+
+    Vertex(const Point& pt, int edge) : pt(pt), edge(edge) { }
+  };
+
+  // Returns true if the vertex "b" can be removed from the contour
+  // a-b-c (it's in the middle of a straight line, of an edge of the
+  // original paths, or it's a spike)
+  bool is_redundant(const Vertex& a, const Vertex& b, const Vertex& c)
+  {
+    if (b.pt == a.pt || b.pt == c.pt)
+      return true;
+
+    if (a.edge >= 0 && a.edge == b.edge)
+      return true;
+
+    long long cross =
+      static_cast<long long>(b.pt.x - a.pt.x) * (c.pt.y - b.pt.y) -
+      static_cast<long long>(b.pt.y - a.pt.y) * (c.pt.x - b.pt.x);
+    return cross == 0;
+  }
+
+  // Removes the redundant vertices of a closed contour
+  void simplify_contour(std::vector<Vertex>& contour)
+  {
+    std::vector<Vertex> result;
+    bool changed = true;
+
+    while (changed && contour.size() >= 3) {
+      changed = false;
+      result.clear();
+
+      for (size_t i=0; i<contour.size(); ++i) {
+	result.push_back(contour[i]);
+
+	while (result.size() >= 3 &&
+	       is_redundant(result[result.size()-3],
+			    result[result.size()-2],
+			    result[result.size()-1])) {
+	  Vertex& a = result[result.size()-3];
+	  const Vertex& b = result[result.size()-2];
+	  if (a.edge != b.edge)
+	    a.edge = -1;
+	  result.erase(result.end()-2);
+	  changed = true;
+	}
+      }
+
+      // the vertices where the contour is closed
+      while (result.size() >= 3 &&
+	     is_redundant(result[result.size()-2], result.back(), result.front())) {
+	Vertex& a = result[result.size()-2];
+	if (a.edge != result.back().edge)
+	  a.edge = -1;
+	result.pop_back();
+	changed = true;
+      }
+      while (result.size() >= 3 &&
+	     is_redundant(result.back(), result.front(), result[1])) {
+	if (result.back().edge != result.front().edge)
+	  result.back().edge = -1;
+	result.erase(result.begin());
+	changed = true;
+      }
+
+      contour.swap(result);
+    }
+  }
+
+}
+
+/**
+   Creates a clipper.
+
+   @param tolerance
+     Maximum distance (in pixels) between the curves of the paths and
+     the lines used to approximate them (see GraphicsPath#flatten).
+*/
+PathClipper::PathClipper(double tolerance)
+  : m_tolerance(tolerance)
+{
+}
+
+PathClipper::~PathClipper()
+{
+}
+
+/**
+   Returns the area of the @a subject path combined with the area of
+   the @a clip path.
+
+   @param fillRule
+     The rule that tells which points are inside each path (open
+     figures are closed, as in Graphics#fillPath).
+*/
+GraphicsPath PathClipper::combine(const GraphicsPath& subject,
+				  const GraphicsPath& clip,
+				  PathOperation operation,
+				  FillRule fillRule)
+{
+  m_edges.clear();
+  m_segments.clear();
+
+  addPath(subject, 0);
+  addPath(clip, 1);
+
+  sweep(operation, fillRule);
+  removeSharedSegments();
+
+  GraphicsPath result;
+  buildContours(result);
+  return result;
+}
+
+/**
+   Adds the non-horizontal edges of the flattened @a path.
+*/
+void PathClipper::addPath(const GraphicsPath& path, int index)
+{
+  GraphicsPath flat = path;
+  flat.flatten(m_tolerance);
+
+  if (flat.empty())
+    return;
+
+  Point start = flat.begin()->getPoint(); // first point of the current figure
+  Point last = start;			   // current point
+
+  for (GraphicsPath::const_iterator it=flat.begin(); it!=flat.end(); ++it) {
+    const Point& pt = it->getPoint();
+
+    // the last edge of a figure goes to its first point
+    if (it->getType() == GraphicsPath::MoveTo) {
+      addEdge(last, start, index);
+      start = pt;
+    }
+    else
+      addEdge(last, pt, index);
+    last = pt;
+
+    // a line after a closed figure starts in the first point of that
+    // figure (like GraphicsPath#contains and PathStroker)
+    if (it->isCloseFigure()) {
+      addEdge(last, start, index);
+      last = start;
+    }
+  }
+  addEdge(last, start, index);
+}
+
+/**
+   Adds the edge from @a a to @a b of the path @a index (horizontal
+   edges are ignored).
+*/
+void PathClipper::addEdge(const Point& a, const Point& b, int index)
+{
+  if (a.y == b.y)
+    return;
+
+  Edge edge;
+  if (a.y < b.y) {
+    edge.x1 = a.x; edge.y1 = a.y;
+    edge.x2 = b.x; edge.y2 = b.y;
+    edge.dir = 1;
+  }
+  else {
+    edge.x1 = b.x; edge.y1 = b.y;
+    edge.x2 = a.x; edge.y2 = a.y;
+    edge.dir = -1;
+  }
+  edge.path = index;
+  edge.x = 0.0;
+  edge.top = edge.bottom = 0;
+  m_edges.push_back(edge);
+}
+
+void PathClipper::addSegment(const Point& a, const Point& b, int edge)
+{
+  if (a == b)
+    return;
+
+  Segment seg;
+  seg.a = a;
+  seg.b = b;
+  seg.edge = (a.y == b.y ? -1: edge);
+  m_segments.push_back(seg);
+}
+
+/**
+   Goes through the beams between the vertices and intersections of
+   the edges, and adds the boundaries of the parts of each beam that
+   are inside the result (trapezoids) as segments.
+*/
+void PathClipper::sweep(PathOperation operation, FillRule fillRule)
+{
+  int count = static_cast<int>(m_edges.size());
+  if (count == 0)
+    return;
+
+  // y coordinates of all vertices
+  std::vector<int> ys;
+  ys.reserve(2*count);
+  for (int i=0; i<count; ++i) {
+    ys.push_back(m_edges[i].y1);
+    ys.push_back(m_edges[i].y2);
+  }
+  std::sort(ys.begin(), ys.end());
+  ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+  // edges sorted by their top
+  std::vector<int> byTop(count);
+  for (int i=0; i<count; ++i)
+    byTop[i] = i;
+  struct TopLess {
+    const std::vector<Edge>& edges;
+    TopLess(const std::vector<Edge>& edges) : edges(edges) { }
+    bool operator()(int i, int j) const { return edges[i].y1 < edges[j].y1; }
+  };
+  std::sort(byTop.begin(), byTop.end(), TopLess(m_edges));
+
+  int next = 0;
+  m_active.clear();
+
+  for (size_t k=0; k+1<ys.size(); ++k) {
+    int top = ys[k];
+    int bottom = ys[k+1];
+
+    // update the list of edges that cross this beam
+    size_t j = 0;
+    for (size_t i=0; i<m_active.size(); ++i)
+      if (m_edges[m_active[i]].y2 > top)
+	m_active[j++] = m_active[i];
+    m_active.resize(j);
+
+    for (; next < count && m_edges[byTop[next]].y1 <= top; ++next) {
+      Edge& edge = m_edges[byTop[next]];
+      edge.top = edge.x1;
+      m_active.push_back(byTop[next]);
+    }
+
+    if (m_active.empty())
+      continue;
+
+    // divide the beam where the edges cross
+    double y = top;
+    while (y < bottom) {
+      for (size_t i=0; i<m_active.size(); ++i)
+	m_edges[m_active[i]].x = getX(m_edges[m_active[i]], y);
+      sort_edges(m_active, m_edges);
+
+      // the first crossing is between two adjacent edges
+      double y2 = bottom;
+      for (size_t i=0; i+1<m_active.size(); ++i) {
+	const Edge& a = m_edges[m_active[i]];
+	const Edge& b = m_edges[m_active[i+1]];
+	double d1 = a.x - b.x;
+	double d2 = getX(a, bottom) - getX(b, bottom);
+	if (d2 > 0.0) {
+	  double yi = y + (bottom - y) * (-d1) / (d2 - d1);
+	  if (yi > y + 1e-9 && yi < y2)
+	    y2 = yi;
+	}
+      }
+
+      // sort the edges in the middle of the beam (where they don't
+      // cross)
+      double middle = (y + y2) / 2.0;
+      for (size_t i=0; i<m_active.size(); ++i)
+	m_edges[m_active[i]].x = getX(m_edges[m_active[i]], middle);
+      sort_edges(m_active, m_edges);
+
+      // round the x of the edges in the bottom of the beam (the edges
+      // that cross there get the same point, so the trapezoids are
+      // never twisted)
+      double prev = 0.0;
+      for (size_t i=0; i<m_active.size(); ++i) {
+	Edge& edge = m_edges[m_active[i]];
+	double x = getX(edge, y2);
+	if (i > 0 && x - prev < same_x)
+	  edge.bottom = m_edges[m_active[i-1]].bottom;
+	else
+	  edge.bottom = round_to_int(x);
+	prev = x;
+      }
+
+      // the parts inside the result
+      int winding[2] = { 0, 0 };
+      bool inside = false;
+      int left = -1;
+      int y1r = round_to_int(y);
+      int y2r = round_to_int(y2);
+
+      for (size_t i=0; i<m_active.size(); ++i) {
+	int index = m_active[i];
+	const Edge& edge = m_edges[index];
+	winding[edge.path] += edge.dir;
+
+	bool state = apply(operation,
+			   is_inside(winding[0], fillRule),
+			   is_inside(winding[1], fillRule));
+	if (state && !inside)
+	  left = index;
+	else if (!state && inside) {
+	  // trapezoid between the "left" and "index" edges (all
+	  // trapezoids have the same orientation)
+	  const Edge& l = m_edges[left];
+	  Point lt(l.top, y1r);
+	  Point lb(l.bottom, y2r);
+	  Point rt(edge.top, y1r);
+	  Point rb(edge.bottom, y2r);
+
+	  addSegment(lt, lb, left);
+	  addSegment(lb, rb, -1);
+	  addSegment(rb, rt, index);
+	  addSegment(rt, lt, -1);
+	}
+	inside = state;
+      }
+
+      for (size_t i=0; i<m_active.size(); ++i)
+	m_edges[m_active[i]].top = m_edges[m_active[i]].bottom;
+      y = y2;
+    }
+  }
+}
+
+/**
+   Removes the segments that are shared by two trapezoids (they go in
+   opposite directions), so only the boundaries of the result remain.
+*/
+void PathClipper::removeSharedSegments()
+{
+  struct Event {
+    int y, x, delta, edge;
+    bool operator<(const Event& other) const {
+      if (y != other.y) return y < other.y;
+      return x < other.x;
+    }
+  };
+
+  std::vector<Event> horizontal;
+  std::vector<Segment> others;
+  others.reserve(m_segments.size());
+
+  for (size_t i=0; i<m_segments.size(); ++i) {
+    const Segment& seg = m_segments[i];
+
+    if (seg.a.y == seg.b.y) {
+      // +1 for segments that go to the right, -1 to the left
+      int sign = (seg.a.x < seg.b.x ? 1: -1);
+      Event e1 = { seg.a.y, min_value(seg.a.x, seg.b.x), sign, -1 };
+      Event e2 = { seg.a.y, max_value(seg.a.x, seg.b.x), -sign, -1 };
+      horizontal.push_back(e1);
+      horizontal.push_back(e2);
+    }
+    else {
+      // all segments between the same points in the same direction
+      Segment canonical = seg;
+      if (point_less(seg.b, seg.a)) {
+	canonical.a = seg.b;
+	canonical.b = seg.a;
+	canonical.edge = -2 - seg.edge;	// reversed (-2 - edge)
+      }
+      others.push_back(canonical);
+    }
+  }
+
+  m_segments.clear();
+
+  // horizontal segments: the sum of the directions in each interval
+  std::sort(horizontal.begin(), horizontal.end());
+  for (size_t i=0; i<horizontal.size(); ) {
+    int y = horizontal[i].y;
+    int sum = 0;
+
+    for (; i<horizontal.size() && horizontal[i].y == y; ) {
+      int x = horizontal[i].x;
+      for (; i<horizontal.size() && horizontal[i].y == y && horizontal[i].x == x; ++i)
+	sum += horizontal[i].delta;
+
+      if (sum != 0 && i<horizontal.size() && horizontal[i].y == y) {
+	Point a(x, y), b(horizontal[i].x, y);
+	for (int n=0; n<std::abs(sum); ++n) {
+	  if (sum > 0)
+	    addSegment(a, b, -1);
+	  else
+	    addSegment(b, a, -1);
+	}
+      }
+    }
+  }
+
+  // other segments: opposite ones are removed
+  struct SegmentLess {
+    bool operator()(const Segment& s, const Segment& t) const {
+      if (s.a != t.a) return point_less(s.a, t.a);
+      return point_less(s.b, t.b);
+    }
+  };
+  std::sort(others.begin(), others.end(), SegmentLess());
+
+  for (size_t i=0; i<others.size(); ) {
+    size_t j = i;
+    int sum = 0;
+    int forward = -1, backward = -1;
+
+    for (; j<others.size() && others[j].a == others[i].a && others[j].b == others[i].b; ++j) {
+      if (others[j].edge >= 0) {
+	++sum;
+	forward = others[j].edge;
+      }
+      else {
+	--sum;
+	backward = -2 - others[j].edge;
+      }
+    }
+
+    for (int n=0; n<std::abs(sum); ++n) {
+      if (sum > 0)
+	addSegment(others[i].a, others[i].b, forward);
+      else
+	addSegment(others[i].b, others[i].a, backward);
+    }
+    i = j;
+  }
+}
+
+/**
+   Joins the segments in closed contours.
+*/
+void PathClipper::buildContours(GraphicsPath& result)
+{
+  int count = static_cast<int>(m_segments.size());
+
+  // segments sorted by their start point
+  struct StartLess {
+    const std::vector<Segment>& segments;
+    StartLess(const std::vector<Segment>& segments) : segments(segments) { }
+    bool operator()(int i, int j) const { return point_less(segments[i].a, segments[j].a); }
+  };
+  std::vector<int> byStart(count);
+  for (int i=0; i<count; ++i)
+    byStart[i] = i;
+  std::sort(byStart.begin(), byStart.end(), StartLess(m_segments));
+
+  std::vector<bool> used(count, false);
+  std::vector<Vertex> contour;
+
+  for (int s=0; s<count; ++s) {
+    if (used[s])
+      continue;
+
+    contour.clear();
+    Point start = m_segments[s].a;
+    int current = s;
+
+    while (current >= 0) {
+      const Segment& seg = m_segments[current];
+      used[current] = true;
+      contour.push_back(Vertex(seg.a, seg.edge));
+
+      if (seg.b == start)
+	break;
+
+      // look for an unused segment that starts where this one ends
+      int lo = 0, hi = count;
+      while (lo < hi) {
+	int mid = (lo + hi) / 2;
+	if (point_less(m_segments[byStart[mid]].a, seg.b))
+	  lo = mid+1;
+	else
+	  hi = mid;
+      }
+
+      current = -1;
+      for (; lo < count && m_segments[byStart[lo]].a == seg.b; ++lo) {
+	if (!used[byStart[lo]]) {
+	  current = byStart[lo];
+	  break;
+	}
+      }
+    }
+
+    simplify_contour(contour);
+    if (contour.size() < 3)
+      continue;
+
+    result.moveTo(contour[0].pt);
+    for (size_t i=1; i<contour.size(); ++i)
+      result.lineTo(contour[i].pt);
+    result.closeFigure();
+  }
+}
+
+/**
+   Returns the x coordinate of the @a edge in the horizontal line @a y.
+*/
+double PathClipper::getX(const Edge& edge, double y) const
+{
+  return edge.x1 + (y - edge.y1) * (edge.x2 - edge.x1) / (edge.y2 - edge.y1);
+}
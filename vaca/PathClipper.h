@@ -0,0 +1,109 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_PATHCLIPPER_H
+#define VACA_PATHCLIPPER_H
+
+#include "vaca/base.h"
+#include "vaca/GraphicsPath.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   Boolean operation between the areas of two paths. One of the
+   following values:
+   @li PathOperation::Union: points inside any of the paths.
+   @li PathOperation::Intersection: points inside both paths.
+   @li PathOperation::Difference: points inside the first path but
+       not inside the second one.
+   @li PathOperation::Xor: points inside only one of the paths.
+
+   @see PathClipper
+*/
+enum class PathOperation
+{
+  Union,
+  Intersection,
+  Difference,
+  Xor
+};
+
+/**
+   Combines the areas filled by two paths (union, intersection,
+   difference or xor) without rasterizing them, so the result is a
+   new path (not a Region of pixels).
+
+   The curves are flattened, and the polygons are processed with a
+   sweep line from top to bottom (like the Vatti clipping algorithm):
+   the plane is divided in horizontal beams where no edges cross or
+   start, so in each beam the edges are sorted from left to right and
+   the winding numbers of both paths tell which parts are inside the
+   result. The boundaries of those parts are joined, and the shared
+   ones removed, to create the contours of the result.
+
+   Coordinates are integers (as in GraphicsPath), the vertices of the
+   paths are kept exactly, and only the points where edges cross are
+   rounded to the nearest pixel.
+
+   The result is a path of closed figures that don't cross each other
+   (outer contours and holes go in opposite directions, and only very
+   thin parts can overlap by less than a pixel after rounding), so it
+   can be filled with any FillRule.
+
+   Example:
+   @code
+   PathClipper clipper;
+   GraphicsPath both = clipper.combine(circle, square, PathOperation::Union);
+   @endcode
+
+   @see GraphicsPath, BandedRegion
+*/
+class VACA_DLL PathClipper
+{
+  struct Edge
+  {
+    int x1, y1, x2, y2;		// y1 < y2
+    int dir;			// +1 if the original edge goes down, -1 if it goes up
+    int path;			// 0 for the subject, 1 for the clip path
+    double x;			// temporary x to sort the edges
+    int top, bottom;		// rounded x in the top and bottom of the current beam
+  };
+
+  struct Segment
+  {
+    Point a, b;
+    int edge;			// source edge (-1 for horizontal segments)
+  };
+
+  double m_tolerance;
+  std::vector<Edge> m_edges;
+  std::vector<int> m_active;
+  std::vector<Segment> m_segments;
+
+public:
+  explicit PathClipper(double tolerance = 0.25);
+  virtual ~PathClipper();
+
+  GraphicsPath combine(const GraphicsPath& subject,
+		       const GraphicsPath& clip,
+		       PathOperation operation,
+		       FillRule fillRule = FillRule::EvenOdd);
+
+private:
+  void addPath(const GraphicsPath& path, int index);
+  void addEdge(const Point& a, const Point& b, int index);
+  void addSegment(const Point& a, const Point& b, int edge);
+  void sweep(PathOperation operation, FillRule fillRule);
+  void removeSharedSegments();
+  void buildContours(GraphicsPath& result);
+  double getX(const Edge& edge, double y) const;
+};
+
+} // namespace vaca
+
+#endif // VACA_PATHCLIPPER_H
@@ -0,0 +1,401 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/PathCodec.h"
+#include "vaca/ParseException.h"
+
+#include <cstring>
+
+using namespace vaca;
+
+namespace {
+
+  const unsigned char signature[4] = { 'V', 'P', 'T', 'H' };
+  const unsigned char version = 1;
+
+  // signature, version, number of nodes and size of the points
+  const size_t fixed_header_size = 4 + 1 + 4 + 4;
+
+  // the bounds (four varints)
+  const size_t max_header_size = fixed_header_size + 4*5;
+
+  // maximum bytes of a varint (32 bits in groups of 7 bits)
+  const int max_varint_size = 5;
+
+  inline unsigned char* write_uint32(unsigned char* p, unsigned value)
+  {
+    p[0] = static_cast<unsigned char>(value);
+    p[1] = static_cast<unsigned char>(value >> 8);
+    p[2] = static_cast<unsigned char>(value >> 16);
+    p[3] = static_cast<unsigned char>(value >> 24);
+    return p+4;
+  }
+
+  inline unsigned read_uint32(const unsigned char* p)
+  {
+    return
+      (static_cast<unsigned>(p[0])) |
+      (static_cast<unsigned>(p[1]) << 8) |
+      (static_cast<unsigned>(p[2]) << 16) |
+      (static_cast<unsigned>(p[3]) << 24);
+  }
+
+  // Signed values are saved in "zigzag" order (0, -1, 1, -2, 2...)
+  // so small negative differences use only one byte too
+  inline unsigned zigzag(unsigned value)
+  {
+    return (value << 1) ^ (0u - (value >> 31));
+  }
+
+  inline unsigned unzigzag(unsigned value)
+  {
+    return (value >> 1) ^ (0u - (value & 1));
+  }
+
+  inline unsigned char* write_varint(unsigned char* p, unsigned value)
+  {
+    while (value >= 0x80) {
+      *p++ = static_cast<unsigned char>(value | 0x80);
+      value >>= 7;
+    }
+    *p++ = static_cast<unsigned char>(value);
+    return p;
+  }
+
+  // Reads a varint that was already checked
+  inline const unsigned char* read_varint(const unsigned char* p, unsigned& value)
+  {
+    unsigned result = *p++;
+    if (result >= 0x80) {
+      unsigned byte;
+      int shift = 7;
+      result &= 0x7f;
+      do {
+	byte = *p++;
+	result |= (byte & 0x7f) << shift;
+	shift += 7;
+      } while (byte >= 0x80);
+    }
+    value = result;
+    return p;
+  }
+
+  // Reads a varint checking the end of the data
+  bool read_checked_varint(const unsigned char*& p, const unsigned char* end, unsigned& value)
+  {
+    unsigned result = 0;
+    for (int i=0; i<max_varint_size; ++i) {
+      if (p == end)
+	return false;
+
+      unsigned byte = *p++;
+      result |= (byte & 0x7f) << (7*i);
+      if (byte < 0x80) {
+	value = result;
+	return true;
+      }
+    }
+    return false;
+  }
+
+  void throw_error(const String& message, const unsigned char* p, const unsigned char* data)
+  {
+    throw ParseException(message, -1, -1, static_cast<int>(p - data));
+  }
+
+}
+
+/**
+   Returns the maximum number of bytes that #encode can add for
+   @a path.
+*/
+size_t PathCodec::getMaxEncodedSize(const GraphicsPath& path)
+{
+  size_t count = path.size();
+  return max_header_size + (count+1)/2 + count*2*max_varint_size;
+}
+
+/**
+   Adds the encoded @a path at the end of @a data (so many paths can be
+   saved in the same buffer).
+*/
+void PathCodec::encode(const GraphicsPath& path, std::vector<unsigned char>& data)
+{
+  unsigned count = path.size();
+  size_t start = data.size();
+  data.resize(start + getMaxEncodedSize(path));
+
+  unsigned char* header = &data[start];
+  unsigned char* p = header;
+  for (int i=0; i<4; ++i)
+    *p++ = signature[i];
+  *p++ = version;
+  p = write_uint32(p, count);
+  unsigned char* pointsSize = p;	// it's known at the end
+  p += 4;
+
+  // the bounds are known after the points, so the types and points
+  // are written after the maximum size of the bounds, and moved back
+  // when the bounds are saved
+  unsigned char* boundsPos = p;
+  p += 4*max_varint_size;
+
+  // types of the nodes (two per byte, the first one in the low bits)
+  GraphicsPath::const_iterator it, end = path.end();
+  unsigned char* types = p;
+  unsigned i = 0;
+  for (it=path.begin(); it!=end; ++it, ++i) {
+    unsigned flags = it->getType() | (it->isCloseFigure() ? GraphicsPath::CloseFigure: 0);
+    if ((i & 1) == 0)
+      *p = static_cast<unsigned char>(flags);
+    else
+      *p++ |= static_cast<unsigned char>(flags << 4);
+  }
+  if (count & 1)
+    ++p;
+
+  // points (differences with the previous one), the bounds include
+  // the control points of curves (GraphicsPath#getBounds would
+  // flatten the whole path)
+  unsigned char* points = p;
+  unsigned x = 0, y = 0;
+  Point p1, p2;
+  if (count > 0)
+    p1 = p2 = path.begin()->getPoint();
+  for (it=path.begin(); it!=end; ++it) {
+    const Point& pt = it->getPoint();
+    p1.x = min_value(p1.x, pt.x);
+    p1.y = min_value(p1.y, pt.y);
+    p2.x = max_value(p2.x, pt.x);
+    p2.y = max_value(p2.y, pt.y);
+
+    unsigned newX = static_cast<unsigned>(pt.x);
+    unsigned newY = static_cast<unsigned>(pt.y);
+    p = write_varint(p, zigzag(newX - x));
+    p = write_varint(p, zigzag(newY - y));
+    x = newX;
+    y = newY;
+  }
+  write_uint32(pointsSize, static_cast<unsigned>(p - points));
+
+  Rect bounds = count > 0 ? Rect(p1, p2): Rect();
+  unsigned char* q = boundsPos;
+  q = write_varint(q, zigzag(bounds.x));
+  q = write_varint(q, zigzag(bounds.y));
+  q = write_varint(q, bounds.w);
+  q = write_varint(q, bounds.h);
+  std::memmove(q, types, p - types);
+  p -= types - q;
+
+  data.resize(start + (p - header));
+}
+
+/**
+   Replaces the nodes of @a path with the nodes encoded in @a data.
+
+   @throw ParseException
+     If the data is not a valid encoded path.
+*/
+void PathCodec::decode(const unsigned char* data, size_t size, GraphicsPath& path)
+{
+  PathView(data, size).toPath(path);
+}
+
+// ======================================================================
+// PathView
+
+/**
+   Creates a view of the path encoded at the beginning of @a data
+   (bytes after the path are ignored, see #getDataSize).
+
+   @throw ParseException
+     If the data is not a valid encoded path (it's truncated, or it has
+     unknown node types, or incomplete curves).
+*/
+PathView::PathView(const unsigned char* data, size_t size)
+{
+  const unsigned char* end = data + size;
+  const unsigned char* p = data;
+
+  if (size < fixed_header_size)
+    throw_error(L"Incomplete path header", end, data);
+
+  for (int i=0; i<4; ++i)
+    if (p[i] != signature[i])
+      throw_error(L"Invalid path signature", p+i, data);
+  p += 4;
+
+  if (*p != version)
+    throw_error(L"Unknown path version", p, data);
+  ++p;
+
+  m_size = read_uint32(p);
+  unsigned pointsSize = read_uint32(p+4);
+  p += 8;
+
+  unsigned bounds[4];
+  for (int i=0; i<4; ++i)
+    if (!read_checked_varint(p, end, bounds[i]))
+      throw_error(L"Incomplete path header", p, data);
+  m_bounds = Rect(static_cast<int>(unzigzag(bounds[0])),
+		  static_cast<int>(unzigzag(bounds[1])),
+		  static_cast<int>(bounds[2]),
+		  static_cast<int>(bounds[3]));
+
+  size_t typesSize = (static_cast<size_t>(m_size)+1) / 2;
+  if (typesSize > static_cast<size_t>(end - p) ||
+      pointsSize > static_cast<size_t>(end - p) - typesSize)
+    throw_error(L"Incomplete path data", end, data);
+
+  m_types = p;
+  m_points = p + typesSize;
+  m_dataSize = (m_points + pointsSize) - data;
+
+  // check the types of the nodes, and that curves are complete
+  int expected = 0;		// next type of a curve, or 0 if the last node isn't a curve
+  for (unsigned i=0; i<m_size; ++i) {
+    int type = (m_types[i/2] >> (4*(i&1))) & GraphicsPath::TypeMask;
+
+    if (type < GraphicsPath::MoveTo || type > GraphicsPath::BezierTo)
+      throw_error(L"Invalid path node type", m_types + i/2, data);
+
+    if (expected != 0 && type != expected)
+      throw_error(L"Incomplete path curve", m_types + i/2, data);
+
+    switch (type) {
+      case GraphicsPath::BezierControl2:
+	if (expected == 0)
+	  throw_error(L"Incomplete path curve", m_types + i/2, data);
+	expected = GraphicsPath::BezierTo;
+	break;
+      case GraphicsPath::BezierControl1:
+	expected = GraphicsPath::BezierControl2;
+	break;
+      case GraphicsPath::BezierTo:
+	if (expected == 0)
+	  throw_error(L"Incomplete path curve", m_types + i/2, data);
+	expected = 0;
+	break;
+    }
+  }
+  if (expected != 0)
+    throw_error(L"Incomplete path curve", m_points, data);
+  if ((m_size & 1) && (m_types[m_size/2] >> 4) != 0)
+    throw_error(L"Invalid path node type", m_types + m_size/2, data);
+
+  // check that the points are 2*m_size varints (each one of
+  // max_varint_size bytes at most)
+  unsigned varints = 0;
+  int length = 0;
+  for (p=m_points; p!=m_points+pointsSize; ++p) {
+    if (*p >= 0x80) {
+      if (++length == max_varint_size)
+	throw_error(L"Invalid path point", p, data);
+    }
+    else {
+      length = 0;
+      ++varints;
+    }
+  }
+  if (varints != 2*m_size || length != 0)
+    throw_error(L"Invalid number of path points", p, data);
+}
+
+bool PathView::empty() const
+{
+  return m_size == 0;
+}
+
+/**
+   Returns the number of nodes.
+*/
+unsigned PathView::size() const
+{
+  return m_size;
+}
+
+/**
+   Returns the number of bytes of the encoded path (the offset of the
+   next path if many paths were encoded in the same buffer).
+*/
+size_t PathView::getDataSize() const
+{
+  return m_dataSize;
+}
+
+/**
+   Returns the bounds of the points of the path saved by
+   PathCodec#encode. They include the control points of the curves,
+   so they can be bigger than GraphicsPath#getBounds (which uses the
+   flattened curves), but they always contain them.
+*/
+Rect PathView::getBounds() const
+{
+  return m_bounds;
+}
+
+PathView::const_iterator PathView::begin() const
+{
+  return const_iterator(m_types, m_points, 0, m_size);
+}
+
+PathView::const_iterator PathView::end() const
+{
+  return const_iterator(m_types, m_points, m_size, m_size);
+}
+
+/**
+   Replaces the nodes of @a path with the nodes of the view.
+*/
+void PathView::toPath(GraphicsPath& path) const
+{
+  std::vector<GraphicsPath::Node>& nodes = path.m_nodes;
+  nodes.clear();
+  nodes.reserve(m_size);
+
+  for (const_iterator it=begin(), end=this->end(); it!=end; ++it)
+    nodes.push_back(*it);
+
+  path.invalidateCache();
+}
+
+// ======================================================================
+// PathView::const_iterator
+
+PathView::const_iterator::const_iterator(const unsigned char* types,
+					 const unsigned char* points,
+					 unsigned index, unsigned size)
+  : m_types(types)
+  , m_points(points)
+  , m_index(index)
+  , m_size(size)
+  , m_node(GraphicsPath::MoveTo, Point(0, 0))
+{
+  if (m_index < m_size)
+    decodeNode();
+}
+
+PathView::const_iterator& PathView::const_iterator::operator++()
+{
+  if (++m_index < m_size)
+    decodeNode();
+  return *this;
+}
+
+void PathView::const_iterator::decodeNode()
+{
+  unsigned flags = (m_types[m_index/2] >> (4*(m_index&1)));
+  unsigned dx, dy;
+  m_points = read_varint(m_points, dx);
+  m_points = read_varint(m_points, dy);
+
+  Point pt = m_node.getPoint();
+  pt.x = static_cast<int>(static_cast<unsigned>(pt.x) + unzigzag(dx));
+  pt.y = static_cast<int>(static_cast<unsigned>(pt.y) + unzigzag(dy));
+
+  m_node = GraphicsPath::Node(flags, pt);
+  m_node.setCloseFigure((flags & GraphicsPath::CloseFigure) != 0);
+}
@@ -0,0 +1,116 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_PATHCODEC_H
+#define VACA_PATHCODEC_H
+
+#include "vaca/base.h"
+#include "vaca/GraphicsPath.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   Converts a GraphicsPath to a compact sequence of bytes (to save it
+   in a file, or to copy it to the clipboard) and back.
+
+   The format doesn't depend on the byte order of the machine:
+   @li A header with the "VPTH" signature, the version of the format,
+       the number of nodes, the bounds of the points (with the
+       control points of the curves) and the size of the points.
+   @li The types of the nodes (with the GraphicsPath::CloseFigure
+       flag), two nodes per byte.
+   @li The points, each one as the difference with the previous one
+       (x and y with variable length, 7 bits per byte), so the nodes
+       of a figure usually need two or three bytes instead of the
+       twelve bytes of a GraphicsPath::Node.
+
+   The data is read with a PathView (without copying it).
+
+   Example:
+   @code
+   std::vector<unsigned char> data;
+   PathCodec::encode(path1, data);
+   PathCodec::encode(path2, data);	// the paths are concatenated
+
+   PathView view1(&data[0], data.size());
+   PathView view2(&data[view1.getDataSize()], data.size() - view1.getDataSize());
+   GraphicsPath copy;
+   view2.toPath(copy);
+   @endcode
+
+   @see PathView, GraphicsPath
+*/
+class VACA_DLL PathCodec
+{
+public:
+  static size_t getMaxEncodedSize(const GraphicsPath& path);
+  static void encode(const GraphicsPath& path, std::vector<unsigned char>& data);
+  static void decode(const unsigned char* data, size_t size, GraphicsPath& path);
+};
+
+/**
+   Reads the nodes of a path encoded with PathCodec directly from the
+   encoded data (the data is not copied, so it must exist while the
+   view is used).
+
+   The data is checked when the view is created, so the iterators
+   don't need to check it again. The bounds of the path are in the
+   header, so they don't need to be calculated.
+
+   @see PathCodec
+*/
+class VACA_DLL PathView
+{
+  const unsigned char* m_types;
+  const unsigned char* m_points;
+  unsigned m_size;		// number of nodes
+  size_t m_dataSize;		// bytes used by the encoded path
+  Rect m_bounds;
+
+public:
+
+  /**
+     Iterates the nodes of a PathView decoding each one.
+  */
+  class VACA_DLL const_iterator
+  {
+    friend class PathView;
+    const unsigned char* m_types;
+    const unsigned char* m_points;
+    unsigned m_index;
+    unsigned m_size;
+    GraphicsPath::Node m_node;
+
+    const_iterator(const unsigned char* types, const unsigned char* points,
+		   unsigned index, unsigned size);
+    void decodeNode();
+
+  public:
+    const GraphicsPath::Node& operator*() const { return m_node; }
+    const GraphicsPath::Node* operator->() const { return &m_node; }
+    const_iterator& operator++();
+    bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+    bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+  };
+
+  PathView(const unsigned char* data, size_t size);
+
+  bool empty() const;
+  unsigned size() const;
+  size_t getDataSize() const;
+  Rect getBounds() const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  void toPath(GraphicsPath& path) const;
+};
+
+} // namespace vaca
+
+#endif // VACA_PATHCODEC_H
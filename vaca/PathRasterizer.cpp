@@ -0,0 +1,552 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/PathRasterizer.h"
+#include "vaca/Color.h"
+#include "vaca/GraphicsPath.h"
+#include "vaca/RectF.h"
+#include "vaca/Simd.h"
+
+#include <cmath>
+#include <cstring>
+
+#ifndef M_PI
+#  define M_PI 3.14159265358979323846
+#endif
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  // Maximum distance (in pixels) between the curves and the lines
+  // used to fill them
+  const double curve_tolerance = 0.1;
+
+  // Maximum number of lines to flatten one curve or arc
+  const int max_segments = 10000;
+
+  // Coordinates farther than this are ignored (they can't be
+  // converted to integers)
+  const double max_coordinate = 1e9;
+
+  // Returns a*b/255 rounded to the nearest integer (exact for any
+  // 8-bit a and b)
+  inline int mul_un8(int a, int b)
+  {
+    int t = a*b + 128;
+    return (t + (t >> 8)) >> 8;
+  }
+
+  inline bool is_valid(double value)
+  {
+    return std::abs(value) < max_coordinate; // false for NaN
+  }
+
+  // Converts the accumulated area of a pixel to its coverage (0-255)
+  inline unsigned char coverage_value(float area, bool evenOdd)
+  {
+    float a = std::abs(area);
+    if (evenOdd) {
+      a -= 2.0f * static_cast<float>(static_cast<int>(a * 0.5f));
+      a = min_value(a, 2.0f - a);
+    }
+    else
+      a = min_value(a, 1.0f);
+    return static_cast<unsigned char>(a * 255.0f + 0.5f);
+  }
+
+}
+
+/**
+   Creates a rasterizer for images of the given @a size.
+*/
+PathRasterizer::PathRasterizer(const Size& size)
+  : m_size(max_value(size.w, 0), max_value(size.h, 0))
+  , m_stride(m_size.w + 2)
+  , m_cells(m_stride * m_size.h, 0.0f)
+  , m_coverage(m_size.w)
+  , m_open(false)
+{
+  reset();
+}
+
+PathRasterizer::~PathRasterizer()
+{
+}
+
+Size PathRasterizer::getSize() const
+{
+  return m_size;
+}
+
+/**
+   Returns the bounds of the pixels that can be covered by the added
+   figures.
+*/
+Rect PathRasterizer::getBounds() const
+{
+  if (empty())
+    return Rect();
+
+  return Rect(m_minX, m_minY,
+	      min_value(m_maxX, m_size.w) - m_minX,
+	      m_maxY+1 - m_minY);
+}
+
+/**
+   Returns true if no pixel is covered by the added figures.
+*/
+bool PathRasterizer::empty() const
+{
+  return m_maxY < m_minY;
+}
+
+/**
+   Removes all the figures.
+*/
+void PathRasterizer::clear()
+{
+  for (int y=m_minY; y<=m_maxY; ++y)
+    std::fill(m_cells.begin() + y*m_stride + m_minX,
+	      m_cells.begin() + y*m_stride + m_maxX+1, 0.0f);
+
+  reset();
+}
+
+/**
+   Starts a new figure (the previous one is closed).
+*/
+void PathRasterizer::moveTo(const PointF& pt)
+{
+  closeFigure();
+  m_start = m_last = pt;
+}
+
+void PathRasterizer::lineTo(const PointF& pt)
+{
+  addLine(m_last.x, m_last.y, pt.x, pt.y);
+  m_last = pt;
+  m_open = true;
+}
+
+/**
+   Adds a bezier curve from the current position (it's converted to
+   lines nearer than a tenth of a pixel to the curve).
+*/
+void PathRasterizer::curveTo(const PointF& pt1, const PointF& pt2, const PointF& pt3)
+{
+  double x0 = m_last.x, y0 = m_last.y;
+  double x1 = pt1.x, y1 = pt1.y;
+  double x2 = pt2.x, y2 = pt2.y;
+  double x3 = pt3.x, y3 = pt3.y;
+
+  // the lines are near to the curve when the second differences of
+  // the control points are small
+  double ddx = max_value(std::abs(x0 - 2*x1 + x2), std::abs(x1 - 2*x2 + x3));
+  double ddy = max_value(std::abs(y0 - 2*y1 + y2), std::abs(y1 - 2*y2 + y3));
+  double dd = std::sqrt(ddx*ddx + ddy*ddy);
+  int segments = 1;
+  if (dd > 0.0 && is_valid(dd))
+    segments = clamp_value(static_cast<int>(std::ceil(std::sqrt(0.75 * dd / curve_tolerance))),
+			   1, max_segments);
+
+  for (int i=1; i<=segments; ++i) {
+    double t = static_cast<double>(i) / segments;
+    double s = 1.0 - t;
+    double b0 = s*s*s, b1 = 3*s*s*t, b2 = 3*s*t*t, b3 = t*t*t;
+    lineTo(PointF(static_cast<float>(b0*x0 + b1*x1 + b2*x2 + b3*x3),
+		  static_cast<float>(b0*y0 + b1*y1 + b2*y2 + b3*y3)));
+  }
+}
+
+/**
+   Closes the current figure with a line to its first point. Figures
+   are closed automatically by #moveTo and #fill.
+*/
+void PathRasterizer::closeFigure()
+{
+  if (m_open) {
+    addLine(m_last.x, m_last.y, m_start.x, m_start.y);
+    m_open = false;
+  }
+  m_last = m_start;
+}
+
+/**
+   Adds all the figures of @a path (open figures are closed).
+*/
+void PathRasterizer::addPath(const GraphicsPath& path)
+{
+  GraphicsPath::const_iterator it, end = path.end();
+
+  for (it=path.begin(); it!=end; ++it) {
+    switch (it->getType()) {
+      case GraphicsPath::MoveTo:
+	moveTo(PointF(it->getPoint()));
+	break;
+      case GraphicsPath::BezierControl1:
+	if (end - it >= 3) {
+	  curveTo(PointF(it->getPoint()),
+		  PointF((it+1)->getPoint()),
+		  PointF((it+2)->getPoint()));
+	  it += 2;
+	  break;
+	}
+	// continue as a line
+      default:
+	lineTo(PointF(it->getPoint()));
+	break;
+    }
+    if (it->isCloseFigure())
+      closeFigure();
+  }
+  closeFigure();
+}
+
+void PathRasterizer::addPolygon(const std::vector<PointF>& points)
+{
+  if (points.empty())
+    return;
+
+  moveTo(points[0]);
+  for (size_t i=1; i<points.size(); ++i)
+    lineTo(points[i]);
+  closeFigure();
+}
+
+/**
+   Adds the ellipse inscribed in @a rc.
+*/
+void PathRasterizer::addEllipse(const RectF& rc)
+{
+  addArc(rc, 0.0, 360.0, false);
+}
+
+/**
+   Adds a pie of the ellipse inscribed in @a rc.
+
+   @param startAngle
+     Angle (in degrees) of the first radius, counterclockwise from the
+     right side of the ellipse (as in Graphics#fillPie).
+
+   @param sweepAngle
+     Angle (in degrees) between the first and the last radius.
+*/
+void PathRasterizer::addPie(const RectF& rc, double startAngle, double sweepAngle)
+{
+  addArc(rc, startAngle, sweepAngle, true);
+}
+
+/**
+   Adds the part of the ellipse inscribed in @a rc that is cut by the
+   line between the ends of the arc (as in Graphics#fillChord).
+*/
+void PathRasterizer::addChord(const RectF& rc, double startAngle, double sweepAngle)
+{
+  addArc(rc, startAngle, sweepAngle, false);
+}
+
+/**
+   Fills the figures in @a pixels with anti-aliased edges and removes
+   them from the rasterizer.
+
+   The pixels are not premultiplied: the color is blended over each
+   pixel with an alpha of @a opacity multiplied by the coverage of
+   the pixel.
+*/
+void PathRasterizer::fill(ImagePixels& pixels, const Color& color,
+			  FillRule fillRule, int opacity)
+{
+  closeFigure();
+  if (empty())
+    return;
+  else if (m_coverage.empty()) {
+    clear();
+    return;
+  }
+
+  opacity = clamp_value(opacity, 0, 255);
+
+  int r = color.getR();
+  int g = color.getG();
+  int b = color.getB();
+  pixel_type solid = ImagePixels::makePixel(r, g, b, 255);
+  int scanline = pixels.getScanlineSize();
+  int x1 = m_minX;
+  int x2 = min_value(min_value(m_maxX, m_size.w), pixels.getWidth());
+
+  for (int y=m_minY; y<=m_maxY; ++y) {
+    processScanline(y, fillRule, &m_coverage[0]);
+    if (y >= pixels.getHeight() || x1 >= x2)
+      continue;
+
+    pixel_type* dst = &pixels[y*scanline];
+    for (int x=x1; x<x2; ++x) {
+      int alpha = mul_un8(m_coverage[x], opacity);
+      if (alpha == 0)
+	continue;
+      else if (alpha == 255) {
+	dst[x] = solid;
+	continue;
+      }
+
+      pixel_type d = dst[x];
+      int inv = 255 - alpha;
+      dst[x] = ImagePixels::makePixel
+	(mul_un8(r, alpha) + mul_un8(ImagePixels::getR(d), inv),
+	 mul_un8(g, alpha) + mul_un8(ImagePixels::getG(d), inv),
+	 mul_un8(b, alpha) + mul_un8(ImagePixels::getB(d), inv),
+	 alpha + mul_un8(ImagePixels::getA(d), inv));
+    }
+  }
+
+  reset();
+}
+
+/**
+   Puts in @a coverage the covered area of each pixel (from 0 to 255,
+   @c width*height values) and removes the figures from the
+   rasterizer.
+*/
+void PathRasterizer::getCoverage(std::vector<unsigned char>& coverage, FillRule fillRule)
+{
+  closeFigure();
+
+  coverage.assign(m_size.w * m_size.h, 0);
+  if (coverage.empty()) {
+    clear();
+    return;
+  }
+
+  for (int y=m_minY; y<=m_maxY; ++y)
+    processScanline(y, fillRule, &coverage[y*m_size.w]);
+
+  reset();
+}
+
+/**
+   Adds a figure with the arc of the ellipse inscribed in @a rc, and
+   its center if @a pie is true.
+*/
+void PathRasterizer::addArc(const RectF& rc, double startAngle, double sweepAngle, bool pie)
+{
+  double rx = rc.w / 2.0;
+  double ry = rc.h / 2.0;
+  double cx = rc.x + rx;
+  double cy = rc.y + ry;
+  double radius = max_value(std::abs(rx), std::abs(ry));
+  double start = startAngle * M_PI / 180.0;
+  double sweep = clamp_value(sweepAngle, -360.0, 360.0) * M_PI / 180.0;
+
+  // angle of each line so it's near enough to the arc
+  int segments = 1;
+  if (radius > curve_tolerance && is_valid(radius)) {
+    double step = 2.0 * std::acos(1.0 - curve_tolerance / radius);
+    segments = clamp_value(static_cast<int>(std::ceil(std::abs(sweep) / step)),
+			   1, max_segments);
+  }
+
+  // the vertices between the ends of the arc are a little outside the
+  // ellipse so the polygon has the same area as the ellipse
+  double step = std::abs(sweep) / segments;
+  double scale = 1.0;
+  if (step > 0.0 && step < M_PI)
+    scale = std::sqrt(step / std::sin(step));
+
+  if (pie)
+    moveTo(PointF(static_cast<float>(cx), static_cast<float>(cy)));
+
+  for (int i=0; i<=segments; ++i) {
+    double a = start + sweep * i / segments;
+    double k = (i == 0 || i == segments ? 1.0: scale);
+    PointF pt(static_cast<float>(cx + k*rx*std::cos(a)),
+	      static_cast<float>(cy - k*ry*std::sin(a)));
+    if (i == 0 && !pie)
+      moveTo(pt);
+    else
+      lineTo(pt);
+  }
+
+  closeFigure();
+}
+
+/**
+   Clips the line to the image and adds it to the cells. The parts at
+   the left or at the right of the image are moved to its sides
+   (they still change the winding of the pixels at their right).
+*/
+void PathRasterizer::addLine(double x0, double y0, double x1, double y1)
+{
+  if (y0 == y1 ||
+      !is_valid(x0) || !is_valid(y0) ||
+      !is_valid(x1) || !is_valid(y1) ||
+      (y0 <= 0.0 && y1 <= 0.0) ||
+      (y0 >= m_size.h && y1 >= m_size.h))
+    return;
+
+  // divide the line where it crosses the sides
+  double sides[2] = { 0.0, static_cast<double>(m_size.w) };
+  for (int i=0; i<2; ++i) {
+    double side = sides[i];
+    if ((x0 < side && x1 > side) || (x0 > side && x1 < side)) {
+      double y = y0 + (y1 - y0) * (side - x0) / (x1 - x0);
+      addLine(x0, y0, side, y);
+      addLine(side, y, x1, y1);
+      return;
+    }
+  }
+
+  accumulateLine(clamp_value(x0, 0.0, sides[1]), y0,
+		 clamp_value(x1, 0.0, sides[1]), y1);
+}
+
+/**
+   Adds to the cells of each scanline crossed by the line (x inside
+   the image) the area at the right of the line (multiplied by the
+   direction of the line). The sum of the cells from the left of the
+   scanline to a pixel is the covered area of the pixel.
+*/
+void PathRasterizer::accumulateLine(double x0, double y0, double x1, double y1)
+{
+  double dir = 1.0;
+  if (y0 > y1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+    dir = -1.0;
+  }
+
+  double top = max_value(y0, 0.0);
+  double bottom = min_value(y1, static_cast<double>(m_size.h));
+  if (top >= bottom)
+    return;
+
+  double dxdy = (x1 - x0) / (y1 - y0);
+  double x = x0 + (top - y0) * dxdy;
+  int yBegin = static_cast<int>(top);
+  int yEnd = static_cast<int>(std::ceil(bottom));
+
+  m_minY = min_value(m_minY, yBegin);
+  m_maxY = max_value(m_maxY, yEnd-1);
+
+  for (int y=yBegin; y<yEnd; ++y) {
+    float* row = &m_cells[y*m_stride];
+    double dy = min_value(static_cast<double>(y+1), bottom) - max_value(static_cast<double>(y), top);
+    double xNext = clamp_value(x + dxdy*dy, 0.0, static_cast<double>(m_size.w));
+    double d = dy * dir;
+    double xa = min_value(x, xNext);
+    double xb = max_value(x, xNext);
+    double xaFloor = std::floor(xa);
+    double xbCeil = std::ceil(xb);
+    int xai = static_cast<int>(xaFloor);
+    int xbi = static_cast<int>(xbCeil);
+
+    if (xbi <= xai+1) {
+      // the line is inside one pixel
+      double xm = 0.5*(x + xNext) - xaFloor;
+      row[xai] += static_cast<float>(d - d*xm);
+      row[xai+1] += static_cast<float>(d*xm);
+      xbi = xai+1;
+    }
+    else {
+      double s = 1.0 / (xb - xa);
+      double xaf = xa - xaFloor;
+      double a0 = 0.5 * s * (1.0 - xaf) * (1.0 - xaf);
+      double xbf = xb - xbCeil + 1.0;
+      double am = 0.5 * s * xbf * xbf;
+
+      row[xai] += static_cast<float>(d*a0);
+      if (xbi == xai+2)
+	row[xai+1] += static_cast<float>(d*(1.0 - a0 - am));
+      else {
+	double a1 = s * (1.5 - xaf);
+	row[xai+1] += static_cast<float>(d*(a1 - a0));
+	for (int xi=xai+2; xi<xbi-1; ++xi)
+	  row[xi] += static_cast<float>(d*s);
+	double a2 = a1 + (xbi - xai - 3) * s;
+	row[xbi-1] += static_cast<float>(d*(1.0 - a2 - am));
+      }
+      row[xbi] += static_cast<float>(d*am);
+    }
+
+    m_minX = min_value(m_minX, xai);
+    m_maxX = max_value(m_maxX, xbi);
+    x = xNext;
+  }
+}
+
+/**
+   Calculates the running sum of the cells of the scanline @a y, puts
+   the coverage of the pixels from m_minX in @a coverage (indexed by
+   x), and clears the cells. The last modified cell (m_maxX) only
+   cancels the winding of the previous cells, so its pixel is not
+   covered.
+*/
+void PathRasterizer::processScanline(int y, FillRule fillRule, unsigned char* coverage)
+{
+  float* row = &m_cells[y*m_stride];
+  bool evenOdd = (fillRule == FillRule::EvenOdd);
+  int end = min_value(m_maxX, m_size.w);
+  int x = m_minX;
+  float sum = 0.0f;
+
+#ifdef VACA_SSE2
+  // prefix sums of four cells at a time
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 scale = _mm_set1_ps(255.0f);
+  __m128 carry = zero;
+
+  for (; x+4<=end; x+=4) {
+    __m128 v = _mm_loadu_ps(row+x);
+    v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+    v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+    v = _mm_add_ps(v, carry);
+    carry = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+    _mm_storeu_ps(row+x, zero);
+
+    __m128 a = _mm_and_ps(v, absMask);
+    if (evenOdd) {
+      __m128 n = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(a, half)));
+      a = _mm_sub_ps(a, _mm_add_ps(n, n));
+      a = _mm_min_ps(a, _mm_sub_ps(two, a));
+    }
+    else
+      a = _mm_min_ps(a, one);
+
+    __m128i c = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(a, scale), half));
+    c = _mm_packs_epi32(c, c);
+    c = _mm_packus_epi16(c, c);
+    int packed = _mm_cvtsi128_si32(c);
+    std::memcpy(coverage+x, &packed, 4);
+  }
+  sum = _mm_cvtss_f32(carry);
+#endif
+
+  for (; x<end; ++x) {
+    sum += row[x];
+    row[x] = 0.0f;
+    coverage[x] = coverage_value(sum, evenOdd);
+  }
+
+  // cells at the right side of the image
+  for (; x<=m_maxX; ++x)
+    row[x] = 0.0f;
+}
+
+void PathRasterizer::reset()
+{
+  m_minX = m_stride;
+  m_minY = m_size.h;
+  m_maxX = -1;
+  m_maxY = -1;
+  m_open = false;
+  m_last = m_start;
+}
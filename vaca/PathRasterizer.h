@@ -0,0 +1,93 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_PATHRASTERIZER_H
+#define VACA_PATHRASTERIZER_H
+
+#include "vaca/base.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/PointF.h"
+#include "vaca/Rect.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   Fills paths in ImagePixels with anti-aliased edges (without GDI, so
+   it can be used to render images in memory or in other threads).
+
+   Graphics#fillPath, Graphics#fillEllipse, etc. paint each pixel
+   completely or not at all. The rasterizer calculates the exact area
+   of each pixel that is covered by the shape: the lines of the
+   figures add their signed area (and the change of the winding) to
+   the cells of an accumulation buffer, and the running sum of each
+   scanline is the coverage of each pixel. The running sums are
+   calculated with SSE2 when it's available.
+
+   The coordinates are floating point, so the shapes can be in any
+   position inside a pixel. Figures are always closed, and the parts
+   outside the image are clipped.
+
+   Example:
+   @code
+   ImagePixels pixels(Size(200, 200));
+   PathRasterizer rasterizer(pixels.getSize());
+   rasterizer.addEllipse(RectF(10.5f, 10.5f, 150, 100));
+   rasterizer.addPath(path);
+   rasterizer.fill(pixels, Color::Red, FillRule::Winding);
+   @endcode
+
+   @see GraphicsPath, ImagePixels
+*/
+class VACA_DLL PathRasterizer
+{
+  Size m_size;
+  int m_stride;			// cells of each scanline (m_size.w + 2)
+  std::vector<float> m_cells;	// accumulated area and winding differences
+  std::vector<unsigned char> m_coverage; // coverage of one scanline
+  int m_minX, m_minY;		// modified cells
+  int m_maxX, m_maxY;
+  PointF m_start;		// first point of the current figure
+  PointF m_last;		// current position
+  bool m_open;			// true if the current figure has lines
+
+public:
+  explicit PathRasterizer(const Size& size);
+  virtual ~PathRasterizer();
+
+  Size getSize() const;
+  Rect getBounds() const;
+  bool empty() const;
+  void clear();
+
+  void moveTo(const PointF& pt);
+  void lineTo(const PointF& pt);
+  void curveTo(const PointF& pt1, const PointF& pt2, const PointF& pt3);
+  void closeFigure();
+
+  void addPath(const GraphicsPath& path);
+  void addPolygon(const std::vector<PointF>& points);
+  void addEllipse(const RectF& rc);
+  void addPie(const RectF& rc, double startAngle, double sweepAngle);
+  void addChord(const RectF& rc, double startAngle, double sweepAngle);
+
+  void fill(ImagePixels& pixels, const Color& color,
+	    FillRule fillRule = FillRule::EvenOdd, int opacity = 255);
+  void getCoverage(std::vector<unsigned char>& coverage,
+		   FillRule fillRule = FillRule::EvenOdd);
+
+private:
+  void addArc(const RectF& rc, double startAngle, double sweepAngle, bool pie);
+  void addLine(double x0, double y0, double x1, double y1);
+  void accumulateLine(double x0, double y0, double x1, double y1);
+  void processScanline(int y, FillRule fillRule, unsigned char* coverage);
+  void reset();
+};
+
+} // namespace vaca
+
+#endif // VACA_PATHRASTERIZER_H
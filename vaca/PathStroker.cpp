@@ -0,0 +1,733 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/PathStroker.h"
+#include "vaca/ScopedLock.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace vaca;
+
+namespace {
+
+  const double pi = 3.14159265358979323846;
+
+  struct Vec
+  {
+    double x, y;
+
+    Vec() : x(0), y(0) { }
+    Vec(double x, double y) : x(x), y(y) { }
+    Vec operator+(const Vec& v) const { return Vec(x+v.x, y+v.y); }
+    Vec operator-(const Vec& v) const { return Vec(x-v.x, y-v.y); }
+    Vec operator*(double s) const { return Vec(x*s, y*s); }
+    Vec operator-() const { return Vec(-x, -y); }
+    bool operator==(const Vec& v) const { return x == v.x && y == v.y; }
+  };
+
+  inline double dot(const Vec& a, const Vec& b) { return a.x*b.x + a.y*b.y; }
+  inline double cross(const Vec& a, const Vec& b) { return a.x*b.y - a.y*b.x; }
+  inline double length(const Vec& v) { return std::sqrt(dot(v, v)); }
+  inline Vec left_normal(const Vec& v) { return Vec(-v.y, v.x); }
+
+  class Stroker
+  {
+    const StrokeStyle& m_style;
+    GraphicsPath& m_output;
+    double m_hw;			// half of the width
+    double m_arcStep;			// maximum angle of each segment of an arc
+    std::vector<Vec> m_poly;		// temporary polygon
+    std::vector<Point> m_points;	// temporary rounded polygon
+
+  public:
+    Stroker(const StrokeStyle& style, double tolerance, GraphicsPath& output)
+      : m_style(style)
+      , m_output(output)
+      , m_hw(style.width / 2.0)
+    {
+      // the arcs are approximated with chords that are at most
+      // "tolerance" far from the circle
+      m_arcStep = (m_hw > tolerance ? 2.0 * std::acos(1.0 - tolerance / m_hw): pi/2);
+      m_arcStep = std::max(m_arcStep, pi/64);
+    }
+
+    void strokeFigure(std::vector<Vec>& pts, bool closed)
+    {
+      // remove zero-length segments
+      pts.erase(std::unique(pts.begin(), pts.end()), pts.end());
+      if (closed && pts.size() > 1 && pts.front() == pts.back())
+	pts.pop_back();
+
+      if (m_style.dashes.empty())
+	strokePolyline(&pts[0], static_cast<int>(pts.size()), closed);
+      else
+	dashPolyline(pts, closed);
+    }
+
+  private:
+
+    void strokePolyline(const Vec* pts, int n, bool closed)
+    {
+      if (n == 1) {
+	addDot(pts[0]);
+	return;
+      }
+      if (n == 2)
+	closed = false;
+
+      int segments = (closed ? n: n-1);
+      for (int i=0; i<segments; ++i)
+	addSegment(pts[i], pts[(i+1) % n]);
+
+      if (closed) {
+	for (int i=0; i<n; ++i)
+	  addJoin(pts[i], pts[(i+n-1) % n], pts[(i+1) % n]);
+      }
+      else {
+	for (int i=1; i<n-1; ++i)
+	  addJoin(pts[i], pts[i-1], pts[i+1]);
+
+	addCap(pts[0], pts[1]);
+	addCap(pts[n-1], pts[n-2]);
+      }
+    }
+
+    // Splits the polyline in dashes, each one is stroked as an open
+    // polyline
+    void dashPolyline(std::vector<Vec>& pts, bool closed)
+    {
+      const std::vector<double>& dashes = m_style.dashes;
+      int count = static_cast<int>(dashes.size());
+      double total = 0.0;
+      for (int i=0; i<count; ++i)
+	total += dashes[i];
+
+      // find the dash where the figure starts
+      double pos = std::fmod(m_style.dashOffset, total);
+      if (pos < 0.0)
+	pos += total;
+
+      int index = 0;
+      while (pos >= dashes[index]) {
+	pos -= dashes[index];
+	index = (index+1) % count;
+      }
+      double remain = dashes[index] - pos;
+
+      if (closed)
+	pts.push_back(pts.front());
+
+      bool startsOn = ((index & 1) == 0);
+      bool firstDash = startsOn;
+      std::vector<Vec> first, current;
+      if (startsOn)
+	current.push_back(pts[0]);
+
+      for (size_t i=1; i<pts.size(); ++i) {
+	Vec a = pts[i-1];
+	Vec d = pts[i] - a;
+	double len = length(d);
+	d = d * (1.0 / len);
+
+	double t = 0.0;
+	while (len - t > remain) {
+	  t += remain;
+	  Vec q = a + d*t;
+
+	  if ((index & 1) == 0) {	// end of a dash
+	    current.push_back(q);
+	    if (firstDash && closed)
+	      first.swap(current);
+	    else
+	      strokeDash(current);
+	    current.clear();
+	    firstDash = false;
+	  }
+	  else
+	    current.push_back(q);	// start of a dash
+
+	  index = (index+1) % count;
+	  remain = dashes[index];
+	}
+	remain -= len - t;
+
+	if ((index & 1) == 0)
+	  current.push_back(pts[i]);
+      }
+
+      // the whole closed figure is one dash
+      if (closed && firstDash) {
+	current.pop_back();
+	current.erase(std::unique(current.begin(), current.end()), current.end());
+	strokePolyline(&current[0], static_cast<int>(current.size()), true);
+	return;
+      }
+
+      // the last dash of a closed figure is joined with the first one
+      if (!first.empty() && (index & 1) == 0)
+	current.insert(current.end(), first.begin()+1, first.end());
+      else if (!first.empty())
+	strokeDash(first);
+
+      if (!current.empty())
+	strokeDash(current);
+    }
+
+    void strokeDash(std::vector<Vec>& dash)
+    {
+      // a dash can start or finish in a vertex of the polyline
+      dash.erase(std::unique(dash.begin(), dash.end()), dash.end());
+      strokePolyline(&dash[0], static_cast<int>(dash.size()), false);
+    }
+
+    void addSegment(const Vec& a, const Vec& b)
+    {
+      Vec d = b - a;
+      Vec n = left_normal(d) * (m_hw / length(d));
+
+      m_poly.clear();
+      m_poly.push_back(a + n);
+      m_poly.push_back(b + n);
+      m_poly.push_back(b - n);
+      m_poly.push_back(a - n);
+      addPolygon();
+    }
+
+    // Adds the join in the vertex "p" between the segments "prev-p" and "p-next"
+    void addJoin(const Vec& p, const Vec& prev, const Vec& next)
+    {
+      Vec d0 = p - prev;
+      Vec d1 = next - p;
+      d0 = d0 * (1.0 / length(d0));
+      d1 = d1 * (1.0 / length(d1));
+
+      double c = cross(d0, d1);
+      double cosAngle = dot(d0, d1);
+
+      // straight line
+      if (std::fabs(c) < 1e-9 && cosAngle > 0.0)
+	return;
+
+      // the join goes in the outer side of the corner
+      Vec o0 = left_normal(d0) * m_hw;
+      Vec o1 = left_normal(d1) * m_hw;
+      if (c > 0.0) {
+	o0 = -o0;
+	o1 = -o1;
+      }
+
+      m_poly.clear();
+      m_poly.push_back(p);
+
+      switch (m_style.join) {
+
+	case PenJoin::Round: {
+	  double a0 = std::atan2(o0.y, o0.x);
+	  double sweep = std::atan2(cross(o0, o1), dot(o0, o1));
+	  // in a U-turn the arc goes around the end of the first segment
+	  if (std::fabs(c) < 1e-9)
+	    sweep = (cross(o0, d0) > 0.0 ? pi: -pi);
+	  addArc(p, a0, sweep);
+	  break;
+	}
+
+	case PenJoin::Miter: {
+	  // the ratio between the miter length and the width is
+	  // 1/sin(theta/2), where theta is the angle between segments
+	  double ratio2 = 2.0 / (1.0 + cosAngle);
+	  if (cosAngle > -1.0 &&
+	      ratio2 <= m_style.miterLimit * m_style.miterLimit) {
+	    m_poly.push_back(p + o0);
+	    m_poly.push_back(p + (o0 + o1) * (1.0 / (1.0 + cosAngle)));
+	    m_poly.push_back(p + o1);
+	    break;
+	  }
+	  // too long, use a bevel join
+	}
+	  // fall through
+
+	case PenJoin::Bevel:
+	  m_poly.push_back(p + o0);
+	  m_poly.push_back(p + o1);
+	  break;
+      }
+
+      addPolygon();
+    }
+
+    // Adds the cap at the "end" point of the segment "prev-end"
+    void addCap(const Vec& end, const Vec& prev)
+    {
+      Vec d = end - prev;
+      d = d * (m_hw / length(d));
+      Vec n = left_normal(d);
+
+      m_poly.clear();
+
+      switch (m_style.endCap) {
+
+	case PenEndCap::Round:
+	  addArc(end, std::atan2(n.y, n.x), -pi);
+	  break;
+
+	case PenEndCap::Square:
+	  m_poly.push_back(end + n);
+	  m_poly.push_back(end + n + d);
+	  m_poly.push_back(end - n + d);
+	  m_poly.push_back(end - n);
+	  break;
+
+	case PenEndCap::Flat:
+	  return;
+      }
+
+      addPolygon();
+    }
+
+    // Adds the shape of a segment of zero length (depends on the cap)
+    void addDot(const Vec& p)
+    {
+      m_poly.clear();
+
+      switch (m_style.endCap) {
+
+	case PenEndCap::Round:
+	  addArc(p, 0.0, 2*pi);
+	  m_poly.pop_back();
+	  break;
+
+	case PenEndCap::Square:
+	  m_poly.push_back(p + Vec(-m_hw, -m_hw));
+	  m_poly.push_back(p + Vec(+m_hw, -m_hw));
+	  m_poly.push_back(p + Vec(+m_hw, +m_hw));
+	  m_poly.push_back(p + Vec(-m_hw, +m_hw));
+	  break;
+
+	case PenEndCap::Flat:
+	  return;
+      }
+
+      addPolygon();
+    }
+
+    // Adds to the temporary polygon the points of the arc with center
+    // "c" that starts in the "start" angle
+    void addArc(const Vec& c, double start, double sweep)
+    {
+      int steps = std::max(1, static_cast<int>(std::ceil(std::fabs(sweep) / m_arcStep)));
+      for (int i=0; i<=steps; ++i) {
+	double angle = start + sweep * i / steps;
+	m_poly.push_back(c + Vec(std::cos(angle), std::sin(angle)) * m_hw);
+      }
+    }
+
+    // Adds the temporary polygon to the output with the same
+    // orientation of all other polygons
+    void addPolygon()
+    {
+      m_points.clear();
+      for (size_t i=0; i<m_poly.size(); ++i) {
+	Point pt(static_cast<int>(std::floor(m_poly[i].x + 0.5)),
+		 static_cast<int>(std::floor(m_poly[i].y + 0.5)));
+	if (m_points.empty() || m_points.back() != pt)
+	  m_points.push_back(pt);
+      }
+      while (m_points.size() > 1 && m_points.front() == m_points.back())
+	m_points.pop_back();
+      if (m_points.size() < 3)
+	return;
+
+      long long area = 0;
+      for (size_t i=0, j=m_points.size()-1; i<m_points.size(); j=i++)
+	area += (long long)m_points[j].x * m_points[i].y - (long long)m_points[i].x * m_points[j].y;
+      if (area == 0)
+	return;
+      if (area < 0)
+	std::reverse(m_points.begin(), m_points.end());
+
+      m_output.moveTo(m_points[0]);
+      for (size_t i=1; i<m_points.size(); ++i)
+	m_output.lineTo(m_points[i]);
+      m_output.closeFigure();
+    }
+
+  };
+
+  // FNV-1a hash of the nodes of the path and the style
+  class KeyHash
+  {
+    unsigned long long m_value;
+
+  public:
+    KeyHash() : m_value(14695981039346656037ULL) { }
+
+    void add(const void* data, size_t size)
+    {
+      const unsigned char* bytes = static_cast<const unsigned char*>(data);
+      for (size_t i=0; i<size; ++i) {
+	m_value ^= bytes[i];
+	m_value *= 1099511628211ULL;
+      }
+    }
+
+    void add(int value) { add(&value, sizeof(value)); }
+    void add(double value) { add(&value, sizeof(value)); }
+
+    unsigned long long getValue() const { return m_value; }
+  };
+
+  unsigned long long make_key(const GraphicsPath& path, const StrokeStyle& style)
+  {
+    KeyHash hash;
+    for (GraphicsPath::const_iterator it=path.begin(); it!=path.end(); ++it) {
+      hash.add(it->getType() | (it->isCloseFigure() ? GraphicsPath::CloseFigure: 0));
+      hash.add(it->getPoint().x);
+      hash.add(it->getPoint().y);
+    }
+    hash.add(style.width);
+    hash.add(static_cast<int>(style.join));
+    hash.add(static_cast<int>(style.endCap));
+    hash.add(style.miterLimit);
+    for (size_t i=0; i<style.dashes.size(); ++i)
+      hash.add(style.dashes[i]);
+    hash.add(style.dashOffset);
+    return hash.getValue();
+  }
+
+  bool same_nodes(const GraphicsPath& a, const GraphicsPath& b)
+  {
+    if (a.size() != b.size())
+      return false;
+
+    for (GraphicsPath::const_iterator i=a.begin(), j=b.begin(); i!=a.end(); ++i, ++j) {
+      if (i->getType() != j->getType() ||
+	  i->isCloseFigure() != j->isCloseFigure() ||
+	  i->getPoint() != j->getPoint())
+	return false;
+    }
+    return true;
+  }
+
+} // anonymous namespace
+
+// ======================================================================
+// StrokeStyle
+
+/**
+   Creates a solid style.
+*/
+StrokeStyle::StrokeStyle(double width, PenJoin join, PenEndCap endCap, double miterLimit)
+  : width(width)
+  , join(join)
+  , endCap(endCap)
+  , miterLimit(miterLimit)
+  , dashOffset(0.0)
+{
+}
+
+/**
+   Creates a style with the width, join, end cap and style of the
+   @a pen. The dashes of PenStyle::Dash, PenStyle::Dot, etc. are
+   proportional to the width of the pen (like geometric pens of
+   Win32), and a PenStyle::Null pen creates a null style.
+*/
+StrokeStyle::StrokeStyle(const Pen& pen, double miterLimit)
+  : width(std::max(1, pen.getWidth()))
+  , join(pen.getJoin())
+  , endCap(pen.getEndCap())
+  , miterLimit(miterLimit)
+  , dashOffset(0.0)
+{
+  static const double dash[] = { 3, 1 };
+  static const double dot[] = { 1, 1 };
+  static const double dashDot[] = { 3, 1, 1, 1 };
+  static const double dashDotDot[] = { 3, 1, 1, 1, 1, 1 };
+  const double* begin = NULL;
+  const double* end = NULL;
+
+  switch (pen.getStyle()) {
+    case PenStyle::Dash:       begin = dash;       end = dash+2;       break;
+    case PenStyle::Dot:        begin = dot;        end = dot+2;        break;
+    case PenStyle::DashDot:    begin = dashDot;    end = dashDot+4;    break;
+    case PenStyle::DashDotDot: begin = dashDotDot; end = dashDotDot+6; break;
+    case PenStyle::Null:       width = 0.0;                            break;
+    default:
+      break;
+  }
+
+  for (; begin != end; ++begin)
+    dashes.push_back(*begin * width);
+}
+
+/**
+   Returns true if the style doesn't paint anything (the width is
+   zero).
+*/
+bool StrokeStyle::isNull() const
+{
+  return width <= 0.0;
+}
+
+bool StrokeStyle::operator==(const StrokeStyle& other) const
+{
+  return
+    width == other.width &&
+    join == other.join &&
+    endCap == other.endCap &&
+    miterLimit == other.miterLimit &&
+    dashes == other.dashes &&
+    dashOffset == other.dashOffset;
+}
+
+bool StrokeStyle::operator!=(const StrokeStyle& other) const
+{
+  return !operator==(other);
+}
+
+// ======================================================================
+// PathStroker
+
+/**
+   Creates a stroker that remembers the last @a capacity strokes.
+
+   @param tolerance
+     Maximum distance (in pixels) between curves (and round joins
+     and caps) and the lines used to approximate them.
+*/
+PathStroker::PathStroker(int capacity, double tolerance)
+  : m_capacity(capacity)
+  , m_tolerance(tolerance)
+  , m_hits(0)
+  , m_misses(0)
+  , m_evictions(0)
+{
+}
+
+PathStroker::~PathStroker()
+{
+}
+
+int PathStroker::getCapacity() const
+{
+  ScopedLock hold(m_mutex);
+  return m_capacity;
+}
+
+/**
+   Changes the maximum number of strokes in the cache. If the new
+   capacity is smaller than the current count, the least recently
+   used strokes are removed.
+*/
+void PathStroker::setCapacity(int capacity)
+{
+  ScopedLock hold(m_mutex);
+  m_capacity = capacity;
+  evict(m_capacity);
+}
+
+double PathStroker::getTolerance() const
+{
+  return m_tolerance;
+}
+
+/**
+   Returns the number of strokes in the cache.
+*/
+int PathStroker::getCount() const
+{
+  ScopedLock hold(m_mutex);
+  return static_cast<int>(m_entries.size());
+}
+
+/**
+   Returns the stroke of the @a path with the specified @a style,
+   from the cache if the same path was stroked before with the same
+   style.
+
+   @see createStroke
+*/
+GraphicsPath PathStroker::stroke(const GraphicsPath& path, const StrokeStyle& style)
+{
+  unsigned long long key = make_key(path, style);
+
+  {
+    ScopedLock hold(m_mutex);
+    Index::iterator it = m_index.find(key);
+
+    if (it != m_index.end() &&
+	it->second->style == style &&
+	same_nodes(it->second->path, path)) {
+      // move the entry to the front of the list (most recently used)
+      m_entries.splice(m_entries.begin(), m_entries, it->second);
+      ++m_hits;
+      return it->second->stroke;
+    }
+    ++m_misses;
+  }
+
+  // stroke the path outside the lock
+  GraphicsPath result = createStroke(path, style, m_tolerance);
+
+  ScopedLock hold(m_mutex);
+  Index::iterator it = m_index.find(key);
+  if (it != m_index.end()) {
+    m_entries.erase(it->second);
+    m_index.erase(it);
+  }
+
+  if (m_capacity > 0) {
+    evict(m_capacity - 1);
+    m_entries.push_front(Entry(key, path, style, result));
+    m_index[key] = m_entries.begin();
+  }
+  return result;
+}
+
+/**
+   Removes all the strokes from the cache (the counters are not
+   reset).
+*/
+void PathStroker::clear()
+{
+  ScopedLock hold(m_mutex);
+  m_entries.clear();
+  m_index.clear();
+}
+
+/**
+   Returns the number of calls to #stroke that found the result in
+   the cache.
+*/
+int PathStroker::getHits() const
+{
+  ScopedLock hold(m_mutex);
+  return m_hits;
+}
+
+/**
+   Returns the number of calls to #stroke that had to compute the
+   stroke.
+*/
+int PathStroker::getMisses() const
+{
+  ScopedLock hold(m_mutex);
+  return m_misses;
+}
+
+/**
+   Returns the number of strokes removed to keep the cache inside its
+   capacity.
+*/
+int PathStroker::getEvictions() const
+{
+  ScopedLock hold(m_mutex);
+  return m_evictions;
+}
+
+void PathStroker::resetCounters()
+{
+  ScopedLock hold(m_mutex);
+  m_hits = 0;
+  m_misses = 0;
+  m_evictions = 0;
+}
+
+/**
+   Converts the @a path to the area that a pen with the specified
+   @a style covers when it draws the path (without using the cache).
+
+   Curves are flattened first (see GraphicsPath#flatten). Each
+   segment is converted to a rectangle, and each corner and end of
+   the open figures to a polygon that depends on the join and end cap
+   of the style. Closed figures have joins in all their vertices and
+   no caps. Dashed figures are divided in open pieces, and the dash
+   pattern starts again in each figure.
+
+   @return
+     A path with closed polygons to be filled with the
+     FillRule::Winding rule.
+*/
+GraphicsPath PathStroker::createStroke(const GraphicsPath& path,
+				       const StrokeStyle& style,
+				       double tolerance)
+{
+  GraphicsPath result;
+  if (style.isNull() || path.empty())
+    return result;
+
+  // a dash pattern without length is a solid line
+  StrokeStyle solid;
+  const StrokeStyle* effective = &style;
+  if (!style.dashes.empty()) {
+    double total = 0.0;
+    bool valid = true;
+    for (size_t i=0; i<style.dashes.size(); ++i) {
+      total += style.dashes[i];
+      valid = valid && style.dashes[i] >= 0.0;
+    }
+    if (!valid || total <= 0.0) {
+      solid = style;
+      solid.dashes.clear();
+      effective = &solid;
+    }
+    // an odd number of lengths is repeated to get dashes and gaps
+    else if (style.dashes.size() & 1) {
+      solid = style;
+      solid.dashes.insert(solid.dashes.end(), style.dashes.begin(), style.dashes.end());
+      effective = &solid;
+    }
+  }
+
+  GraphicsPath flat = path;
+  flat.flatten(tolerance);
+
+  Stroker stroker(*effective, tolerance, result);
+  std::vector<Vec> figure;
+  Vec start;
+
+  for (GraphicsPath::const_iterator it=flat.begin(); it!=flat.end(); ++it) {
+    Vec pt(it->getPoint().x, it->getPoint().y);
+
+    if (it->getType() == GraphicsPath::MoveTo) {
+      if (figure.size() > 1)
+	stroker.strokeFigure(figure, false);
+      figure.clear();
+      start = pt;
+    }
+    // a line after a closed figure starts in the start of that figure
+    else if (figure.empty())
+      figure.push_back(start);
+
+    figure.push_back(pt);
+
+    if (it->isCloseFigure()) {
+      if (figure.size() > 1)
+	stroker.strokeFigure(figure, true);
+      figure.clear();
+    }
+  }
+
+  if (figure.size() > 1)
+    stroker.strokeFigure(figure, false);
+
+  return result;
+}
+
+/**
+   Removes the least recently used strokes until the cache has
+   @a capacity strokes or less. The mutex must be locked.
+*/
+void PathStroker::evict(int capacity)
+{
+  capacity = std::max(0, capacity);
+
+  while (static_cast<int>(m_entries.size()) > capacity) {
+    m_index.erase(m_entries.back().key);
+    m_entries.pop_back();
+    ++m_evictions;
+  }
+}
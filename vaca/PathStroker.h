@@ -0,0 +1,139 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_PATHSTROKER_H
+#define VACA_PATHSTROKER_H
+
+#include "vaca/base.h"
+#include "vaca/NonCopyable.h"
+#include "vaca/GraphicsPath.h"
+#include "vaca/Mutex.h"
+#include "vaca/Pen.h"
+
+#include <list>
+#include <map>
+#include <vector>
+
+namespace vaca {
+
+/**
+   Parameters to stroke a GraphicsPath: the width of the line, how
+   the corners are joined, how open figures end, and the dash
+   pattern.
+
+   The dash pattern is a list of lengths (in pixels): the first one
+   is a dash, the second one a gap, and so on. An empty list means a
+   solid line.
+
+   @see PathStroker
+*/
+class VACA_DLL StrokeStyle
+{
+public:
+  double width;
+  PenJoin join;
+  PenEndCap endCap;
+  double miterLimit;
+  std::vector<double> dashes;
+  double dashOffset;
+
+  StrokeStyle(double width = 1.0,
+	      PenJoin join = PenJoin::Round,
+	      PenEndCap endCap = PenEndCap::Round,
+	      double miterLimit = 10.0);
+  explicit StrokeStyle(const Pen& pen, double miterLimit = 10.0);
+
+  bool isNull() const;
+
+  bool operator==(const StrokeStyle& other) const;
+  bool operator!=(const StrokeStyle& other) const;
+};
+
+/**
+   Converts paths to the area covered by their outlines without GDI.
+
+   The result of a stroke is a GraphicsPath with closed polygons (one
+   for each segment, join and cap) that must be filled with the
+   FillRule::Winding rule: all polygons have the same orientation, so
+   the overlapped parts are filled only one time. The result can be
+   rendered by any software rasterizer, or used to know if a point is
+   over the outline of a shape.
+
+   The last strokes are kept in a cache (keyed by the nodes of the
+   path and the style), so drawing the same shapes each time a window
+   is painted doesn't compute them again. All member functions are
+   thread-safe.
+
+   Example:
+   @code
+   PathStroker stroker;
+   GraphicsPath outline = stroker.stroke(path, StrokeStyle(pen));
+   g.setFillRule(FillRule::Winding);
+   g.fillPath(outline, brush, Point(0, 0));
+   @endcode
+
+   @see GraphicsPath, StrokeStyle, Pen
+*/
+class VACA_DLL PathStroker : private NonCopyable
+{
+  struct Entry
+  {
+    unsigned long long key;
+    GraphicsPath path;
+    StrokeStyle style;
+    GraphicsPath stroke;
+
+    Entry(unsigned long long key, const GraphicsPath& path,
+	  const StrokeStyle& style, const GraphicsPath& stroke)
+      : key(key), path(path), style(style), stroke(stroke) { }
+  };
+
+  // Entries sorted from the most to the least recently used one
+  typedef std::list<Entry> Entries;
+  typedef std::map<unsigned long long, Entries::iterator> Index;
+
+  mutable Mutex m_mutex;
+  Entries m_entries;
+  Index m_index;
+  int m_capacity;
+  double m_tolerance;
+  int m_hits;
+  int m_misses;
+  int m_evictions;
+
+public:
+  /**
+     Default number of strokes in the cache.
+  */
+  enum { DefaultCapacity = 64 };
+
+  explicit PathStroker(int capacity = DefaultCapacity, double tolerance = 0.25);
+  virtual ~PathStroker();
+
+  int getCapacity() const;
+  void setCapacity(int capacity);
+  double getTolerance() const;
+  int getCount() const;
+
+  GraphicsPath stroke(const GraphicsPath& path, const StrokeStyle& style);
+  void clear();
+
+  int getHits() const;
+  int getMisses() const;
+  int getEvictions() const;
+  void resetCounters();
+
+  static GraphicsPath createStroke(const GraphicsPath& path,
+				   const StrokeStyle& style,
+				   double tolerance = 0.25);
+
+private:
+  void evict(int capacity);
+};
+
+} // namespace vaca
+
+#endif // VACA_PATHSTROKER_H
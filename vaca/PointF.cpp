@@ -0,0 +1,140 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/PointF.h"
+#include "vaca/Point.h"
+#include "vaca/SizeF.h"
+
+#include <cmath>
+
+using namespace vaca;
+
+PointF::PointF()
+{
+  x = 0.0f;
+  y = 0.0f;
+}
+
+PointF::PointF(float x, float y)
+{
+  this->x = x;
+  this->y = y;
+}
+
+PointF::PointF(const PointF& point)
+{
+  x = point.x;
+  y = point.y;
+}
+
+/**
+   Converts an integer Point to a PointF (it's exact for the
+   coordinates of the screen).
+*/
+PointF::PointF(const Point& point)
+{
+  x = static_cast<float>(point.x);
+  y = static_cast<float>(point.y);
+}
+
+PointF::PointF(const SizeF& size)
+{
+  x = size.w;
+  y = size.h;
+}
+
+/**
+   Returns the nearest pixel (the coordinates rounded to the nearest
+   integer, halves go to the right/bottom).
+
+   Use this instead of @c static_cast<int>, which truncates the
+   coordinates towards zero (so negative coordinates are moved to the
+   right and positive ones to the left).
+*/
+Point PointF::round() const
+{
+  return Point(static_cast<int>(std::floor(x + 0.5f)),
+	       static_cast<int>(std::floor(y + 0.5f)));
+}
+
+/**
+   Returns the pixel that contains this point.
+*/
+Point PointF::floor() const
+{
+  return Point(static_cast<int>(std::floor(x)),
+	       static_cast<int>(std::floor(y)));
+}
+
+const PointF& PointF::operator=(const PointF& pt)
+{
+  x = pt.x;
+  y = pt.y;
+  return *this;
+}
+
+const PointF& PointF::operator+=(const PointF& pt)
+{
+  x += pt.x;
+  y += pt.y;
+  return *this;
+}
+
+const PointF& PointF::operator-=(const PointF& pt)
+{
+  x -= pt.x;
+  y -= pt.y;
+  return *this;
+}
+
+const PointF& PointF::operator*=(float value)
+{
+  x *= value;
+  y *= value;
+  return *this;
+}
+
+const PointF& PointF::operator/=(float value)
+{
+  x /= value;
+  y /= value;
+  return *this;
+}
+
+PointF PointF::operator+(const PointF& pt) const
+{
+  return PointF(x+pt.x, y+pt.y);
+}
+
+PointF PointF::operator-(const PointF& pt) const
+{
+  return PointF(x-pt.x, y-pt.y);
+}
+
+PointF PointF::operator*(float value) const
+{
+  return PointF(x*value, y*value);
+}
+
+PointF PointF::operator/(float value) const
+{
+  return PointF(x/value, y/value);
+}
+
+PointF PointF::operator-() const
+{
+  return PointF(-x, -y);
+}
+
+bool PointF::operator==(const PointF& pt) const
+{
+  return x == pt.x && y == pt.y;
+}
+
+bool PointF::operator!=(const PointF& pt) const
+{
+  return x != pt.x || y != pt.y;
+}
@@ -0,0 +1,56 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_POINTF_H
+#define VACA_POINTF_H
+
+#include "vaca/base.h"
+
+namespace vaca {
+
+/**
+   A 2D coordinate with subpixel precision (floating-point).
+
+   Use it to keep positions that move smoothly (animations, scrolling,
+   physics) or that are scaled, and round them to a Point only to draw
+   them.
+
+   @see Point, Transform
+*/
+class VACA_DLL PointF
+{
+public:
+
+  float x, y;
+
+  PointF();
+  PointF(float x, float y);
+  PointF(const PointF& point);
+  PointF(const Point& point);
+  explicit PointF(const SizeF& size);
+
+  Point round() const;
+  Point floor() const;
+
+  const PointF& operator=(const PointF& pt);
+  const PointF& operator+=(const PointF& pt);
+  const PointF& operator-=(const PointF& pt);
+  const PointF& operator*=(float value);
+  const PointF& operator/=(float value);
+  PointF operator+(const PointF& pt) const;
+  PointF operator-(const PointF& pt) const;
+  PointF operator*(float value) const;
+  PointF operator/(float value) const;
+  PointF operator-() const;
+
+  bool operator==(const PointF& pt) const;
+  bool operator!=(const PointF& pt) const;
+
+};
+
+} // namespace vaca
+
+#endif // VACA_POINTF_H
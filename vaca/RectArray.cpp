@@ -0,0 +1,534 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/RectArray.h"
+#include "vaca/Point.h"
+#include "vaca/Simd.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace vaca;
+
+namespace {
+
+#ifdef VACA_SSE2
+
+  inline __m128i load(const int* p)
+  {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+
+  inline void store(int* p, __m128i v)
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+  }
+
+  // Returns the values of a where the mask is set, and b in the rest
+  inline __m128i select(__m128i mask, __m128i a, __m128i b)
+  {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+  }
+
+  // _mm_min_epi32 and _mm_max_epi32 need SSE4.1
+  inline __m128i min_epi32(__m128i a, __m128i b)
+  {
+    return select(_mm_cmpgt_epi32(a, b), b, a);
+  }
+
+  inline __m128i max_epi32(__m128i a, __m128i b)
+  {
+    return select(_mm_cmpgt_epi32(a, b), a, b);
+  }
+
+#endif
+
+  // Sorts the indices by the values of "keys" (and by their indices
+  // when they are equal, so the order is the same in all platforms)
+  struct KeyLess
+  {
+    const std::vector<int>* key1;
+    const std::vector<int>* key2;
+    const std::vector<int>* key3;
+
+    bool operator()(int a, int b) const {
+      if ((*key1)[a] != (*key1)[b]) return (*key1)[a] < (*key1)[b];
+      if ((*key2)[a] != (*key2)[b]) return (*key2)[a] < (*key2)[b];
+      if ((*key3)[a] != (*key3)[b]) return (*key3)[a] < (*key3)[b];
+      return a < b;
+    }
+  };
+
+}
+
+RectArray::RectArray()
+{
+}
+
+RectArray::RectArray(const std::vector<Rect>& rects)
+{
+  reserve(static_cast<int>(rects.size()));
+  for (size_t i=0; i<rects.size(); ++i)
+    add(rects[i]);
+}
+
+RectArray::~RectArray()
+{
+}
+
+bool RectArray::empty() const
+{
+  return m_x1.empty();
+}
+
+int RectArray::size() const
+{
+  return static_cast<int>(m_x1.size());
+}
+
+void RectArray::clear()
+{
+  m_x1.clear();
+  m_y1.clear();
+  m_x2.clear();
+  m_y2.clear();
+}
+
+void RectArray::reserve(int size)
+{
+  m_x1.reserve(size);
+  m_y1.reserve(size);
+  m_x2.reserve(size);
+  m_y2.reserve(size);
+}
+
+void RectArray::add(const Rect& rc)
+{
+  m_x1.push_back(rc.x);
+  m_y1.push_back(rc.y);
+  m_x2.push_back(rc.x+rc.w);
+  m_y2.push_back(rc.y+rc.h);
+}
+
+/**
+   Returns the rectangle in the @a index position (Rect() if it's
+   empty).
+*/
+Rect RectArray::getRect(int index) const
+{
+  assert(index >= 0 && index < size());
+
+  if (m_x1[index] >= m_x2[index] || m_y1[index] >= m_y2[index])
+    return Rect();
+  else
+    return Rect(Point(m_x1[index], m_y1[index]),
+		Point(m_x2[index], m_y2[index]));
+}
+
+void RectArray::setRect(int index, const Rect& rc)
+{
+  assert(index >= 0 && index < size());
+
+  m_x1[index] = rc.x;
+  m_y1[index] = rc.y;
+  m_x2[index] = rc.x+rc.w;
+  m_y2[index] = rc.y+rc.h;
+}
+
+void RectArray::getRects(std::vector<Rect>& rects) const
+{
+  rects.resize(m_x1.size());
+  for (int i=0; i<size(); ++i)
+    rects[i] = getRect(i);
+}
+
+/**
+   Returns the union of all rectangles (the same as calling
+   Rect#createUnion with each one).
+*/
+Rect RectArray::getBounds() const
+{
+  int n = size();
+  int i = 0;
+  int x1 = INT_MAX, y1 = INT_MAX;
+  int x2 = INT_MIN, y2 = INT_MIN;
+
+#ifdef VACA_SSE2
+  if (n >= 4) {
+    __m128i minX = _mm_set1_epi32(INT_MAX), minY = minX;
+    __m128i maxX = _mm_set1_epi32(INT_MIN), maxY = maxX;
+
+    for (; i+4<=n; i+=4) {
+      __m128i a1 = load(&m_x1[i]), b1 = load(&m_y1[i]);
+      __m128i a2 = load(&m_x2[i]), b2 = load(&m_y2[i]);
+      __m128i valid = _mm_and_si128(_mm_cmpgt_epi32(a2, a1),
+				    _mm_cmpgt_epi32(b2, b1));
+
+      minX = select(valid, min_epi32(minX, a1), minX);
+      minY = select(valid, min_epi32(minY, b1), minY);
+      maxX = select(valid, max_epi32(maxX, a2), maxX);
+      maxY = select(valid, max_epi32(maxY, b2), maxY);
+    }
+
+    int lanes[4][4];
+    store(lanes[0], minX);
+    store(lanes[1], minY);
+    store(lanes[2], maxX);
+    store(lanes[3], maxY);
+    for (int j=0; j<4; ++j) {
+      x1 = min_value(x1, lanes[0][j]);
+      y1 = min_value(y1, lanes[1][j]);
+      x2 = max_value(x2, lanes[2][j]);
+      y2 = max_value(y2, lanes[3][j]);
+    }
+  }
+#endif
+
+  for (; i<n; ++i) {
+    if (m_x1[i] < m_x2[i] && m_y1[i] < m_y2[i]) {
+      x1 = min_value(x1, m_x1[i]);
+      y1 = min_value(y1, m_y1[i]);
+      x2 = max_value(x2, m_x2[i]);
+      y2 = max_value(y2, m_y2[i]);
+    }
+  }
+
+  if (x1 >= x2)
+    return Rect();
+  else
+    return Rect(Point(x1, y1), Point(x2, y2));
+}
+
+/**
+   Moves all the rectangles.
+*/
+void RectArray::offset(int dx, int dy)
+{
+  int n = size();
+  int i = 0;
+
+#ifdef VACA_SSE2
+  __m128i vx = _mm_set1_epi32(dx);
+  __m128i vy = _mm_set1_epi32(dy);
+  for (; i+4<=n; i+=4) {
+    store(&m_x1[i], _mm_add_epi32(load(&m_x1[i]), vx));
+    store(&m_y1[i], _mm_add_epi32(load(&m_y1[i]), vy));
+    store(&m_x2[i], _mm_add_epi32(load(&m_x2[i]), vx));
+    store(&m_y2[i], _mm_add_epi32(load(&m_y2[i]), vy));
+  }
+#endif
+
+  for (; i<n; ++i) {
+    m_x1[i] += dx;
+    m_y1[i] += dy;
+    m_x2[i] += dx;
+    m_y2[i] += dy;
+  }
+}
+
+/**
+   Replaces each rectangle with its intersection with @a clip (the
+   same as calling Rect#createIntersect with each one). The rectangles
+   outside @a clip become empty, but they are not removed, so the
+   indices don't change.
+*/
+void RectArray::intersect(const Rect& clip)
+{
+  int n = size();
+  int i = 0;
+  int cx1 = clip.x, cy1 = clip.y;
+  int cx2 = clip.x+clip.w, cy2 = clip.y+clip.h;
+
+#ifdef VACA_SSE2
+  __m128i vx1 = _mm_set1_epi32(cx1), vy1 = _mm_set1_epi32(cy1);
+  __m128i vx2 = _mm_set1_epi32(cx2), vy2 = _mm_set1_epi32(cy2);
+  for (; i+4<=n; i+=4) {
+    store(&m_x1[i], max_epi32(load(&m_x1[i]), vx1));
+    store(&m_y1[i], max_epi32(load(&m_y1[i]), vy1));
+    store(&m_x2[i], min_epi32(load(&m_x2[i]), vx2));
+    store(&m_y2[i], min_epi32(load(&m_y2[i]), vy2));
+  }
+#endif
+
+  for (; i<n; ++i) {
+    m_x1[i] = max_value(m_x1[i], cx1);
+    m_y1[i] = max_value(m_y1[i], cy1);
+    m_x2[i] = min_value(m_x2[i], cx2);
+    m_y2[i] = min_value(m_y2[i], cy2);
+  }
+}
+
+/**
+   Puts in @a indices the positions of the rectangles that overlap
+   @a rc (sorted).
+*/
+void RectArray::findOverlapping(const Rect& rc, std::vector<int>& indices) const
+{
+  indices.clear();
+  if (rc.isEmpty())
+    return;
+
+  int n = size();
+  int i = 0;
+  int rx1 = rc.x, ry1 = rc.y;
+  int rx2 = rc.x+rc.w, ry2 = rc.y+rc.h;
+
+#ifdef VACA_SSE2
+  __m128i vx1 = _mm_set1_epi32(rx1), vy1 = _mm_set1_epi32(ry1);
+  __m128i vx2 = _mm_set1_epi32(rx2), vy2 = _mm_set1_epi32(ry2);
+  for (; i+4<=n; i+=4) {
+    __m128i a1 = load(&m_x1[i]), b1 = load(&m_y1[i]);
+    __m128i a2 = load(&m_x2[i]), b2 = load(&m_y2[i]);
+
+    // the intersection of both rectangles isn't empty
+    __m128i ix1 = max_epi32(a1, vx1), iy1 = max_epi32(b1, vy1);
+    __m128i ix2 = min_epi32(a2, vx2), iy2 = min_epi32(b2, vy2);
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(ix2, ix1),
+							      _mm_cmpgt_epi32(iy2, iy1))));
+    for (; mask != 0; mask &= mask-1) {
+      int bit = (mask & 1 ? 0: mask & 2 ? 1: mask & 4 ? 2: 3);
+      indices.push_back(i+bit);
+    }
+  }
+#endif
+
+  for (; i<n; ++i) {
+    if (max_value(m_x1[i], rx1) < min_value(m_x2[i], rx2) &&
+	max_value(m_y1[i], ry1) < min_value(m_y2[i], ry2))
+      indices.push_back(i);
+  }
+}
+
+/**
+   Puts in @a pairs all the pairs of rectangles that overlap (each pair
+   is a pair of indices, the first one less than the second one).
+
+   The rectangles are sorted by their left side, so each rectangle is
+   only compared with the next rectangles that start before its right
+   side (sweep and prune).
+*/
+void RectArray::findOverlappingPairs(std::vector<std::pair<int, int> >& pairs) const
+{
+  pairs.clear();
+
+  std::vector<int> order;
+  order.reserve(m_x1.size());
+  for (int i=0; i<size(); ++i)
+    if (m_x1[i] < m_x2[i] && m_y1[i] < m_y2[i])
+      order.push_back(i);
+
+  KeyLess less = { &m_x1, &m_y1, &m_x2 };
+  std::sort(order.begin(), order.end(), less);
+
+  int n = static_cast<int>(order.size());
+  std::vector<int> x1(n), y1(n), x2(n), y2(n);
+  for (int i=0; i<n; ++i) {
+    x1[i] = m_x1[order[i]];
+    y1[i] = m_y1[order[i]];
+    x2[i] = m_x2[order[i]];
+    y2[i] = m_y2[order[i]];
+  }
+
+  for (int i=0; i<n; ++i) {
+    int right = x2[i];
+    int top = y1[i];
+    int bottom = y2[i];
+    int j = i+1;
+
+#ifdef VACA_SSE2
+    __m128i vRight = _mm_set1_epi32(right);
+    __m128i vTop = _mm_set1_epi32(top);
+    __m128i vBottom = _mm_set1_epi32(bottom);
+    for (; j+4<=n && x1[j] < right; j+=4) {
+      __m128i inside = _mm_and_si128(_mm_cmplt_epi32(load(&x1[j]), vRight),
+				     _mm_and_si128(_mm_cmplt_epi32(load(&y1[j]), vBottom),
+						   _mm_cmpgt_epi32(load(&y2[j]), vTop)));
+      int mask = _mm_movemask_ps(_mm_castsi128_ps(inside));
+      for (; mask != 0; mask &= mask-1) {
+	int k = j + (mask & 1 ? 0: mask & 2 ? 1: mask & 4 ? 2: 3);
+	pairs.push_back(std::make_pair(min_value(order[i], order[k]),
+				       max_value(order[i], order[k])));
+      }
+    }
+#endif
+
+    for (; j<n && x1[j] < right; ++j) {
+      if (y1[j] < bottom && y2[j] > top)
+	pairs.push_back(std::make_pair(min_value(order[i], order[j]),
+				       max_value(order[i], order[j])));
+    }
+  }
+}
+
+/**
+   Replaces the rectangles with rectangles that don't overlap and
+   cover exactly the same pixels. Empty rectangles are removed.
+
+   The pixels are split in horizontal bands where no rectangle starts
+   or ends (like BandedRegion does), the spans of each band are
+   joined, and then the spans of consecutive bands with the same left
+   and right sides are joined in one rectangle.
+
+   The order of the rectangles is not kept.
+*/
+void RectArray::merge()
+{
+  removeEmpty();
+  if (empty())
+    return;
+
+  splitInBands();
+
+  // each band has the biggest spans, so after this no rectangles
+  // can be joined horizontally
+  mergeAdjacent(m_y1, m_x1, m_y2, m_x2);
+}
+
+void RectArray::removeEmpty()
+{
+  int count = 0;
+  for (int i=0; i<size(); ++i) {
+    if (m_x1[i] < m_x2[i] && m_y1[i] < m_y2[i]) {
+      m_x1[count] = m_x1[i];
+      m_y1[count] = m_y1[i];
+      m_x2[count] = m_x2[i];
+      m_y2[count] = m_y2[i];
+      ++count;
+    }
+  }
+  m_x1.resize(count);
+  m_y1.resize(count);
+  m_x2.resize(count);
+  m_y2.resize(count);
+}
+
+/**
+   Replaces the rectangles with the spans of each band (the rows
+   between two consecutive top or bottom sides). The rectangles must
+   not be empty.
+*/
+void RectArray::splitInBands()
+{
+  int n = size();
+
+  std::vector<int> edges;
+  edges.reserve(2*n);
+  edges.insert(edges.end(), m_y1.begin(), m_y1.end());
+  edges.insert(edges.end(), m_y2.begin(), m_y2.end());
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  std::vector<int> order(n);
+  for (int i=0; i<n; ++i)
+    order[i] = i;
+
+  KeyLess less = { &m_y1, &m_x1, &m_x2 };
+  std::sort(order.begin(), order.end(), less);
+
+  std::vector<int> newX1, newY1, newX2, newY2;
+  std::vector<int> active;	// rectangles in the current band
+  std::vector<std::pair<int, int> > spans;
+  int next = 0;
+
+  for (size_t e=0; e+1<edges.size(); ++e) {
+    int top = edges[e];
+    int bottom = edges[e+1];
+
+    // remove the rectangles that end above this band, and add the
+    // ones that start here
+    int count = 0;
+    for (size_t i=0; i<active.size(); ++i)
+      if (m_y2[active[i]] > top)
+	active[count++] = active[i];
+    active.resize(count);
+
+    while (next < n && m_y1[order[next]] == top)
+      active.push_back(order[next++]);
+
+    if (active.empty())
+      continue;
+
+    spans.clear();
+    for (size_t i=0; i<active.size(); ++i)
+      spans.push_back(std::make_pair(m_x1[active[i]], m_x2[active[i]]));
+    std::sort(spans.begin(), spans.end());
+
+    // join the spans that overlap or touch
+    int x1 = spans[0].first;
+    int x2 = spans[0].second;
+    for (size_t i=1; i<=spans.size(); ++i) {
+      if (i < spans.size() && spans[i].first <= x2) {
+	x2 = max_value(x2, spans[i].second);
+	continue;
+      }
+
+      newX1.push_back(x1);
+      newY1.push_back(top);
+      newX2.push_back(x2);
+      newY2.push_back(bottom);
+
+      if (i < spans.size()) {
+	x1 = spans[i].first;
+	x2 = spans[i].second;
+      }
+    }
+  }
+
+  m_x1.swap(newX1);
+  m_y1.swap(newY1);
+  m_x2.swap(newX2);
+  m_y2.swap(newY2);
+}
+
+/**
+   Joins the rectangles that have the same sides b1 and b2 and touch
+   in the "a" axis (a2 of one rectangle is a1 of the other one).
+   Returns true if some rectangles were joined.
+*/
+bool RectArray::mergeAdjacent(std::vector<int>& a1, std::vector<int>& b1,
+			      std::vector<int>& a2, std::vector<int>& b2)
+{
+  int n = size();
+  std::vector<int> order(n);
+  for (int i=0; i<n; ++i)
+    order[i] = i;
+
+  KeyLess less = { &b1, &b2, &a1 };
+  std::sort(order.begin(), order.end(), less);
+
+  std::vector<int> newA1, newB1, newA2, newB2;
+  newA1.reserve(n);
+  newB1.reserve(n);
+  newA2.reserve(n);
+  newB2.reserve(n);
+
+  for (int i=0; i<n; ) {
+    int k = order[i];
+    int end = a2[k];
+    int j = i+1;
+    for (; j<n; ++j) {
+      int next = order[j];
+      if (b1[next] != b1[k] || b2[next] != b2[k] || a1[next] != end)
+	break;
+      end = a2[next];
+    }
+
+    newA1.push_back(a1[k]);
+    newB1.push_back(b1[k]);
+    newA2.push_back(end);
+    newB2.push_back(b2[k]);
+    i = j;
+  }
+
+  bool joined = (static_cast<int>(newA1.size()) < n);
+  if (joined) {
+    a1.swap(newA1);
+    b1.swap(newB1);
+    a2.swap(newA2);
+    b2.swap(newB2);
+  }
+  return joined;
+}
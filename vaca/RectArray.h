@@ -0,0 +1,82 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_RECTARRAY_H
+#define VACA_RECTARRAY_H
+
+#include "vaca/base.h"
+#include "vaca/Rect.h"
+
+#include <utility>
+#include <vector>
+
+namespace vaca {
+
+/**
+   An array of rectangles with operations that process all of them at
+   once (instead of calling Rect#createUnion, Rect#createIntersect or
+   Rect#intersects for each pair of rectangles).
+
+   The sides of the rectangles are stored in four arrays (left, top,
+   right and bottom sides), so the operations process four rectangles
+   at a time with SSE2 when it's available.
+
+   Two rectangles overlap when their intersection has pixels (unlike
+   Rect#intersects, rectangles that only touch don't overlap). Empty
+   rectangles don't overlap anything, and they are returned as
+   Rect().
+
+   Example:
+   @code
+   RectArray rects(invalidatedRects);
+   rects.intersect(getClientBounds());
+   rects.merge();	// now the rectangles don't overlap
+   for (int i=0; i<rects.size(); ++i)
+     repaint(rects.getRect(i));
+   @endcode
+
+   @see Rect, BandedRegion, RectTree
+*/
+class VACA_DLL RectArray
+{
+  std::vector<int> m_x1;	// left sides
+  std::vector<int> m_y1;	// top sides
+  std::vector<int> m_x2;	// right sides (exclusive)
+  std::vector<int> m_y2;	// bottom sides (exclusive)
+
+public:
+  RectArray();
+  explicit RectArray(const std::vector<Rect>& rects);
+  virtual ~RectArray();
+
+  bool empty() const;
+  int size() const;
+  void clear();
+  void reserve(int size);
+
+  void add(const Rect& rc);
+  Rect getRect(int index) const;
+  void setRect(int index, const Rect& rc);
+  void getRects(std::vector<Rect>& rects) const;
+
+  Rect getBounds() const;
+  void offset(int dx, int dy);
+  void intersect(const Rect& clip);
+
+  void findOverlapping(const Rect& rc, std::vector<int>& indices) const;
+  void findOverlappingPairs(std::vector<std::pair<int, int> >& pairs) const;
+  void merge();
+
+private:
+  void removeEmpty();
+  void splitInBands();
+  bool mergeAdjacent(std::vector<int>& a1, std::vector<int>& b1,
+		     std::vector<int>& a2, std::vector<int>& b2);
+};
+
+} // namespace vaca
+
+#endif // VACA_RECTARRAY_H
@@ -0,0 +1,288 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/RectF.h"
+#include "vaca/Rect.h"
+#include "vaca/Point.h"
+#include "vaca/PointF.h"
+#include "vaca/SizeF.h"
+
+#include <cmath>
+
+using namespace vaca;
+
+namespace {
+
+  inline int round_to_int(float x)
+  {
+    return static_cast<int>(std::floor(x + 0.5f));
+  }
+
+}
+
+/**
+   Creates a new empty rectangle with the origin in @c PointF(0,0).
+*/
+RectF::RectF()
+{
+  x = 0.0f;
+  y = 0.0f;
+  w = 0.0f;
+  h = 0.0f;
+}
+
+RectF::RectF(float w, float h)
+{
+  this->x = 0.0f;
+  this->y = 0.0f;
+  this->w = w;
+  this->h = h;
+}
+
+RectF::RectF(const SizeF& size)
+{
+  x = 0.0f;
+  y = 0.0f;
+  w = size.w;
+  h = size.h;
+}
+
+RectF::RectF(const RectF& rect)
+{
+  x = rect.x;
+  y = rect.y;
+  w = rect.w;
+  h = rect.h;
+}
+
+/**
+   Converts an integer Rect to a RectF. The new rectangle covers the
+   same pixels: from its left-top corner to the left-top corner of the
+   pixel outside it (Rect#getPoint2).
+*/
+RectF::RectF(const Rect& rect)
+{
+  x = static_cast<float>(rect.x);
+  y = static_cast<float>(rect.y);
+  w = static_cast<float>(rect.w);
+  h = static_cast<float>(rect.h);
+}
+
+RectF::RectF(const PointF& point, const SizeF& size)
+{
+  x = point.x;
+  y = point.y;
+  w = size.w;
+  h = size.h;
+}
+
+/**
+   Creates the rectangle between two corners (in any order).
+*/
+RectF::RectF(const PointF& point1, const PointF& point2)
+{
+  x = min_value(point1.x, point2.x);
+  y = min_value(point1.y, point2.y);
+  w = max_value(point1.x, point2.x) - x;
+  h = max_value(point1.y, point2.y) - y;
+}
+
+RectF::RectF(float x, float y, float w, float h)
+{
+  this->x = x;
+  this->y = y;
+  this->w = w;
+  this->h = h;
+}
+
+/**
+   Verifies if the width and/or height of the rectangle are less or
+   equal than zero.
+*/
+bool RectF::isEmpty() const
+{
+  return (w <= 0.0f || h <= 0.0f);
+}
+
+/**
+   Returns the exact middle point of the rectangle.
+*/
+PointF RectF::getCenter() const
+{
+  return PointF(x+w/2, y+h/2);
+}
+
+PointF RectF::getOrigin() const
+{
+  return PointF(x, y);
+}
+
+/**
+   Returns the lower-right corner.
+*/
+PointF RectF::getPoint2() const
+{
+  return PointF(x+w, y+h);
+}
+
+SizeF RectF::getSize() const
+{
+  return SizeF(w, h);
+}
+
+RectF& RectF::setOrigin(const PointF& pt)
+{
+  x = pt.x;
+  y = pt.y;
+  return *this;
+}
+
+RectF& RectF::setSize(const SizeF& sz)
+{
+  w = sz.w;
+  h = sz.h;
+  return *this;
+}
+
+RectF& RectF::offset(float dx, float dy)
+{
+  x += dx;
+  y += dy;
+  return *this;
+}
+
+RectF& RectF::offset(const PointF& point)
+{
+  x += point.x;
+  y += point.y;
+  return *this;
+}
+
+RectF& RectF::inflate(float dw, float dh)
+{
+  w += dw;
+  h += dh;
+  return *this;
+}
+
+RectF& RectF::inflate(const SizeF& size)
+{
+  w += size.w;
+  h += size.h;
+  return *this;
+}
+
+/**
+   Returns true if the point is inside the rectangle (the left and top
+   sides are inside, the right and bottom sides are outside).
+*/
+bool RectF::contains(const PointF& pt) const
+{
+  return
+    pt.x >= x && pt.x < x+w &&
+    pt.y >= y && pt.y < y+h;
+}
+
+/**
+   Returns true if this rectangle entirely contains the @a rc rectangle.
+
+   @warning
+     If some rectangle is empty, this member function returns false.
+*/
+bool RectF::contains(const RectF& rc) const
+{
+  if (isEmpty() || rc.isEmpty())
+    return false;
+
+  return
+    rc.x >= x && rc.x+rc.w <= x+w &&
+    rc.y >= y && rc.y+rc.h <= y+h;
+}
+
+/**
+   Returns true if the intersection between this rectangle with @a rc
+   rectangle has an area (rectangles that only touch don't intersect).
+*/
+bool RectF::intersects(const RectF& rc) const
+{
+  if (isEmpty() || rc.isEmpty())
+    return false;
+
+  return
+    rc.x < x+w && rc.x+rc.w > x &&
+    rc.y < y+h && rc.y+rc.h > y;
+}
+
+/**
+   Returns the union rectangle between this and @c rc rectangle.
+
+   @warning
+     If some rectangle is empty, this member function will return the
+     other rectangle.
+*/
+RectF RectF::createUnion(const RectF& rc) const
+{
+  if (isEmpty())
+    return rc;
+  else if (rc.isEmpty())
+    return *this;
+  else
+    return RectF(PointF(min_value(x, rc.x), min_value(y, rc.y)),
+		 PointF(max_value(x+w, rc.x+rc.w), max_value(y+h, rc.y+rc.h)));
+}
+
+/**
+   Returns the intersection rectangle between this and @c rc rectangles.
+*/
+RectF RectF::createIntersect(const RectF& rc) const
+{
+  if (intersects(rc))
+    return RectF(PointF(max_value(x, rc.x), max_value(y, rc.y)),
+		 PointF(min_value(x+w, rc.x+rc.w), min_value(y+h, rc.y+rc.h)));
+  else
+    return RectF();
+}
+
+/**
+   Returns the pixels that this rectangle covers: its sides are rounded
+   to the nearest pixel.
+
+   The sides are rounded (instead of the origin and the size), so two
+   rectangles that share a side in subpixel coordinates are adjacent
+   after rounding too.
+*/
+Rect RectF::round() const
+{
+  return Rect(Point(round_to_int(x), round_to_int(y)),
+	      Point(round_to_int(x+w), round_to_int(y+h)));
+}
+
+/**
+   Returns the smallest rectangle of pixels that contains all this
+   rectangle (e.g. the area to invalidate after drawing something
+   with anti-aliasing).
+*/
+Rect RectF::getEnclosingRect() const
+{
+  return Rect(Point(static_cast<int>(std::floor(x)),
+		    static_cast<int>(std::floor(y))),
+	      Point(static_cast<int>(std::ceil(x+w)),
+		    static_cast<int>(std::ceil(y+h))));
+}
+
+bool RectF::operator==(const RectF& rc) const
+{
+  return
+    x == rc.x && w == rc.w &&
+    y == rc.y && h == rc.h;
+}
+
+bool RectF::operator!=(const RectF& rc) const
+{
+  return
+    x != rc.x || w != rc.w ||
+    y != rc.y || h != rc.h;
+}
@@ -0,0 +1,71 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_RECTF_H
+#define VACA_RECTF_H
+
+#include "vaca/base.h"
+
+namespace vaca {
+
+/**
+   A rectangle with subpixel precision (floating-point).
+
+   Unlike Rect, the right and bottom sides (#x+#w and #y+#h) are
+   just lines, not pixels outside the rectangle. Use #round to get
+   the pixels to draw it, or #getEnclosingRect to get all the pixels
+   that it touches (e.g. to invalidate them).
+
+   @see Rect, PointF, SizeF, Transform
+*/
+class VACA_DLL RectF
+{
+public:
+
+  float x, y, w, h;
+
+  RectF();
+  RectF(float w, float h);
+  explicit RectF(const SizeF& size);
+  RectF(const RectF& rect);
+  RectF(const Rect& rect);
+  RectF(const PointF& point, const SizeF& size);
+  RectF(const PointF& point1, const PointF& point2);
+  RectF(float x, float y, float w, float h);
+
+  bool isEmpty() const;
+
+  PointF getCenter() const;
+  PointF getOrigin() const;
+  PointF getPoint2() const;
+  SizeF getSize() const;
+
+  RectF& setOrigin(const PointF& pt);
+  RectF& setSize(const SizeF& sz);
+
+  RectF& offset(float dx, float dy);
+  RectF& offset(const PointF& point);
+  RectF& inflate(float dw, float dh);
+  RectF& inflate(const SizeF& size);
+
+  bool contains(const PointF& pt) const;
+  bool contains(const RectF& rc) const;
+  bool intersects(const RectF& rc) const;
+
+  RectF createUnion(const RectF& rc) const;
+  RectF createIntersect(const RectF& rc) const;
+
+  Rect round() const;
+  Rect getEnclosingRect() const;
+
+  bool operator==(const RectF& rc) const;
+  bool operator!=(const RectF& rc) const;
+
+};
+
+} // namespace vaca
+
+#endif // VACA_RECTF_H
@@ -0,0 +1,671 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/RectTree.h"
+#include "vaca/Point.h"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+using namespace vaca;
+
+namespace {
+
+  // Stack of nodes to walk the tree without recursion (it doesn't use
+  // the heap for trees with less than 64 levels)
+  class NodeStack
+  {
+    int m_fixed[64];
+    std::vector<int> m_more;
+    int m_size;
+
+  public:
+    NodeStack() : m_size(0) { }
+
+    bool empty() const { return m_size == 0; }
+
+    void push(int node)
+    {
+      if (m_size < 64)
+	m_fixed[m_size] = node;
+      else
+	m_more.push_back(node);
+      ++m_size;
+    }
+
+    int pop()
+    {
+      --m_size;
+      if (m_size < 64)
+	return m_fixed[m_size];
+
+      int node = m_more.back();
+      m_more.pop_back();
+      return node;
+    }
+  };
+
+  // The following functions are templates because RectTree::Box is
+  // private (its name cannot be used here, but it can be deduced)
+
+  template<typename Box>
+  void box_union(Box& result, const Box& a, const Box& b)
+  {
+    result.x1 = min_value(a.x1, b.x1);
+    result.y1 = min_value(a.y1, b.y1);
+    result.x2 = max_value(a.x2, b.x2);
+    result.y2 = max_value(a.y2, b.y2);
+  }
+
+  template<typename Box>
+  long long box_perimeter(const Box& a)
+  {
+    return
+      static_cast<long long>(a.x2 - a.x1) +
+      static_cast<long long>(a.y2 - a.y1);
+  }
+
+  template<typename Box>
+  bool box_is_empty(const Box& a)
+  {
+    return a.x1 >= a.x2 || a.y1 >= a.y2;
+  }
+
+  // Square of the distance from the pixel "pt" to the nearest pixel of the box
+  template<typename Box>
+  long long box_distance(const Point& pt, const Box& box)
+  {
+    long long dx =
+      pt.x < box.x1 ? box.x1 - pt.x:
+      pt.x >= box.x2 ? pt.x - box.x2 + 1: 0;
+    long long dy =
+      pt.y < box.y1 ? box.y1 - pt.y:
+      pt.y >= box.y2 ? pt.y - box.y2 + 1: 0;
+    return dx*dx + dy*dy;
+  }
+
+  template<typename Box>
+  void box_from_rect(Box& box, const Rect& rc)
+  {
+    box.x1 = rc.x;
+    box.y1 = rc.y;
+    box.x2 = rc.x + rc.w;
+    box.y2 = rc.y + rc.h;
+  }
+
+}
+
+RectTree::RectTree()
+  : m_root(-1)
+  , m_freeNode(-1)
+  , m_freeItem(-1)
+  , m_count(0)
+{
+}
+
+RectTree::~RectTree()
+{
+}
+
+bool RectTree::empty() const
+{
+  return m_count == 0;
+}
+
+/**
+   Returns the number of rectangles in the tree.
+*/
+int RectTree::size() const
+{
+  return m_count;
+}
+
+/**
+   Removes all rectangles (all handles become invalid).
+*/
+void RectTree::clear()
+{
+  m_nodes.clear();
+  m_items.clear();
+  m_root = -1;
+  m_freeNode = -1;
+  m_freeItem = -1;
+  m_count = 0;
+}
+
+/**
+   Adds a rectangle to the tree.
+
+   @param value
+     A value associated to the rectangle (see #getValue).
+
+   @return
+     The handle to move or remove the rectangle.
+*/
+int RectTree::insert(const Rect& bounds, int value)
+{
+  int handle;
+  if (m_freeItem >= 0) {
+    handle = m_freeItem;
+    m_freeItem = m_items[handle].value;
+  }
+  else {
+    handle = static_cast<int>(m_items.size());
+    m_items.push_back(Item());
+  }
+
+  int leaf = allocateNode();
+  Node& node = m_nodes[leaf];
+  box_from_rect(node.box, bounds);
+  node.height = 0;
+  node.item = handle;
+
+  Item& item = m_items[handle];
+  item.bounds = bounds;
+  item.value = value;
+  item.leaf = leaf;
+
+  insertLeaf(leaf);
+  ++m_count;
+  return handle;
+}
+
+/**
+   Removes the rectangle with the specified @a handle (the handle can
+   be reused by a next #insert).
+*/
+void RectTree::remove(int handle)
+{
+  assert(handle >= 0 && handle < static_cast<int>(m_items.size()));
+  assert(m_items[handle].leaf >= 0);
+
+  int leaf = m_items[handle].leaf;
+  removeLeaf(leaf);
+  freeNode(leaf);
+
+  m_items[handle].leaf = -1;
+  m_items[handle].value = m_freeItem;
+  m_freeItem = handle;
+  --m_count;
+}
+
+/**
+   Changes the bounds of the rectangle with the specified @a handle.
+*/
+void RectTree::move(int handle, const Rect& bounds)
+{
+  assert(handle >= 0 && handle < static_cast<int>(m_items.size()));
+  assert(m_items[handle].leaf >= 0);
+
+  Item& item = m_items[handle];
+  if (item.bounds == bounds)
+    return;
+
+  int leaf = item.leaf;
+  item.bounds = bounds;
+
+  removeLeaf(leaf);
+
+  box_from_rect(m_nodes[leaf].box, bounds);
+
+  insertLeaf(leaf);
+}
+
+/**
+   Replaces the content of the tree with the rectangles of the
+   @a bounds vector (bulk loading). The handle of each rectangle is
+   its index in the vector, and its value is the same index.
+
+   The rectangles are divided recursively in two halves (by the
+   center of the rectangles along the widest axis), so the tree is
+   balanced and the nodes overlap less than inserting them one by one.
+*/
+void RectTree::build(const std::vector<Rect>& bounds)
+{
+  clear();
+
+  int count = static_cast<int>(bounds.size());
+  if (count == 0)
+    return;
+
+  m_items.resize(count);
+  m_nodes.reserve(2*count - 1);
+
+  std::vector<int> leaves(count);
+  for (int i=0; i<count; ++i) {
+    int leaf = allocateNode();
+    Node& node = m_nodes[leaf];
+    box_from_rect(node.box, bounds[i]);
+    node.height = 0;
+    node.item = i;
+
+    m_items[i].bounds = bounds[i];
+    m_items[i].value = i;
+    m_items[i].leaf = leaf;
+    leaves[i] = leaf;
+  }
+
+  m_root = buildRange(&leaves[0], count, -1);
+  m_count = count;
+}
+
+Rect RectTree::getBounds(int handle) const
+{
+  assert(handle >= 0 && handle < static_cast<int>(m_items.size()));
+  return m_items[handle].bounds;
+}
+
+int RectTree::getValue(int handle) const
+{
+  assert(handle >= 0 && handle < static_cast<int>(m_items.size()));
+  return m_items[handle].value;
+}
+
+void RectTree::setValue(int handle, int value)
+{
+  assert(handle >= 0 && handle < static_cast<int>(m_items.size()));
+  m_items[handle].value = value;
+}
+
+/**
+   Returns the number of levels of the tree (0 for an empty tree, 1 for
+   a tree with one rectangle).
+*/
+int RectTree::getHeight() const
+{
+  return m_root >= 0 ? m_nodes[m_root].height+1: 0;
+}
+
+/**
+   Puts in @a handles the rectangles that contain the point @a pt (in
+   no particular order). The vector is cleared first.
+*/
+void RectTree::query(const Point& pt, std::vector<int>& handles) const
+{
+  handles.clear();
+  if (m_root < 0)
+    return;
+
+  NodeStack stack;
+  stack.push(m_root);
+
+  while (!stack.empty()) {
+    const Node& node = m_nodes[stack.pop()];
+
+    if (pt.x < node.box.x1 || pt.x >= node.box.x2 ||
+	pt.y < node.box.y1 || pt.y >= node.box.y2)
+      continue;
+
+    if (node.height == 0)
+      handles.push_back(node.item);
+    else {
+      stack.push(node.child1);
+      stack.push(node.child2);
+    }
+  }
+}
+
+/**
+   Puts in @a handles the rectangles that intersect the @a rc area
+   (they have at least one pixel in common). The vector is cleared
+   first.
+*/
+void RectTree::query(const Rect& rc, std::vector<int>& handles) const
+{
+  handles.clear();
+  if (m_root < 0 || rc.w <= 0 || rc.h <= 0)
+    return;
+
+  int x1 = rc.x, y1 = rc.y, x2 = rc.x+rc.w, y2 = rc.y+rc.h;
+
+  NodeStack stack;
+  stack.push(m_root);
+
+  while (!stack.empty()) {
+    const Node& node = m_nodes[stack.pop()];
+
+    if (x2 <= node.box.x1 || x1 >= node.box.x2 ||
+	y2 <= node.box.y1 || y1 >= node.box.y2)
+      continue;
+
+    if (node.height == 0) {
+      if (!box_is_empty(node.box))
+	handles.push_back(node.item);
+    }
+    else {
+      stack.push(node.child1);
+      stack.push(node.child2);
+    }
+  }
+}
+
+/**
+   Returns the handle of the rectangle nearest to the point @a pt (a
+   rectangle that contains the point has distance zero), or -1 if the
+   tree doesn't have non-empty rectangles.
+
+   The nearest child of each node is visited first, and the nodes
+   farther than the best rectangle found are skipped.
+*/
+int RectTree::nearest(const Point& pt) const
+{
+  if (m_root < 0)
+    return -1;
+
+  int best = -1;
+  long long bestDistance = 0;
+
+  NodeStack stack;
+  stack.push(m_root);
+
+  while (!stack.empty()) {
+    const Node& node = m_nodes[stack.pop()];
+    long long distance = box_distance(pt, node.box);
+
+    if (best >= 0 && distance >= bestDistance)
+      continue;
+
+    if (node.height == 0) {
+      if (!box_is_empty(node.box)) {
+	best = node.item;
+	bestDistance = distance;
+	if (distance == 0)
+	  break;
+      }
+    }
+    else {
+      // the nearest child is the next one to visit
+      const Node& child1 = m_nodes[node.child1];
+      const Node& child2 = m_nodes[node.child2];
+      if (box_distance(pt, child1.box) <= box_distance(pt, child2.box)) {
+	stack.push(node.child2);
+	stack.push(node.child1);
+      }
+      else {
+	stack.push(node.child1);
+	stack.push(node.child2);
+      }
+    }
+  }
+
+  return best;
+}
+
+int RectTree::allocateNode()
+{
+  int index;
+  if (m_freeNode >= 0) {
+    index = m_freeNode;
+    m_freeNode = m_nodes[index].parent;
+  }
+  else {
+    index = static_cast<int>(m_nodes.size());
+    m_nodes.push_back(Node());
+  }
+
+  Node& node = m_nodes[index];
+  node.parent = -1;
+  node.child1 = -1;
+  node.child2 = -1;
+  node.height = 0;
+  node.item = -1;
+  return index;
+}
+
+void RectTree::freeNode(int index)
+{
+  m_nodes[index].parent = m_freeNode;
+  m_nodes[index].height = -1;
+  m_freeNode = index;
+}
+
+/**
+   Puts the @a leaf in the tree next to the node where the perimeter
+   of the bounds grows less (surface area heuristic).
+*/
+void RectTree::insertLeaf(int leaf)
+{
+  if (m_root < 0) {
+    m_root = leaf;
+    m_nodes[leaf].parent = -1;
+    return;
+  }
+
+  Box leafBox = m_nodes[leaf].box;
+  int index = m_root;
+
+  while (m_nodes[index].height > 0) {
+    const Node& node = m_nodes[index];
+    int child1 = node.child1;
+    int child2 = node.child2;
+
+    Box combined;
+    box_union(combined, node.box, leafBox);
+    long long combinedPerimeter = box_perimeter(combined);
+
+    // cost of creating a new parent for this node and the leaf
+    long long cost = 2 * combinedPerimeter;
+
+    // minimum cost of pushing the leaf further down the tree
+    long long inheritance = 2 * (combinedPerimeter - box_perimeter(node.box));
+
+    long long cost1, cost2;
+    Box box;
+
+    box_union(box, m_nodes[child1].box, leafBox);
+    cost1 = box_perimeter(box) + inheritance;
+    if (m_nodes[child1].height > 0)
+      cost1 -= box_perimeter(m_nodes[child1].box);
+
+    box_union(box, m_nodes[child2].box, leafBox);
+    cost2 = box_perimeter(box) + inheritance;
+    if (m_nodes[child2].height > 0)
+      cost2 -= box_perimeter(m_nodes[child2].box);
+
+    if (cost < cost1 && cost < cost2)
+      break;
+
+    index = (cost1 < cost2 ? child1: child2);
+  }
+
+  int sibling = index;
+  int oldParent = m_nodes[sibling].parent;
+  int newParent = allocateNode();	// can reallocate m_nodes
+
+  Node& parent = m_nodes[newParent];
+  parent.parent = oldParent;
+  box_union(parent.box, m_nodes[sibling].box, leafBox);
+  parent.height = m_nodes[sibling].height + 1;
+  parent.child1 = sibling;
+  parent.child2 = leaf;
+
+  if (oldParent >= 0) {
+    if (m_nodes[oldParent].child1 == sibling)
+      m_nodes[oldParent].child1 = newParent;
+    else
+      m_nodes[oldParent].child2 = newParent;
+  }
+  else
+    m_root = newParent;
+
+  m_nodes[sibling].parent = newParent;
+  m_nodes[leaf].parent = newParent;
+
+  updateAncestors(newParent);
+}
+
+/**
+   Removes the @a leaf from the tree (the node of its parent is freed
+   and its sibling takes its place).
+*/
+void RectTree::removeLeaf(int leaf)
+{
+  if (leaf == m_root) {
+    m_root = -1;
+    return;
+  }
+
+  int parent = m_nodes[leaf].parent;
+  int grandParent = m_nodes[parent].parent;
+  int sibling = (m_nodes[parent].child1 == leaf ?
+		 m_nodes[parent].child2:
+		 m_nodes[parent].child1);
+
+  if (grandParent >= 0) {
+    if (m_nodes[grandParent].child1 == parent)
+      m_nodes[grandParent].child1 = sibling;
+    else
+      m_nodes[grandParent].child2 = sibling;
+    m_nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    updateAncestors(grandParent);
+  }
+  else {
+    m_root = sibling;
+    m_nodes[sibling].parent = -1;
+    freeNode(parent);
+  }
+}
+
+/**
+   Balances and recalculates the bounds and heights of the @a node and
+   all its ancestors.
+*/
+void RectTree::updateAncestors(int index)
+{
+  while (index >= 0) {
+    index = balance(index);
+
+    Node& node = m_nodes[index];
+    const Node& child1 = m_nodes[node.child1];
+    const Node& child2 = m_nodes[node.child2];
+
+    node.height = 1 + max_value(child1.height, child2.height);
+    box_union(node.box, child1.box, child2.box);
+
+    index = node.parent;
+  }
+}
+
+/**
+   If a child of the node @a a is two levels taller than the other
+   one, rotates the taller child to the place of @a a.
+
+   @return
+     The node that is now in the place of @a a.
+*/
+int RectTree::balance(int a)
+{
+  Node& A = m_nodes[a];
+  if (A.height < 2)
+    return a;
+
+  int b = A.child1;
+  int c = A.child2;
+  int diff = m_nodes[c].height - m_nodes[b].height;
+
+  if (diff > 1 || diff < -1) {
+    // "up" is the taller child, "other" the shorter one
+    int up = (diff > 1 ? c: b);
+    int other = (diff > 1 ? b: c);
+    Node& U = m_nodes[up];
+    int f = U.child1;
+    int g = U.child2;
+    Node& F = m_nodes[f];
+    Node& G = m_nodes[g];
+
+    // "up" takes the place of "a"
+    U.child1 = a;
+    U.parent = A.parent;
+    A.parent = up;
+
+    if (U.parent >= 0) {
+      if (m_nodes[U.parent].child1 == a)
+	m_nodes[U.parent].child1 = up;
+      else
+	m_nodes[U.parent].child2 = up;
+    }
+    else
+      m_root = up;
+
+    // the taller grandchild stays in "up", the other goes to "a"
+    int keep = (F.height > G.height ? f: g);
+    int give = (F.height > G.height ? g: f);
+
+    U.child2 = keep;
+    A.child1 = other;
+    A.child2 = give;
+    m_nodes[give].parent = a;
+
+    const Node& O = m_nodes[other];
+    const Node& K = m_nodes[keep];
+    const Node& V = m_nodes[give];
+
+    box_union(A.box, O.box, V.box);
+    A.height = 1 + max_value(O.height, V.height);
+    box_union(U.box, A.box, K.box);
+    U.height = 1 + max_value(A.height, K.height);
+    return up;
+  }
+
+  return a;
+}
+
+/**
+   Creates the subtree of the @a count leaves of the array, and returns
+   its root.
+*/
+int RectTree::buildRange(int* leaves, int count, int parent)
+{
+  if (count == 1) {
+    m_nodes[leaves[0]].parent = parent;
+    return leaves[0];
+  }
+
+  // bounds of the centers of the rectangles (multiplied by 2)
+  Box centers = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+  for (int i=0; i<count; ++i) {
+    const Box& box = m_nodes[leaves[i]].box;
+    int cx = box.x1 + box.x2, cy = box.y1 + box.y2;
+    centers.x1 = min_value(centers.x1, cx);
+    centers.y1 = min_value(centers.y1, cy);
+    centers.x2 = max_value(centers.x2, cx);
+    centers.y2 = max_value(centers.y2, cy);
+  }
+
+  // split the leaves by the median along the widest axis
+  struct Compare {
+    const std::vector<Node>& nodes;
+    bool horizontal;
+    Compare(const std::vector<Node>& nodes, bool horizontal)
+      : nodes(nodes), horizontal(horizontal) { }
+    bool operator()(int a, int b) const {
+      const Box& p = nodes[a].box;
+      const Box& q = nodes[b].box;
+      return (horizontal ? p.x1 + p.x2 < q.x1 + q.x2:
+			   p.y1 + p.y2 < q.y1 + q.y2);
+    }
+  };
+
+  int half = count / 2;
+  std::nth_element(leaves, leaves+half, leaves+count,
+		   Compare(m_nodes, (static_cast<long long>(centers.x2) - centers.x1 >=
+				     static_cast<long long>(centers.y2) - centers.y1)));
+
+  int index = allocateNode();
+  int child1 = buildRange(leaves, half, index);
+  int child2 = buildRange(leaves+half, count-half, index);
+
+  Node& node = m_nodes[index];
+  node.parent = parent;
+  node.child1 = child1;
+  node.child2 = child2;
+  node.height = 1 + max_value(m_nodes[child1].height, m_nodes[child2].height);
+  box_union(node.box, m_nodes[child1].box, m_nodes[child2].box);
+  return index;
+}
@@ -0,0 +1,112 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_RECTTREE_H
+#define VACA_RECTTREE_H
+
+#include "vaca/base.h"
+#include "vaca/Rect.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   A spatial index of rectangles to know quickly which ones are below
+   a point or inside an area (a dynamic bounding-box tree).
+
+   Each rectangle inserted in the tree gets a handle (an integer) that
+   is used to move or remove it, and the queries return the handles of
+   the rectangles that were found. A handle has an associated value
+   (e.g. the index of a figure or a widget in your own list).
+
+   The tree is binary: each internal node has the bounds of its two
+   children. Inserting a rectangle puts it next to the node that makes
+   the bounds grow less, and the tree is rotated to keep it balanced,
+   so all operations are O(log n). When all rectangles are known
+   before, #build creates a better tree in O(n log n).
+
+   Example:
+   @code
+   RectTree tree;
+   for (int i=0; i<widgets.size(); ++i)
+     tree.insert(widgets[i]->getBounds(), i);
+
+   std::vector<int> found;
+   tree.query(mousePoint, found);
+   for (int j=0; j<found.size(); ++j)
+     widgets[tree.getValue(found[j])]->...;
+   @endcode
+
+   @see Rect, BandedRegion
+*/
+class VACA_DLL RectTree
+{
+  struct Box
+  {
+    int x1, y1, x2, y2;		// x2 and y2 are exclusive
+  };
+
+  struct Node
+  {
+    Box box;
+    int parent;
+    int child1;
+    int child2;
+    int height;			// 0 for leaves, -1 for free nodes
+    int item;			// handle of the leaf's rectangle
+  };
+
+  struct Item
+  {
+    Rect bounds;
+    int value;
+    int leaf;			// -1 for free handles
+  };
+
+  std::vector<Node> m_nodes;
+  std::vector<Item> m_items;
+  int m_root;
+  int m_freeNode;		// list of free nodes (linked by "parent")
+  int m_freeItem;		// list of free handles (linked by "value")
+  int m_count;
+
+public:
+  RectTree();
+  virtual ~RectTree();
+
+  bool empty() const;
+  int size() const;
+  void clear();
+
+  int insert(const Rect& bounds, int value = 0);
+  void remove(int handle);
+  void move(int handle, const Rect& bounds);
+
+  void build(const std::vector<Rect>& bounds);
+
+  Rect getBounds(int handle) const;
+  int getValue(int handle) const;
+  void setValue(int handle, int value);
+  int getHeight() const;
+
+  void query(const Point& pt, std::vector<int>& handles) const;
+  void query(const Rect& rc, std::vector<int>& handles) const;
+  int nearest(const Point& pt) const;
+
+private:
+  int allocateNode();
+  void freeNode(int node);
+  void insertLeaf(int leaf);
+  void removeLeaf(int leaf);
+  void updateAncestors(int node);
+  int balance(int node);
+  int buildRange(int* leaves, int count, int parent);
+};
+
+} // namespace vaca
+
+#endif // VACA_RECTTREE_H
@@ -5,6 +5,7 @@
 // please read LICENSE.txt for more information.
 
 #include "vaca/Region.h"
+#include "vaca/BandedRegion.h"
 #include "vaca/Rect.h"
 #include "vaca/Debug.h"
 #include "vaca/Point.h"
@@ -117,6 +118,32 @@ Rect Region::getBounds() const
     return convert_to<Rect>(rc);
 }
 
+/**
+   Returns the rectangles of the Region (sorted from top to bottom,
+   and from left to right).
+*/
+std::vector<Rect> Region::getRects() const
+{
+  assert(getHandle());
+
+  std::vector<Rect> rects;
+  DWORD size = GetRegionData(getHandle(), 0, NULL);
+  if (size == 0)
+    return rects;
+
+  std::vector<BYTE> data(size);
+  RGNDATA* rgnData = reinterpret_cast<RGNDATA*>(&data[0]);
+  if (GetRegionData(getHandle(), size, rgnData) == 0)
+    return rects;
+
+  const RECT* rcs = reinterpret_cast<const RECT*>(rgnData->Buffer);
+  rects.reserve(rgnData->rdh.nCount);
+  for (DWORD i=0; i<rgnData->rdh.nCount; ++i)
+    rects.push_back(convert_to<Rect>(rcs[i]));
+
+  return rects;
+}
+
 Region& Region::offset(int dx, int dy)
 {
   OffsetRgn(getHandle(), dx, dy);
@@ -143,6 +170,32 @@ bool Region::contains(const Rect& rc) const
   return RectInRegion(getHandle(), &rc2) != FALSE;
 }
 
+/**
+   Tests a lot of points at the same time. It is a lot faster than
+   calling #contains for each point (the rectangles of the Region are
+   got only one time, see BandedRegion#contains).
+
+   @param mask
+     The result: the bit @c i%32 of @c mask[i/32] is 1 if
+     @c points[i] is inside the region.
+*/
+void Region::contains(const std::vector<Point>& points, std::vector<unsigned int>& mask) const
+{
+  BandedRegion::fromBandedRects(getRects()).contains(points, mask);
+}
+
+/**
+   Tests a lot of rectangles at the same time.
+
+   @param mask
+     The result: the bit @c i%32 of @c mask[i/32] is 1 if some part
+     of @c rects[i] is inside the region.
+*/
+void Region::contains(const std::vector<Rect>& rects, std::vector<unsigned int>& mask) const
+{
+  BandedRegion::fromBandedRects(getRects()).contains(rects, mask);
+}
+
 bool Region::operator==(const Region& rgn) const
 {
   BOOL res = EqualRgn(getHandle(), rgn.getHandle()) != FALSE;
@@ -264,6 +317,34 @@ Region Region::fromRect(const Rect &_rc)
   return Region(CreateRectRgnIndirect(&rc));
 }
 
+/**
+   Creates a region from a list of rectangles (that shouldn't
+   overlap). It is faster than joining the rectangles one by one.
+*/
+Region Region::fromRects(const std::vector<Rect>& rects)
+{
+  if (rects.empty())
+    return Region();
+
+  std::vector<BYTE> data(sizeof(RGNDATAHEADER) + sizeof(RECT)*rects.size());
+  RGNDATA* rgnData = reinterpret_cast<RGNDATA*>(&data[0]);
+  RECT* rcs = reinterpret_cast<RECT*>(rgnData->Buffer);
+  Rect bounds;
+
+  for (size_t i=0; i<rects.size(); ++i) {
+    rcs[i] = convert_to<RECT>(rects[i]);
+    bounds = bounds.createUnion(rects[i]);
+  }
+
+  rgnData->rdh.dwSize = sizeof(RGNDATAHEADER);
+  rgnData->rdh.iType = RDH_RECTANGLES;
+  rgnData->rdh.nCount = static_cast<DWORD>(rects.size());
+  rgnData->rdh.nRgnSize = static_cast<DWORD>(sizeof(RECT)*rects.size());
+  rgnData->rdh.rcBound = convert_to<RECT>(bounds);
+
+  return Region(ExtCreateRegion(NULL, static_cast<DWORD>(data.size()), rgnData));
+}
+
 /**
    Creates a region from an ellipse.
 */
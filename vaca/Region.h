@@ -11,6 +11,8 @@
 #include "vaca/GdiObject.h"
 #include "vaca/SharedPtr.h"
 
+#include <vector>
+
 namespace vaca {
 
 /**
@@ -35,12 +37,15 @@ public:
   Region clone() const;
 
   Rect getBounds() const;
+  std::vector<Rect> getRects() const;
 
   Region& offset(int dx, int dy);
   Region& offset(const Point& point);
 
   bool contains(const Point& pt) const;
   bool contains(const Rect& rc) const;
+  void contains(const std::vector<Point>& points, std::vector<unsigned int>& mask) const;
+  void contains(const std::vector<Rect>& rects, std::vector<unsigned int>& mask) const;
 
   bool operator==(const Region& rgn) const;
   bool operator!=(const Region& rgn) const;
@@ -58,6 +63,7 @@ public:
   Region& operator^=(const Region& rgn);
 
   static Region fromRect(const Rect& rc);
+  static Region fromRects(const std::vector<Rect>& rects);
   static Region fromEllipse(const Rect& rc);
   static Region fromRoundRect(const Rect& rc, const Size& ellipseSize);
 
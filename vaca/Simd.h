@@ -0,0 +1,20 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_SIMD_H
+#define VACA_SIMD_H
+
+// This header file is used internally by pixel routines that have a
+// SSE2 version. SSE2 is always available in x64, and in x86 when the
+// compiler is configured to generate it. Each routine has a scalar
+// version when VACA_SSE2 is not defined.
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define VACA_SSE2
+  #include <emmintrin.h>
+#endif
+
+#endif // VACA_SIMD_H
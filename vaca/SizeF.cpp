@@ -0,0 +1,134 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/SizeF.h"
+#include "vaca/Size.h"
+#include "vaca/PointF.h"
+
+#include <cmath>
+
+using namespace vaca;
+
+SizeF::SizeF()
+{
+  w = 0.0f;
+  h = 0.0f;
+}
+
+SizeF::SizeF(float w, float h)
+{
+  this->w = w;
+  this->h = h;
+}
+
+SizeF::SizeF(const SizeF& size)
+{
+  w = size.w;
+  h = size.h;
+}
+
+SizeF::SizeF(const Size& size)
+{
+  w = static_cast<float>(size.w);
+  h = static_cast<float>(size.h);
+}
+
+SizeF::SizeF(const PointF& point)
+{
+  w = point.x;
+  h = point.y;
+}
+
+/**
+   Returns the size rounded to the nearest integers.
+*/
+Size SizeF::round() const
+{
+  return Size(static_cast<int>(std::floor(w + 0.5f)),
+	      static_cast<int>(std::floor(h + 0.5f)));
+}
+
+SizeF SizeF::createUnion(const SizeF& sz) const
+{
+  return SizeF(max_value(w, sz.w),
+	       max_value(h, sz.h));
+}
+
+SizeF SizeF::createIntersect(const SizeF& sz) const
+{
+  return SizeF(min_value(w, sz.w),
+	       min_value(h, sz.h));
+}
+
+const SizeF& SizeF::operator=(const SizeF& sz)
+{
+  w = sz.w;
+  h = sz.h;
+  return *this;
+}
+
+const SizeF& SizeF::operator+=(const SizeF& sz)
+{
+  w += sz.w;
+  h += sz.h;
+  return *this;
+}
+
+const SizeF& SizeF::operator-=(const SizeF& sz)
+{
+  w -= sz.w;
+  h -= sz.h;
+  return *this;
+}
+
+const SizeF& SizeF::operator*=(float value)
+{
+  w *= value;
+  h *= value;
+  return *this;
+}
+
+const SizeF& SizeF::operator/=(float value)
+{
+  w /= value;
+  h /= value;
+  return *this;
+}
+
+SizeF SizeF::operator+(const SizeF& sz) const
+{
+  return SizeF(w+sz.w, h+sz.h);
+}
+
+SizeF SizeF::operator-(const SizeF& sz) const
+{
+  return SizeF(w-sz.w, h-sz.h);
+}
+
+SizeF SizeF::operator*(float value) const
+{
+  return SizeF(w*value, h*value);
+}
+
+SizeF SizeF::operator/(float value) const
+{
+  return SizeF(w/value, h/value);
+}
+
+SizeF SizeF::operator-() const
+{
+  return SizeF(-w, -h);
+}
+
+bool SizeF::operator==(const SizeF& sz) const
+{
+  return w == sz.w && h == sz.h;
+}
+
+bool SizeF::operator!=(const SizeF& sz) const
+{
+  return w != sz.w || h != sz.h;
+}
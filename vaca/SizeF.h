@@ -0,0 +1,54 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_SIZEF_H
+#define VACA_SIZEF_H
+
+#include "vaca/base.h"
+
+namespace vaca {
+
+/**
+   A 2D size with subpixel precision (floating-point).
+
+   @see Size, PointF, RectF
+*/
+class VACA_DLL SizeF
+{
+public:
+
+  float w, h;
+
+  SizeF();
+  SizeF(float w, float h);
+  SizeF(const SizeF& size);
+  SizeF(const Size& size);
+  explicit SizeF(const PointF& point);
+
+  Size round() const;
+
+  SizeF createUnion(const SizeF& sz) const;
+  SizeF createIntersect(const SizeF& sz) const;
+
+  const SizeF& operator=(const SizeF& sz);
+  const SizeF& operator+=(const SizeF& sz);
+  const SizeF& operator-=(const SizeF& sz);
+  const SizeF& operator*=(float value);
+  const SizeF& operator/=(float value);
+  SizeF operator+(const SizeF& sz) const;
+  SizeF operator-(const SizeF& sz) const;
+  SizeF operator*(float value) const;
+  SizeF operator/(float value) const;
+  SizeF operator-() const;
+
+  bool operator==(const SizeF& sz) const;
+  bool operator!=(const SizeF& sz) const;
+
+};
+
+} // namespace vaca
+
+#endif // VACA_SIZEF_H
@@ -0,0 +1,145 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/SkylinePacker.h"
+
+#include <climits>
+
+using namespace vaca;
+
+/**
+   Creates an empty sheet of the specified @a size.
+*/
+SkylinePacker::SkylinePacker(const Size& size)
+  : m_size(size)
+{
+  assert(size.w > 0 && size.h > 0);
+  clear();
+}
+
+Size SkylinePacker::getSize() const
+{
+  return m_size;
+}
+
+/**
+   Returns the used area of the sheet, from 0.0 (empty) to 1.0
+   (full).
+*/
+double SkylinePacker::getOccupancy() const
+{
+  return static_cast<double>(m_usedArea) / (static_cast<double>(m_size.w) * m_size.h);
+}
+
+/**
+   Looks for a place for a rectangle of the specified @a size.
+
+   @return
+     True if the rectangle was placed (then @a position is its
+     top-left corner), or false if there is not enough space in the
+     sheet.
+*/
+bool SkylinePacker::insert(const Size& size, Point& position)
+{
+  if (size.w <= 0 || size.h <= 0)
+    return false;
+
+  int bestIndex = -1;
+  int bestBottom = INT_MAX;
+  int bestWidth = INT_MAX;
+  int y;
+
+  for (int i=0; i<static_cast<int>(m_skyline.size()); ++i) {
+    if (fit(i, size, y)) {
+      // the lowest bottom side, or the narrowest segment for the
+      // same bottom
+      if (y + size.h < bestBottom ||
+	  (y + size.h == bestBottom && m_skyline[i].w < bestWidth)) {
+	bestIndex = i;
+	bestBottom = y + size.h;
+	bestWidth = m_skyline[i].w;
+	position = Point(m_skyline[i].x, y);
+      }
+    }
+  }
+
+  if (bestIndex < 0)
+    return false;
+
+  addSegment(bestIndex, position, size);
+  m_usedArea += static_cast<long>(size.w) * size.h;
+  return true;
+}
+
+/**
+   Removes all the rectangles from the sheet.
+*/
+void SkylinePacker::clear()
+{
+  m_skyline.clear();
+  m_skyline.push_back(Segment(0, 0, m_size.w));
+  m_usedArea = 0;
+}
+
+/**
+   Returns true if a rectangle of the specified @a size fits with its
+   left side in the segment @a index. In that case @a y is the top
+   side of the rectangle (the highest segment below it).
+*/
+bool SkylinePacker::fit(int index, const Size& size, int& y) const
+{
+  int x = m_skyline[index].x;
+  if (x + size.w > m_size.w)
+    return false;
+
+  int widthLeft = size.w;
+  y = m_skyline[index].y;
+
+  for (int i=index; widthLeft > 0; ++i) {
+    y = max_value(y, m_skyline[i].y);
+    if (y + size.h > m_size.h)
+      return false;
+    widthLeft -= m_skyline[i].w;
+  }
+  return true;
+}
+
+/**
+   Puts a new segment in the skyline (the top side of the new
+   rectangle) and removes the segments that are below it.
+*/
+void SkylinePacker::addSegment(int index, const Point& position, const Size& size)
+{
+  m_skyline.insert(m_skyline.begin()+index,
+		   Segment(position.x, position.y + size.h, size.w));
+
+  // shrink or remove the next segments that are covered by the new one
+  int right = position.x + size.w;
+  for (int i=index+1; i<static_cast<int>(m_skyline.size()); ) {
+    Segment& s = m_skyline[i];
+    if (s.x >= right)
+      break;
+
+    int shrink = right - s.x;
+    if (s.w <= shrink)
+      m_skyline.erase(m_skyline.begin()+i);
+    else {
+      s.x += shrink;
+      s.w -= shrink;
+      break;
+    }
+  }
+
+  // merge contiguous segments at the same height
+  for (int i=0; i+1<static_cast<int>(m_skyline.size()); ) {
+    if (m_skyline[i].y == m_skyline[i+1].y) {
+      m_skyline[i].w += m_skyline[i+1].w;
+      m_skyline.erase(m_skyline.begin()+i+1);
+    }
+    else
+      ++i;
+  }
+}
@@ -0,0 +1,60 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_SKYLINEPACKER_H
+#define VACA_SKYLINEPACKER_H
+
+#include "vaca/base.h"
+#include "vaca/Point.h"
+#include "vaca/Size.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   Places rectangles inside a bigger one (a sheet) without overlapping
+   them, using the skyline bottom-left algorithm.
+
+   The packer keeps the "skyline" of the sheet: the top edge of the
+   rectangles placed so far, as a list of horizontal segments. Each
+   new rectangle is put over the segment where its bottom side ends
+   lower (so the sheet is filled from the top to the bottom).
+
+   For a better result, insert the rectangles sorted by height (the
+   tallest first).
+
+   @see ImageAtlas
+*/
+class VACA_DLL SkylinePacker
+{
+  struct Segment
+  {
+    int x, y, w;
+    Segment(int x, int y, int w) : x(x), y(y), w(w) { }
+  };
+
+  Size m_size;
+  std::vector<Segment> m_skyline;
+  long m_usedArea;
+
+public:
+  explicit SkylinePacker(const Size& size);
+
+  Size getSize() const;
+  double getOccupancy() const;
+
+  bool insert(const Size& size, Point& position);
+  void clear();
+
+private:
+  bool fit(int index, const Size& size, int& y) const;
+  void addSegment(int index, const Point& position, const Size& size);
+};
+
+} // namespace vaca
+
+#endif // VACA_SKYLINEPACKER_H
@@ -0,0 +1,508 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/StrokeFitter.h"
+
+#include <cmath>
+#include <utility>
+
+using namespace vaca;
+
+namespace {
+
+  // Maximum number of points of a curve (if a stroke is approximated
+  // with only one curve, the curve is fixed anyway to keep the time to
+  // fit it bounded)
+  const size_t max_curve_points = 256;
+
+  // Newton-Raphson iterations to improve the parameters of the points
+  const int max_iterations = 4;
+
+  struct Vec
+  {
+    double x, y;
+
+    Vec() : x(0.0), y(0.0) { }
+    Vec(double x, double y) : x(x), y(y) { }
+    Vec(const PointF& pt) : x(pt.x), y(pt.y) { }
+
+    Vec operator+(const Vec& v) const { return Vec(x+v.x, y+v.y); }
+    Vec operator-(const Vec& v) const { return Vec(x-v.x, y-v.y); }
+    Vec operator*(double k) const { return Vec(x*k, y*k); }
+    double dot(const Vec& v) const { return x*v.x + y*v.y; }
+    double length() const { return std::sqrt(x*x + y*y); }
+    bool isZero() const { return x == 0.0 && y == 0.0; }
+
+    Vec normalize() const {
+      double len = length();
+      return len > 0.0 ? Vec(x/len, y/len): Vec();
+    }
+
+    PointF toPointF() const {
+      return PointF(static_cast<float>(x), static_cast<float>(y));
+    }
+  };
+
+  struct Bezier
+  {
+    Vec p[4];
+
+    Vec at(double t) const {
+      double s = 1.0 - t;
+      return
+	p[0]*(s*s*s) + p[1]*(3*s*s*t) +
+	p[2]*(3*s*t*t) + p[3]*(t*t*t);
+    }
+
+    // first derivative
+    Vec d1(double t) const {
+      double s = 1.0 - t;
+      return
+	(p[1]-p[0])*(3*s*s) +
+	(p[2]-p[1])*(6*s*t) +
+	(p[3]-p[2])*(3*t*t);
+    }
+
+    // second derivative
+    Vec d2(double t) const {
+      return
+	(p[2] - p[1]*2 + p[0])*(6*(1.0-t)) +
+	(p[3] - p[2]*2 + p[1])*(6*t);
+    }
+  };
+
+  // Squared distance from "pt" to the segment a-b
+  double segment_distance2(const Vec& pt, const Vec& a, const Vec& b)
+  {
+    Vec ab = b - a;
+    Vec ap = pt - a;
+    double len2 = ab.dot(ab);
+    double t = (len2 > 0.0 ? ap.dot(ab) / len2: 0.0);
+    t = clamp_value(t, 0.0, 1.0);
+    Vec d = ap - ab*t;
+    return d.dot(d);
+  }
+
+  // Tangent in the first point (estimated with the next two points,
+  // because the positions of the mouse are rounded to pixels)
+  Vec start_tangent(const PointF* pts, int count)
+  {
+    Vec tangent = (Vec(pts[min_value(2, count-1)]) - Vec(pts[0])).normalize();
+    if (tangent.isZero())	// the stroke goes back
+      tangent = (Vec(pts[1]) - Vec(pts[0])).normalize();
+    return tangent;
+  }
+
+  // Tangent in the last point (pointing backwards)
+  Vec end_tangent(const PointF* pts, int count)
+  {
+    int last = count-1;
+    Vec tangent = (Vec(pts[max_value(last-2, 0)]) - Vec(pts[last])).normalize();
+    if (tangent.isZero())
+      tangent = (Vec(pts[last-1]) - Vec(pts[last])).normalize();
+    return tangent;
+  }
+
+  void chord_length_parameterize(const PointF* pts, int count, std::vector<double>& u)
+  {
+    u.resize(count);
+    u[0] = 0.0;
+    for (int i=1; i<count; ++i)
+      u[i] = u[i-1] + (Vec(pts[i]) - Vec(pts[i-1])).length();
+
+    double total = u[count-1];
+    for (int i=1; i<count; ++i)
+      u[i] = (total > 0.0 ? u[i] / total: 1.0);
+  }
+
+  // Finds the length of the tangents in the ends of the curve with
+  // least squares (the ends and the directions are fixed)
+  Bezier generate_bezier(const PointF* pts, int count, const std::vector<double>& u,
+			 const Vec& tangent1, const Vec& tangent2)
+  {
+    Vec p0(pts[0]);
+    Vec p3(pts[count-1]);
+    double c00 = 0.0, c01 = 0.0, c11 = 0.0;
+    double x0 = 0.0, x1 = 0.0;
+
+    for (int i=0; i<count; ++i) {
+      double t = u[i];
+      double s = 1.0 - t;
+      double b0 = s*s*s, b1 = 3*s*s*t, b2 = 3*s*t*t, b3 = t*t*t;
+
+      Vec a0 = tangent1*b1;
+      Vec a1 = tangent2*b2;
+      Vec tmp = Vec(pts[i]) - (p0*(b0+b1) + p3*(b2+b3));
+
+      c00 += a0.dot(a0);
+      c01 += a0.dot(a1);
+      c11 += a1.dot(a1);
+      x0 += a0.dot(tmp);
+      x1 += a1.dot(tmp);
+    }
+
+    double det = c00*c11 - c01*c01;
+    double alpha1 = (det != 0.0 ? (x0*c11 - x1*c01) / det: 0.0);
+    double alpha2 = (det != 0.0 ? (c00*x1 - c01*x0) / det: 0.0);
+
+    // the least squares solution is bad (e.g. the tangents go in the
+    // opposite direction), use the heuristic of Wu and Barsky
+    double length = (p3 - p0).length();
+    double epsilon = 1e-6 * length;
+    if (alpha1 < epsilon || alpha2 < epsilon)
+      alpha1 = alpha2 = length / 3.0;
+
+    Bezier bezier;
+    bezier.p[0] = p0;
+    bezier.p[1] = p0 + tangent1*alpha1;
+    bezier.p[2] = p3 + tangent2*alpha2;
+    bezier.p[3] = p3;
+    return bezier;
+  }
+
+  // Finds the curve with least squares where only the first point,
+  // the last point and the direction of the start tangent are fixed
+  // (so the end tangent is found from all the points instead of the
+  // last ones, which are rounded to pixels). Returns false if the
+  // curve can't be calculated or has a bad end tangent.
+  bool generate_free_bezier(const PointF* pts, int count, const std::vector<double>& u,
+			    const Vec& tangent1, Bezier& bezier)
+  {
+    if (count < 4)
+      return false;
+
+    Vec p0(pts[0]);
+    Vec p3(pts[count-1]);
+    double c00 = 0.0, c01x = 0.0, c01y = 0.0, c11 = 0.0;
+    double x0 = 0.0, x1 = 0.0, y1 = 0.0;
+
+    for (int i=0; i<count; ++i) {
+      double t = u[i];
+      double s = 1.0 - t;
+      double b0 = s*s*s, b1 = 3*s*s*t, b2 = 3*s*t*t, b3 = t*t*t;
+      Vec tmp = Vec(pts[i]) - (p0*(b0+b1) + p3*b3);
+
+      c00 += b1*b1;
+      c01x += b1*b2*tangent1.x;
+      c01y += b1*b2*tangent1.y;
+      c11 += b2*b2;
+      x0 += b1*tangent1.dot(tmp);
+      x1 += b2*tmp.x;
+      y1 += b2*tmp.y;
+    }
+
+    if (c11 <= 0.0)
+      return false;
+
+    // the position of the second control point depends on alpha1
+    double det = c00 - (c01x*c01x + c01y*c01y) / c11;
+    if (det <= 0.0)
+      return false;
+
+    double alpha1 = (x0 - (c01x*x1 + c01y*y1) / c11) / det;
+    Vec p2((x1 - c01x*alpha1) / c11,
+	   (y1 - c01y*alpha1) / c11);
+
+    double length = (p3 - p0).length();
+    double alpha2 = (p3 - p2).length();
+    if (alpha1 < 1e-6 * length || alpha1 > length ||
+	alpha2 < 1e-6 * length || alpha2 > length)
+      return false;
+
+    bezier.p[0] = p0;
+    bezier.p[1] = p0 + tangent1*alpha1;
+    bezier.p[2] = p2;
+    bezier.p[3] = p3;
+    return true;
+  }
+
+  // Returns the maximum squared distance between the points and the
+  // curve (in their parameters)
+  double compute_max_error(const PointF* pts, int count,
+			   const Bezier& bezier, const std::vector<double>& u)
+  {
+    double maxError = 0.0;
+    for (int i=1; i<count-1; ++i) {
+      Vec d = bezier.at(u[i]) - Vec(pts[i]);
+      maxError = max_value(maxError, d.dot(d));
+    }
+    return maxError;
+  }
+
+  // Improves the parameters of the points with a Newton-Raphson step
+  // (to find the nearest point of the curve)
+  void reparameterize(const PointF* pts, int count,
+		      const Bezier& bezier, std::vector<double>& u)
+  {
+    for (int i=1; i<count-1; ++i) {
+      double t = u[i];
+      Vec d = bezier.at(t) - Vec(pts[i]);
+      Vec q1 = bezier.d1(t);
+      Vec q2 = bezier.d2(t);
+      double denominator = q1.dot(q1) + d.dot(q2);
+      if (denominator != 0.0)
+	u[i] = clamp_value(t - d.dot(q1) / denominator, 0.0, 1.0);
+    }
+  }
+
+  // Fits all the points with one cubic bezier curve, and returns the
+  // maximum squared distance between the points and the curve
+  double fit_curve(const PointF* pts, int count, const Vec* startTangent,
+		   std::vector<double>& u, Bezier& bezier)
+  {
+    Vec tangent1 = (startTangent ? *startTangent: start_tangent(pts, count));
+    Vec tangent2 = end_tangent(pts, count);
+
+    chord_length_parameterize(pts, count, u);
+    if (!generate_free_bezier(pts, count, u, tangent1, bezier))
+      bezier = generate_bezier(pts, count, u, tangent1, tangent2);
+    double maxError = compute_max_error(pts, count, bezier, u);
+
+    for (int i=0; i<max_iterations && maxError > 0.0; ++i) {
+      reparameterize(pts, count, bezier, u);
+      Bezier other;
+      if (!generate_free_bezier(pts, count, u, tangent1, other))
+	other = generate_bezier(pts, count, u, tangent1, tangent2);
+      double error = compute_max_error(pts, count, other, u);
+      if (error >= maxError)
+	break;
+
+      bezier = other;
+      maxError = error;
+    }
+    return maxError;
+  }
+
+}
+
+/**
+   Creates a fitter for a new stroke.
+
+   @param tolerance
+     Maximum distance (in pixels) between the points of the stroke and
+     the curves. The control points of the curves are rounded to
+     pixels in the GraphicsPath.
+*/
+StrokeFitter::StrokeFitter(double tolerance)
+  : m_tolerance(tolerance)
+{
+  clear();
+}
+
+StrokeFitter::~StrokeFitter()
+{
+}
+
+double StrokeFitter::getTolerance() const
+{
+  return m_tolerance;
+}
+
+/**
+   Removes all the points and curves to start a new stroke.
+*/
+void StrokeFitter::clear()
+{
+  m_path.clear();
+  m_points.clear();
+  m_tangent = PointF();
+  m_hasTangent = false;
+  m_count = 0;
+}
+
+/**
+   Adds the next point of the stroke. A point equal to the previous
+   one is ignored.
+*/
+void StrokeFitter::addPoint(const PointF& pt)
+{
+  if (!m_points.empty() && m_points.back() == pt)
+    return;
+
+  m_points.push_back(pt);
+  ++m_count;
+
+  if (m_points.size() == 1) {
+    if (m_path.empty())
+      m_path.moveTo(pt);
+    return;
+  }
+
+  if (fitPending()) {
+    if (m_points.size() >= max_curve_points)
+      fixCurve();
+    return;
+  }
+
+  // the new point doesn't fit in the curve, so the curve is fixed
+  // without it, and a new curve starts in the previous point
+  m_points.pop_back();
+  fitPending();
+  fixCurve();
+
+  // a corner (the stroke turns more than 90 degrees): the new curve
+  // doesn't continue the tangent of the previous one
+  if (m_hasTangent &&
+      (Vec(pt) - Vec(m_points[0])).dot(Vec(m_tangent)) < 0.0)
+    m_hasTangent = false;
+
+  m_points.push_back(pt);
+  fitPending();
+}
+
+/**
+   Fixes the last curve (call it when the stroke is finished, e.g.
+   when the mouse button is released).
+*/
+void StrokeFitter::finish()
+{
+  if (m_points.size() >= 2)
+    fixCurve();
+}
+
+bool StrokeFitter::empty() const
+{
+  return m_count == 0;
+}
+
+/**
+   Returns the number of points added to the stroke (without the
+   repeated ones).
+*/
+int StrokeFitter::getPointCount() const
+{
+  return m_count;
+}
+
+/**
+   Returns the number of points that are kept to fit the last curve
+   (the rest of the points are already converted to curves).
+*/
+int StrokeFitter::getPendingPointCount() const
+{
+  return static_cast<int>(m_points.size());
+}
+
+/**
+   Returns the whole stroke: a figure with the fixed curves and the
+   last curve (that can change when more points are added).
+
+   A stroke with only one point is a path with only a
+   GraphicsPath::MoveTo node.
+*/
+GraphicsPath StrokeFitter::getPath() const
+{
+  GraphicsPath path = m_path;
+  if (m_points.size() >= 2)
+    path.curveTo(m_curve[0], m_curve[1], m_curve[2]);
+  return path;
+}
+
+/**
+   Fits the pending points with one curve (#m_curve).
+
+   @return
+     True if all the points are near the curve.
+*/
+bool StrokeFitter::fitPending()
+{
+  Vec tangent(m_tangent);
+  Bezier bezier;
+  double error = fit_curve(&m_points[0], static_cast<int>(m_points.size()),
+			   m_hasTangent ? &tangent: NULL, m_params, bezier);
+
+  m_curve[0] = bezier.p[1].toPointF();
+  m_curve[1] = bezier.p[2].toPointF();
+  m_curve[2] = bezier.p[3].toPointF();
+
+  return error <= m_tolerance*m_tolerance;
+}
+
+/**
+   Adds the last curve to the path, and starts a new curve in its last
+   point with the same tangent.
+*/
+void StrokeFitter::fixCurve()
+{
+  m_path.curveTo(m_curve[0], m_curve[1], m_curve[2]);
+
+  Vec direction = (Vec(m_curve[2]) - Vec(m_curve[1])).normalize();
+  if (direction.isZero())
+    direction = (Vec(m_curve[2]) - Vec(m_points[0])).normalize();
+
+  m_tangent = direction.toPointF();
+  m_hasTangent = !direction.isZero();
+  m_points.erase(m_points.begin(), m_points.end()-1);
+}
+
+/**
+   Removes the points of a polyline that are not needed to keep its
+   shape (Ramer-Douglas-Peucker algorithm): no removed point is
+   farther than @a tolerance pixels from the new polyline. The first
+   and last points are always kept.
+*/
+void StrokeFitter::simplify(const std::vector<PointF>& points, double tolerance,
+			    std::vector<PointF>& result)
+{
+  int count = static_cast<int>(points.size());
+  result.clear();
+  if (count <= 2) {
+    result = points;
+    return;
+  }
+
+  double error = tolerance*tolerance;
+  std::vector<bool> keep(count, false);
+  std::vector<std::pair<int, int> > stack;
+
+  keep[0] = keep[count-1] = true;
+  stack.push_back(std::make_pair(0, count-1));
+
+  while (!stack.empty()) {
+    int first = stack.back().first;
+    int last = stack.back().second;
+    stack.pop_back();
+
+    Vec a(points[first]);
+    Vec b(points[last]);
+    double maxError = 0.0;
+    int index = -1;
+
+    for (int i=first+1; i<last; ++i) {
+      double d = segment_distance2(Vec(points[i]), a, b);
+      if (d > maxError) {
+	maxError = d;
+	index = i;
+      }
+    }
+
+    if (index >= 0 && maxError > error) {
+      keep[index] = true;
+      stack.push_back(std::make_pair(first, index));
+      stack.push_back(std::make_pair(index, last));
+    }
+  }
+
+  for (int i=0; i<count; ++i)
+    if (keep[i])
+      result.push_back(points[i]);
+}
+
+/**
+   Returns a figure with the bezier curves that approximate all the
+   @a points (the points of a stroke that is already captured).
+
+   @param tolerance
+     Maximum distance (in pixels) between the points and the curves.
+*/
+GraphicsPath StrokeFitter::fitCurves(const std::vector<PointF>& points, double tolerance)
+{
+  StrokeFitter fitter(tolerance);
+  for (size_t i=0; i<points.size(); ++i)
+    fitter.addPoint(points[i]);
+  fitter.finish();
+  return fitter.getPath();
+}
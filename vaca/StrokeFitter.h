@@ -0,0 +1,94 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_STROKEFITTER_H
+#define VACA_STROKEFITTER_H
+
+#include "vaca/base.h"
+#include "vaca/PointF.h"
+#include "vaca/GraphicsPath.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   Converts the points of a freehand stroke (e.g. the positions of the
+   mouse while a button is pressed) to a few bezier curves.
+
+   The points are received one by one with #addPoint, and the curves
+   are fitted while the stroke is drawn: the last curve is extended
+   while it can approximate the new points, and when it can't, it's
+   fixed and a new curve starts (with the same tangent, so the stroke
+   is smooth, unless it turns more than 90 degrees there: a corner).
+   Only the points of the last curve are kept, so a long stroke uses a
+   GraphicsPath with some curves instead of thousands of points.
+
+   The curves are never farther than the tolerance from the points.
+   They are fitted with least squares, as in Philip J. Schneider's
+   algorithm ("An Algorithm for Automatically Fitting Digitized
+   Curves", Graphics Gems).
+
+   Example:
+   @code
+   void onMouseDown(MouseEvent& ev) {
+     m_fitter.clear();
+     m_fitter.addPoint(ev.getPoint());
+   }
+   void onMouseMove(MouseEvent& ev) {
+     m_fitter.addPoint(ev.getPoint());
+     invalidate(false);	// onPaint uses m_fitter.getPath()
+   }
+   void onMouseUp(MouseEvent& ev) {
+     m_fitter.finish();
+     m_strokes.push_back(m_fitter.getPath());
+   }
+   @endcode
+
+   The static member functions #simplify (Ramer-Douglas-Peucker
+   algorithm) and #fitCurves process a whole polyline at once.
+
+   @see GraphicsPath, PointF
+*/
+class VACA_DLL StrokeFitter
+{
+  double m_tolerance;
+  GraphicsPath m_path;		// fixed curves
+  std::vector<PointF> m_points;	// points after the last fixed curve
+  std::vector<double> m_params;	// parameters of the points in the curve
+  PointF m_curve[3];		// curve that fits m_points (control points and end)
+  PointF m_tangent;		// start tangent of the curve
+  bool m_hasTangent;
+  int m_count;
+
+public:
+
+  explicit StrokeFitter(double tolerance = 1.0);
+  virtual ~StrokeFitter();
+
+  double getTolerance() const;
+
+  void clear();
+  void addPoint(const PointF& pt);
+  void finish();
+
+  bool empty() const;
+  int getPointCount() const;
+  int getPendingPointCount() const;
+  GraphicsPath getPath() const;
+
+  static void simplify(const std::vector<PointF>& points, double tolerance,
+		       std::vector<PointF>& result);
+  static GraphicsPath fitCurves(const std::vector<PointF>& points, double tolerance);
+
+private:
+  bool fitPending();
+  void fixCurve();
+};
+
+} // namespace vaca
+
+#endif // VACA_STROKEFITTER_H
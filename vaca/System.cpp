@@ -344,6 +344,23 @@ String System::getFriendlyUserName()
   return getUserName();
 }
 
+/**
+   Returns the number of logical processors in the computer.
+
+   It is used to know how many threads are worth to be created to
+   split a CPU intensive task (see parallel_for).
+
+   @win32
+     It is the @c dwNumberOfProcessors field returned by @msdn{GetSystemInfo}.
+   @endwin32
+*/
+int System::getProcessorCount()
+{
+  SYSTEM_INFO si;
+  GetSystemInfo(&si);
+  return si.dwNumberOfProcessors > 0 ? static_cast<int>(si.dwNumberOfProcessors): 1;
+}
+
 // int System::getWheelScrollLines()
 // {
 //   UINT pulScrollLines = 0;
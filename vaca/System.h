@@ -50,6 +50,8 @@ public:
   static String getUserName();
   static String getFriendlyUserName();
 
+  static int getProcessorCount();
+
   //static int getWheelScrollLines();
 
 };
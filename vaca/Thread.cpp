@@ -5,6 +5,7 @@
 // please read LICENSE.txt for more information.
 
 #include "vaca/Thread.h"
+#include "vaca/BackingStore.h"
 #include "vaca/Debug.h"
 #include "vaca/Frame.h"
 #include "vaca/Signal.h"
@@ -53,11 +54,22 @@ struct ThreadData
   */
   Widget* outsideWidget;
 
+  /**
+     Off-screen image shared by double-buffered widgets (created
+     the first time it is needed).
+  */
+  BackingStore* backingStore;
+
   ThreadData(ThreadId id) {
     threadId = id;
     breakLoop = false;
     updateIndicators = true;
     outsideWidget = NULL;
+    backingStore = NULL;
+  }
+
+  ~ThreadData() {
+    delete backingStore;
   }
 
 };
@@ -407,6 +419,22 @@ void CurrentThread::processMessage(Message& message)
   }
 }
 
+/**
+   Returns the BackingStore used to paint double-buffered widgets in
+   the current thread.
+
+   @see Widget#setDoubleBuffered
+*/
+BackingStore& CurrentThread::getBackingStore()
+{
+  ThreadData* data = get_thread_data();
+
+  if (data->backingStore == NULL)
+    data->backingStore = new BackingStore();
+
+  return *data->backingStore;
+}
+
 // ======================================================================
 // Vaca internals
 
@@ -128,6 +128,8 @@ namespace CurrentThread
   VACA_DLL bool peekMessage(Message& msg);
   VACA_DLL void processMessage(Message& msg);
 
+  VACA_DLL BackingStore& getBackingStore();
+
   namespace details {
     VACA_DLL bool preTranslateMessage(Message& message);
 
@@ -0,0 +1,305 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/TiledSurface.h"
+#include "vaca/Brush.h"
+#include "vaca/Graphics.h"
+
+#include <algorithm>
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  // Division rounding to negative infinity (tiles with negative
+  // coordinates are valid)
+  inline int floor_div(int a, int b)
+  {
+    return (a >= 0 ? a / b: -((-a + b - 1) / b));
+  }
+
+  // Copies a rectangle of pixels between two ImagePixels
+  void copy_pixels(const ImagePixels& src, const Point& srcPt,
+		   ImagePixels& dst, const Point& dstPt, const Size& size)
+  {
+    for (int y=0; y<size.h; ++y) {
+      const pixel_type* s = &src[0] + (srcPt.y+y)*src.getScanlineSize() + srcPt.x;
+      std::copy(s, s+size.w, &dst[0] + (dstPt.y+y)*dst.getScanlineSize() + dstPt.x);
+    }
+  }
+
+} // anonymous namespace
+
+/**
+   Creates an empty surface.
+
+   @param bgColor
+     Color of the areas where nothing was drawn.
+
+   @param tileSize
+     Width and height of each tile.
+*/
+TiledSurface::TiledSurface(const Color& bgColor, int tileSize)
+  : m_bgColor(bgColor)
+  , m_tileSize(tileSize)
+{
+  assert(tileSize > 0);
+}
+
+TiledSurface::~TiledSurface()
+{
+}
+
+Color TiledSurface::getBgColor() const
+{
+  return m_bgColor;
+}
+
+int TiledSurface::getTileSize() const
+{
+  return m_tileSize;
+}
+
+/**
+   Returns the number of tiles created (tiles are created the first
+   time something is drawn inside them).
+*/
+int TiledSurface::getTileCount() const
+{
+  return static_cast<int>(m_tiles.size());
+}
+
+/**
+   Returns the bounds of all the created tiles.
+*/
+Rect TiledSurface::getBounds() const
+{
+  Rect bounds;
+  for (Tiles::const_iterator it=m_tiles.begin(); it!=m_tiles.end(); ++it)
+    bounds = bounds.createUnion(getTileBounds(it->first));
+  return bounds;
+}
+
+/**
+   Draws inside the @a bounds area of the surface.
+
+   The function @a f is called one time for each tile that intersects
+   @a bounds, with a Graphics that uses the coordinates of the surface
+   and is clipped to @a bounds and to the tile. The area is marked as
+   dirty.
+*/
+void TiledSurface::draw(const Rect& bounds, const std::function<void(Graphics&)>& f)
+{
+  if (bounds.isEmpty())
+    return;
+
+  TileKey first, last;
+  getTileRange(bounds, first, last);
+
+  for (int row=first.first; row<=last.first; ++row)
+    for (int col=first.second; col<=last.second; ++col) {
+      TileKey key(row, col);
+      Rect tileBounds = getTileBounds(key);
+      Tile& tile = getTile(key);
+      Graphics& g = tile.image.getGraphics();
+      HDC hdc = g.getHandle();
+      int savedDC = SaveDC(hdc);
+
+      SetViewportOrgEx(hdc, -tileBounds.x, -tileBounds.y, NULL);
+      g.intersectClipRect(bounds);
+      f(g);
+      RestoreDC(hdc, savedDC);
+
+      tile.dirty = tile.dirty.createUnion(bounds.createIntersect(tileBounds));
+    }
+}
+
+/**
+   Paints the @a rc area of the surface in @a g (both use the same
+   coordinates). Only the tiles that intersect @a rc are copied.
+*/
+void TiledSurface::paint(Graphics& g, const Rect& rc)
+{
+  if (rc.isEmpty())
+    return;
+
+  Brush bgBrush(m_bgColor);
+  TileKey first, last;
+  getTileRange(rc, first, last);
+
+  for (int row=first.first; row<=last.first; ++row)
+    for (int col=first.second; col<=last.second; ++col) {
+      TileKey key(row, col);
+      Rect tileBounds = getTileBounds(key);
+      Rect part = rc.createIntersect(tileBounds);
+      Tiles::iterator it = m_tiles.find(key);
+
+      if (it != m_tiles.end())
+	g.drawImage(it->second.image,
+		    part.x, part.y,
+		    part.x - tileBounds.x, part.y - tileBounds.y,
+		    part.w, part.h);
+      else
+	g.fillRect(bgBrush, part);
+    }
+}
+
+/**
+   Returns the pixels of the @a rc area of the surface.
+*/
+ImagePixels TiledSurface::getPixels(const Rect& rc)
+{
+  ImagePixels pixels(rc.w, rc.h);
+  pixel_type bg = ImagePixels::makePixel(m_bgColor.getR(),
+					 m_bgColor.getG(),
+					 m_bgColor.getB(), 0);
+  TileKey first, last;
+  getTileRange(rc, first, last);
+
+  for (int row=first.first; row<=last.first; ++row)
+    for (int col=first.second; col<=last.second; ++col) {
+      TileKey key(row, col);
+      Rect tileBounds = getTileBounds(key);
+      Rect part = rc.createIntersect(tileBounds);
+      Tiles::iterator it = m_tiles.find(key);
+
+      if (it != m_tiles.end()) {
+	ImagePixels tilePixels = it->second.image.getPixels();
+	copy_pixels(tilePixels, part.getOrigin() - tileBounds.getOrigin(),
+		    pixels, part.getOrigin() - rc.getOrigin(), part.getSize());
+      }
+      else {
+	for (int y=part.y; y<part.y+part.h; ++y)
+	  for (int x=part.x; x<part.x+part.w; ++x)
+	    pixels.setPixel(x - rc.x, y - rc.y, bg);
+      }
+    }
+
+  return pixels;
+}
+
+/**
+   Copies the @a pixels to the surface, in the position @a pt. The
+   modified area is marked as dirty.
+*/
+void TiledSurface::setPixels(const Point& pt, const ImagePixels& pixels)
+{
+  Rect rc(pt, Size(pixels.getWidth(), pixels.getHeight()));
+  if (rc.isEmpty())
+    return;
+
+  TileKey first, last;
+  getTileRange(rc, first, last);
+
+  for (int row=first.first; row<=last.first; ++row)
+    for (int col=first.second; col<=last.second; ++col) {
+      TileKey key(row, col);
+      Rect tileBounds = getTileBounds(key);
+      Rect part = rc.createIntersect(tileBounds);
+      Tile& tile = getTile(key);
+
+      ImagePixels tilePixels = tile.image.getPixels();
+      copy_pixels(pixels, part.getOrigin() - rc.getOrigin(),
+		  tilePixels, part.getOrigin() - tileBounds.getOrigin(), part.getSize());
+      tile.image.setPixels(tilePixels);
+
+      tile.dirty = tile.dirty.createUnion(part);
+    }
+}
+
+/**
+   Marks the @a rc area as dirty (e.g. to repaint it again). Areas
+   without tiles are not marked.
+*/
+void TiledSurface::invalidate(const Rect& rc)
+{
+  if (rc.isEmpty())
+    return;
+
+  TileKey first, last;
+  getTileRange(rc, first, last);
+
+  for (int row=first.first; row<=last.first; ++row)
+    for (int col=first.second; col<=last.second; ++col) {
+      TileKey key(row, col);
+      Tiles::iterator it = m_tiles.find(key);
+      if (it != m_tiles.end())
+	it->second.dirty = it->second.dirty.createUnion(rc.createIntersect(getTileBounds(key)));
+    }
+}
+
+/**
+   Returns true if some area was modified since the last call to
+   #clearDirty.
+*/
+bool TiledSurface::isDirty() const
+{
+  for (Tiles::const_iterator it=m_tiles.begin(); it!=m_tiles.end(); ++it)
+    if (!it->second.dirty.isEmpty())
+      return true;
+  return false;
+}
+
+/**
+   Returns the modified areas (one rectangle for each dirty tile, at
+   most) since the last call to #clearDirty.
+*/
+void TiledSurface::getDirtyRects(std::vector<Rect>& rects) const
+{
+  rects.clear();
+  for (Tiles::const_iterator it=m_tiles.begin(); it!=m_tiles.end(); ++it)
+    if (!it->second.dirty.isEmpty())
+      rects.push_back(it->second.dirty);
+}
+
+void TiledSurface::clearDirty()
+{
+  for (Tiles::iterator it=m_tiles.begin(); it!=m_tiles.end(); ++it)
+    it->second.dirty = Rect();
+}
+
+/**
+   Removes all the tiles (the whole surface gets the background
+   color).
+*/
+void TiledSurface::clear()
+{
+  m_tiles.clear();
+}
+
+Rect TiledSurface::getTileBounds(const TileKey& key) const
+{
+  return Rect(key.second*m_tileSize, key.first*m_tileSize,
+	      m_tileSize, m_tileSize);
+}
+
+void TiledSurface::getTileRange(const Rect& rc, TileKey& first, TileKey& last) const
+{
+  first.first = floor_div(rc.y, m_tileSize);
+  first.second = floor_div(rc.x, m_tileSize);
+  last.first = floor_div(rc.y+rc.h-1, m_tileSize);
+  last.second = floor_div(rc.x+rc.w-1, m_tileSize);
+}
+
+/**
+   Returns the tile with the specified @a key, creating it (filled
+   with the background color) if it doesn't exist.
+*/
+TiledSurface::Tile& TiledSurface::getTile(const TileKey& key)
+{
+  Tiles::iterator it = m_tiles.find(key);
+  if (it != m_tiles.end())
+    return it->second;
+
+  Tile& tile = m_tiles[key];
+  tile.image = Image(Size(m_tileSize, m_tileSize), 32);
+
+  Brush bgBrush(m_bgColor);
+  tile.image.getGraphics().fillRect(bgBrush, 0, 0, m_tileSize, m_tileSize);
+  return tile;
+}
@@ -0,0 +1,107 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_TILEDSURFACE_H
+#define VACA_TILEDSURFACE_H
+
+#include "vaca/base.h"
+#include "vaca/NonCopyable.h"
+#include "vaca/Color.h"
+#include "vaca/Image.h"
+#include "vaca/ImagePixels.h"
+#include "vaca/Rect.h"
+
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace vaca {
+
+/**
+   A drawing surface without limits, made of fixed-size tiles.
+
+   Tiles are 32 bits per pixel images (the same format of ImagePixels)
+   that are created the first time something is drawn inside them, so
+   the surface can be as big as needed and it grows without copying
+   the existing content. Areas without tiles are painted with the
+   background color.
+
+   The surface remembers which part of each tile was modified
+   (dirty areas), so a widget can repaint only what changed:
+   @code
+   void MyCanvas::onMouseMove(MouseEvent& ev)
+   {
+     m_surface.draw(bounds, [&](Graphics& g) {
+	 g.drawLine(pen, p1, p2);
+       });
+
+     std::vector<Rect> dirty;
+     m_surface.getDirtyRects(dirty);
+     for (size_t i=0; i<dirty.size(); ++i)
+       invalidate(dirty[i], false);
+     m_surface.clearDirty();
+   }
+
+   void MyCanvas::onPaint(PaintEvent& ev)
+   {
+     Graphics& g = ev.getGraphics();
+     m_surface.paint(g, g.getClipBounds());
+   }
+   @endcode
+*/
+class VACA_DLL TiledSurface : private NonCopyable
+{
+  struct Tile
+  {
+    Image image;
+    Rect dirty;
+  };
+
+  typedef std::pair<int, int> TileKey; // (row, column)
+  typedef std::map<TileKey, Tile> Tiles;
+
+  Tiles m_tiles;
+  Color m_bgColor;
+  int m_tileSize;
+
+public:
+  /**
+     Default width and height of each tile.
+  */
+  enum { DefaultTileSize = 256 };
+
+  explicit TiledSurface(const Color& bgColor = Color::White,
+			int tileSize = DefaultTileSize);
+  virtual ~TiledSurface();
+
+  Color getBgColor() const;
+  int getTileSize() const;
+  int getTileCount() const;
+  Rect getBounds() const;
+
+  void draw(const Rect& bounds, const std::function<void(Graphics&)>& f);
+  void paint(Graphics& g, const Rect& rc);
+
+  ImagePixels getPixels(const Rect& rc);
+  void setPixels(const Point& pt, const ImagePixels& pixels);
+
+  void invalidate(const Rect& rc);
+  bool isDirty() const;
+  void getDirtyRects(std::vector<Rect>& rects) const;
+  void clearDirty();
+
+  void clear();
+
+private:
+  Rect getTileBounds(const TileKey& key) const;
+  void getTileRange(const Rect& rc, TileKey& first, TileKey& last) const;
+  Tile& getTile(const TileKey& key);
+};
+
+} // namespace vaca
+
+#endif // VACA_TILEDSURFACE_H
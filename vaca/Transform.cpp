@@ -0,0 +1,286 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/Transform.h"
+#include "vaca/PointF.h"
+#include "vaca/RectF.h"
+#include "vaca/Simd.h"
+
+#include <cmath>
+#ifndef M_PI
+#  define M_PI 3.14159265358979323846
+#endif
+
+using namespace vaca;
+
+/**
+   Creates the identity transformation (points aren't modified).
+*/
+Transform::Transform()
+{
+  reset();
+}
+
+Transform::Transform(double m11, double m12, double m21, double m22, double dx, double dy)
+{
+  this->m11 = m11;
+  this->m12 = m12;
+  this->m21 = m21;
+  this->m22 = m22;
+  this->dx = dx;
+  this->dy = dy;
+}
+
+Transform::Transform(const Transform& transform)
+{
+  operator=(transform);
+}
+
+bool Transform::isIdentity() const
+{
+  return
+    m11 == 1.0 && m12 == 0.0 &&
+    m21 == 0.0 && m22 == 1.0 &&
+    dx == 0.0 && dy == 0.0;
+}
+
+/**
+   Returns true if the transformation can be inverted (it doesn't
+   collapse the plane in a line or a point, e.g. a scale of zero).
+*/
+bool Transform::isInvertible() const
+{
+  return getDeterminant() != 0.0;
+}
+
+/**
+   Returns the determinant of the matrix: how much the areas are
+   scaled (it's negative if the transformation flips the shapes).
+*/
+double Transform::getDeterminant() const
+{
+  return m11*m22 - m12*m21;
+}
+
+/**
+   Changes the transformation to the identity.
+*/
+Transform& Transform::reset()
+{
+  m11 = 1.0;
+  m12 = 0.0;
+  m21 = 0.0;
+  m22 = 1.0;
+  dx = 0.0;
+  dy = 0.0;
+  return *this;
+}
+
+/**
+   Moves the origin of the coordinates to (@a tx, @a ty).
+*/
+Transform& Transform::translate(double tx, double ty)
+{
+  return multiply(Transform(1.0, 0.0, 0.0, 1.0, tx, ty));
+}
+
+Transform& Transform::scale(double sx, double sy)
+{
+  return multiply(Transform(sx, 0.0, 0.0, sy, 0.0, 0.0));
+}
+
+/**
+   Rotates the coordinates around the origin.
+
+   @param angle
+     Angle in degrees, from the x axis to the y axis (clockwise
+     on the screen, because the y axis goes down).
+*/
+Transform& Transform::rotate(double angle)
+{
+  double r = angle * M_PI / 180.0;
+  double c = std::cos(r);
+  double s = std::sin(r);
+
+  // exact values for multiples of 90 degrees
+  if (std::fabs(c) < 1e-15) c = 0.0;
+  if (std::fabs(s) < 1e-15) s = 0.0;
+
+  return multiply(Transform(c, s, -s, c, 0.0, 0.0));
+}
+
+/**
+   Shears the coordinates: x' = x + @a shx*y and y' = y + @a shy*x.
+*/
+Transform& Transform::shear(double shx, double shy)
+{
+  return multiply(Transform(1.0, shy, shx, 1.0, 0.0, 0.0));
+}
+
+/**
+   Applies @a transform to the points before this transformation
+   (this = transform * this).
+*/
+Transform& Transform::multiply(const Transform& transform)
+{
+  *this = transform * (*this);
+  return *this;
+}
+
+/**
+   Changes this transformation to its inverse (the one that converts
+   transformed points to the original ones).
+
+   @return
+     False if the transformation isn't invertible (in this case it's
+     not modified).
+*/
+bool Transform::invert()
+{
+  double det = getDeterminant();
+  if (det == 0.0)
+    return false;
+
+  Transform inv( m22/det, -m12/det,
+		-m21/det,  m11/det,
+		(m21*dy - m22*dx)/det,
+		(m12*dx - m11*dy)/det);
+  *this = inv;
+  return true;
+}
+
+/**
+   Returns the transformed point.
+
+   The result is exactly the same of the batch version of #apply.
+*/
+PointF Transform::apply(const PointF& pt) const
+{
+  PointF result;
+  apply(&pt, &result, 1);
+  return result;
+}
+
+/**
+   Returns the bounds of the transformed rectangle (if the
+   transformation rotates or shears the rectangle, the result
+   contains its four corners).
+*/
+RectF Transform::apply(const RectF& rc) const
+{
+  PointF corners[4] = { PointF(rc.x, rc.y),
+			PointF(rc.x+rc.w, rc.y),
+			PointF(rc.x, rc.y+rc.h),
+			PointF(rc.x+rc.w, rc.y+rc.h) };
+  apply(corners, corners, 4);
+
+  PointF p1 = corners[0];
+  PointF p2 = corners[0];
+  for (int i=1; i<4; ++i) {
+    p1.x = min_value(p1.x, corners[i].x);
+    p1.y = min_value(p1.y, corners[i].y);
+    p2.x = max_value(p2.x, corners[i].x);
+    p2.y = max_value(p2.y, corners[i].y);
+  }
+  return RectF(p1, p2);
+}
+
+/**
+   Transforms @a count points from @a src to @a dst. The same array
+   can be used as source and destination.
+
+   The points are transformed with single precision (as the
+   coordinates of PointF), four points at a time with SSE2.
+*/
+void Transform::apply(const PointF* src, PointF* dst, int count) const
+{
+  const float a = static_cast<float>(m11);
+  const float b = static_cast<float>(m12);
+  const float c = static_cast<float>(m21);
+  const float d = static_cast<float>(m22);
+  const float e = static_cast<float>(dx);
+  const float f = static_cast<float>(dy);
+  int i = 0;
+
+#ifdef VACA_SSE2
+  static_assert(sizeof(PointF) == 2*sizeof(float), "PointF must be x, y");
+
+  const __m128 mx = _mm_setr_ps(a, b, a, b);
+  const __m128 my = _mm_setr_ps(c, d, c, d);
+  const __m128 mt = _mm_setr_ps(e, f, e, f);
+  const float* s = &src->x;
+  float* t = &dst->x;
+
+  for (; i+4<=count; i+=4, s+=8, t+=8) {
+    __m128 p0 = _mm_loadu_ps(s);   // x0 y0 x1 y1
+    __m128 p1 = _mm_loadu_ps(s+4); // x2 y2 x3 y3
+
+    __m128 x0 = _mm_shuffle_ps(p0, p0, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 y0 = _mm_shuffle_ps(p0, p0, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128 x1 = _mm_shuffle_ps(p1, p1, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 y1 = _mm_shuffle_ps(p1, p1, _MM_SHUFFLE(3, 3, 1, 1));
+
+    _mm_storeu_ps(t,   _mm_add_ps(_mm_add_ps(_mm_mul_ps(x0, mx), _mm_mul_ps(y0, my)), mt));
+    _mm_storeu_ps(t+4, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x1, mx), _mm_mul_ps(y1, my)), mt));
+  }
+#endif
+
+  // the same operations in the same order than the SSE2 version
+  for (; i<count; ++i) {
+    float x = src[i].x;
+    float y = src[i].y;
+    dst[i].x = (x*a + y*c) + e;
+    dst[i].y = (x*b + y*d) + f;
+  }
+}
+
+/**
+   Transforms all the @a points.
+*/
+void Transform::apply(std::vector<PointF>& points) const
+{
+  if (!points.empty())
+    apply(&points[0], &points[0], static_cast<int>(points.size()));
+}
+
+const Transform& Transform::operator=(const Transform& transform)
+{
+  m11 = transform.m11;
+  m12 = transform.m12;
+  m21 = transform.m21;
+  m22 = transform.m22;
+  dx = transform.dx;
+  dy = transform.dy;
+  return *this;
+}
+
+/**
+   Returns the transformation that applies this one and then @a
+   transform.
+*/
+Transform Transform::operator*(const Transform& transform) const
+{
+  const Transform& t = transform;
+  return Transform(m11*t.m11 + m12*t.m21,
+		   m11*t.m12 + m12*t.m22,
+		   m21*t.m11 + m22*t.m21,
+		   m21*t.m12 + m22*t.m22,
+		   dx*t.m11 + dy*t.m21 + t.dx,
+		   dx*t.m12 + dy*t.m22 + t.dy);
+}
+
+bool Transform::operator==(const Transform& transform) const
+{
+  return
+    m11 == transform.m11 && m12 == transform.m12 &&
+    m21 == transform.m21 && m22 == transform.m22 &&
+    dx == transform.dx && dy == transform.dy;
+}
+
+bool Transform::operator!=(const Transform& transform) const
+{
+  return !operator==(transform);
+}
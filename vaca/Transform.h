@@ -0,0 +1,78 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_TRANSFORM_H
+#define VACA_TRANSFORM_H
+
+#include "vaca/base.h"
+
+#include <vector>
+
+namespace vaca {
+
+/**
+   A 2D affine transformation (translation, scale, rotation and
+   shear) of PointF coordinates.
+
+   It's a 3x3 matrix where the last column is always (0, 0, 1), so a
+   point (x, y) is transformed to:
+   @code
+   x' = m11*x + m21*y + dx
+   y' = m12*x + m22*y + dy
+   @endcode
+   (the same elements as the XFORM structure of Win32).
+
+   The #translate, #scale, #rotate and #shear member functions are
+   applied to the points before the current transformation, so they
+   are written in the same order that you would move a coordinate
+   system:
+   @code
+   Transform t;
+   t.translate(100, 100)	// the center of the widget
+    .rotate(45)
+    .scale(2, 2);		// draw a 2x shape rotated in the center
+   @endcode
+
+   @see PointF, RectF, GraphicsPath#transform
+*/
+class VACA_DLL Transform
+{
+public:
+
+  double m11, m12, m21, m22, dx, dy;
+
+  Transform();
+  Transform(double m11, double m12, double m21, double m22, double dx, double dy);
+  Transform(const Transform& transform);
+
+  bool isIdentity() const;
+  bool isInvertible() const;
+  double getDeterminant() const;
+
+  Transform& reset();
+  Transform& translate(double tx, double ty);
+  Transform& scale(double sx, double sy);
+  Transform& rotate(double angle);
+  Transform& shear(double shx, double shy);
+  Transform& multiply(const Transform& transform);
+  bool invert();
+
+  PointF apply(const PointF& pt) const;
+  RectF apply(const RectF& rc) const;
+  void apply(const PointF* src, PointF* dst, int count) const;
+  void apply(std::vector<PointF>& points) const;
+
+  const Transform& operator=(const Transform& transform);
+  Transform operator*(const Transform& transform) const;
+
+  bool operator==(const Transform& transform) const;
+  bool operator!=(const Transform& transform) const;
+
+};
+
+} // namespace vaca
+
+#endif // VACA_TRANSFORM_H
@@ -0,0 +1,180 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "vaca/VideoFormats.h"
+#include "vaca/ParallelFor.h"
+#include "vaca/Simd.h"
+
+using namespace vaca;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+namespace {
+
+  // Minimum number of scanlines to be converted by each thread
+  const int scanlines_per_thread = 32;
+
+  // BT.601 coefficients in 8.8 fixed-point
+  const int coef_y = 298;
+  const int coef_rv = 409;
+  const int coef_gu = -100;
+  const int coef_gv = -208;
+  const int coef_bu = 516;
+
+  // Returns value*coef/256. It is calculated in the same way as the
+  // SSE2 version (_mm_mulhi_epi16 of value<<7 and coef<<1), so both
+  // versions give exactly the same result.
+  inline int mul_coef(int value, int coef)
+  {
+    return ((value*128) * (coef*2)) >> 16;
+  }
+
+  inline int clamp_byte(int value)
+  {
+    return value < 0 ? 0: (value > 255 ? 255: value);
+  }
+
+  inline pixel_type yuv_to_pixel(int y, int u, int v)
+  {
+    int c = mul_coef(y - 16, coef_y);
+    int d = u - 128;
+    int e = v - 128;
+    return ImagePixels::makePixel(clamp_byte(c + mul_coef(e, coef_rv)),
+				  clamp_byte(c + mul_coef(d, coef_gu) + mul_coef(e, coef_gv)),
+				  clamp_byte(c + mul_coef(d, coef_bu)),
+				  255);
+  }
+
+#ifdef VACA_SSE2
+
+  // Converts eight pixels. y has eight 16-bit Y values, and uv has
+  // four 16-bit U/V pairs (U0 V0 U1 V1 U2 V2 U3 V3), one pair for each
+  // two pixels.
+  inline void yuv_to_pixels_sse2(__m128i y, __m128i uv, pixel_type* dst)
+  {
+    const __m128i k16 = _mm_set1_epi16(16);
+    const __m128i k128 = _mm_set1_epi16(128);
+    const __m128i alpha = _mm_set1_epi8(static_cast<char>(255));
+
+    // duplicate each U and each V for the two pixels of the pair
+    uv = _mm_sub_epi16(uv, k128);
+    __m128i u = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(2, 2, 0, 0)),
+				    _MM_SHUFFLE(2, 2, 0, 0));
+    __m128i v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(uv, _MM_SHUFFLE(3, 3, 1, 1)),
+				    _MM_SHUFFLE(3, 3, 1, 1));
+    u = _mm_slli_epi16(u, 7);
+    v = _mm_slli_epi16(v, 7);
+
+    __m128i c = _mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(y, k16), 7),
+				_mm_set1_epi16(coef_y*2));
+
+    __m128i r = _mm_add_epi16(c, _mm_mulhi_epi16(v, _mm_set1_epi16(coef_rv*2)));
+    __m128i g = _mm_add_epi16(c, _mm_add_epi16(_mm_mulhi_epi16(u, _mm_set1_epi16(coef_gu*2)),
+					       _mm_mulhi_epi16(v, _mm_set1_epi16(coef_gv*2))));
+    __m128i b = _mm_add_epi16(c, _mm_mulhi_epi16(u, _mm_set1_epi16(coef_bu*2)));
+
+    // saturate to bytes and interleave as B G R A
+    __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+    __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), alpha);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst+4), _mm_unpackhi_epi16(bg, ra));
+  }
+
+#endif
+
+} // anonymous namespace
+
+/**
+   Converts a YUY2 frame to @a pixels.
+
+   @param src
+     First byte of the frame.
+
+   @param stride
+     Bytes of each scanline in @a src (usually width*2).
+*/
+void VideoFormats::yuy2ToPixels(const unsigned char* src, int stride,
+				ImagePixels& pixels)
+{
+  const int width = pixels.getWidth();
+  assert((width & 1) == 0);
+
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 for (int y=y0; y<y1; ++y) {
+		   const unsigned char* s = src + y*stride;
+		   pixel_type* dst = &pixels[0] + y*pixels.getScanlineSize();
+		   int x = 0;
+
+#ifdef VACA_SSE2
+		   // eight pixels (16 bytes) at a time
+		   const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+		   for (; x+8<=width; x+=8) {
+		     __m128i yuyv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + x*2));
+		     yuv_to_pixels_sse2(_mm_and_si128(yuyv, lowBytes),
+					_mm_srli_epi16(yuyv, 8),
+					dst + x);
+		   }
+#endif
+
+		   for (; x<width; x+=2) {
+		     const unsigned char* p = s + x*2;
+		     dst[x  ] = yuv_to_pixel(p[0], p[1], p[3]);
+		     dst[x+1] = yuv_to_pixel(p[2], p[1], p[3]);
+		   }
+		 }
+	       });
+}
+
+/**
+   Converts a NV12 frame to @a pixels.
+
+   @param srcY
+     First byte of the Y plane.
+
+   @param strideY
+     Bytes of each scanline in the Y plane (usually the width).
+
+   @param srcUV
+     First byte of the U/V plane (usually srcY + strideY*height).
+
+   @param strideUV
+     Bytes of each scanline in the U/V plane (usually the width).
+*/
+void VideoFormats::nv12ToPixels(const unsigned char* srcY, int strideY,
+				const unsigned char* srcUV, int strideUV,
+				ImagePixels& pixels)
+{
+  const int width = pixels.getWidth();
+
+  parallel_for(0, pixels.getHeight(), scanlines_per_thread,
+	       [&](int y0, int y1) {
+		 for (int y=y0; y<y1; ++y) {
+		   const unsigned char* sy = srcY + y*strideY;
+		   const unsigned char* suv = srcUV + (y/2)*strideUV;
+		   pixel_type* dst = &pixels[0] + y*pixels.getScanlineSize();
+		   int x = 0;
+
+#ifdef VACA_SSE2
+		   // eight pixels at a time (8 Y bytes and 4 U/V pairs)
+		   const __m128i zero = _mm_setzero_si128();
+		   for (; x+8<=width; x+=8) {
+		     __m128i yv = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(sy + x));
+		     __m128i uv = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(suv + x));
+		     yuv_to_pixels_sse2(_mm_unpacklo_epi8(yv, zero),
+					_mm_unpacklo_epi8(uv, zero),
+					dst + x);
+		   }
+#endif
+
+		   for (; x<width; ++x) {
+		     const unsigned char* p = suv + (x & ~1);
+		     dst[x] = yuv_to_pixel(sy[x], p[0], p[1]);
+		   }
+		 }
+	       });
+}
@@ -0,0 +1,42 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#ifndef VACA_VIDEOFORMATS_H
+#define VACA_VIDEOFORMATS_H
+
+#include "vaca/base.h"
+#include "vaca/ImagePixels.h"
+
+namespace vaca {
+
+/**
+   Conversions from the YUV formats used by video capture devices to
+   ImagePixels (BGRA in memory, opaque pixels).
+
+   The conversion uses the ITU-R BT.601 coefficients with video range
+   (Y from 16 to 235), which is what most webcams use. The size of
+   the frame is the size of the destination @a pixels.
+
+   @li YUY2: one plane, four bytes (Y0 U Y1 V) for each pair of pixels.
+   @li NV12: a plane of Y bytes, followed by a plane with half the
+       height of interleaved U and V bytes (one U/V pair for each 2x2
+       pixels).
+
+   @see FramePipeline
+*/
+namespace VideoFormats
+{
+  VACA_DLL void yuy2ToPixels(const unsigned char* src, int stride,
+			     ImagePixels& pixels);
+
+  VACA_DLL void nv12ToPixels(const unsigned char* srcY, int strideY,
+			     const unsigned char* srcUV, int strideUV,
+			     ImagePixels& pixels);
+}
+
+} // namespace vaca
+
+#endif // VACA_VIDEOFORMATS_H
@@ -26,6 +26,8 @@
 #include "vaca/Point.h"
 #include "vaca/Region.h"
 #include "vaca/System.h"
+#include "vaca/Thread.h"
+#include "vaca/BackingStore.h"
 #include "vaca/Mutex.h"
 #include "vaca/ScopedLock.h"
 #include "vaca/Command.h"
@@ -68,6 +70,39 @@ static void create_atom()
   }
 }
 
+namespace {
+
+  // Saves the state of a Graphics (with SaveDC and the fill rule) and
+  // restores it when it is destroyed, even if an exception is thrown
+  // while the Graphics is used
+  class SavedGraphicsState : private NonCopyable
+  {
+    Graphics& m_g;
+    int m_savedDC;
+    FillRule m_fillRule;
+
+    // not defined
+    SavedGraphicsState();
+
+  public:
+
+    SavedGraphicsState(Graphics& g)
+      : m_g(g)
+      , m_savedDC(SaveDC(g.getHandle()))
+      , m_fillRule(g.getFillRule())
+    {
+    }
+
+    ~SavedGraphicsState()
+    {
+      RestoreDC(m_g.getHandle(), m_savedDC);
+      m_g.setFillRule(m_fillRule);
+    }
+
+  };
+
+}
+
 // ============================================================
 // CTOR & DTOR
 // ============================================================
@@ -3019,12 +3054,16 @@ LRESULT Widget::defWndProc(UINT message, WPARAM wParam, LPARAM lParam)
    Paints the widgets calling the #onPaint event.
 
    This member function check the value of #m_doubleBuffered to do the
-   double-buffering technique (draw in a Graphics of a temporary
-   Image, and then copy its content to @a g).
+   double-buffering technique (draw in a Graphics of an off-screen
+   Image, and then copy its content to @a g). The image is taken from
+   the BackingStore of the current thread, so it is reused between
+   paints instead of being created for each @c WM_PAINT.
 
    @param g Where to draw.
 
    @internal
+
+   @see CurrentThread#getBackingStore
 */
 bool Widget::doPaint(Graphics& g)
 {
@@ -3036,40 +3075,53 @@ bool Widget::doPaint(Graphics& g)
     Rect clipBounds = g.getClipBounds();
     // is not it empty?
     if (!clipBounds.isEmpty()) {
-      // create the image for double-buffering (of the size of
+      // get the image for double-buffering (at least of the size of
       // the clipping bounds)
-      Image image(clipBounds.getSize(), g);
+      BackingStore& store = CurrentThread::getBackingStore();
+      BackingStoreImage backing(store, clipBounds.getSize(), g);
+      Image& image = backing.getImage();
       // get the Graphics to draw in the image
       Graphics& imageG = image.getGraphics();
       // background brush
-      Brush bgBrush(getBgColor());
-
-      // setup clipping region
-      Region clipRegion;
-      g.getClipRegion(clipRegion);
-      clipRegion.offset(-clipBounds.x, -clipBounds.y);
-      imageG.setClipRegion(clipRegion);
-
-      // special coordinates transformation (to make the "imageG"
-      // graphics transparent to "onPaint" member function)
-      SetViewportOrgEx(imageG.getHandle(), -clipBounds.x, -clipBounds.y, NULL);
+      Brush bgBrush = store.getBrush(getBgColor());
 
-      // clear the background of the image
-      imageG.fillRect(bgBrush, clipBounds);
-
-      // configure defaults
-      imageG.setFont(getFont());
-
-      // paint on imageG
-      PaintEvent ev(this, imageG);
-      onPaint(ev);
-      painted = ev.isPainted();
-
-      // restore the viewport origin (so drawImage works fine)
-      SetViewportOrgEx(imageG.getHandle(), 0, 0, NULL);
+      {
+	// the image is shared with other widgets, so its Graphics
+	// state (the viewport origin and clipping region too, so
+	// drawImage works fine) is restored after painting
+	SavedGraphicsState saved(imageG);
+
+	// setup clipping region (reusing the same HRGN, GetClipRgn
+	// doesn't modify it if "g" hasn't a clipping region)
+	Region& clipRegion = store.getRegion();
+	SetRectRgn(clipRegion.getHandle(),
+		   clipBounds.x, clipBounds.y,
+		   clipBounds.x+clipBounds.w, clipBounds.y+clipBounds.h);
+	GetClipRgn(g.getHandle(), clipRegion.getHandle());
+	clipRegion.offset(-clipBounds.x, -clipBounds.y);
+	imageG.setClipRegion(clipRegion);
+
+	// special coordinates transformation (to make the "imageG"
+	// graphics transparent to "onPaint" member function)
+	SetViewportOrgEx(imageG.getHandle(), -clipBounds.x, -clipBounds.y, NULL);
+
+	// clear the background of the image
+	imageG.fillRect(bgBrush, clipBounds);
+
+	// configure defaults
+	imageG.setFont(getFont());
+
+	// paint on imageG
+	PaintEvent ev(this, imageG);
+	onPaint(ev);
+	painted = ev.isPainted();
+      }
 
-      // bit transfer from image to graphics device
-      g.drawImage(image, clipBounds.getOrigin());
+      // bit transfer from image to graphics device (only the used
+      // part of the image)
+      g.drawImage(image,
+		  clipBounds.x, clipBounds.y,
+		  0, 0, clipBounds.w, clipBounds.h);
     }
   }
   // draw directly to the screen
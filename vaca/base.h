@@ -301,6 +301,24 @@ enum class CardinalDirection
 
 // ======================================================================
 
+/**
+   Rule to know which points are inside a shape with crossed or
+   nested figures.
+
+   One of the following values:
+   @li FillRule::EvenOdd (default): a point is inside if a ray from
+       it crosses the edges an odd number of times.
+   @li FillRule::Winding: a point is inside if the edges go around it
+       a non-zero number of times (counting the direction).
+*/
+enum class FillRule
+{
+  EvenOdd,
+  Winding
+};
+
+// ======================================================================
+
 /**
    Removes an @a element from the specified STL @a container.
 
@@ -334,6 +352,7 @@ void remove_from_container(ContainerType& container,
 class Anchor;
 class AnchorLayout;
 class Application;
+class BackingStore;
 class BandedDockArea;
 class BasicDockArea;
 class Bix;
@@ -415,6 +434,7 @@ class OpenFileDialog;
 class PaintEvent;
 class Pen;
 class Point;
+class PointF;
 class PopupMenu;
 class PreferredSizeEvent;
 class ProgressBar;
@@ -424,6 +444,7 @@ class RadioGroup;
 class ReBar;
 class ReBarBand;
 class Rect;
+class RectF;
 class Referenceable;
 class Region;
 class ResizeEvent;
@@ -438,6 +459,7 @@ class ScrollInfo;
 class Separator;
 class SetCursorEvent;
 class Size;
+class SizeF;
 class Slider;
 class SpinButton;
 class Spinner;
@@ -455,6 +477,7 @@ class ToggleButton;
 class ToolBar;
 class ToolButton;
 class ToolSet;
+class Transform;
 class TreeNode;
 class TreeView;
 class TreeViewEvent;
@@ -12,7 +12,9 @@
 #include "vaca/Anchor.h"
 #include "vaca/AnchorLayout.h"
 #include "vaca/Application.h"
+#include "vaca/BackingStore.h"
 // #include "vaca/BandedDockArea.h"
+#include "vaca/BandedRegion.h"
 // #include "vaca/BasicDockArea.h"
 #include "vaca/Bix.h"
 #include "vaca/BoxConstraint.h"
@@ -27,17 +29,21 @@
 #include "vaca/CloseEvent.h"
 #include "vaca/Color.h"
 #include "vaca/ColorDialog.h"
+#include "vaca/ColorQuantizer.h"
+#include "vaca/ColorSpaces.h"
 #include "vaca/ComboBox.h"
 #include "vaca/Command.h"
 #include "vaca/CommandEvent.h"
 #include "vaca/CommonDialog.h"
 #include "vaca/Component.h"
+#include "vaca/Compositor.h"
 #include "vaca/ConditionVariable.h"
 #include "vaca/Constraint.h"
 #include "vaca/ConsumableEvent.h"
 #include "vaca/Cursor.h"
 #include "vaca/CustomButton.h"
 #include "vaca/CustomLabel.h"
+#include "vaca/DamageDetector.h"
 #include "vaca/DataGrid.h"
 #include "vaca/Debug.h"
 #include "vaca/Dialog.h"
@@ -55,6 +61,7 @@
 #include "vaca/Font.h"
 #include "vaca/FontDialog.h"
 #include "vaca/Frame.h"
+#include "vaca/FramePipeline.h"
 #include "vaca/GdiObject.h"
 #include "vaca/Graphics.h"
 #include "vaca/GraphicsPath.h"
@@ -62,7 +69,12 @@
 #include "vaca/HttpRequest.h"
 #include "vaca/Icon.h"
 #include "vaca/Image.h"
+#include "vaca/ImageAtlas.h"
+#include "vaca/ImageCache.h"
+#include "vaca/ImageFilters.h"
 #include "vaca/ImageList.h"
+#include "vaca/ImagePyramid.h"
+#include "vaca/ImageResampler.h"
 #include "vaca/KeyEvent.h"
 #include "vaca/Keys.h"
 #include "vaca/Label.h"
@@ -82,14 +94,23 @@
 #include "vaca/Mutex.h"
 #include "vaca/NonCopyable.h"
 #include "vaca/PaintEvent.h"
+#include "vaca/ParallelFor.h"
 #include "vaca/ParseException.h"
+#include "vaca/PathClipper.h"
+#include "vaca/PathCodec.h"
+#include "vaca/PathRasterizer.h"
+#include "vaca/PathStroker.h"
 #include "vaca/Pen.h"
 #include "vaca/Point.h"
+#include "vaca/PointF.h"
 #include "vaca/PreferredSizeEvent.h"
 #include "vaca/ProgressBar.h"
 #include "vaca/RadioButton.h"
 #include "vaca/ReBar.h"
 #include "vaca/Rect.h"
+#include "vaca/RectArray.h"
+#include "vaca/RectF.h"
+#include "vaca/RectTree.h"
 #include "vaca/Referenceable.h"
 #include "vaca/Region.h"
 #include "vaca/Register.h"
@@ -107,6 +128,8 @@
 #include "vaca/SharedPtr.h"
 #include "vaca/Signal.h"
 #include "vaca/Size.h"
+#include "vaca/SizeF.h"
+#include "vaca/SkylinePacker.h"
 #include "vaca/Slider.h"
 #include "vaca/Slot.h"
 #include "vaca/SpinButton.h"
@@ -114,18 +137,22 @@
 #include "vaca/SplitBar.h"
 #include "vaca/StatusBar.h"
 #include "vaca/String.h"
+#include "vaca/StrokeFitter.h"
 #include "vaca/Style.h"
 #include "vaca/System.h"
 #include "vaca/Tab.h"
 #include "vaca/TextEdit.h"
 #include "vaca/Thread.h"
+#include "vaca/TiledSurface.h"
 #include "vaca/TimePoint.h"
 #include "vaca/Timer.h"
 #include "vaca/ToggleButton.h"
 #include "vaca/ToolBar.h"
+#include "vaca/Transform.h"
 #include "vaca/TreeNode.h"
 #include "vaca/TreeView.h"
 #include "vaca/TreeViewEvent.h"
+#include "vaca/VideoFormats.h"
 #include "vaca/Widget.h"
 #include "vaca/WidgetClass.h"
 #include "vaca/WidgetHit.h"